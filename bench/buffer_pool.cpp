@@ -0,0 +1,67 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/buffer_pool.hpp"
+
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+const std::size_t buffer_sizes[] = { 1024, 16 * 1024, 64 * 1024 };
+
+// Keeps the compiler from eliding the allocations.
+volatile uint8_t sink;
+
+// Get a fresh buffer for each operation, as the examples do.
+void per_operation_vector(state& st, std::size_t size)
+{
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    std::vector<uint8_t> buf(size);
+    buf[size - 1] = static_cast<uint8_t>(i);
+    sink = buf[size - 1];
+  }
+
+  st.set_items_per_iteration(1);
+}
+
+void per_operation_lease(state& st, std::size_t size)
+{
+  buffer_pool pool(1024, 64 * 1024);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    pooled_buffer buf = pool.acquire(size);
+    buf.data()[size - 1] = static_cast<uint8_t>(i);
+    sink = buf.data()[size - 1];
+  }
+
+  st.set_items_per_iteration(1);
+}
+
+void register_buffer_pool_benchmarks()
+{
+  using std::placeholders::_1;
+
+  for (std::size_t i = 0;
+       i != sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); ++i) {
+    const std::string suffix = "/" + size_string(buffer_sizes[i]);
+    register_benchmark("buffer_pool/vector" + suffix,
+                       std::bind(&per_operation_vector, _1, buffer_sizes[i]));
+    register_benchmark("buffer_pool/lease" + suffix,
+                       std::bind(&per_operation_lease, _1, buffer_sizes[i]));
+  }
+}
+
+ASIOEXT_BENCH_REGISTER(register_buffer_pool_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
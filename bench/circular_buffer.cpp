@@ -0,0 +1,75 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/circular_buffer.hpp"
+#include "asioext/mirrored_circular_buffer.hpp"
+#include "asioext/linear_buffer.hpp"
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+const std::size_t buffer_sizes[] = { 4 * 1024, 64 * 1024, 1024 * 1024 };
+
+const std::size_t max_chunk_size = 4096;
+const uint8_t payload[max_chunk_size] = {};
+
+// Simulate a streaming parser: the buffer holds |size| bytes of unparsed
+// data, of which a small message is consumed from the front before the
+// same amount is received at the back.
+template <typename Buffer, typename DynamicBuffer>
+void stream_parse(state& st, std::size_t size)
+{
+  const std::size_t message = 16;
+
+  Buffer storage;
+  DynamicBuffer buf(storage);
+  asio::buffer_copy(buf.prepare(size), asio::buffer(payload, max_chunk_size));
+  buf.commit(size);
+
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    buf.consume(message);
+    asio::buffer_copy(buf.prepare(message), asio::buffer(payload, message));
+    buf.commit(message);
+  }
+
+  st.set_bytes_per_iteration(message);
+}
+
+void register_circular_buffer_benchmarks()
+{
+  using std::placeholders::_1;
+
+  for (std::size_t i = 0;
+       i != sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); ++i) {
+    const std::string suffix = "/" + size_string(buffer_sizes[i]);
+    register_benchmark("dynamic_linear_buffer/stream_parse" + suffix,
+        std::bind(&stream_parse<linear_buffer,
+                                dynamic_linear_buffer<std::allocator<uint8_t>>>,
+                  _1, buffer_sizes[i]));
+    register_benchmark("dynamic_circular_buffer/stream_parse" + suffix,
+        std::bind(&stream_parse<circular_buffer,
+                                dynamic_circular_buffer<circular_buffer>>,
+                  _1, buffer_sizes[i]));
+#if defined(ASIOEXT_HAS_MIRRORED_MEMORY)
+    register_benchmark("mirrored_circular_buffer/stream_parse" + suffix,
+        std::bind(&stream_parse<mirrored_circular_buffer,
+                      dynamic_circular_buffer<mirrored_circular_buffer>>,
+                  _1, buffer_sizes[i]));
+#endif
+  }
+}
+
+ASIOEXT_BENCH_REGISTER(register_circular_buffer_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
@@ -0,0 +1,232 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/composed_operation.hpp"
+
+#include "asioext/detail/handler_work.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+#else
+# include <asio/io_service.hpp>
+#endif
+
+#include <cstdlib>
+#include <memory>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+// Number of asynchronous steps of each operation.
+const int chain_length = 5;
+
+// Size of the per-operation state that is carried from step to step,
+// e.g. a DynamicBuffer and a few counters in the SOCKS operations.
+const std::size_t state_size = 128;
+
+struct allocation_counter
+{
+  allocation_counter()
+    : allocations(0)
+    , bytes(0)
+  {
+    // ctor
+  }
+
+  std::size_t allocations;
+  std::size_t bytes;
+};
+
+// Counts the memory requested through the handler's hooks and allocator.
+template <typename T>
+class counting_allocator
+{
+public:
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef counting_allocator<U> other;
+  };
+
+  explicit counting_allocator(allocation_counter* counter)
+    : counter_(counter)
+  {
+    // ctor
+  }
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other)
+    : counter_(other.counter_)
+  {
+    // ctor
+  }
+
+  T* allocate(std::size_t n)
+  {
+    ++counter_->allocations;
+    counter_->bytes += sizeof(T) * n;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(const counting_allocator<U>& other) const
+  {
+    return counter_ == other.counter_;
+  }
+
+  template <typename U>
+  bool operator!=(const counting_allocator<U>& other) const
+  {
+    return counter_ != other.counter_;
+  }
+
+private:
+  template <typename U>
+  friend class counting_allocator;
+
+  allocation_counter* counter_;
+};
+
+template <typename Start>
+struct chain_handler
+{
+  void operator()(int)
+  {
+    if (--*remaining != 0)
+      Start()(io_service, *this);
+  }
+
+#if (ASIOEXT_ASIO_VERSION >= 101100)
+  typedef counting_allocator<void> allocator_type;
+
+  allocator_type get_allocator() const
+  {
+    return allocator_type(counter);
+  }
+#endif
+
+  asio::io_service& io_service;
+  allocation_counter* counter;
+  std::size_t* remaining;
+};
+
+template <typename Start>
+void* asio_handler_allocate(std::size_t size,
+                            chain_handler<Start>* this_handler)
+{
+  ++this_handler->counter->allocations;
+  this_handler->counter->bytes += size;
+  return std::malloc(size);
+}
+
+template <typename Start>
+void asio_handler_deallocate(void* pointer, std::size_t,
+                             chain_handler<Start>*)
+{
+  std::free(pointer);
+}
+
+// Moved into a new handler on every step (make_composed_operation).
+struct moving_chain_op
+{
+  template <typename Handler>
+  void operator()(Handler&& handler)
+  {
+    if (++step != chain_length) {
+      detail::post_handler(io_service, make_composed_operation(
+          std::move(handler), std::move(*this)));
+      return;
+    }
+    handler(step);
+  }
+
+  asio::io_service& io_service;
+  int step;
+  char data[state_size];
+};
+
+struct start_moving_chain
+{
+  template <typename Handler>
+  void operator()(asio::io_service& io_service, const Handler& handler)
+  {
+    moving_chain_op op = { io_service, 0, {} };
+    op(Handler(handler));
+  }
+};
+
+// Allocated once, only a pointer is passed between the steps
+// (allocate_composed_operation).
+struct allocated_chain_op
+{
+  template <typename Self>
+  void operator()(Self& self)
+  {
+    if (++step != chain_length) {
+      detail::post_handler(io_service, std::move(self));
+      return;
+    }
+    self.complete(step);
+  }
+
+  asio::io_service& io_service;
+  int step;
+  char data[state_size];
+};
+
+struct start_allocated_chain
+{
+  template <typename Handler>
+  void operator()(asio::io_service& io_service, const Handler& handler)
+  {
+    allocated_chain_op op = { io_service, 0, {} };
+    allocate_composed_operation(Handler(handler), op)();
+  }
+};
+
+template <typename Start>
+void run_chains(state& st)
+{
+  asio::io_service io_service;
+  allocation_counter counter;
+  std::size_t remaining = st.iterations();
+
+  chain_handler<Start> handler = { io_service, &counter, &remaining };
+  Start()(io_service, handler);
+  io_service.run();
+
+  const double n = static_cast<double>(st.iterations());
+  st.set_items_per_iteration(1);
+  st.set_counter("allocations/op", counter.allocations / n);
+  st.set_counter("allocated_bytes/op", counter.bytes / n);
+}
+
+void register_composed_operation_benchmarks()
+{
+  register_benchmark("composed_operation/chain5/make_composed_operation",
+                     &run_chains<start_moving_chain>);
+  register_benchmark("composed_operation/chain5/allocate_composed_operation",
+                     &run_chains<start_allocated_chain>);
+}
+
+ASIOEXT_BENCH_REGISTER(register_composed_operation_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
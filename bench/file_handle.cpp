@@ -0,0 +1,256 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/unique_file_handle.hpp"
+#include "asioext/open.hpp"
+#include "asioext/write_file.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/read.hpp>
+# include <boost/asio/write.hpp>
+#else
+# include <asio/read.hpp>
+# include <asio/write.hpp>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+const std::size_t block_sizes[] = {
+  512, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024
+};
+
+// Sequential I/O wraps around inside a window of this size, so the file
+// doesn't grow unbounded with the iteration count.
+uint64_t window_size()
+{
+  return (std::min)(current_options().max_file_size,
+                    static_cast<uint64_t>(16 * 1024 * 1024));
+}
+
+void prepare_file(const temp_file& file, uint64_t size)
+{
+  std::vector<char> data(static_cast<std::size_t>(size), 'x');
+  write_file(file.path(), asio::buffer(data));
+}
+
+void write_some(state& st, std::size_t block_size)
+{
+  st.pause_timing();
+  temp_file file("file_handle_write_some");
+  unique_file_handle fh = open(file.path(), open_flags::access_write |
+                                            open_flags::create_always);
+  std::vector<char> data(block_size, 'x');
+  const uint64_t window = (std::max)(window_size(),
+                                     static_cast<uint64_t>(block_size));
+  st.resume_timing();
+
+  uint64_t pos = 0;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    if (pos + block_size > window) {
+      fh.seek(seek_origin::from_begin, 0);
+      pos = 0;
+    }
+    pos += asio::write(fh, asio::buffer(data));
+  }
+
+  st.set_bytes_per_iteration(block_size);
+}
+
+void read_some(state& st, std::size_t block_size)
+{
+  st.pause_timing();
+  temp_file file("file_handle_read_some");
+  const uint64_t window = (std::max)(window_size(),
+                                     static_cast<uint64_t>(block_size));
+  prepare_file(file, window);
+  unique_file_handle fh = open(file.path(), open_flags::access_read |
+                                            open_flags::open_existing);
+  std::vector<char> data(block_size);
+  st.resume_timing();
+
+  uint64_t pos = 0;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    if (pos + block_size > window) {
+      fh.seek(seek_origin::from_begin, 0);
+      pos = 0;
+    }
+    pos += asio::read(fh, asio::buffer(data));
+  }
+
+  st.set_bytes_per_iteration(block_size);
+}
+
+void write_some_at(state& st, std::size_t block_size)
+{
+  st.pause_timing();
+  temp_file file("file_handle_write_some_at");
+  unique_file_handle fh = open(file.path(), open_flags::access_write |
+                                            open_flags::create_always);
+  std::vector<char> data(block_size, 'x');
+  const uint64_t window = (std::max)(window_size(),
+                                     static_cast<uint64_t>(block_size));
+  st.resume_timing();
+
+  uint64_t pos = 0;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    if (pos + block_size > window)
+      pos = 0;
+    pos += fh.write_some_at(pos, asio::buffer(data));
+  }
+
+  st.set_bytes_per_iteration(block_size);
+}
+
+void read_some_at(state& st, std::size_t block_size)
+{
+  st.pause_timing();
+  temp_file file("file_handle_read_some_at");
+  const uint64_t window = (std::max)(window_size(),
+                                     static_cast<uint64_t>(block_size));
+  prepare_file(file, window);
+  unique_file_handle fh = open(file.path(), open_flags::access_read |
+                                            open_flags::open_existing);
+  std::vector<char> data(block_size);
+  st.resume_timing();
+
+  uint64_t pos = 0;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    if (pos + block_size > window)
+      pos = 0;
+    pos += fh.read_some_at(pos, asio::buffer(data));
+  }
+
+  st.set_bytes_per_iteration(block_size);
+}
+
+// Gather-write |segments| buffers of |segment_size| bytes with a single
+// write_some_at() call, which has to consume the whole sequence.
+void gather_write(state& st, std::size_t segments, std::size_t segment_size)
+{
+  st.pause_timing();
+  temp_file file("file_handle_gather_write");
+  unique_file_handle fh = open(file.path(), open_flags::access_write |
+                                            open_flags::create_always);
+  std::vector<char> data(segments * segment_size, 'x');
+  std::vector<asio::const_buffer> buffers;
+  for (std::size_t i = 0; i != segments; ++i)
+    buffers.push_back(asio::buffer(&data[i * segment_size], segment_size));
+
+  const uint64_t window = (std::max)(window_size(),
+                                     static_cast<uint64_t>(data.size()));
+  st.resume_timing();
+
+  uint64_t pos = 0;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    if (pos + data.size() > window)
+      pos = 0;
+    const std::size_t written = fh.write_some_at(pos, buffers);
+    if (written != data.size()) {
+      st.fail("short gather write");
+      return;
+    }
+    pos += written;
+  }
+
+  st.set_bytes_per_iteration(data.size());
+}
+
+// Query size, permissions, attributes and times with one call each.
+void metadata_separate(state& st)
+{
+  st.pause_timing();
+  temp_file file("file_handle_metadata_separate");
+  prepare_file(file, 4096);
+  unique_file_handle fh = open(file.path(), open_flags::access_read |
+                                            open_flags::open_existing);
+  st.resume_timing();
+
+  uint64_t total = 0;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    total += fh.size();
+    total += static_cast<uint64_t>(fh.permissions());
+    total += static_cast<uint64_t>(fh.attributes());
+    total += fh.times().mtime.time_since_epoch().count() != 0;
+  }
+
+  if (total == 0)
+    st.fail("no metadata");
+  st.set_items_per_iteration(1);
+}
+
+// Query the same values with a single status() call.
+void metadata_status(state& st)
+{
+  st.pause_timing();
+  temp_file file("file_handle_metadata_status");
+  prepare_file(file, 4096);
+  unique_file_handle fh = open(file.path(), open_flags::access_read |
+                                            open_flags::open_existing);
+  st.resume_timing();
+
+  uint64_t total = 0;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    const file_status s = fh.status(file_status_mask::size |
+                                    file_status_mask::perms |
+                                    file_status_mask::attrs |
+                                    file_status_mask::times);
+    total += s.size;
+    total += static_cast<uint64_t>(s.perms);
+    total += static_cast<uint64_t>(s.attrs);
+    total += s.mtime.time_since_epoch().count() != 0;
+  }
+
+  if (total == 0)
+    st.fail("no metadata");
+  st.set_items_per_iteration(1);
+}
+
+void register_file_handle_benchmarks()
+{
+  using std::placeholders::_1;
+
+  for (std::size_t i = 0; i != sizeof(block_sizes) / sizeof(block_sizes[0]);
+       ++i) {
+    const std::size_t bs = block_sizes[i];
+    const std::string suffix = "/" + size_string(bs);
+    register_benchmark("file_handle/write" + suffix,
+                       std::bind(&write_some, _1, bs));
+    register_benchmark("file_handle/read" + suffix,
+                       std::bind(&read_some, _1, bs));
+    register_benchmark("file_handle/write_some_at" + suffix,
+                       std::bind(&write_some_at, _1, bs));
+    register_benchmark("file_handle/read_some_at" + suffix,
+                       std::bind(&read_some_at, _1, bs));
+  }
+
+  static const std::size_t segment_sizes[] = { 16, 512, 4096 };
+  for (std::size_t i = 0;
+       i != sizeof(segment_sizes) / sizeof(segment_sizes[0]); ++i) {
+    const std::size_t ss = segment_sizes[i];
+    register_benchmark("file_handle/gather_write/1k_segments/" +
+                       size_string(ss),
+                       std::bind(&gather_write, _1, 1024, ss));
+  }
+
+  register_benchmark("file_handle/metadata/separate", &metadata_separate);
+  register_benchmark("file_handle/metadata/status", &metadata_status);
+}
+
+ASIOEXT_BENCH_REGISTER(register_file_handle_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
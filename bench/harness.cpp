@@ -0,0 +1,218 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+#include "report.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+struct entry
+{
+  std::string name;
+  function_type fn;
+};
+
+std::vector<entry>& registry()
+{
+  static std::vector<entry> r;
+  return r;
+}
+
+options& mutable_options()
+{
+  static options o;
+  return o;
+}
+
+double to_ns(clock_type::duration d)
+{
+  return static_cast<double>(
+      chrono::duration_cast<chrono::nanoseconds>(d).count());
+}
+
+double percentile(std::vector<clock_type::duration>& v, double p)
+{
+  const std::size_t i = static_cast<std::size_t>(
+      p * static_cast<double>(v.size() - 1) + 0.5);
+  std::nth_element(v.begin(), v.begin() + i, v.end());
+  return to_ns(v[i]);
+}
+
+// Execute |fn| once with |iterations| and return the net duration.
+clock_type::duration run_once(const function_type& fn, state& st)
+{
+  const clock_type::time_point start = clock_type::now();
+  try {
+    fn(st);
+  } catch (std::exception& e) {
+    st.fail(e.what());
+  }
+  return (clock_type::now() - start) - st.paused();
+}
+
+}
+
+void register_benchmark(const std::string& name, function_type fn)
+{
+  entry e;
+  e.name = name;
+  e.fn = fn;
+  registry().push_back(e);
+}
+
+const options& current_options()
+{
+  return mutable_options();
+}
+
+std::string temp_path(const std::string& name)
+{
+  const std::string& dir = current_options().directory;
+  if (dir.empty())
+    return "asioext_bench_" + name;
+  return dir + "/asioext_bench_" + name;
+}
+
+temp_file::temp_file(const std::string& name)
+  : path_(temp_path(name))
+{
+  std::remove(path_.c_str());
+}
+
+temp_file::~temp_file()
+{
+  std::remove(path_.c_str());
+}
+
+std::string size_string(uint64_t n)
+{
+  static const char suffixes[] = { 'k', 'm', 'g', 't' };
+
+  char buf[32];
+  int i = -1;
+  while (n >= 1024 && n % 1024 == 0 && i != 3) {
+    n /= 1024;
+    ++i;
+  }
+
+  if (i == -1)
+    std::snprintf(buf, sizeof(buf), "%llu",
+                  static_cast<unsigned long long>(n));
+  else
+    std::snprintf(buf, sizeof(buf), "%llu%c",
+                  static_cast<unsigned long long>(n), suffixes[i]);
+  return buf;
+}
+
+result run_benchmark(const std::string& name, const function_type& fn)
+{
+  const options& opts = current_options();
+
+  result res;
+  res.name = name;
+
+  // Calibrate the iteration count, so that a run takes at least min_time.
+  std::size_t n = 1;
+  std::vector<double> samples;
+  std::vector<clock_type::duration> latencies;
+  while (true) {
+    state st(n);
+    const clock_type::duration d = run_once(fn, st);
+    if (!st.error().empty()) {
+      res.error = st.error();
+      return res;
+    }
+    if (!st.skipped().empty()) {
+      res.skipped = st.skipped();
+      return res;
+    }
+
+    if (d >= opts.min_time || n >= 1000000000) {
+      samples.push_back(to_ns(d) / static_cast<double>(n));
+      latencies.insert(latencies.end(), st.latencies().begin(),
+                       st.latencies().end());
+      res.bytes_per_iteration = st.bytes_per_iteration();
+      res.items_per_iteration = st.items_per_iteration();
+      res.counters = st.counters();
+      break;
+    }
+
+    const double elapsed = (std::max)(to_ns(d), 1.0);
+    const double target = to_ns(opts.min_time) * 1.2;
+    const double next = static_cast<double>(n) * target / elapsed;
+    n = static_cast<std::size_t>((std::min)(
+        (std::max)(next, static_cast<double>(n) + 1.0),
+        static_cast<double>(n) * 10.0));
+  }
+
+  for (std::size_t i = 1; i < opts.repetitions; ++i) {
+    state st(n);
+    const clock_type::duration d = run_once(fn, st);
+    if (!st.error().empty()) {
+      res.error = st.error();
+      return res;
+    }
+
+    samples.push_back(to_ns(d) / static_cast<double>(n));
+    latencies.insert(latencies.end(), st.latencies().begin(),
+                     st.latencies().end());
+  }
+
+  std::sort(samples.begin(), samples.end());
+  res.iterations = n;
+  res.repetitions = samples.size();
+  res.ns_per_iteration = samples[samples.size() / 2];
+  res.min_ns_per_iteration = samples.front();
+  res.max_ns_per_iteration = samples.back();
+
+  if (!latencies.empty()) {
+    res.has_latency = true;
+    res.latency_p50_ns = percentile(latencies, 0.50);
+    res.latency_p90_ns = percentile(latencies, 0.90);
+    res.latency_p99_ns = percentile(latencies, 0.99);
+  }
+  return res;
+}
+
+std::vector<std::string> benchmark_names()
+{
+  std::vector<std::string> names;
+  for (std::size_t i = 0, n = registry().size(); i != n; ++i)
+    names.push_back(registry()[i].name);
+  return names;
+}
+
+std::size_t run_benchmarks(const options& opts, reporter& rep)
+{
+  mutable_options() = opts;
+
+  std::size_t failed = 0;
+  rep.begin();
+  for (std::size_t i = 0, n = registry().size(); i != n; ++i) {
+    const entry& e = registry()[i];
+    if (!opts.filter.empty() && e.name.find(opts.filter) == std::string::npos)
+      continue;
+
+    const result res = run_benchmark(e.name, e.fn);
+    if (!res.error.empty())
+      ++failed;
+
+    rep.report(res);
+  }
+  rep.end();
+  return failed;
+}
+
+}
+
+ASIOEXT_NS_END
@@ -0,0 +1,179 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_BENCH_HARNESS_HPP
+#define ASIOEXT_BENCH_HARNESS_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/chrono.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+typedef chrono::steady_clock clock_type;
+
+// Passed to every benchmark function. A benchmark has to execute its
+// operation iterations() times; the harness calibrates the count so that a
+// single run takes at least the configured minimum time.
+class state
+{
+public:
+  explicit state(std::size_t iterations)
+    : iterations_(iterations)
+    , bytes_per_iteration_(0)
+    , items_per_iteration_(1)
+    , paused_(clock_type::duration::zero())
+  {
+    // ctor
+  }
+
+  std::size_t iterations() const { return iterations_; }
+
+  // Number of payload bytes moved by one iteration.
+  // Used to report a throughput.
+  void set_bytes_per_iteration(uint64_t n) { bytes_per_iteration_ = n; }
+  uint64_t bytes_per_iteration() const { return bytes_per_iteration_; }
+
+  // Number of operations performed by one iteration.
+  void set_items_per_iteration(uint64_t n) { items_per_iteration_ = n; }
+  uint64_t items_per_iteration() const { return items_per_iteration_; }
+
+  // Exclude setup work (e.g. re-creating a file) from the measurement.
+  void pause_timing() { pause_start_ = clock_type::now(); }
+  void resume_timing() { paused_ += clock_type::now() - pause_start_; }
+  clock_type::duration paused() const { return paused_; }
+
+  // Record the latency of a single operation. If any latencies were
+  // recorded, percentiles are included in the report.
+  void record_latency(clock_type::duration d) { latencies_.push_back(d); }
+  std::vector<clock_type::duration>& latencies() { return latencies_; }
+
+  // Report an additional value (e.g. allocations per operation) along
+  // with the timing results.
+  void set_counter(const std::string& name, double value)
+  {
+    counters_.push_back(std::make_pair(name, value));
+  }
+
+  const std::vector<std::pair<std::string, double> >& counters() const
+  {
+    return counters_;
+  }
+
+  // Mark this benchmark as failed. The harness reports the message
+  // instead of timing results.
+  void fail(const std::string& message) { error_ = message; }
+  const std::string& error() const { return error_; }
+
+  // Mark this benchmark as not applicable (e.g. due to the current options).
+  void skip(const std::string& reason) { skipped_ = reason; }
+  const std::string& skipped() const { return skipped_; }
+
+private:
+  std::size_t iterations_;
+  uint64_t bytes_per_iteration_;
+  uint64_t items_per_iteration_;
+  clock_type::time_point pause_start_;
+  clock_type::duration paused_;
+  std::vector<clock_type::duration> latencies_;
+  std::vector<std::pair<std::string, double> > counters_;
+  std::string error_;
+  std::string skipped_;
+};
+
+typedef std::function<void (state&)> function_type;
+
+struct options
+{
+  options()
+    : min_time(chrono::milliseconds(250))
+    , repetitions(3)
+    , max_file_size(64 * 1024 * 1024)
+    , directory(".")
+  {
+    // ctor
+  }
+
+  // Minimum duration of a single calibrated run.
+  clock_type::duration min_time;
+
+  // Number of calibrated runs. The median is reported.
+  std::size_t repetitions;
+
+  // Upper limit for generated file sizes (read_file/write_file etc.)
+  uint64_t max_file_size;
+
+  // Directory in which temporary files are created.
+  std::string directory;
+
+  // Only benchmarks whose name contains this string are run.
+  std::string filter;
+};
+
+// Register a benchmark. |name| uses '/' to separate the benchmark
+// and its parameters, e.g. "file_handle/read_some/4096".
+void register_benchmark(const std::string& name, function_type fn);
+
+// Options of the current run, for benchmarks that need to create files
+// or scale their parameters.
+const options& current_options();
+
+// Build a temporary file path inside options::directory.
+std::string temp_path(const std::string& name);
+
+// Removes the named temporary file on construction and destruction.
+class temp_file
+{
+public:
+  explicit temp_file(const std::string& name);
+  ~temp_file();
+
+  const char* path() const { return path_.c_str(); }
+
+private:
+  temp_file(const temp_file&) ASIOEXT_DELETED;
+  temp_file& operator=(const temp_file&) ASIOEXT_DELETED;
+
+  std::string path_;
+};
+
+// Format a byte count as a short parameter string (4k, 16m, ...).
+std::string size_string(uint64_t n);
+
+// Helper for registering benchmarks at static-initialization time.
+struct registrar
+{
+  explicit registrar(void (*fn)())
+  {
+    fn();
+  }
+};
+
+}
+
+ASIOEXT_NS_END
+
+#define ASIOEXT_BENCH_CONCAT_IMPL(a, b) a ## b
+#define ASIOEXT_BENCH_CONCAT(a, b) ASIOEXT_BENCH_CONCAT_IMPL(a, b)
+
+// Run |fn| at startup to register a set of benchmarks.
+#define ASIOEXT_BENCH_REGISTER(fn) \
+  static const ::asioext::bench::registrar \
+    ASIOEXT_BENCH_CONCAT(asioext_bench_registrar_, __LINE__)(&fn)
+
+#endif
@@ -0,0 +1,248 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/linear_buffer.hpp"
+#include "asioext/small_linear_buffer.hpp"
+
+#include <algorithm>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+const std::size_t chunk_sizes[] = { 1, 16, 256, 4096 };
+const std::size_t buffer_sizes[] = { 256, 4 * 1024, 64 * 1024 };
+
+const std::size_t max_chunk_size = 4096;
+const uint8_t payload[max_chunk_size] = {};
+
+// Append into a buffer with sufficient capacity.
+void append(state& st, std::size_t chunk)
+{
+  const std::size_t limit = 1024 * 1024;
+
+  linear_buffer buf;
+  buf.reserve(limit);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    if (buf.size() + chunk > limit)
+      buf.clear();
+    buf.append(payload, chunk);
+  }
+
+  st.set_bytes_per_iteration(chunk);
+}
+
+// Build a buffer of |total| bytes from scratch, including all reallocations.
+void append_grow(state& st, std::size_t total, linear_buffer_growth policy)
+{
+  const std::size_t chunk = 64;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    linear_buffer buf;
+    buf.growth_policy(policy);
+    for (std::size_t size = 0; size < total; size += chunk)
+      buf.append(payload, chunk);
+  }
+
+  st.set_bytes_per_iteration(total);
+}
+
+// Insert a small chunk in the middle and remove it again.
+void insert_erase_middle(state& st, std::size_t size)
+{
+  const std::size_t chunk = 16;
+
+  linear_buffer buf;
+  buf.reserve(size + chunk);
+  buf.resize(size);
+  const std::size_t mid = size / 2;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    buf.insert(mid, payload, chunk);
+    buf.erase(mid, mid + chunk);
+  }
+
+  st.set_items_per_iteration(2);
+}
+
+// Consume a small chunk from the front and refill at the back,
+// i.e. use the buffer as a FIFO.
+void erase_front(state& st, std::size_t size)
+{
+  const std::size_t chunk = 16;
+
+  linear_buffer buf;
+  buf.reserve(size + chunk);
+  buf.resize(size);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    buf.erase(0, chunk);
+    buf.append(payload, chunk);
+  }
+
+  st.set_bytes_per_iteration(chunk);
+}
+
+// Assemble a short protocol frame (header + small payload) in a fresh
+// buffer, as done for each message of a request/response protocol.
+template <typename Buffer>
+void short_frames(state& st)
+{
+  const uint8_t header[4] = { 0x05, 0x01, 0x00, 0x03 };
+
+  std::size_t bytes = 0;
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    Buffer buf;
+    buf.append(header, sizeof(header));
+    buf.append(payload, i % 17);
+    bytes += buf.size();
+  }
+
+  st.set_bytes_per_iteration(bytes / (std::max)(st.iterations(),
+                                                std::size_t(1)));
+}
+
+// Buffer of |size| bytes whose only delimiter ("\r\n\r\n") is at the end,
+// so that every search has to scan the whole buffer.
+void fill_search_buffer(linear_buffer& buf, std::size_t size)
+{
+  buf.resize(size);
+  std::fill(buf.begin(), buf.end(), 'a');
+  std::copy_n("\r\n\r\n", 4, buf.end() - 4);
+}
+
+volatile std::size_t search_result;
+
+// Baseline: the byte-by-byte loop a parser would otherwise use.
+void find_byte_loop(state& st, std::size_t size)
+{
+  linear_buffer buf;
+  fill_search_buffer(buf, size);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    std::size_t pos = 0;
+    while (pos != buf.size() && buf[pos] != '\r')
+      ++pos;
+    search_result = pos;
+  }
+
+  st.set_bytes_per_iteration(size);
+}
+
+void find_byte(state& st, std::size_t size)
+{
+  linear_buffer buf;
+  fill_search_buffer(buf, size);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i)
+    search_result = buf.find('\r');
+
+  st.set_bytes_per_iteration(size);
+}
+
+void find_string_std(state& st, std::size_t size)
+{
+  static const char needle[] = "\r\n\r\n";
+
+  linear_buffer buf;
+  fill_search_buffer(buf, size);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    search_result = std::search(buf.begin(), buf.end(),
+                                needle, needle + 4) - buf.begin();
+  }
+
+  st.set_bytes_per_iteration(size);
+}
+
+void find_string(state& st, std::size_t size)
+{
+  linear_buffer buf;
+  fill_search_buffer(buf, size);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i)
+    search_result = buf.find("\r\n\r\n", 4);
+
+  st.set_bytes_per_iteration(size);
+}
+
+void find_any(state& st, std::size_t size)
+{
+  linear_buffer buf;
+  fill_search_buffer(buf, size);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i)
+    search_result = buf.find_any("\r\n\t ", 4);
+
+  st.set_bytes_per_iteration(size);
+}
+
+void register_linear_buffer_benchmarks()
+{
+  using std::placeholders::_1;
+
+  for (std::size_t i = 0; i != sizeof(chunk_sizes) / sizeof(chunk_sizes[0]);
+       ++i) {
+    register_benchmark("linear_buffer/append/" + size_string(chunk_sizes[i]),
+                       std::bind(&append, _1, chunk_sizes[i]));
+  }
+
+  const struct {
+    const char* name;
+    linear_buffer_growth policy;
+  } policies[] = {
+    { "exact", linear_buffer_growth::exact },
+    { "1.5x", linear_buffer_growth::factor_1_5 },
+    { "2x", linear_buffer_growth::factor_2 },
+    { "page", linear_buffer_growth::page_rounded },
+  };
+
+  for (std::size_t i = 0; i != sizeof(policies) / sizeof(policies[0]); ++i) {
+    const std::string prefix = "linear_buffer/append_grow/" +
+                               std::string(policies[i].name);
+    register_benchmark(prefix + "/4k",
+                       std::bind(&append_grow, _1, 4 * 1024,
+                                 policies[i].policy));
+    // Exact growth is quadratic, 1m would take seconds per iteration.
+    if (policies[i].policy != linear_buffer_growth::exact) {
+      register_benchmark(prefix + "/1m",
+                         std::bind(&append_grow, _1, 1024 * 1024,
+                                   policies[i].policy));
+    }
+  }
+
+  for (std::size_t i = 0;
+       i != sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); ++i) {
+    const std::string suffix = "/" + size_string(buffer_sizes[i]);
+    register_benchmark("linear_buffer/insert_erase_middle" + suffix,
+                       std::bind(&insert_erase_middle, _1, buffer_sizes[i]));
+    register_benchmark("linear_buffer/erase_front" + suffix,
+                       std::bind(&erase_front, _1, buffer_sizes[i]));
+  }
+
+  for (std::size_t i = 1;
+       i != sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); ++i) {
+    const std::string suffix = "/" + size_string(buffer_sizes[i]);
+    register_benchmark("linear_buffer/find_byte_loop" + suffix,
+                       std::bind(&find_byte_loop, _1, buffer_sizes[i]));
+    register_benchmark("linear_buffer/find_byte" + suffix,
+                       std::bind(&find_byte, _1, buffer_sizes[i]));
+    register_benchmark("linear_buffer/find_string_std" + suffix,
+                       std::bind(&find_string_std, _1, buffer_sizes[i]));
+    register_benchmark("linear_buffer/find_string" + suffix,
+                       std::bind(&find_string, _1, buffer_sizes[i]));
+    register_benchmark("linear_buffer/find_any" + suffix,
+                       std::bind(&find_any, _1, buffer_sizes[i]));
+  }
+
+  register_benchmark("linear_buffer/short_frames",
+                     &short_frames<linear_buffer>);
+  register_benchmark("small_linear_buffer/short_frames",
+                     &short_frames<small_linear_buffer<32>>);
+}
+
+ASIOEXT_BENCH_REGISTER(register_linear_buffer_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
@@ -0,0 +1,124 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+#include "report.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace bench = asioext::bench;
+
+static const char usage[] =
+  "usage: asioext.bench [options]\n"
+  "  --filter=<substring>    only run benchmarks whose name contains this\n"
+  "  --min-time=<ms>         minimum duration of a run (default: 250)\n"
+  "  --repetitions=<n>       number of runs, the median is reported "
+                             "(default: 3)\n"
+  "  --max-file-size=<size>  largest file to benchmark, e.g. 4g "
+                             "(default: 64m)\n"
+  "  --dir=<path>            directory for temporary files (default: .)\n"
+  "  --format=<fmt>          text, json or csv (default: text)\n"
+  "  --out=<file>            write results to a file instead of stdout\n"
+  "  --list                  list all benchmarks and exit\n";
+
+static bool parse_size(const char* s, asioext::uint64_t& out)
+{
+  char* end;
+  const unsigned long long n = std::strtoull(s, &end, 10);
+  if (end == s)
+    return false;
+
+  asioext::uint64_t mul = 1;
+  switch (*end) {
+    case '\0': break;
+    case 'k': case 'K': mul = 1024ull; ++end; break;
+    case 'm': case 'M': mul = 1024ull * 1024; ++end; break;
+    case 'g': case 'G': mul = 1024ull * 1024 * 1024; ++end; break;
+    default: return false;
+  }
+  if (*end != '\0')
+    return false;
+
+  out = n * mul;
+  return true;
+}
+
+static const char* match(const char* arg, const char* name)
+{
+  const std::size_t len = std::strlen(name);
+  if (std::strncmp(arg, name, len) == 0 && arg[len] == '=')
+    return arg + len + 1;
+  return 0;
+}
+
+int main(int argc, const char* argv[])
+{
+  bench::options opts;
+  std::string format = "text";
+  std::string out_path;
+
+  for (int i = 1; i != argc; ++i) {
+    const char* arg = argv[i];
+    const char* value;
+    asioext::uint64_t n;
+
+    if (std::strcmp(arg, "--list") == 0) {
+      const std::vector<std::string> names = bench::benchmark_names();
+      for (std::size_t j = 0; j != names.size(); ++j)
+        std::printf("%s\n", names[j].c_str());
+      return 0;
+    } else if ((value = match(arg, "--filter"))) {
+      opts.filter = value;
+    } else if ((value = match(arg, "--min-time")) && parse_size(value, n)) {
+      opts.min_time = asioext::chrono::milliseconds(n);
+    } else if ((value = match(arg, "--repetitions")) && parse_size(value, n) &&
+               n != 0) {
+      opts.repetitions = static_cast<std::size_t>(n);
+    } else if ((value = match(arg, "--max-file-size")) &&
+               parse_size(value, n)) {
+      opts.max_file_size = n;
+    } else if ((value = match(arg, "--dir"))) {
+      opts.directory = value;
+    } else if ((value = match(arg, "--format"))) {
+      format = value;
+    } else if ((value = match(arg, "--out"))) {
+      out_path = value;
+    } else {
+      std::fprintf(stderr, "%s", usage);
+      return 2;
+    }
+  }
+
+  std::FILE* out = stdout;
+  if (!out_path.empty()) {
+    out = std::fopen(out_path.c_str(), "w");
+    if (!out) {
+      std::perror(out_path.c_str());
+      return 1;
+    }
+  }
+
+  std::unique_ptr<bench::reporter> rep;
+  if (format == "text") {
+    rep.reset(new bench::text_reporter(out));
+  } else if (format == "json") {
+    rep.reset(new bench::json_reporter(out));
+  } else if (format == "csv") {
+    rep.reset(new bench::csv_reporter(out));
+  } else {
+    std::fprintf(stderr, "%s", usage);
+    return 2;
+  }
+
+  const std::size_t failed = bench::run_benchmarks(opts, *rep);
+
+  if (out != stdout)
+    std::fclose(out);
+
+  return failed == 0 ? 0 : 1;
+}
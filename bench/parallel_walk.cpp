@@ -0,0 +1,129 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/parallel_walk.hpp"
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+
+#include "asioext/open.hpp"
+
+#include <atomic>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+// 584 directories with 16 files each.
+const std::size_t tree_fanout = 8;
+const std::size_t tree_depth = 3;
+const std::size_t files_per_directory = 16;
+
+void create_tree(const std::string& path, std::size_t depth)
+{
+  ::mkdir(path.c_str(), 0755);
+  for (std::size_t i = 0; i != files_per_directory; ++i) {
+    open((path + "/f" + std::to_string(i)).c_str(),
+         open_flags::access_write | open_flags::create_always);
+  }
+
+  if (depth != 0) {
+    for (std::size_t i = 0; i != tree_fanout; ++i)
+      create_tree(path + "/d" + std::to_string(i), depth - 1);
+  }
+}
+
+void remove_tree(const std::string& path, std::size_t depth)
+{
+  for (std::size_t i = 0; i != files_per_directory; ++i)
+    ::unlink((path + "/f" + std::to_string(i)).c_str());
+
+  if (depth != 0) {
+    for (std::size_t i = 0; i != tree_fanout; ++i)
+      remove_tree(path + "/d" + std::to_string(i), depth - 1);
+  }
+
+  ::rmdir(path.c_str());
+}
+
+class temp_tree
+{
+public:
+  explicit temp_tree(const std::string& name)
+    : path_(temp_path(name))
+  {
+    remove_tree(path_, tree_depth);
+    create_tree(path_, tree_depth);
+  }
+
+  ~temp_tree()
+  {
+    remove_tree(path_, tree_depth);
+  }
+
+  const char* path() const { return path_.c_str(); }
+
+private:
+  std::string path_;
+};
+
+// Visit every entry of a (cached) tree, as a backup scanner would.
+void walk(state& st, std::size_t threads, file_status_mask mask)
+{
+  st.pause_timing();
+  temp_tree tree("parallel_walk");
+  walk_options options;
+  options.threads = threads;
+  options.status_mask = mask;
+  st.resume_timing();
+
+  std::atomic<uint64_t> entries(0);
+  const walk_visitor visitor = [&entries] (const walk_entry&) {
+    entries.fetch_add(1, std::memory_order_relaxed);
+    return walk_action::proceed;
+  };
+
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i)
+    parallel_walk(tree.path(), visitor, options);
+
+  if (entries.load() == 0) {
+    st.fail("no entries");
+    return;
+  }
+  st.set_items_per_iteration(entries.load() / st.iterations());
+}
+
+void register_parallel_walk_benchmarks()
+{
+  using std::placeholders::_1;
+
+  static const std::size_t thread_counts[] = { 1, 2, 4, 8 };
+  for (std::size_t i = 0;
+       i != sizeof(thread_counts) / sizeof(thread_counts[0]); ++i) {
+    const std::size_t t = thread_counts[i];
+    register_benchmark("parallel_walk/names/" + std::to_string(t),
+                       std::bind(&walk, _1, t, file_status_mask::none));
+    register_benchmark("parallel_walk/status/" + std::to_string(t),
+                       std::bind(&walk, _1, t, file_status_mask::size |
+                                               file_status_mask::times));
+  }
+}
+
+ASIOEXT_BENCH_REGISTER(register_parallel_walk_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
+
+#endif
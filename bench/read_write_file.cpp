@@ -0,0 +1,86 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/read_file.hpp"
+#include "asioext/write_file.hpp"
+
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+// 4 KiB, 64 KiB, 1 MiB, 16 MiB, 256 MiB, 4 GiB.
+// Sizes above options::max_file_size are skipped.
+const uint64_t min_file_size = 4 * 1024;
+const uint64_t max_file_size = 4ull * 1024 * 1024 * 1024;
+const uint64_t file_size_step = 16;
+
+void write_file_bench(state& st, uint64_t size)
+{
+  st.pause_timing();
+  temp_file file("write_file");
+  std::vector<char> data(static_cast<std::size_t>(size), 'x');
+  st.resume_timing();
+
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i)
+    write_file(file.path(), asio::buffer(data));
+
+  st.set_bytes_per_iteration(size);
+}
+
+void read_file_bench(state& st, uint64_t size)
+{
+  st.pause_timing();
+  temp_file file("read_file");
+  std::vector<char> data(static_cast<std::size_t>(size), 'x');
+  write_file(file.path(), asio::buffer(data));
+  st.resume_timing();
+
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    // Don't let the container's capacity carry over between iterations,
+    // so allocation is measured as part of the operation.
+    std::vector<char>().swap(data);
+    read_file(file.path(), data);
+  }
+
+  st.set_bytes_per_iteration(size);
+}
+
+void register_read_write_file_benchmarks()
+{
+  for (uint64_t size = min_file_size; size <= max_file_size;
+       size *= file_size_step) {
+    const std::string suffix = "/" + size_string(size);
+    register_benchmark("write_file" + suffix,
+                       [size] (state& st) {
+      if (size > current_options().max_file_size) {
+        st.skip("larger than --max-file-size");
+        return;
+      }
+      write_file_bench(st, size);
+    });
+    register_benchmark("read_file" + suffix,
+                       [size] (state& st) {
+      if (size > current_options().max_file_size) {
+        st.skip("larger than --max-file-size");
+        return;
+      }
+      read_file_bench(st, size);
+    });
+  }
+}
+
+ASIOEXT_BENCH_REGISTER(register_read_write_file_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
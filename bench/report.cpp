@@ -0,0 +1,221 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "report.hpp"
+
+#include <ctime>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+void print_json_string(std::FILE* out, const std::string& s)
+{
+  std::fputc('"', out);
+  for (std::size_t i = 0, n = s.size(); i != n; ++i) {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c == '"' || c == '\\')
+      std::fprintf(out, "\\%c", c);
+    else if (c < 0x20)
+      std::fprintf(out, "\\u%04x", c);
+    else
+      std::fputc(c, out);
+  }
+  std::fputc('"', out);
+}
+
+void print_csv_string(std::FILE* out, const std::string& s)
+{
+  std::fputc('"', out);
+  for (std::size_t i = 0, n = s.size(); i != n; ++i) {
+    if (s[i] == '"')
+      std::fputc('"', out);
+    std::fputc(s[i], out);
+  }
+  std::fputc('"', out);
+}
+
+void format_rate(char* buf, std::size_t size, double value, const char* unit)
+{
+  static const char* prefixes[] = { "", "k", "M", "G", "T" };
+  int i = 0;
+  while (value >= 1000.0 && i != 4) {
+    value /= 1000.0;
+    ++i;
+  }
+  std::snprintf(buf, size, "%.2f %s%s/s", value, prefixes[i], unit);
+}
+
+}
+
+void text_reporter::begin()
+{
+  std::fprintf(out_, "%-64s %14s %14s %12s %20s\n",
+               "benchmark", "time/iter", "iterations", "spread",
+               "throughput");
+}
+
+void text_reporter::report(const result& res)
+{
+  if (!res.error.empty()) {
+    std::fprintf(out_, "%-64s ERROR: %s\n", res.name.c_str(),
+                 res.error.c_str());
+    return;
+  }
+  if (!res.skipped.empty()) {
+    std::fprintf(out_, "%-64s skipped: %s\n", res.name.c_str(),
+                 res.skipped.c_str());
+    return;
+  }
+
+  char rate[32] = "";
+  if (res.bytes_per_iteration != 0)
+    format_rate(rate, sizeof(rate), res.bytes_per_second(), "B");
+  else
+    format_rate(rate, sizeof(rate), res.items_per_second(), "op");
+
+  const double spread = res.ns_per_iteration > 0 ?
+      (res.max_ns_per_iteration - res.min_ns_per_iteration) * 100.0 /
+      res.ns_per_iteration : 0;
+
+  std::fprintf(out_, "%-64s %11.1f ns %14llu %11.1f%% %20s\n",
+               res.name.c_str(), res.ns_per_iteration,
+               static_cast<unsigned long long>(res.iterations),
+               spread, rate);
+
+  if (res.has_latency)
+    std::fprintf(out_, "%-64s p50 %.0f ns, p90 %.0f ns, p99 %.0f ns\n", "",
+                 res.latency_p50_ns, res.latency_p90_ns, res.latency_p99_ns);
+
+  for (std::size_t i = 0; i != res.counters.size(); ++i)
+    std::fprintf(out_, "%-64s %s: %.2f\n", "", res.counters[i].first.c_str(),
+                 res.counters[i].second);
+}
+
+void text_reporter::end()
+{
+  std::fflush(out_);
+}
+
+void json_reporter::begin()
+{
+  char date[64] = "";
+  const std::time_t now = std::time(0);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  const options& opts = current_options();
+  std::fprintf(out_, "{\n  \"context\": {\n");
+  std::fprintf(out_, "    \"date\": \"%s\",\n", date);
+  std::fprintf(out_, "    \"min_time_ns\": %lld,\n",
+               static_cast<long long>(chrono::duration_cast<
+                   chrono::nanoseconds>(opts.min_time).count()));
+  std::fprintf(out_, "    \"repetitions\": %llu,\n",
+               static_cast<unsigned long long>(opts.repetitions));
+  std::fprintf(out_, "    \"max_file_size\": %llu\n",
+               static_cast<unsigned long long>(opts.max_file_size));
+  std::fprintf(out_, "  },\n  \"benchmarks\": [");
+  first_ = true;
+}
+
+void json_reporter::report(const result& res)
+{
+  std::fprintf(out_, "%s\n    {\n      \"name\": ", first_ ? "" : ",");
+  first_ = false;
+  print_json_string(out_, res.name);
+
+  if (!res.error.empty()) {
+    std::fprintf(out_, ",\n      \"error_occurred\": true,\n"
+                       "      \"error_message\": ");
+    print_json_string(out_, res.error);
+    std::fprintf(out_, "\n    }");
+    return;
+  }
+  if (!res.skipped.empty()) {
+    std::fprintf(out_, ",\n      \"skipped\": true,\n"
+                       "      \"skip_message\": ");
+    print_json_string(out_, res.skipped);
+    std::fprintf(out_, "\n    }");
+    return;
+  }
+
+  std::fprintf(out_, ",\n      \"iterations\": %llu",
+               static_cast<unsigned long long>(res.iterations));
+  std::fprintf(out_, ",\n      \"repetitions\": %llu",
+               static_cast<unsigned long long>(res.repetitions));
+  std::fprintf(out_, ",\n      \"real_time\": %.3f", res.ns_per_iteration);
+  std::fprintf(out_, ",\n      \"min_time\": %.3f", res.min_ns_per_iteration);
+  std::fprintf(out_, ",\n      \"max_time\": %.3f", res.max_ns_per_iteration);
+  std::fprintf(out_, ",\n      \"time_unit\": \"ns\"");
+  if (res.bytes_per_iteration != 0)
+    std::fprintf(out_, ",\n      \"bytes_per_second\": %.3f",
+                 res.bytes_per_second());
+  std::fprintf(out_, ",\n      \"items_per_second\": %.3f",
+               res.items_per_second());
+  if (res.has_latency) {
+    std::fprintf(out_, ",\n      \"latency_p50\": %.3f", res.latency_p50_ns);
+    std::fprintf(out_, ",\n      \"latency_p90\": %.3f", res.latency_p90_ns);
+    std::fprintf(out_, ",\n      \"latency_p99\": %.3f", res.latency_p99_ns);
+  }
+  for (std::size_t i = 0; i != res.counters.size(); ++i) {
+    std::fprintf(out_, ",\n      ");
+    print_json_string(out_, res.counters[i].first);
+    std::fprintf(out_, ": %.3f", res.counters[i].second);
+  }
+  std::fprintf(out_, "\n    }");
+}
+
+void json_reporter::end()
+{
+  std::fprintf(out_, "\n  ]\n}\n");
+  std::fflush(out_);
+}
+
+void csv_reporter::begin()
+{
+  std::fprintf(out_, "name,iterations,repetitions,real_time_ns,"
+                     "min_time_ns,max_time_ns,bytes_per_second,"
+                     "items_per_second,latency_p50_ns,latency_p90_ns,"
+                     "latency_p99_ns,error\n");
+}
+
+void csv_reporter::report(const result& res)
+{
+  print_csv_string(out_, res.name);
+  if (!res.error.empty()) {
+    std::fprintf(out_, ",,,,,,,,,,,");
+    print_csv_string(out_, res.error);
+    std::fputc('\n', out_);
+    return;
+  }
+  if (!res.skipped.empty()) {
+    std::fprintf(out_, ",,,,,,,,,,,");
+    print_csv_string(out_, "skipped: " + res.skipped);
+    std::fputc('\n', out_);
+    return;
+  }
+
+  std::fprintf(out_, ",%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,",
+               static_cast<unsigned long long>(res.iterations),
+               static_cast<unsigned long long>(res.repetitions),
+               res.ns_per_iteration, res.min_ns_per_iteration,
+               res.max_ns_per_iteration, res.bytes_per_second(),
+               res.items_per_second());
+  if (res.has_latency)
+    std::fprintf(out_, "%.3f,%.3f,%.3f,\n", res.latency_p50_ns,
+                 res.latency_p90_ns, res.latency_p99_ns);
+  else
+    std::fprintf(out_, ",,,\n");
+}
+
+void csv_reporter::end()
+{
+  std::fflush(out_);
+}
+
+}
+
+ASIOEXT_NS_END
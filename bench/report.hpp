@@ -0,0 +1,140 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_BENCH_REPORT_HPP
+#define ASIOEXT_BENCH_REPORT_HPP
+
+#include "harness.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+struct result
+{
+  result()
+    : iterations(0)
+    , repetitions(0)
+    , bytes_per_iteration(0)
+    , items_per_iteration(0)
+    , ns_per_iteration(0)
+    , min_ns_per_iteration(0)
+    , max_ns_per_iteration(0)
+    , has_latency(false)
+    , latency_p50_ns(0)
+    , latency_p90_ns(0)
+    , latency_p99_ns(0)
+  {
+    // ctor
+  }
+
+  std::string name;
+  std::string error;
+  std::string skipped;
+
+  std::size_t iterations;
+  std::size_t repetitions;
+  uint64_t bytes_per_iteration;
+  uint64_t items_per_iteration;
+
+  // Median, minimum and maximum over all repetitions.
+  double ns_per_iteration;
+  double min_ns_per_iteration;
+  double max_ns_per_iteration;
+
+  bool has_latency;
+  double latency_p50_ns;
+  double latency_p90_ns;
+  double latency_p99_ns;
+
+  // Values reported by the benchmark itself (see state::set_counter()).
+  std::vector<std::pair<std::string, double> > counters;
+
+  double bytes_per_second() const
+  {
+    return ns_per_iteration > 0 ?
+        static_cast<double>(bytes_per_iteration) * 1e9 / ns_per_iteration : 0;
+  }
+
+  double items_per_second() const
+  {
+    return ns_per_iteration > 0 ?
+        static_cast<double>(items_per_iteration) * 1e9 / ns_per_iteration : 0;
+  }
+};
+
+class reporter
+{
+public:
+  explicit reporter(std::FILE* out)
+    : out_(out)
+  {
+    // ctor
+  }
+
+  virtual ~reporter() {}
+
+  virtual void begin() = 0;
+  virtual void report(const result& res) = 0;
+  virtual void end() = 0;
+
+protected:
+  std::FILE* out_;
+};
+
+// Human-readable table.
+class text_reporter : public reporter
+{
+public:
+  explicit text_reporter(std::FILE* out) : reporter(out) {}
+
+  void begin();
+  void report(const result& res);
+  void end();
+};
+
+// A single JSON document, loosely following Google Benchmark's
+// --benchmark_format=json layout so existing comparison tools can be used.
+class json_reporter : public reporter
+{
+public:
+  explicit json_reporter(std::FILE* out) : reporter(out), first_(true) {}
+
+  void begin();
+  void report(const result& res);
+  void end();
+
+private:
+  bool first_;
+};
+
+// One line per benchmark, with a header line.
+class csv_reporter : public reporter
+{
+public:
+  explicit csv_reporter(std::FILE* out) : reporter(out) {}
+
+  void begin();
+  void report(const result& res);
+  void end();
+};
+
+result run_benchmark(const std::string& name, const function_type& fn);
+
+std::vector<std::string> benchmark_names();
+
+// Run all registered benchmarks matching |opts.filter|.
+// Returns the number of failed benchmarks.
+std::size_t run_benchmarks(const options& opts, reporter& rep);
+
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,75 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/segmented_buffer.hpp"
+#include "asioext/linear_buffer.hpp"
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+const std::size_t response_sizes[] = { 64 * 1024, 1024 * 1024,
+                                       16 * 1024 * 1024 };
+
+const std::size_t chunk = 1024;
+const uint8_t payload[chunk] = {};
+
+// Assemble a response of |total| bytes from small chunks and release it,
+// i.e. the whole life cycle of a large response buffer.
+void build_linear(state& st, std::size_t total)
+{
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    linear_buffer buf;
+    dynamic_linear_buffer<std::allocator<uint8_t>> dyn(buf);
+    for (std::size_t size = 0; size < total; size += chunk) {
+      asio::buffer_copy(dyn.prepare(chunk), asio::buffer(payload));
+      dyn.commit(chunk);
+    }
+    dyn.consume(total);
+  }
+
+  st.set_bytes_per_iteration(total);
+}
+
+void build_segmented(state& st, std::size_t total)
+{
+  block_pool pool(16 * 1024);
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    segmented_buffer buf(pool);
+    for (std::size_t size = 0; size < total; size += chunk) {
+      asio::buffer_copy(buf.prepare(chunk), asio::buffer(payload));
+      buf.commit(chunk);
+    }
+    buf.consume(total);
+  }
+
+  st.set_bytes_per_iteration(total);
+}
+
+void register_segmented_buffer_benchmarks()
+{
+  using std::placeholders::_1;
+
+  for (std::size_t i = 0;
+       i != sizeof(response_sizes) / sizeof(response_sizes[0]); ++i) {
+    const std::string suffix = "/" + size_string(response_sizes[i]);
+    register_benchmark("linear_buffer/build_response" + suffix,
+                       std::bind(&build_linear, _1, response_sizes[i]));
+    register_benchmark("segmented_buffer/build_response" + suffix,
+                       std::bind(&build_segmented, _1, response_sizes[i]));
+  }
+}
+
+ASIOEXT_BENCH_REGISTER(register_segmented_buffer_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
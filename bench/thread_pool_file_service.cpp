@@ -0,0 +1,243 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "harness.hpp"
+
+#include "asioext/file.hpp"
+#include "asioext/thread_pool_file_service.hpp"
+#include "asioext/read_at.hpp"
+#include "asioext/write_file.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/read_at.hpp>
+#else
+# include <asio/io_service.hpp>
+# include <asio/read_at.hpp>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace bench {
+
+namespace {
+
+const std::size_t thread_counts[] = { 1, 2, 4, 8 };
+const std::size_t queue_depths[] = { 1, 4, 16 };
+const std::size_t block_sizes[] = { 4 * 1024, 64 * 1024 };
+
+// Operations are spread over a file of this size.
+const uint64_t file_size = 16 * 1024 * 1024;
+
+// Keeps |depth| positional operations in flight until |total| operations
+// have completed. Each completion records its latency.
+class async_driver
+{
+public:
+  async_driver(state& st, file& f, bool write, std::size_t block_size,
+               std::size_t depth)
+    : st_(st)
+    , file_(f)
+    , write_(write)
+    , block_size_(block_size)
+    , window_((std::max)((std::min)(current_options().max_file_size,
+                                    file_size),
+                         static_cast<uint64_t>(block_size)))
+    , issued_(0)
+    , next_offset_(0)
+    , slots_(depth)
+  {
+    for (std::size_t i = 0; i != depth; ++i)
+      slots_[i].data.resize(block_size, 'x');
+  }
+
+  void start()
+  {
+    for (std::size_t i = 0; i != slots_.size(); ++i)
+      issue(slots_[i]);
+  }
+
+private:
+  struct slot
+  {
+    std::vector<char> data;
+    clock_type::time_point start;
+  };
+
+  void issue(slot& s)
+  {
+    if (issued_ == st_.iterations())
+      return;
+    ++issued_;
+
+    if (next_offset_ + block_size_ > window_)
+      next_offset_ = 0;
+    const uint64_t offset = next_offset_;
+    next_offset_ += block_size_;
+
+    s.start = clock_type::now();
+    if (write_) {
+      file_.async_write_some_at(offset, asio::buffer(s.data),
+                                [this, &s] (const error_code& ec,
+                                            std::size_t) {
+        on_complete(s, ec);
+      });
+    } else {
+      file_.async_read_some_at(offset, asio::buffer(s.data),
+                               [this, &s] (const error_code& ec,
+                                           std::size_t) {
+        on_complete(s, ec);
+      });
+    }
+  }
+
+  void on_complete(slot& s, const error_code& ec)
+  {
+    st_.record_latency(clock_type::now() - s.start);
+    if (ec) {
+      st_.fail(ec.message());
+      return;
+    }
+    issue(s);
+  }
+
+  state& st_;
+  file& file_;
+  bool write_;
+  std::size_t block_size_;
+  uint64_t window_;
+  std::size_t issued_;
+  uint64_t next_offset_;
+  std::vector<slot> slots_;
+};
+
+void async_io(state& st, bool write, bool nowait, std::size_t num_threads,
+              std::size_t depth, std::size_t block_size)
+{
+  st.pause_timing();
+  temp_file tf("thread_pool_file_service");
+  {
+    std::vector<char> data(static_cast<std::size_t>(
+        (std::min)(current_options().max_file_size, file_size)), 'x');
+    write_file(tf.path(), asio::buffer(data));
+  }
+
+  asio::io_service io_service;
+  thread_pool_file_service* svc =
+      new thread_pool_file_service(io_service, num_threads);
+  asio::add_service(io_service, svc);
+  svc->nowait_reads(nowait);
+
+  file f(io_service, tf.path(),
+         open_flags::access_read_write | open_flags::open_existing);
+  async_driver driver(st, f, write, block_size, depth);
+  st.resume_timing();
+
+  driver.start();
+  io_service.run();
+
+  st.set_bytes_per_iteration(block_size);
+}
+
+// Read the whole file into |segment_size| buffers with one complete-transfer
+// operation. asio::async_read_at() only passes a limited number of buffers
+// to each async_read_some_at() call and hops back to the io_service in
+// between, whereas asioext::async_read_at() loops on the pool thread.
+void async_read_at_all(state& st, bool use_asioext, std::size_t segment_size)
+{
+  st.pause_timing();
+  temp_file tf("thread_pool_file_service_read_at");
+  const std::size_t size = static_cast<std::size_t>(
+      (std::min)(current_options().max_file_size, file_size));
+  std::vector<char> data(size, 'x');
+  write_file(tf.path(), asio::buffer(data));
+
+  std::vector<asio::mutable_buffer> buffers;
+  for (std::size_t i = 0; i < size; i += segment_size) {
+    buffers.push_back(asio::buffer(&data[i],
+                                   (std::min)(segment_size, size - i)));
+  }
+
+  asio::io_service io_service;
+  file f(io_service, tf.path(),
+         open_flags::access_read | open_flags::open_existing);
+  st.resume_timing();
+
+  for (std::size_t i = 0, n = st.iterations(); i != n; ++i) {
+    const clock_type::time_point start = clock_type::now();
+    auto handler = [&st, size] (const error_code& ec,
+                                std::size_t bytes_transferred) {
+      if (ec)
+        st.fail(ec.message());
+      else if (bytes_transferred != size)
+        st.fail("short read");
+    };
+
+    if (use_asioext)
+      asioext::async_read_at(f, 0, buffers, handler);
+    else
+      asio::async_read_at(f, 0, buffers, handler);
+
+    io_service.run();
+    io_service.reset();
+    st.record_latency(clock_type::now() - start);
+  }
+
+  st.set_bytes_per_iteration(size);
+}
+
+void register_thread_pool_file_service_benchmarks()
+{
+  using std::placeholders::_1;
+
+  static const std::size_t segment_sizes[] = { 4 * 1024, 64 * 1024 };
+  for (std::size_t i = 0;
+       i != sizeof(segment_sizes) / sizeof(segment_sizes[0]); ++i) {
+    const std::string suffix = "/segments:" + size_string(segment_sizes[i]);
+    register_benchmark("thread_pool_file_service/asio_read_at" + suffix,
+                       std::bind(&async_read_at_all, _1, false,
+                                 segment_sizes[i]));
+    register_benchmark("thread_pool_file_service/read_at" + suffix,
+                       std::bind(&async_read_at_all, _1, true,
+                                 segment_sizes[i]));
+  }
+
+  for (std::size_t b = 0; b != sizeof(block_sizes) / sizeof(block_sizes[0]);
+       ++b) {
+    for (std::size_t t = 0;
+         t != sizeof(thread_counts) / sizeof(thread_counts[0]); ++t) {
+      for (std::size_t d = 0;
+           d != sizeof(queue_depths) / sizeof(queue_depths[0]); ++d) {
+        const std::string suffix = "/" + size_string(block_sizes[b]) +
+            "/threads:" + std::to_string(thread_counts[t]) +
+            "/depth:" + std::to_string(queue_depths[d]);
+        register_benchmark("thread_pool_file_service/read_some_at" + suffix,
+                           std::bind(&async_io, _1, false, true,
+                                     thread_counts[t], queue_depths[d],
+                                     block_sizes[b]));
+        register_benchmark("thread_pool_file_service/read_some_at_pool_only" +
+                           suffix,
+                           std::bind(&async_io, _1, false, false,
+                                     thread_counts[t], queue_depths[d],
+                                     block_sizes[b]));
+        register_benchmark("thread_pool_file_service/write_some_at" + suffix,
+                           std::bind(&async_io, _1, true, false,
+                                     thread_counts[t], queue_depths[d],
+                                     block_sizes[b]));
+      }
+    }
+  }
+}
+
+ASIOEXT_BENCH_REGISTER(register_thread_pool_file_service_benchmarks);
+
+}
+
+}
+
+ASIOEXT_NS_END
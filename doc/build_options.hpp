@@ -43,6 +43,17 @@
 /// in the system ANSI code page (if unset) or UTF-8 (if set).
 #define ASIOEXT_WINDOWS_USE_UTF8_FILENAMES
 
+/// @brief Report file system calls to a @ref asioext::file_io_observer.
+///
+/// If defined, the file operations used by @ref asioext::file_handle
+/// (and everything built on top of it) time each system call and report it
+/// to the observer installed with @ref asioext::set_file_io_observer().
+/// Otherwise, the tracing hooks compile to nothing.
+///
+/// This flag **must** be defined consistently when building and consuming
+/// the library.
+#define ASIOEXT_ENABLE_FILE_IO_OBSERVER
+
 /// @brief Disable the use of Boost.Filesystem
 ///
 /// This macro disables the use of Boost.Filesystem, even if Boost is used
@@ -74,6 +85,20 @@
 /// to query or modify file attributes fail.
 #define ASIOEXT_DISABLE_FILE_FLAGS
 
+/// @brief Disable double-mapped memory.
+///
+/// This macro disables the use of @c memfd_create() and @c mmap() to map
+/// memory twice at adjacent addresses, regardless of platform support.
+/// asioext::mirrored_circular_buffer is unavailable then.
+#define ASIOEXT_DISABLE_MIRRORED_MEMORY
+
+/// @brief Disable the non-blocking read fast path.
+///
+/// This macro disables the use of @c preadv2() with @c RWF_NOWAIT in
+/// asioext::thread_pool_file_service, regardless of platform support.
+/// All reads are then performed on the thread pool.
+#define ASIOEXT_DISABLE_NOWAIT_READS
+
 /// @brief Disable <code>\#pragma once</code> support.
 ///
 /// This macro disables the use of <code>\#pragma once</code>, regardless of
@@ -0,0 +1,121 @@
+/// @file
+/// Defines the aligned_allocator class template.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_ALIGNEDALLOCATOR_HPP
+#define ASIOEXT_ALIGNEDALLOCATOR_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/detail/aligned_memory.hpp"
+#include "asioext/detail/throw_exception.hpp"
+
+#include <cstddef> // for size_t
+#include <limits>
+#include <new>
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup core
+/// @brief Allocator that aligns all allocations to @c Alignment bytes.
+///
+/// This class satisfies the <em>Allocator</em> requirements and can be used
+/// with any allocator-aware container, e.g. @ref basic_linear_buffer or
+/// std::vector. Aligning buffers to the block or page size is necessary
+/// for unbuffered (direct) I/O and helpful for DMA.
+///
+/// @tparam T The type of the allocated objects.
+///
+/// @tparam Alignment The alignment in bytes. Has to be a power of two and
+/// at least the natural alignment of @c T.
+///
+/// @par Example
+/// @code
+/// basic_linear_buffer<aligned_allocator<uint8_t, 4096>> buf;
+/// read_file("data.bin", buf);
+/// @endcode
+template <class T, std::size_t Alignment>
+class aligned_allocator
+{
+  static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two");
+  static_assert(Alignment >= alignof(T),
+                "Alignment must not be smaller than alignof(T)");
+
+public:
+  typedef T value_type;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  /// The alignment of all allocations.
+  static const std::size_t alignment = Alignment;
+
+  template <class U>
+  struct rebind
+  {
+    typedef aligned_allocator<U, Alignment> other;
+  };
+
+  aligned_allocator() ASIOEXT_NOEXCEPT
+  {
+    // ctor
+  }
+
+  template <class U>
+  aligned_allocator(const aligned_allocator<U, Alignment>&) ASIOEXT_NOEXCEPT
+  {
+    // ctor
+  }
+
+  /// @brief Allocate storage for @c n objects.
+  ///
+  /// @throws std::bad_alloc Thrown if the allocation failed.
+  T* allocate(std::size_t n)
+  {
+    if (n > (std::numeric_limits<std::size_t>::max)() / sizeof(T)) {
+      std::bad_alloc ex;
+      detail::throw_exception(ex);
+    }
+
+    void* p = detail::aligned_memory::allocate(n * sizeof(T), Alignment);
+    if (!p) {
+      std::bad_alloc ex;
+      detail::throw_exception(ex);
+    }
+    return static_cast<T*>(p);
+  }
+
+  /// @brief Free storage obtained from allocate().
+  void deallocate(T* p, std::size_t /*n*/) ASIOEXT_NOEXCEPT
+  {
+    detail::aligned_memory::deallocate(p);
+  }
+};
+
+template <class T, std::size_t Alignment>
+const std::size_t aligned_allocator<T, Alignment>::alignment;
+
+template <class T, class U, std::size_t Alignment>
+bool operator==(const aligned_allocator<T, Alignment>&,
+                const aligned_allocator<U, Alignment>&) ASIOEXT_NOEXCEPT
+{
+  return true;
+}
+
+template <class T, class U, std::size_t Alignment>
+bool operator!=(const aligned_allocator<T, Alignment>&,
+                const aligned_allocator<U, Alignment>&) ASIOEXT_NOEXCEPT
+{
+  return false;
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -61,6 +61,7 @@
 /// * Utilities for reading/writing files:
 ///   * @ref asioext::read_file
 ///   * @ref asioext::write_file
+///   * @ref asioext::read_at / @ref asioext::write_at
 
 /// @ingroup files
 /// @defgroup files_handle File handles
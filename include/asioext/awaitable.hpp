@@ -0,0 +1,671 @@
+/// @file
+/// Defines C++20 coroutine support: the task class template, co_spawn()
+/// and awaitable versions of file and connect operations.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_AWAITABLE_HPP
+#define ASIOEXT_AWAITABLE_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#if defined(ASIOEXT_HAS_CO_AWAIT) || defined(ASIOEXT_IS_DOCUMENTATION)
+
+#include "asioext/basic_file.hpp"
+#include "asioext/bind_handler.hpp"
+#include "asioext/connect.hpp"
+#include "asioext/error_code.hpp"
+#include "asioext/read_file.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/frame_allocator.hpp"
+#include "asioext/detail/handler_work.hpp"
+#include "asioext/detail/throw_error.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/buffer.hpp>
+# include <boost/asio/error.hpp>
+# include <boost/asio/io_service.hpp>
+#else
+# include <asio/buffer.hpp>
+# include <asio/error.hpp>
+# include <asio/io_service.hpp>
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+ASIOEXT_NS_BEGIN
+
+template <typename T = void>
+class task;
+
+namespace detail {
+
+class task_promise_base
+{
+public:
+  // Coroutine frames come from the recycling frame allocator.
+  static void* operator new(std::size_t size)
+  {
+    return frame_allocate(size);
+  }
+
+  static void operator delete(void* p) ASIOEXT_NOEXCEPT
+  {
+    frame_deallocate(p);
+  }
+
+  std::suspend_always initial_suspend() const ASIOEXT_NOEXCEPT
+  {
+    return {};
+  }
+
+  // Transfers control to the awaiting coroutine without growing the stack.
+  struct final_awaiter
+  {
+    bool await_ready() const ASIOEXT_NOEXCEPT
+    {
+      return false;
+    }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> h) const ASIOEXT_NOEXCEPT
+    {
+      return static_cast<task_promise_base&>(h.promise()).continuation_;
+    }
+
+    void await_resume() const ASIOEXT_NOEXCEPT
+    {
+    }
+  };
+
+  final_awaiter final_suspend() const ASIOEXT_NOEXCEPT
+  {
+    return {};
+  }
+
+  void unhandled_exception() ASIOEXT_NOEXCEPT
+  {
+    exception_ = std::current_exception();
+  }
+
+  void set_continuation(std::coroutine_handle<> continuation) ASIOEXT_NOEXCEPT
+  {
+    continuation_ = continuation;
+  }
+
+protected:
+  void rethrow_exception()
+  {
+    if (exception_)
+      std::rethrow_exception(exception_);
+  }
+
+private:
+  std::coroutine_handle<> continuation_ = std::noop_coroutine();
+  std::exception_ptr exception_;
+};
+
+template <typename T>
+class task_promise : public task_promise_base
+{
+public:
+  task<T> get_return_object() ASIOEXT_NOEXCEPT;
+
+  template <typename U>
+  void return_value(U&& value)
+  {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  T result()
+  {
+    rethrow_exception();
+    return std::move(*value_);
+  }
+
+private:
+  std::optional<T> value_;
+};
+
+template <>
+class task_promise<void> : public task_promise_base
+{
+public:
+  task<void> get_return_object() ASIOEXT_NOEXCEPT;
+
+  void return_void() ASIOEXT_NOEXCEPT
+  {
+  }
+
+  void result()
+  {
+    rethrow_exception();
+  }
+};
+
+}
+
+/// @ingroup core
+/// @brief A coroutine that produces a value of type @c T.
+///
+/// A task doesn't run until it is awaited by another coroutine
+/// (@c co_await) or started by co_spawn(). The awaiting coroutine is resumed
+/// once the task returned, and receives its value or exception.
+///
+/// Frames of task coroutines are allocated from a small per-thread cache
+/// of recycled frames, so steady-state use (e.g. one task per request or
+/// per chunk of a file) doesn't allocate.
+///
+/// @par Example
+/// @code
+/// asioext::task<std::size_t> copy(asioext::file& in, asioext::file& out)
+/// {
+///   char buffer[4096];
+///   uint64_t offset = 0;
+///   for (;;) {
+///     asioext::error_code ec;
+///     const std::size_t n = co_await asioext::await_read_some_at(
+///         in, offset, asio::buffer(buffer), ec);
+///     if (ec) // asio::error::eof once everything was copied.
+///       co_return offset;
+///     co_await asioext::await_write_some_at(out, offset,
+///                                           asio::buffer(buffer, n));
+///     offset += n;
+///   }
+/// }
+/// @endcode
+template <typename T>
+class task
+{
+public:
+  /// The coroutine's promise type.
+  typedef detail::task_promise<T> promise_type;
+
+  /// @brief Take ownership of the coroutine of @c other.
+  task(task&& other) ASIOEXT_NOEXCEPT
+    : handle_(std::exchange(other.handle_, nullptr))
+  {
+    // ctor
+  }
+
+  /// @brief Destroy the task's coroutine (if any).
+  ~task()
+  {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  /// @brief Destroy the task's coroutine (if any) and take ownership of
+  /// the coroutine of @c other.
+  task& operator=(task&& other) ASIOEXT_NOEXCEPT
+  {
+    if (this != &other) {
+      if (handle_)
+        handle_.destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+#if !defined(ASIOEXT_IS_DOCUMENTATION)
+  bool await_ready() const ASIOEXT_NOEXCEPT
+  {
+    return false;
+  }
+
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> caller) ASIOEXT_NOEXCEPT
+  {
+    handle_.promise().set_continuation(caller);
+    return handle_;
+  }
+
+  T await_resume()
+  {
+    return handle_.promise().result();
+  }
+#endif
+
+private:
+  friend class detail::task_promise<T>;
+
+  explicit task(std::coroutine_handle<promise_type> handle) ASIOEXT_NOEXCEPT
+    : handle_(handle)
+  {
+    // ctor
+  }
+
+  task(const task&) ASIOEXT_DELETED;
+  task& operator=(const task&) ASIOEXT_DELETED;
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+task<T> task_promise<T>::get_return_object() ASIOEXT_NOEXCEPT
+{
+  return task<T>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+inline task<void> task_promise<void>::get_return_object() ASIOEXT_NOEXCEPT
+{
+  return task<void>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+// The entry point of a spawned task. It is posted as a handler: it starts
+// when invoked, and destroys itself once done (or when it is destroyed
+// without having been invoked).
+class spawned_task
+{
+public:
+  struct promise_type
+  {
+    static void* operator new(std::size_t size)
+    {
+      return frame_allocate(size);
+    }
+
+    static void operator delete(void* p) ASIOEXT_NOEXCEPT
+    {
+      frame_deallocate(p);
+    }
+
+    spawned_task get_return_object() ASIOEXT_NOEXCEPT
+    {
+      return spawned_task(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() const ASIOEXT_NOEXCEPT
+    {
+      return {};
+    }
+
+    std::suspend_never final_suspend() const ASIOEXT_NOEXCEPT
+    {
+      return {};
+    }
+
+    void return_void() ASIOEXT_NOEXCEPT
+    {
+    }
+
+    // spawn_entry() catches everything.
+    void unhandled_exception() ASIOEXT_NOEXCEPT
+    {
+      std::terminate();
+    }
+  };
+
+  spawned_task(spawned_task&& other) ASIOEXT_NOEXCEPT
+    : handle_(std::exchange(other.handle_, nullptr))
+  {
+    // ctor
+  }
+
+  ~spawned_task()
+  {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  void operator()()
+  {
+    std::exchange(handle_, nullptr).resume();
+  }
+
+private:
+  explicit spawned_task(std::coroutine_handle<promise_type> handle)
+      ASIOEXT_NOEXCEPT
+    : handle_(handle)
+  {
+    // ctor
+  }
+
+  spawned_task(const spawned_task&) ASIOEXT_DELETED;
+  spawned_task& operator=(const spawned_task&) ASIOEXT_DELETED;
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename T, typename Handler>
+spawned_task spawn_entry(task<T> t, Handler handler,
+                         asio::io_service& io_service)
+{
+  std::exception_ptr e;
+  if constexpr (std::is_void<T>::value) {
+    try {
+      co_await std::move(t);
+    } catch (...) {
+      e = std::current_exception();
+    }
+    post_handler(io_service, bind_handler(std::move(handler), e));
+  } else {
+    T value{};
+    try {
+      value = co_await std::move(t);
+    } catch (...) {
+      e = std::current_exception();
+    }
+    post_handler(io_service, bind_handler(std::move(handler), e,
+                                          std::move(value)));
+  }
+}
+
+// Awaits an asynchronous operation whose handler signature is
+// void(error_code, Results...). The operation is started once the
+// awaiting coroutine is suspended, and its handler resumes the coroutine.
+// The awaiter is part of the coroutine frame, so the results are stored
+// there.
+template <typename Initiation, typename... Results>
+class async_awaiter
+{
+public:
+  class handler
+  {
+  public:
+    handler(async_awaiter* awaiter, std::coroutine_handle<> coroutine)
+      : awaiter_(awaiter)
+      , coroutine_(coroutine)
+    {
+      // ctor
+    }
+
+    void operator()(const error_code& ec, Results... results)
+    {
+      awaiter_->ec_ = ec;
+      awaiter_->results_ = std::tuple<Results...>(std::move(results)...);
+      coroutine_.resume();
+    }
+
+  private:
+    async_awaiter* awaiter_;
+    std::coroutine_handle<> coroutine_;
+  };
+
+  async_awaiter(Initiation&& initiation, error_code* ec, const char* what)
+    : initiation_(std::move(initiation))
+    , ec_out_(ec)
+    , what_(what)
+  {
+    // ctor
+  }
+
+  bool await_ready() const ASIOEXT_NOEXCEPT
+  {
+    return false;
+  }
+
+  void await_suspend(std::coroutine_handle<> coroutine)
+  {
+    initiation_(handler(this, coroutine));
+  }
+
+  auto await_resume()
+  {
+    if (ec_out_)
+      *ec_out_ = ec_;
+    else
+      throw_error(ec_, what_);
+
+    if constexpr (sizeof...(Results) == 1)
+      return std::get<0>(std::move(results_));
+    else if constexpr (sizeof...(Results) > 1)
+      return std::move(results_);
+  }
+
+private:
+  Initiation initiation_;
+  error_code* ec_out_;
+  const char* what_;
+  error_code ec_;
+  std::tuple<Results...> results_;
+};
+
+template <typename... Results, typename Initiation>
+async_awaiter<Initiation, Results...> make_async_awaiter(
+    Initiation initiation, error_code* ec, const char* what)
+{
+  return async_awaiter<Initiation, Results...>(std::move(initiation), ec,
+                                               what);
+}
+
+template <typename FileService, typename RawByteContainer>
+auto make_read_file_awaiter(basic_file<FileService>& file,
+                            RawByteContainer& c, error_code* ec)
+{
+  return make_async_awaiter<std::size_t>(
+      [&file, &c] (auto handler) {
+    error_code ec;
+    const uint64_t size = file.size(ec);
+    if (!ec && (size > (std::numeric_limits<
+                           typename RawByteContainer::size_type>::max)() ||
+                size > c.max_size()))
+      ec = asio::error::message_size;
+
+    if (ec || size == 0) {
+      if (!ec)
+        c.clear();
+      post_handler(file, bind_handler(std::move(handler), ec,
+                                      std::size_t(0)));
+      return;
+    }
+
+    resize_for_overwrite(c, static_cast<std::size_t>(size), 0);
+    file.async_read_at(0, asio::buffer(&c[0], c.size()), std::move(handler));
+  }, ec, "read_file");
+}
+
+}
+
+/// @ingroup core
+/// @brief Start a task on an io_service.
+///
+/// The task is started as if by asio::io_service::post(). Once it
+/// returned, the handler is posted.
+///
+/// @param io_service The io_service to start the task on.
+/// @param t The task to run.
+/// @param handler The handler to be called when the task returned. The
+/// function signature of the handler must be:
+/// @code
+/// void handler(
+///   // The exception thrown by the task, if any.
+///   std::exception_ptr e,
+///
+///   // The task's result. Omitted for task<void>. Default-constructed if
+///   // the task threw.
+///   T value
+/// );
+/// @endcode
+template <typename T, typename CompletionHandler>
+void co_spawn(asio::io_service& io_service, task<T> t,
+              CompletionHandler&& handler)
+{
+  detail::post_handler(io_service, detail::spawn_entry(
+      std::move(t), typename std::decay<CompletionHandler>::type(
+          std::forward<CompletionHandler>(handler)), io_service));
+}
+
+/// @ingroup files
+/// @brief Await basic_file::async_read_some_at().
+///
+/// @returns The number of bytes read.
+/// @throws asio::system_error Thrown on failure.
+template <typename FileService, typename MutableBufferSequence>
+auto await_read_some_at(basic_file<FileService>& file, uint64_t offset,
+                        const MutableBufferSequence& buffers)
+{
+  return detail::make_async_awaiter<std::size_t>(
+      [&file, offset, buffers] (auto handler) {
+    file.async_read_some_at(offset, buffers, std::move(handler));
+  }, nullptr, "read_some_at");
+}
+
+/// @ingroup files
+/// @brief Await basic_file::async_read_some_at().
+///
+/// @returns The number of bytes read.
+/// @param ec Set to indicate what error occurred, if any.
+template <typename FileService, typename MutableBufferSequence>
+auto await_read_some_at(basic_file<FileService>& file, uint64_t offset,
+                        const MutableBufferSequence& buffers, error_code& ec)
+{
+  return detail::make_async_awaiter<std::size_t>(
+      [&file, offset, buffers] (auto handler) {
+    file.async_read_some_at(offset, buffers, std::move(handler));
+  }, &ec, "read_some_at");
+}
+
+/// @ingroup files
+/// @brief Await basic_file::async_write_some_at().
+///
+/// @returns The number of bytes written.
+/// @throws asio::system_error Thrown on failure.
+template <typename FileService, typename ConstBufferSequence>
+auto await_write_some_at(basic_file<FileService>& file, uint64_t offset,
+                         const ConstBufferSequence& buffers)
+{
+  return detail::make_async_awaiter<std::size_t>(
+      [&file, offset, buffers] (auto handler) {
+    file.async_write_some_at(offset, buffers, std::move(handler));
+  }, nullptr, "write_some_at");
+}
+
+/// @ingroup files
+/// @brief Await basic_file::async_write_some_at().
+///
+/// @returns The number of bytes written.
+/// @param ec Set to indicate what error occurred, if any.
+template <typename FileService, typename ConstBufferSequence>
+auto await_write_some_at(basic_file<FileService>& file, uint64_t offset,
+                         const ConstBufferSequence& buffers, error_code& ec)
+{
+  return detail::make_async_awaiter<std::size_t>(
+      [&file, offset, buffers] (auto handler) {
+    file.async_write_some_at(offset, buffers, std::move(handler));
+  }, &ec, "write_some_at");
+}
+
+/// @ingroup files
+/// @brief Asynchronously read the contents of an open file into a
+/// container.
+///
+/// This is the asynchronous counterpart of read_file(): the container
+/// is resized to the file's size and filled with a single
+/// basic_file::async_read_at() call.
+///
+/// @returns The number of bytes read.
+/// @throws asio::system_error Thrown on failure.
+template <typename FileService, typename RawByteContainer>
+auto await_read_file(basic_file<FileService>& file, RawByteContainer& c)
+{
+  return detail::make_read_file_awaiter(file, c, nullptr);
+}
+
+/// @ingroup files
+/// @brief Asynchronously read the contents of an open file into a
+/// container.
+///
+/// See await_read_file(basic_file<FileService>&, RawByteContainer&).
+///
+/// @returns The number of bytes read.
+/// @param ec Set to indicate what error occurred, if any.
+template <typename FileService, typename RawByteContainer>
+auto await_read_file(basic_file<FileService>& file, RawByteContainer& c,
+                     error_code& ec)
+{
+  return detail::make_read_file_awaiter(file, c, &ec);
+}
+
+/// @ingroup net
+/// @brief Await asioext::async_connect().
+///
+/// @param resolver An asio::ip::tcp::resolver or a @ref resolver_cache.
+/// @returns An iterator denoting the endpoint that was connected to.
+/// @throws asio::system_error Thrown on failure.
+template <typename Resolver>
+auto await_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+                   Resolver& resolver,
+                   const asio::ip::tcp::resolver::query& q)
+{
+  return detail::make_async_awaiter<asio::ip::tcp::resolver::iterator>(
+      [&socket, &resolver, q] (auto handler) {
+    asioext::async_connect(socket, resolver, q, std::move(handler));
+  }, nullptr, "connect");
+}
+
+/// @ingroup net
+/// @brief Await asioext::async_connect().
+///
+/// @param resolver An asio::ip::tcp::resolver or a @ref resolver_cache.
+/// @returns An iterator denoting the endpoint that was connected to.
+/// @param ec Set to indicate what error occurred, if any.
+template <typename Resolver>
+auto await_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+                   Resolver& resolver,
+                   const asio::ip::tcp::resolver::query& q, error_code& ec)
+{
+  return detail::make_async_awaiter<asio::ip::tcp::resolver::iterator>(
+      [&socket, &resolver, q] (auto handler) {
+    asioext::async_connect(socket, resolver, q, std::move(handler));
+  }, &ec, "connect");
+}
+
+/// @ingroup net
+/// @brief Await asioext::async_connect() for a sequence of endpoints.
+///
+/// @returns An iterator denoting the endpoint that was connected to.
+/// @throws asio::system_error Thrown on failure.
+template <typename Iterator>
+auto await_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+                   Iterator begin, Iterator end,
+                   const asio::steady_timer::duration& attempt_delay)
+{
+  return detail::make_async_awaiter<Iterator>(
+      [&socket, begin, end, attempt_delay] (auto handler) {
+    asioext::async_connect(socket, begin, end, attempt_delay,
+                           std::move(handler));
+  }, nullptr, "connect");
+}
+
+/// @ingroup net
+/// @brief Await asioext::async_connect() for a sequence of endpoints.
+///
+/// @returns An iterator denoting the endpoint that was connected to.
+/// @param ec Set to indicate what error occurred, if any.
+template <typename Iterator>
+auto await_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+                   Iterator begin, Iterator end,
+                   const asio::steady_timer::duration& attempt_delay,
+                   error_code& ec)
+{
+  return detail::make_async_awaiter<Iterator>(
+      [&socket, begin, end, attempt_delay] (auto handler) {
+    asioext::async_connect(socket, begin, end, attempt_delay,
+                           std::move(handler));
+  }, &ec, "connect");
+}
+
+ASIOEXT_NS_END
+
+#endif
+
+#endif
@@ -248,9 +248,9 @@ public:
 
   /// @brief Cancel all asynchronous operations associated with the file.
   ///
-  /// This function causes all outstanding asynchronous write and read
-  /// operations to finish immediately, and the handlers for cancelled operations
-  /// will be passed the asio::error::operation_aborted error.
+  /// This function causes all outstanding asynchronous operations (except
+  /// async_close()) to finish immediately, and the handlers for cancelled
+  /// operations will be passed the asio::error::operation_aborted error.
   ///
   /// @throws asio::system_error Thrown on failure.
   void cancel()
@@ -262,9 +262,9 @@ public:
 
   /// @brief Cancel all asynchronous operations associated with the file.
   ///
-  /// This function causes all outstanding asynchronous write and read
-  /// operations to finish immediately, and the handlers for cancelled operations
-  /// will be passed the asio::error::operation_aborted error.
+  /// This function causes all outstanding asynchronous operations (except
+  /// async_close()) to finish immediately, and the handlers for cancelled
+  /// operations will be passed the asio::error::operation_aborted error.
   ///
   /// @param ec Set to indicate what error occurred. If no error occurred,
   /// the object is reset.
@@ -393,6 +393,69 @@ public:
     this->get_service().close(this->get_implementation(), ec);
   }
 
+  /// @brief Start an asynchronous open of a file.
+  ///
+  /// This function is used to asynchronously open a handle to the specified
+  /// file. The function call always returns immediately. The file is opened
+  /// by the file service (e.g. on a thread of a thread_pool_file_service),
+  /// so slow file systems don't block the caller.
+  ///
+  /// The new handle is assigned to this basic_file before the handler
+  /// is invoked. If the basic_file is cancelled, closed, moved or destroyed
+  /// before that, the operation fails with asio::error::operation_aborted
+  /// and the file (if it was opened already) is closed again. Moving the
+  /// basic_file also cancels its other outstanding operations.
+  ///
+  /// @param filename The path of the file to open. The string is copied,
+  /// it doesn't need to remain valid until the handler is called.
+  /// See @ref filenames for details.
+  ///
+  /// @param args Additional options used to open the file.
+  ///
+  /// @param handler The handler to be called when the open operation
+  /// completes. Copies will be made of the handler as required. The function
+  /// signature of the handler must be:
+  /// @code void handler(
+  ///   const error_code& error // Result of operation.
+  /// ); @endcode
+  /// Regardless of whether the asynchronous operation completes immediately or
+  /// not, the handler will not be invoked from within this function. Invocation
+  /// of the handler will be performed in a manner equivalent to using
+  /// asio::io_service::post().
+  template <typename OpenHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(OpenHandler, void(error_code))
+  async_open(const char* filename, const open_args& args,
+             ASIOEXT_MOVE_ARG(OpenHandler) handler)
+  {
+    return this->get_service().async_open(this->get_implementation(),
+        filename, args, ASIOEXT_MOVE_CAST(OpenHandler)(handler));
+  }
+
+  /// @brief Start an asynchronous close of the handle.
+  ///
+  /// This function is used to asynchronously close the handle. The
+  /// basic_file is reset immediately, so it can be re-opened right away.
+  /// All outstanding asynchronous operations are cancelled, as if
+  /// cancel() was called.
+  ///
+  /// @param handler The handler to be called when the close operation
+  /// completes. Copies will be made of the handler as required. The function
+  /// signature of the handler must be:
+  /// @code void handler(
+  ///   const error_code& error // Result of operation.
+  /// ); @endcode
+  /// Regardless of whether the asynchronous operation completes immediately or
+  /// not, the handler will not be invoked from within this function. Invocation
+  /// of the handler will be performed in a manner equivalent to using
+  /// asio::io_service::post().
+  template <typename CloseHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(CloseHandler, void(error_code))
+  async_close(ASIOEXT_MOVE_ARG(CloseHandler) handler)
+  {
+    return this->get_service().async_close(this->get_implementation(),
+        ASIOEXT_MOVE_CAST(CloseHandler)(handler));
+  }
+
   /// @}
 
   /// @name File pointer functions
@@ -624,6 +687,95 @@ public:
     this->get_service().times(this->get_implementation(), new_times, ec);
   }
 
+  /// @copydoc file_handle::status(file_status_mask)
+  file_status status(file_status_mask mask = file_status_mask::all)
+  {
+    error_code ec;
+    file_status st = this->get_service().status(this->get_implementation(),
+                                                mask, ec);
+    detail::throw_error(ec);
+    return st;
+  }
+
+  /// @copydoc file_handle::status(file_status_mask,error_code&)
+  file_status status(file_status_mask mask, error_code& ec) ASIOEXT_NOEXCEPT
+  {
+    return this->get_service().status(this->get_implementation(), mask, ec);
+  }
+
+  /// @brief Start an asynchronous query of the file size.
+  ///
+  /// The handler's function signature must be:
+  /// @code void handler(
+  ///   const error_code& error, // Result of operation.
+  ///   uint64_t size // The file's size.
+  /// ); @endcode
+  ///
+  /// Like the read and write operations, the query can be cancelled
+  /// using cancel().
+  template <typename SizeHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(SizeHandler, void(error_code, uint64_t))
+  async_size(ASIOEXT_MOVE_ARG(SizeHandler) handler)
+  {
+    return this->get_service().async_size(this->get_implementation(),
+        ASIOEXT_MOVE_CAST(SizeHandler)(handler));
+  }
+
+  /// @brief Start an asynchronous change of the file size.
+  ///
+  /// The handler's function signature must be:
+  /// @code void handler(
+  ///   const error_code& error // Result of operation.
+  /// ); @endcode
+  ///
+  /// Like the read and write operations, the change can be cancelled
+  /// using cancel().
+  template <typename SizeHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(SizeHandler, void(error_code))
+  async_size(uint64_t new_size, ASIOEXT_MOVE_ARG(SizeHandler) handler)
+  {
+    return this->get_service().async_size(this->get_implementation(),
+        new_size, ASIOEXT_MOVE_CAST(SizeHandler)(handler));
+  }
+
+  /// @brief Start an asynchronous query of the file times.
+  ///
+  /// The handler's function signature must be:
+  /// @code void handler(
+  ///   const error_code& error, // Result of operation.
+  ///   file_times times // The file's times.
+  /// ); @endcode
+  ///
+  /// Like the read and write operations, the query can be cancelled
+  /// using cancel().
+  template <typename TimesHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(TimesHandler, void(error_code, file_times))
+  async_times(ASIOEXT_MOVE_ARG(TimesHandler) handler)
+  {
+    return this->get_service().async_times(this->get_implementation(),
+        ASIOEXT_MOVE_CAST(TimesHandler)(handler));
+  }
+
+  /// @brief Start an asynchronous query of multiple metadata values.
+  ///
+  /// @param mask The members of @ref file_status to fetch.
+  ///
+  /// @param handler The handler's function signature must be:
+  /// @code void handler(
+  ///   const error_code& error, // Result of operation.
+  ///   file_status status // The requested metadata.
+  /// ); @endcode
+  ///
+  /// Like the read and write operations, the query can be cancelled
+  /// using cancel().
+  template <typename StatusHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(StatusHandler, void(error_code, file_status))
+  async_status(file_status_mask mask, ASIOEXT_MOVE_ARG(StatusHandler) handler)
+  {
+    return this->get_service().async_status(this->get_implementation(),
+        mask, ASIOEXT_MOVE_CAST(StatusHandler)(handler));
+  }
+
   /// @}
 
   /// @name SyncReadStream functions
@@ -1081,6 +1233,52 @@ public:
         offset, buffers, ASIOEXT_MOVE_CAST(ReadHandler)(handler));
   }
 
+  /// @brief Start an asynchronous read of a specific amount of data at the
+  /// specified offset.
+  ///
+  /// This function is used to asynchronously read data from the file.
+  /// The operation completes when @c buffers are full, the end of the file
+  /// was reached or an error occurred. The function call always returns
+  /// immediately.
+  ///
+  /// Unlike @c asio::async_read_at, which is composed of multiple
+  /// async_read_some_at() calls, the whole operation is performed by the
+  /// file service, e.g. on a single thread of a thread_pool_file_service.
+  ///
+  /// @param offset The offset at which the data will be read.
+  ///
+  /// @param buffers One or more buffers into which the data will be read.
+  /// Although the buffers object may be copied as necessary, ownership of the
+  /// underlying memory blocks is retained by the caller, which must guarantee
+  /// that they remain valid until the handler is called.
+  ///
+  /// @param handler The handler to be called when the read operation completes.
+  /// Copies will be made of the handler as required. The function signature of
+  /// the handler must be:
+  /// @code void handler(
+  ///   const error_code& error, // Result of operation.
+  ///   std::size_t bytes_transferred // Number of bytes read.
+  /// ); @endcode
+  /// Regardless of whether the asynchronous operation completes immediately or
+  /// not, the handler will not be invoked from within this function. Invocation
+  /// of the handler will be performed in a manner equivalent to using
+  /// asio::io_service::post().
+  ///
+  /// @see asioext::async_read_at
+  template <typename MutableBufferSequence, typename ReadHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+  async_read_at(uint64_t offset,
+                const MutableBufferSequence& buffers,
+                ASIOEXT_MOVE_ARG(ReadHandler) handler)
+  {
+    // If you get an error on the following line it means that your handler does
+    // not meet the documented type requirements for a ReadHandler.
+    ASIOEXT_READ_HANDLER_CHECK(ReadHandler, handler) type_check;
+
+    return this->get_service().async_read_at(this->get_implementation(),
+        offset, buffers, ASIOEXT_MOVE_CAST(ReadHandler)(handler));
+  }
+
   /// @}
 
   /// @name AsyncRandomAccessWriteDevice functions
@@ -1138,6 +1336,51 @@ public:
         offset, buffers, ASIOEXT_MOVE_CAST(WriteHandler)(handler));
   }
 
+  /// @brief Start an asynchronous write of all data at the specified offset.
+  ///
+  /// This function is used to asynchronously write data to the file.
+  /// The operation completes when all of @c buffers were written or an error
+  /// occurred. The function call always returns immediately.
+  ///
+  /// Unlike @c asio::async_write_at, which is composed of multiple
+  /// async_write_some_at() calls, the whole operation is performed by the
+  /// file service, e.g. on a single thread of a thread_pool_file_service.
+  ///
+  /// @param offset The offset at which the data will be written.
+  ///
+  /// @param buffers One or more data buffers to be written to the file.
+  /// Although the buffers object may be copied as necessary, ownership of the
+  /// underlying memory blocks is retained by the caller, which must guarantee
+  /// that they remain valid until the handler is called.
+  ///
+  /// @param handler The handler to be called when the write operation
+  /// completes.
+  /// Copies will be made of the handler as required. The function signature of
+  /// the handler must be:
+  /// @code void handler(
+  ///   const error_code& error, // Result of operation.
+  ///   std::size_t bytes_transferred // Number of bytes written.
+  /// ); @endcode
+  /// Regardless of whether the asynchronous operation completes immediately or
+  /// not, the handler will not be invoked from within this function. Invocation
+  /// of the handler will be performed in a manner equivalent to using
+  /// asio::io_service::post().
+  ///
+  /// @see asioext::async_write_at
+  template <typename ConstBufferSequence, typename WriteHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(WriteHandler, void(error_code, std::size_t))
+  async_write_at(uint64_t offset,
+                 const ConstBufferSequence& buffers,
+                 ASIOEXT_MOVE_ARG(WriteHandler) handler)
+  {
+    // If you get an error on the following line it means that your handler does
+    // not meet the documented type requirements for a WriteHandler.
+    ASIOEXT_WRITE_HANDLER_CHECK(WriteHandler, handler) type_check;
+
+    return this->get_service().async_write_at(this->get_implementation(),
+        offset, buffers, ASIOEXT_MOVE_CAST(WriteHandler)(handler));
+  }
+
   /// @}
 };
 
@@ -0,0 +1,109 @@
+/// @file
+/// Defines the block_pool class.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_BLOCKPOOL_HPP
+#define ASIOEXT_BLOCKPOOL_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/detail/cstdint.hpp"
+
+#include <cstddef> // for size_t
+#include <limits>
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup core
+/// @brief Cache of equally-sized memory blocks.
+///
+/// Blocks that are returned to the pool are kept in a free list and handed
+/// out again by the next allocate() call, so steady-state usage doesn't
+/// touch the heap at all.
+///
+/// The free list is stored inside the cached blocks themselves, so
+/// returning a block never allocates.
+///
+/// @note This class is not thread-safe.
+class block_pool
+{
+public:
+  /// @brief Construct an empty block pool.
+  ///
+  /// @param block_size The size of each block, in bytes. Values smaller than
+  /// the size of a pointer are rounded up.
+  ///
+  /// @param max_cached_blocks The maximum number of free blocks that are
+  /// kept for later reuse. Blocks returned beyond that are freed.
+  explicit block_pool(std::size_t block_size = 4096,
+                      std::size_t max_cached_blocks =
+                          (std::numeric_limits<std::size_t>::max)())
+      ASIOEXT_NOEXCEPT
+    : block_size_(block_size < sizeof(free_block) ? sizeof(free_block)
+                                                  : block_size)
+    , max_cached_blocks_(max_cached_blocks)
+    , cached_blocks_(0)
+    , free_list_(nullptr)
+  {
+    // ctor
+  }
+
+  /// @brief Destroy the block pool.
+  ///
+  /// Frees all cached blocks. All allocated blocks have to be returned
+  /// before the pool is destroyed.
+  ASIOEXT_DECL ~block_pool();
+
+  /// @brief Get the size of a single block.
+  std::size_t block_size() const ASIOEXT_NOEXCEPT
+  {
+    return block_size_;
+  }
+
+  /// @brief Get the number of free blocks that are currently cached.
+  std::size_t cached_blocks() const ASIOEXT_NOEXCEPT
+  {
+    return cached_blocks_;
+  }
+
+  /// @brief Get a block of block_size() bytes.
+  ///
+  /// @throws std::bad_alloc Thrown if the pool is empty and no new block
+  /// could be allocated.
+  ASIOEXT_DECL uint8_t* allocate();
+
+  /// @brief Return a block obtained from allocate() to the pool.
+  ASIOEXT_DECL void deallocate(uint8_t* block) ASIOEXT_NOEXCEPT;
+
+  /// @brief Free all cached blocks.
+  ASIOEXT_DECL void release() ASIOEXT_NOEXCEPT;
+
+private:
+  block_pool(const block_pool&) ASIOEXT_DELETED;
+  block_pool& operator=(const block_pool&) ASIOEXT_DELETED;
+
+  struct free_block
+  {
+    free_block* next;
+  };
+
+  std::size_t block_size_;
+  std::size_t max_cached_blocks_;
+  std::size_t cached_blocks_;
+  free_block* free_list_;
+};
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/impl/block_pool.cpp"
+#endif
+
+#endif
@@ -0,0 +1,408 @@
+/// @file
+/// Defines the buffer_pool class and related types.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_BUFFERPOOL_HPP
+#define ASIOEXT_BUFFERPOOL_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/mutex.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/buffer.hpp>
+#else
+# include <asio/buffer.hpp>
+#endif
+
+#include <cstddef> // for size_t
+#include <type_traits>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+class buffer_pool;
+
+namespace detail {
+
+struct buffer_pool_thread_cache;
+class buffer_pool_tls;
+
+}
+
+/// @ingroup core
+/// @brief A buffer leased from a @ref buffer_pool.
+///
+/// pooled_buffer owns a buffer obtained by buffer_pool::acquire() and
+/// returns it to its pool on destruction. It is movable, but not copyable.
+///
+/// A default-constructed pooled_buffer doesn't own any buffer.
+///
+/// @par Example
+/// @code
+/// asioext::pooled_buffer buf = pool.acquire(16 * 1024);
+/// std::size_t n = file.read_some(asio::buffer(buf));
+/// @endcode
+class pooled_buffer
+{
+public:
+  /// @brief Construct an empty pooled_buffer.
+  pooled_buffer() ASIOEXT_NOEXCEPT
+    : pool_(nullptr)
+    , data_(nullptr)
+    , size_(0)
+    , capacity_(0)
+  {
+    // ctor
+  }
+
+  /// @brief Take ownership of the buffer leased by @c other.
+  ///
+  /// After the move, @c other is empty.
+  pooled_buffer(pooled_buffer&& other) ASIOEXT_NOEXCEPT
+    : pool_(other.pool_)
+    , data_(other.data_)
+    , size_(other.size_)
+    , capacity_(other.capacity_)
+  {
+    other.pool_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = other.capacity_ = 0;
+  }
+
+  /// @brief Return the owned buffer (if any) to its pool.
+  ~pooled_buffer()
+  {
+    reset();
+  }
+
+  /// @brief Return the owned buffer (if any) and take ownership of the
+  /// buffer leased by @c other.
+  ASIOEXT_DECL pooled_buffer& operator=(pooled_buffer&& other) ASIOEXT_NOEXCEPT;
+
+  /// @brief Return the owned buffer (if any) to its pool.
+  ///
+  /// After this function returns, the pooled_buffer is empty.
+  ASIOEXT_DECL void reset() ASIOEXT_NOEXCEPT;
+
+  /// @brief Get a pointer to the first byte of the buffer.
+  uint8_t* data() const ASIOEXT_NOEXCEPT
+  {
+    return data_;
+  }
+
+  /// @brief Get the requested size of the buffer.
+  std::size_t size() const ASIOEXT_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// @brief Get the usable size of the buffer.
+  ///
+  /// This is the size of the pool's size class, which can be larger than the
+  /// requested size.
+  std::size_t capacity() const ASIOEXT_NOEXCEPT
+  {
+    return capacity_;
+  }
+
+  /// @brief Check whether this pooled_buffer doesn't own a buffer.
+  bool empty() const ASIOEXT_NOEXCEPT
+  {
+    return data_ == nullptr;
+  }
+
+  /// @brief Get the pool this buffer belongs to.
+  buffer_pool* pool() const ASIOEXT_NOEXCEPT
+  {
+    return pool_;
+  }
+
+  /// @brief Get a mutable buffer that represents the requested size.
+  operator asio::mutable_buffer() const ASIOEXT_NOEXCEPT
+  {
+    return asio::mutable_buffer(data_, size_);
+  }
+
+  /// @brief Get a mutable buffer sequence that represents the requested size.
+  operator asio::mutable_buffers_1() const ASIOEXT_NOEXCEPT
+  {
+    return asio::mutable_buffers_1(data_, size_);
+  }
+
+private:
+  friend class buffer_pool;
+
+  pooled_buffer(buffer_pool* pool, uint8_t* data, std::size_t size,
+                std::size_t capacity) ASIOEXT_NOEXCEPT
+    : pool_(pool)
+    , data_(data)
+    , size_(size)
+    , capacity_(capacity)
+  {
+    // ctor
+  }
+
+  pooled_buffer(const pooled_buffer&) ASIOEXT_DELETED;
+  pooled_buffer& operator=(const pooled_buffer&) ASIOEXT_DELETED;
+
+  buffer_pool* pool_;
+  uint8_t* data_;
+  std::size_t size_;
+  std::size_t capacity_;
+};
+
+/// @ingroup core
+/// @brief Usage statistics of a @ref buffer_pool.
+struct buffer_pool_stats
+{
+  /// The number of allocations.
+  uint64_t allocations;
+
+  /// The number of allocations served from the calling thread's cache.
+  uint64_t thread_cache_hits;
+
+  /// The number of allocations served from the shared overflow list.
+  uint64_t shared_hits;
+
+  /// The number of allocations that had to allocate new memory, including
+  /// those that were too large to be pooled.
+  uint64_t misses;
+
+  /// The number of bytes in free buffers held by the pool.
+  std::size_t bytes_cached;
+
+  /// The number of bytes in buffers that are currently allocated.
+  std::size_t bytes_in_use;
+
+  /// @brief Get the fraction of allocations that didn't allocate new memory.
+  double hit_rate() const ASIOEXT_NOEXCEPT
+  {
+    return allocations != 0
+        ? static_cast<double>(thread_cache_hits + shared_hits) /
+          static_cast<double>(allocations)
+        : 0.0;
+  }
+};
+
+/// @ingroup core
+/// @brief Thread-safe pool of I/O buffers.
+///
+/// buffer_pool hands out buffers from a fixed set of size classes (powers
+/// of two between min_buffer_size() and max_buffer_size()). Freed buffers
+/// are kept in a per-thread cache, so that the common case of allocating and
+/// freeing a buffer on the same thread takes no locks at all. If a thread
+/// cache grows beyond its limit, half of it is moved to a shared overflow
+/// list, from which other threads refill their caches.
+///
+/// When a thread exits, the buffers in its cache are moved to the overflow
+/// list.
+///
+/// Requests larger than max_buffer_size() aren't pooled and go directly to
+/// the heap.
+///
+/// Buffers can be obtained as RAII leases (acquire()), as raw memory
+/// (allocate() / deallocate()) or through @ref buffer_pool_allocator, which
+/// makes the pool usable as the allocator of a @ref basic_linear_buffer.
+///
+/// @note All member functions can be called concurrently, except for the
+/// destructor. All buffers have to be returned before the pool is destroyed.
+class buffer_pool
+{
+public:
+  /// @brief Construct an empty buffer pool.
+  ///
+  /// @param min_buffer_size The smallest size class. Rounded up to a power
+  /// of two.
+  ///
+  /// @param max_buffer_size The largest size class. Rounded up to a power of
+  /// two.
+  ///
+  /// @param thread_cache_size The number of free buffers of each size class
+  /// that a thread keeps for itself.
+  ASIOEXT_DECL explicit buffer_pool(std::size_t min_buffer_size = 512,
+                                    std::size_t max_buffer_size = 64 * 1024,
+                                    std::size_t thread_cache_size = 16);
+
+  /// @brief Destroy the buffer pool.
+  ///
+  /// Frees all cached buffers.
+  ASIOEXT_DECL ~buffer_pool();
+
+  /// @brief Get the smallest size class.
+  std::size_t min_buffer_size() const ASIOEXT_NOEXCEPT
+  {
+    return min_buffer_size_;
+  }
+
+  /// @brief Get the largest size class.
+  std::size_t max_buffer_size() const ASIOEXT_NOEXCEPT
+  {
+    return max_buffer_size_;
+  }
+
+  /// @brief Get the number of bytes actually allocated for a request of
+  /// @c size bytes.
+  ASIOEXT_DECL std::size_t buffer_size(std::size_t size) const ASIOEXT_NOEXCEPT;
+
+  /// @brief Lease a buffer of at least @c size bytes.
+  ///
+  /// @throws std::bad_alloc Thrown if no memory could be allocated.
+  ASIOEXT_DECL pooled_buffer acquire(std::size_t size);
+
+  /// @brief Allocate a buffer of at least @c size bytes.
+  ///
+  /// The buffer has to be returned with deallocate(), passing the same
+  /// @c size.
+  ///
+  /// @throws std::bad_alloc Thrown if no memory could be allocated.
+  ASIOEXT_DECL void* allocate(std::size_t size);
+
+  /// @brief Return a buffer obtained from allocate().
+  ///
+  /// This function can be called from any thread.
+  ASIOEXT_DECL void deallocate(void* p, std::size_t size) ASIOEXT_NOEXCEPT;
+
+  /// @brief Get usage statistics.
+  ///
+  /// The values are collected from all threads without stopping them, so
+  /// they are only approximate while the pool is in use.
+  ASIOEXT_DECL buffer_pool_stats stats() const;
+
+  /// @brief Free all buffers held by the overflow list and the calling
+  /// thread's cache.
+  ASIOEXT_DECL void release() ASIOEXT_NOEXCEPT;
+
+private:
+  friend struct detail::buffer_pool_thread_cache;
+  friend class detail::buffer_pool_tls;
+
+  buffer_pool(const buffer_pool&) ASIOEXT_DELETED;
+  buffer_pool& operator=(const buffer_pool&) ASIOEXT_DELETED;
+
+  struct free_block
+  {
+    free_block* next;
+  };
+
+  struct free_list
+  {
+    free_block* head;
+    std::size_t count;
+  };
+
+  std::size_t size_class(std::size_t size) const ASIOEXT_NOEXCEPT;
+
+  detail::buffer_pool_thread_cache& thread_cache();
+
+  // Move the cache of an exiting thread into the overflow list.
+  void retire(detail::buffer_pool_thread_cache& cache) ASIOEXT_NOEXCEPT;
+
+  static void free_all(free_list& list) ASIOEXT_NOEXCEPT;
+
+  const uint64_t id_;
+  std::size_t min_buffer_size_;
+  std::size_t max_buffer_size_;
+  std::size_t num_classes_;
+  const std::size_t thread_cache_size_;
+
+  mutable detail::mutex mutex_;
+
+  // All of these are protected by |mutex_|.
+  std::vector<free_list> shared_;
+  std::size_t shared_bytes_;
+  std::vector<detail::buffer_pool_thread_cache*> caches_;
+};
+
+/// @ingroup core
+/// @brief Allocator that allocates from a @ref buffer_pool.
+///
+/// This class satisfies the <em>Allocator</em> requirements and can be used
+/// with any allocator-aware container, e.g. @ref basic_linear_buffer. Two
+/// allocators compare equal if they use the same pool.
+///
+/// @par Example
+/// @code
+/// asioext::buffer_pool pool;
+/// asioext::basic_linear_buffer<asioext::buffer_pool_allocator<uint8_t>>
+///     buf(asioext::buffer_pool_allocator<uint8_t>(pool));
+/// @endcode
+template <class T>
+class buffer_pool_allocator
+{
+public:
+  typedef T value_type;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  /// @brief Construct an allocator that uses @c pool.
+  explicit buffer_pool_allocator(buffer_pool& pool) ASIOEXT_NOEXCEPT
+    : pool_(&pool)
+  {
+    // ctor
+  }
+
+  template <class U>
+  buffer_pool_allocator(const buffer_pool_allocator<U>& other) ASIOEXT_NOEXCEPT
+    : pool_(other.pool())
+  {
+    // ctor
+  }
+
+  /// @brief Get the pool this allocator uses.
+  buffer_pool* pool() const ASIOEXT_NOEXCEPT
+  {
+    return pool_;
+  }
+
+  /// @brief Allocate storage for @c n objects.
+  ///
+  /// @throws std::bad_alloc Thrown if no memory could be allocated.
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+  }
+
+  /// @brief Free storage obtained from allocate().
+  void deallocate(T* p, std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    pool_->deallocate(p, n * sizeof(T));
+  }
+
+private:
+  buffer_pool* pool_;
+};
+
+template <class T, class U>
+bool operator==(const buffer_pool_allocator<T>& a,
+                const buffer_pool_allocator<U>& b) ASIOEXT_NOEXCEPT
+{
+  return a.pool() == b.pool();
+}
+
+template <class T, class U>
+bool operator!=(const buffer_pool_allocator<T>& a,
+                const buffer_pool_allocator<U>& b) ASIOEXT_NOEXCEPT
+{
+  return a.pool() != b.pool();
+}
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/impl/buffer_pool.cpp"
+#endif
+
+#endif
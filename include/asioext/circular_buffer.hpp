@@ -0,0 +1,523 @@
+/// @file
+/// Defines the basic_circular_buffer class template.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_CIRCULARBUFFER_HPP
+#define ASIOEXT_CIRCULARBUFFER_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/error_code.hpp"
+#include "asioext/detail/buffer_pair.hpp"
+#include "asioext/detail/error.hpp"
+#include "asioext/detail/move_support.hpp"
+#include "asioext/detail/throw_exception.hpp"
+#include "asioext/detail/cstdint.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/buffer.hpp>
+#else
+# include <asio/buffer.hpp>
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup core
+/// @brief Byte FIFO stored in a ring of power-of-two size.
+///
+/// Unlike a @c basic_linear_buffer used as a DynamicBuffer, removing data
+/// from the front of a basic_circular_buffer doesn't move the remaining
+/// data, which makes it a good fit for streaming parsers that consume a few
+/// bytes at a time.
+///
+/// The price is that the stored data may wrap around the end of the
+/// storage, so the input and output sequences consist of up to two buffers.
+///
+/// The capacity is always zero or a power of two. Memory is only
+/// reallocated if the buffer grows, in which case the data is linearized.
+///
+/// basic_circular_buffer provides the DynamicBuffer member functions
+/// (@c data(), @c prepare(), @c commit(), @c consume()) itself.
+/// Use @ref dynamic_buffer() to obtain a copyable DynamicBuffer referring to
+/// it.
+template <typename Allocator = std::allocator<uint8_t>>
+class basic_circular_buffer
+{
+public:
+  typedef Allocator allocator_type;
+  typedef std::allocator_traits<allocator_type> allocator_traits_type;
+
+  typedef std::size_t size_type;
+
+  /// The type used to represent a reference to a single byte inside the buffer.
+  typedef uint8_t& reference;
+
+  /// The type used to represent a const. reference to a single byte inside
+  /// the buffer.
+  typedef const uint8_t& const_reference;
+
+  /// The type used to represent the input sequence as a list of buffers.
+  ///
+  /// Contains at most two buffers.
+  typedef detail::buffer_pair<asio::const_buffer> const_buffers_type;
+
+  /// The type used to represent the output sequence as a list of buffers.
+  ///
+  /// Contains at most two buffers.
+  typedef detail::buffer_pair<asio::mutable_buffer> mutable_buffers_type;
+
+  static_assert(std::is_same<typename allocator_type::value_type, uint8_t>::value,
+                "Allocator::value_type must be uint8_t");
+
+  /// @brief Default-construct a basic_circular_buffer.
+  ///
+  /// The constructed buffer is empty and doesn't have any allocated memory.
+  basic_circular_buffer() ASIOEXT_NOEXCEPT
+    : rep_()
+    , capacity_(0)
+    , head_(0)
+    , size_(0)
+    , prepared_(0)
+    , max_size_(allocator_traits_type::max_size(rep_))
+  {
+  }
+
+  /// @brief Construct an empty buffer with the given allocator.
+  explicit basic_circular_buffer(const Allocator& a) ASIOEXT_NOEXCEPT
+    : rep_(a)
+    , capacity_(0)
+    , head_(0)
+    , size_(0)
+    , prepared_(0)
+    , max_size_(allocator_traits_type::max_size(rep_))
+  {
+  }
+
+  /// @brief Construct an empty buffer with a minimum capacity.
+  ///
+  /// @param initial_capacity The minimum initial capacity. It is rounded up
+  /// to the next power of two.
+  ///
+  /// @param maximum_size Specifies a maximum size for the buffer, in bytes.
+  explicit basic_circular_buffer(std::size_t initial_capacity,
+      std::size_t maximum_size = (std::numeric_limits<std::size_t>::max)());
+
+  /// @brief Copy-construct a circular buffer.
+  ///
+  /// The data is stored linearly in the new buffer.
+  basic_circular_buffer(const basic_circular_buffer& other);
+
+#if defined(ASIOEXT_HAS_MOVE)
+  /// @brief Move-construct a circular buffer.
+  ///
+  /// After the move, @c other is an empty buffer with no allocated memory
+  /// (as-if just default-constructed).
+  basic_circular_buffer(basic_circular_buffer&& other) ASIOEXT_NOEXCEPT
+    : rep_(ASIOEXT_MOVE_CAST(representation_type)(other.rep_))
+    , capacity_(other.capacity_)
+    , head_(other.head_)
+    , size_(other.size_)
+    , prepared_(other.prepared_)
+    , max_size_(other.max_size_)
+  {
+    other.rep_.data_ = nullptr;
+    other.capacity_ = other.head_ = other.size_ = other.prepared_ = 0;
+  }
+#endif
+
+  /// @brief Destroy the basic_circular_buffer.
+  ///
+  /// Deallocates all owned data.
+  ~basic_circular_buffer()
+  {
+    if (rep_.data_)
+      allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
+  }
+
+  /// @brief Copy-assign a circular buffer.
+  basic_circular_buffer& operator=(const basic_circular_buffer& other);
+
+#if defined(ASIOEXT_HAS_MOVE)
+  /// @brief Move-assign a circular buffer.
+  ///
+  /// If the allocator doesn't propagate on move assignment and differs from
+  /// @c other's, the data is copied, which may throw.
+  basic_circular_buffer& operator=(basic_circular_buffer&& other)
+      ASIOEXT_NOEXCEPT_IF(allocator_traits_type::
+                          propagate_on_container_move_assignment::value);
+#endif
+
+  /// @brief Get a copy of the allocator used by this buffer.
+  allocator_type get_allocator() const ASIOEXT_NOEXCEPT
+  {
+    return static_cast<const allocator_type&>(rep_);
+  }
+
+  /// @brief Get the size of the input sequence.
+  std::size_t size() const ASIOEXT_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// @brief Check whether the input sequence is empty.
+  bool empty() const ASIOEXT_NOEXCEPT
+  {
+    return size_ == 0;
+  }
+
+  /// @brief Get the maximum size of the circular buffer.
+  std::size_t max_size() const ASIOEXT_NOEXCEPT
+  {
+    return max_size_;
+  }
+
+  /// @brief Get the current capacity of the circular buffer.
+  ///
+  /// @returns Zero or a power of two.
+  std::size_t capacity() const ASIOEXT_NOEXCEPT
+  {
+    return capacity_;
+  }
+
+  /// @brief Access the byte at position @c pos of the input sequence.
+  reference operator[](std::size_t pos) ASIOEXT_NOEXCEPT
+  {
+    return rep_.data_[(head_ + pos) & (capacity_ - 1)];
+  }
+
+  /// @brief Access the byte at position @c pos of the input sequence.
+  const_reference operator[](std::size_t pos) const ASIOEXT_NOEXCEPT
+  {
+    return rep_.data_[(head_ + pos) & (capacity_ - 1)];
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  ///
+  /// @returns A sequence of at most two buffers.
+  ///
+  /// @note The returned object is invalidated by any member function that
+  /// modifies the input sequence or output sequence.
+  mutable_buffers_type data() ASIOEXT_NOEXCEPT
+  {
+    return segments(head_, size_);
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  ///
+  /// @returns A sequence of at most two buffers.
+  ///
+  /// @note The returned object is invalidated by any member function that
+  /// modifies the input sequence or output sequence.
+  const_buffers_type data() const ASIOEXT_NOEXCEPT
+  {
+    return segments(head_, size_);
+  }
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// Ensures that the output sequence can accommodate @c n bytes, growing the
+  /// storage as necessary.
+  ///
+  /// @param n Total number of bytes the output sequence has to accommodate.
+  ///
+  /// @returns A sequence of at most two buffers with a total size of @c n.
+  ///
+  /// @throws std::length_error If <tt>size() + n > max_size()</tt>.
+  ///
+  /// @note The returned object is invalidated by any member function that
+  /// modifies the input sequence or output sequence.
+  mutable_buffers_type prepare(std::size_t n);
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// Ensures that the output sequence can accommodate @c n bytes, growing the
+  /// storage as necessary.
+  ///
+  /// @param n Total number of bytes the output sequence has to accommodate.
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ///
+  /// @returns A sequence of at most two buffers with a total size of @c n.
+  ///
+  /// @note This function is not part of the DynamicBuffer requirements.
+  mutable_buffers_type prepare(std::size_t n, error_code& ec);
+
+  /// @brief Move bytes from the output sequence to the input sequence.
+  ///
+  /// @param n The number of bytes to append from the start of the output
+  /// sequence to the end of the input sequence. The remainder of the output
+  /// sequence is discarded.
+  ///
+  /// @note If @c n is greater than the size of the output sequence, the entire
+  /// output sequence is moved to the input sequence and no error is issued.
+  void commit(std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    size_ += (std::min)(n, prepared_);
+    prepared_ = 0;
+  }
+
+  /// @brief Remove bytes from the input sequence.
+  ///
+  /// Removes @c n bytes from the beginning of the input sequence.
+  /// This doesn't move any data.
+  ///
+  /// @note If @c n is greater than the size of the input sequence, the entire
+  /// input sequence is consumed and no error is issued.
+  void consume(std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    if (n >= size_) {
+      // Start over at the beginning, so the next writes aren't split.
+      head_ = size_ = 0;
+    } else {
+      head_ = (head_ + n) & (capacity_ - 1);
+      size_ -= n;
+    }
+    prepared_ = 0;
+  }
+
+  /// @brief Append data to the input sequence.
+  ///
+  /// @throws std::length_error If <tt>size() + n > max_size()</tt>.
+  void append(const void* data, std::size_t n);
+
+  /// @brief Ensure that the buffer can hold at least @c n bytes without
+  /// reallocating.
+  ///
+  /// @throws std::length_error If <tt>n > max_size()</tt>.
+  void reserve(std::size_t n);
+
+  /// @brief Remove all data from the buffer.
+  ///
+  /// Doesn't release any memory.
+  void clear() ASIOEXT_NOEXCEPT
+  {
+    head_ = size_ = prepared_ = 0;
+  }
+
+private:
+  struct representation_type : Allocator
+  {
+    representation_type()
+      : data_(nullptr)
+    {}
+
+    explicit representation_type(const Allocator& a)
+      : Allocator(a)
+      , data_(nullptr)
+    {}
+
+#if defined(ASIOEXT_HAS_MOVE)
+    representation_type(representation_type&& other) ASIOEXT_NOEXCEPT
+      : Allocator(std::move(static_cast<Allocator&>(other)))
+      , data_(other.data_)
+    {
+      other.data_ = nullptr;
+    }
+#endif
+
+    uint8_t* data_;
+  };
+
+  // The up to two buffers of |n| bytes, starting at the ring offset |pos|.
+  mutable_buffers_type segments(std::size_t pos,
+                                std::size_t n) const ASIOEXT_NOEXCEPT
+  {
+    if (n == 0)
+      return mutable_buffers_type();
+
+    const std::size_t first = (std::min)(n, capacity_ - pos);
+    return mutable_buffers_type(
+        asio::mutable_buffer(rep_.data_ + pos, first),
+        asio::mutable_buffer(rep_.data_, n - first));
+  }
+
+  // Grow the storage to the next power of two >= |n| and linearize the data.
+  void grow(std::size_t n);
+
+#if defined(ASIOEXT_HAS_MOVE)
+  void move_allocator(basic_circular_buffer& other, std::true_type)
+  {
+    static_cast<allocator_type&>(rep_) =
+        std::move(static_cast<allocator_type&>(other.rep_));
+  }
+
+  void move_allocator(basic_circular_buffer&, std::false_type)
+  {
+  }
+#endif
+
+  representation_type rep_;
+  std::size_t capacity_;
+  std::size_t head_;
+  std::size_t size_;
+  std::size_t prepared_;
+  std::size_t max_size_;
+};
+
+/// @brief A circular buffer using the default allocator.
+typedef basic_circular_buffer<> circular_buffer;
+
+/// @ingroup core
+/// @brief Adapt a circular buffer to the DynamicBuffer requirements.
+///
+/// The adapter only refers to the buffer, so the buffer keeps its contents
+/// after the adapter is gone, e.g. when an asynchronous read operation
+/// completes.
+///
+/// @tparam CircularBuffer Either @ref basic_circular_buffer or
+/// @ref mirrored_circular_buffer.
+template <typename CircularBuffer>
+class dynamic_circular_buffer
+{
+public:
+  /// The type used to represent the input sequence as a list of buffers.
+  typedef typename CircularBuffer::const_buffers_type const_buffers_type;
+
+  /// The type used to represent the output sequence as a list of buffers.
+  typedef typename CircularBuffer::mutable_buffers_type mutable_buffers_type;
+
+  /// @brief Construct a dynamic buffer from a circular buffer.
+  ///
+  /// @param b The circular buffer to be used as backing storage for the
+  /// dynamic buffer. Any existing data in the buffer is treated as the
+  /// dynamic buffer's input sequence. The object stores a reference to the
+  /// buffer and the user is responsible for ensuring that the buffer object
+  /// remains valid until the dynamic_circular_buffer object is destroyed.
+  ///
+  /// @param maximum_size Specifies a maximum size for the buffer, in bytes.
+  explicit dynamic_circular_buffer(CircularBuffer& b,
+      std::size_t maximum_size =
+        (std::numeric_limits<std::size_t>::max)()) ASIOEXT_NOEXCEPT
+    : data_(b)
+    , max_size_((std::min)(b.max_size(), maximum_size))
+  {
+  }
+
+  /// @brief Get the size of the input sequence.
+  std::size_t size() const ASIOEXT_NOEXCEPT
+  {
+    return data_.size();
+  }
+
+  /// @brief Get the maximum size of the dynamic buffer.
+  std::size_t max_size() const ASIOEXT_NOEXCEPT
+  {
+    return max_size_;
+  }
+
+  /// @brief Get the current capacity of the dynamic buffer.
+  std::size_t capacity() const ASIOEXT_NOEXCEPT
+  {
+    return data_.capacity();
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  mutable_buffers_type data() ASIOEXT_NOEXCEPT
+  {
+    return data_.data();
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  const_buffers_type data() const ASIOEXT_NOEXCEPT
+  {
+    return static_cast<const CircularBuffer&>(data_).data();
+  }
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// @throws std::length_error If <tt>size() + n > max_size()</tt>.
+  mutable_buffers_type prepare(std::size_t n)
+  {
+    const std::size_t size = data_.size();
+    if (size > max_size_ || max_size_ - size < n) {
+      std::length_error ex("dynamic_circular_buffer too long");
+      detail::throw_exception(ex);
+    }
+
+    return data_.prepare(n);
+  }
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ///
+  /// @note This function is not part of the DynamicBuffer requirements.
+  mutable_buffers_type prepare(std::size_t n, error_code& ec)
+  {
+    const std::size_t size = data_.size();
+    if (size > max_size_ || max_size_ - size < n) {
+      ec = asio::error::no_memory;
+      return mutable_buffers_type();
+    }
+
+    return data_.prepare(n, ec);
+  }
+
+  /// @brief Move bytes from the output sequence to the input sequence.
+  void commit(std::size_t n)
+  {
+    data_.commit(n);
+  }
+
+  /// @brief Remove bytes from the input sequence.
+  void consume(std::size_t n)
+  {
+    data_.consume(n);
+  }
+
+private:
+  CircularBuffer& data_;
+  std::size_t max_size_;
+};
+
+/// @ingroup core
+/// @brief Create a new dynamic buffer that represents the
+/// given @c basic_circular_buffer.
+///
+/// @returns <tt>dynamic_circular_buffer<basic_circular_buffer<Allocator>>(data)</tt>.
+template <typename Allocator>
+inline dynamic_circular_buffer<basic_circular_buffer<Allocator>>
+dynamic_buffer(basic_circular_buffer<Allocator>& data) ASIOEXT_NOEXCEPT
+{
+  return dynamic_circular_buffer<basic_circular_buffer<Allocator>>(data);
+}
+
+/// @ingroup core
+/// @brief Create a new dynamic buffer that represents the
+/// given @c basic_circular_buffer.
+///
+/// @returns <tt>dynamic_circular_buffer<basic_circular_buffer<Allocator>>(
+/// data, max_size)</tt>.
+template <typename Allocator>
+inline dynamic_circular_buffer<basic_circular_buffer<Allocator>>
+dynamic_buffer(basic_circular_buffer<Allocator>& data,
+               std::size_t max_size) ASIOEXT_NOEXCEPT
+{
+  return dynamic_circular_buffer<basic_circular_buffer<Allocator>>(data,
+                                                                   max_size);
+}
+
+ASIOEXT_NS_END
+
+#include "asioext/impl/circular_buffer.hpp"
+
+#endif
@@ -44,10 +44,40 @@
 # endif
 #endif
 
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 ASIOEXT_NS_BEGIN
 
 namespace detail {
 
+// The handler's associated allocator, rebound to T.
+template <typename Handler, typename T>
+struct handler_allocator_type
+{
+#if ASIOEXT_ASIO_VERSION >= 101200
+  typedef typename std::allocator_traits<
+    typename asio::associated_allocator<Handler>::type
+  >::template rebind_alloc<T> type;
+
+  static type get(const Handler& handler) ASIOEXT_NOEXCEPT
+  {
+    return type(asio::get_associated_allocator(handler));
+  }
+#else
+  typedef std::allocator<T> type;
+
+  static type get(const Handler&) ASIOEXT_NOEXCEPT
+  {
+    return type();
+  }
+#endif
+};
+
 template <typename Handler, typename Operation>
 class composed_op
 {
@@ -116,6 +146,353 @@ public:
   }
 };
 
+
+// Size of the memory block every composed_state keeps for the
+// asynchronous operation that is currently in flight.
+const std::size_t composed_state_slot_size = 256;
+
+// The state of an operation started by allocate_composed_operation().
+// It is allocated once, with the handler's allocator, and lives until the
+// operation completes. Each step's asynchronous operation gets its memory
+// from |slot_|, so a chain of steps doesn't allocate at all once started.
+template <typename Handler, typename Operation>
+class composed_state
+{
+  typedef handler_allocator_type<
+    Handler, composed_state
+  > allocator_helper;
+  typedef typename allocator_helper::type allocator_type;
+  typedef std::allocator_traits<allocator_type> traits;
+
+public:
+  template <typename Handler2, typename Operation2>
+  static composed_state* create(Handler2&& handler, Operation2&& op)
+  {
+    allocator_type alloc(allocator_helper::get(handler));
+    composed_state* p = traits::allocate(alloc, 1);
+    try {
+      new (p) composed_state(std::forward<Handler2>(handler),
+                             std::forward<Operation2>(op));
+    } catch (...) {
+      traits::deallocate(alloc, p, 1);
+      throw;
+    }
+    return p;
+  }
+
+  void* allocate(std::size_t size)
+  {
+    void* p;
+    if (!slot_used_ && size <= sizeof(slot_)) {
+      slot_used_ = true;
+      p = &slot_;
+    } else {
+      p = ASIOEXT_HANDLER_ALLOC_HELPERS_NS::allocate(size, handler_);
+    }
+    ++outstanding_;
+    return p;
+  }
+
+  void deallocate(void* p, std::size_t size) ASIOEXT_NOEXCEPT
+  {
+    if (p == &slot_)
+      slot_used_ = false;
+    else
+      ASIOEXT_HANDLER_ALLOC_HELPERS_NS::deallocate(p, size, handler_);
+
+    if (--outstanding_ == 0 && released_)
+      destroy(this, handler_);
+  }
+
+  // Give up ownership. The state is destroyed as soon as no memory
+  // handed out by allocate() is in use anymore. Asio destroys a pending
+  // operation's handler before freeing the operation's memory.
+  void release() ASIOEXT_NOEXCEPT
+  {
+    released_ = true;
+    if (outstanding_ == 0)
+      destroy(this, handler_);
+  }
+
+  // Whether memory handed out by allocate() is still in use.
+  bool in_use() const ASIOEXT_NOEXCEPT
+  {
+    return outstanding_ != 0;
+  }
+
+  // Move the handler out and destroy the state, which must not be in use.
+  Handler take_handler()
+  {
+    Handler handler(std::move(handler_));
+    destroy(this, handler);
+    return handler;
+  }
+
+  Handler handler_;
+  Operation op_;
+
+private:
+  template <typename Handler2, typename Operation2>
+  composed_state(Handler2&& handler, Operation2&& op)
+    : handler_(std::forward<Handler2>(handler))
+    , op_(std::forward<Operation2>(op))
+    , outstanding_(0)
+    , slot_used_(false)
+    , released_(false)
+  {
+    // ctor
+  }
+
+  // |handler| provides the allocator. It might not be |p->handler_|,
+  // which is destroyed here.
+  static void destroy(composed_state* p,
+                      const Handler& handler) ASIOEXT_NOEXCEPT
+  {
+    allocator_type alloc(allocator_helper::get(handler));
+    p->~composed_state();
+    traits::deallocate(alloc, p, 1);
+  }
+
+  std::size_t outstanding_;
+  bool slot_used_;
+  bool released_;
+  typename std::aligned_storage<composed_state_slot_size>::type slot_;
+};
+
+#if (ASIOEXT_ASIO_VERSION >= 101100)
+// Serves the slot of a composed_state.
+template <typename T, typename State>
+class composed_state_allocator
+{
+public:
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef composed_state_allocator<U, State> other;
+  };
+
+  explicit composed_state_allocator(State* state) ASIOEXT_NOEXCEPT
+    : state_(state)
+  {
+    // ctor
+  }
+
+  template <typename U>
+  composed_state_allocator(
+      const composed_state_allocator<U, State>& other) ASIOEXT_NOEXCEPT
+    : state_(other.state_)
+  {
+    // ctor
+  }
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(state_->allocate(sizeof(T) * n));
+  }
+
+  void deallocate(T* p, std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    state_->deallocate(p, sizeof(T) * n);
+  }
+
+  template <typename U>
+  bool operator==(
+      const composed_state_allocator<U, State>& other) const ASIOEXT_NOEXCEPT
+  {
+    return state_ == other.state_;
+  }
+
+  template <typename U>
+  bool operator!=(
+      const composed_state_allocator<U, State>& other) const ASIOEXT_NOEXCEPT
+  {
+    return state_ != other.state_;
+  }
+
+private:
+  template <typename U, typename State2>
+  friend class composed_state_allocator;
+
+  State* state_;
+};
+#endif
+
+// Invokes a handler with the elements of a tuple, moving them.
+template <std::size_t N>
+struct composed_state_apply
+{
+  template <typename Handler, typename Tuple, typename... Args>
+  static void call(Handler& handler, Tuple& t, Args&&... args)
+  {
+    composed_state_apply<N - 1>::call(handler, t,
+                                      std::move(std::get<N - 1>(t)),
+                                      std::forward<Args>(args)...);
+  }
+};
+
+template <>
+struct composed_state_apply<0>
+{
+  template <typename Handler, typename Tuple, typename... Args>
+  static void call(Handler& handler, Tuple&, Args&&... args)
+  {
+    handler(std::forward<Args>(args)...);
+  }
+};
+
+// The handler passed between the steps of a composed_state.
+// It only holds a pointer, so moving it into the next asynchronous
+// operation is cheap no matter how large the operation's state is.
+template <typename Handler, typename Operation>
+class composed_state_op
+{
+  typedef composed_state<Handler, Operation> state_type;
+
+#if !defined(ASIOEXT_IS_DOCUMENTATION) && (ASIOEXT_ASIO_VERSION >= 101100)
+  template <typename T, typename Executor>
+  friend struct asio::associated_allocator;
+
+  template <typename T, typename Allocator>
+  friend struct asio::associated_executor;
+#endif
+
+  friend void* asio_handler_allocate(std::size_t size,
+                                     composed_state_op* this_handler)
+  {
+    return this_handler->state_->allocate(size);
+  }
+
+  friend void asio_handler_deallocate(void* pointer, std::size_t size,
+                                      composed_state_op* this_handler)
+  {
+    this_handler->state_->deallocate(pointer, size);
+  }
+
+  friend bool asio_handler_is_continuation(composed_state_op* this_handler)
+  {
+    return ASIOEXT_HANDLER_CONT_HELPERS_NS::is_continuation(
+        this_handler->state_->handler_);
+  }
+
+  template <typename Function>
+  friend void asio_handler_invoke(Function& function,
+                                  composed_state_op* this_handler)
+  {
+    ASIOEXT_HANDLER_INVOKE_HELPERS_NS::invoke(
+        function, this_handler->state_->handler_);
+  }
+
+  template <typename Function>
+  friend void asio_handler_invoke(const Function& function,
+                                  composed_state_op* this_handler)
+  {
+    ASIOEXT_HANDLER_INVOKE_HELPERS_NS::invoke(
+        function, this_handler->state_->handler_);
+  }
+
+  state_type* state_;
+
+  // Set by complete(). |result_| holds the arguments for the handler,
+  // |finish_| knows their types.
+  state_type* completed_;
+  void* result_;
+  void (*finish_)(state_type* state, void* result);
+
+public:
+  explicit composed_state_op(state_type* state) ASIOEXT_NOEXCEPT
+    : state_(state)
+    , completed_(nullptr)
+    , result_(nullptr)
+    , finish_(nullptr)
+  {
+    // ctor
+  }
+
+  composed_state_op(composed_state_op&& other) ASIOEXT_NOEXCEPT
+    : state_(other.state_)
+    , completed_(nullptr)
+    , result_(nullptr)
+    , finish_(nullptr)
+  {
+    other.state_ = nullptr;
+  }
+
+  // |state_| is left untouched: Asio may still deallocate the memory
+  // of the operation that contained this handler through our hooks.
+  ~composed_state_op()
+  {
+    if (state_)
+      state_->release();
+  }
+
+  template <typename... Args>
+  void operator()(Args&&... args)
+  {
+    state_->op_(*this, std::forward<Args>(args)...);
+
+    // The operation might still touch its members (e.g. asio::coroutine)
+    // after completing, so the handler is only invoked once it returned.
+    if (completed_) {
+      state_type* state = completed_;
+      completed_ = nullptr;
+      finish_(state, result_);
+    }
+  }
+
+  // Record the handler's arguments. The handler is invoked once the
+  // operation returned.
+  template <typename... Args>
+  void complete(Args&&... args)
+  {
+    typedef std::tuple<typename std::decay<Args>::type...> result_type;
+
+    // Usually served by the slot, which is free again by now.
+    void* p = state_->allocate(sizeof(result_type));
+    try {
+      new (p) result_type(std::forward<Args>(args)...);
+    } catch (...) {
+      state_->deallocate(p, sizeof(result_type));
+      throw;
+    }
+
+    completed_ = state_;
+    state_ = nullptr;
+    result_ = p;
+    finish_ = &finish<result_type>;
+  }
+
+private:
+  // Like Asio's own operations, free our memory before the upcall, so
+  // that the handler can reuse it.
+  template <typename Result>
+  static void finish(state_type* state, void* p)
+  {
+    Result* stored = static_cast<Result*>(p);
+    Result result(std::move(*stored));
+    stored->~Result();
+    state->deallocate(p, sizeof(Result));
+
+    // Asio frees an operation's memory before invoking its handler, so
+    // this only happens with a foreign operation that doesn't.
+    if (state->in_use()) {
+      composed_state_apply<std::tuple_size<Result>::value>::call(
+          state->handler_, result);
+      state->release();
+      return;
+    }
+
+    Handler handler(state->take_handler());
+    composed_state_apply<std::tuple_size<Result>::value>::call(
+        handler, result);
+  }
+
+  composed_state_op(const composed_state_op&) ASIOEXT_DELETED;
+  composed_state_op& operator=(const composed_state_op&) ASIOEXT_DELETED;
+  composed_state_op& operator=(composed_state_op&&) ASIOEXT_DELETED;
+};
+
 }
 
 /// @ingroup core
@@ -316,6 +693,89 @@ detail::composed_op<
 }
 #endif
 
+#if defined(ASIOEXT_IS_DOCUMENTATION)
+/// @ingroup core
+/// @brief Allocate a composed operation's state once and bind it to a
+/// handler.
+///
+/// Unlike @ref make_composed_operation, which moves the handler and the
+/// operation into every intermediate handler, this function allocates
+/// both only once (using the handler's associated allocator) and
+/// returns a handler that merely points to them. The memory of the
+/// asynchronous operations started by the individual steps is taken
+/// from a block inside that allocation, so that a running chain of steps
+/// doesn't allocate.
+///
+/// @c op will be invoked by the following expression:
+/// @code
+/// op(self, std::forward<Args>(args)...)
+/// @endcode
+/// where @c self is a reference to the invoked handler, and @c args are
+/// the arguments that the handler has been called with. @c op then
+/// either passes <code>std::move(self)</code> to the next asynchronous
+/// operation or finishes the operation using
+/// <code>self.complete(args...)</code>, which invokes the original
+/// handler. The arguments are copied, so they may refer to members of
+/// @c op. Once @c op returns from the call in which it completed, it is
+/// destroyed and its memory freed; only then is the handler invoked.
+/// Members of @c op must not be accessed after passing @c self on.
+///
+/// The returned handler is move-only and supports the same customization
+/// points as the one returned by @ref make_composed_operation.
+///
+/// @param handler The @c Handler object whose hooks you wish to use.
+/// @param op The function object that implements the operation's steps.
+/// @returns A new @c Handler that forwards invocations to `op`.
+/// The operation is started by invoking it.
+///
+/// @par Example
+/// @code
+/// struct copy_op : asio::coroutine
+/// {
+///   tcp::socket& from;
+///   tcp::socket& to;
+///   std::array<char, 4096> data;
+///
+///   template <typename Self>
+///   void operator()(Self& self, asioext::error_code ec = {},
+///                   std::size_t size = 0)
+///   {
+///     ASIOEXT_CORO_REENTER (this) {
+///       ASIOEXT_CORO_YIELD from.async_read_some(asio::buffer(data),
+///                                              std::move(self));
+///       if (!ec)
+///         ASIOEXT_CORO_YIELD asio::async_write(
+///             to, asio::buffer(data, size), std::move(self));
+///       self.complete(ec);
+///     }
+///   }
+/// };
+///
+/// asioext::allocate_composed_operation(std::move(handler),
+///                                      copy_op{from, to})();
+/// @endcode
+template <typename Handler, typename Operation>
+implementation_defined allocate_composed_operation(Handler&& handler,
+                                                   Operation&& op);
+#else
+template <typename Handler, typename Operation>
+detail::composed_state_op<
+    typename std::decay<Handler>::type,
+    typename std::decay<Operation>::type
+> allocate_composed_operation(Handler&& handler, Operation&& op)
+{
+  typedef detail::composed_state_op<
+    typename std::decay<Handler>::type,
+    typename std::decay<Operation>::type
+  > op_type;
+
+  return op_type(detail::composed_state<
+      typename std::decay<Handler>::type,
+      typename std::decay<Operation>::type
+  >::create(std::forward<Handler>(handler), std::forward<Operation>(op)));
+}
+#endif
+
 ASIOEXT_NS_END
 
 #if !defined(ASIOEXT_IS_DOCUMENTATION) && (ASIOEXT_ASIO_VERSION >= 101100)
@@ -350,6 +810,37 @@ struct associated_executor<
   }
 };
 
+template <typename Handler, typename Operation, typename Allocator>
+struct associated_allocator<
+    asioext::detail::composed_state_op<Handler, Operation>, Allocator>
+{
+  typedef asioext::detail::composed_state_allocator<
+    void, asioext::detail::composed_state<Handler, Operation>
+  > type;
+
+  static type get(
+      const asioext::detail::composed_state_op<Handler, Operation>& h,
+      const Allocator& = Allocator()) ASIOEXT_NOEXCEPT
+  {
+    return type(h.state_);
+  }
+};
+
+template <typename Handler, typename Operation, typename Executor>
+struct associated_executor<
+    asioext::detail::composed_state_op<Handler, Operation>, Executor>
+{
+  typedef typename associated_executor<Handler, Executor>::type type;
+
+  static type get(
+      const asioext::detail::composed_state_op<Handler, Operation>& h,
+      const Executor& ex = Executor()) ASIOEXT_NOEXCEPT
+  {
+    return associated_executor<Handler, Executor>::get(
+        h.state_->handler_, ex);
+  }
+};
+
 }
 # if defined(ASIOEXT_USE_BOOST_ASIO)
 }
@@ -22,12 +22,16 @@
 
 #if defined(ASIOEXT_USE_BOOST_ASIO)
 # include <boost/asio/ip/tcp.hpp>
+# include <boost/asio/steady_timer.hpp>
 #else
 # include <asio/ip/tcp.hpp>
+# include <asio/steady_timer.hpp>
 #endif
 
 ASIOEXT_NS_BEGIN
 
+class resolver_cache;
+
 /// @ingroup net
 /// @defgroup connect asioext::connect()
 /// @{
@@ -73,16 +77,26 @@ ASIOEXT_DECL void connect(asio::ip::tcp::socket::lowest_layer_type& socket,
                           const asio::ip::tcp::resolver::query& q,
                           error_code& ec);
 
-/// @brief Asynchronously establishe a socket connection by trying each
-/// endpoint of a resolved name.
+/// @brief Default delay between two connection attempts of
+/// async_connect().
+///
+/// This is the value recommended by RFC 8305.
+const long default_connection_attempt_delay_ms = 250;
+
+/// @brief Asynchronously establish a socket connection by racing the
+/// endpoints of a resolved name.
 ///
 /// This function attempts to connect a socket by first resolving the given
-/// name (using the query and resolver arguments) and then trying each
-/// resolved endpoint (by calling the socket's connect member) until
-/// a connection is established (or we've run out of endpoints).
+/// name (using the query and resolver arguments) and then connecting to the
+/// resolved endpoints as described in RFC 8305 ("Happy Eyeballs").
+/// See the iterator overload for details.
+///
+/// Connection attempts are started 250ms apart
+/// (@ref default_connection_attempt_delay_ms).
 ///
 /// @param socket The socket to be connected.
 /// If the socket is already open, it will be closed.
+/// The operation can be cancelled by closing the socket.
 /// @param resolver The resolver to be used for our query.
 /// @param q The name to be resolved to a list of endpoints.
 /// @param handler The handler to be called when the connect operation
@@ -107,6 +121,100 @@ async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
               const asio::ip::tcp::resolver::query& q,
               ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler);
 
+/// @brief Asynchronously establish a socket connection by racing the
+/// endpoints of a resolved name.
+///
+/// Same as above, with a custom delay between two connection attempts.
+template <typename ComposedConnectHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ComposedConnectHandler,
+                           void(error_code, asio::ip::tcp::resolver::iterator))
+async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+              asio::ip::tcp::resolver& resolver,
+              const asio::ip::tcp::resolver::query& q,
+              const asio::steady_timer::duration& attempt_delay,
+              ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler);
+
+/// @brief Asynchronously establish a socket connection by racing the
+/// endpoints of a name resolved through a cache.
+///
+/// Same as the resolver overload, but looks the name up in a
+/// @ref resolver_cache, which avoids a system resolver call for
+/// recently resolved names.
+template <typename ComposedConnectHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ComposedConnectHandler,
+                           void(error_code, asio::ip::tcp::resolver::iterator))
+async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+              resolver_cache& resolver,
+              const asio::ip::tcp::resolver::query& q,
+              ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler);
+
+/// @brief Asynchronously establish a socket connection by racing the
+/// endpoints of a name resolved through a cache.
+///
+/// Same as above, with a custom delay between two connection attempts.
+template <typename ComposedConnectHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ComposedConnectHandler,
+                           void(error_code, asio::ip::tcp::resolver::iterator))
+async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+              resolver_cache& resolver,
+              const asio::ip::tcp::resolver::query& q,
+              const asio::steady_timer::duration& attempt_delay,
+              ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler);
+
+/// @brief Asynchronously establish a socket connection by racing a
+/// sequence of endpoints.
+///
+/// This function implements the connection racing of RFC 8305
+/// ("Happy Eyeballs"):
+///
+/// * The endpoints are reordered so that address families alternate,
+/// starting with the family of the first endpoint. Otherwise the order is
+/// preserved.
+/// * The first connection attempt is started immediately. Each following
+/// attempt is started once @c attempt_delay has passed or the previous
+/// attempt has failed, whatever happens first. Earlier attempts keep
+/// running, so a slow address doesn't cost a full connect timeout.
+/// * The first attempt to succeed wins. All other attempts are cancelled
+/// and the winning connection is moved into @c socket.
+///
+/// Each attempt uses its own socket, opened for the endpoint's protocol, so
+/// endpoints of any family can be used.
+///
+/// The attempts' intermediate handlers are serialized with a strand (which
+/// runs on the handler's associated executor, if supported), so the
+/// io_service may be run by multiple threads.
+///
+/// @param socket The socket to be connected.
+/// If the socket is already open, it will be closed once an attempt
+/// succeeds. Closing it before cancels the operation. This is noticed when
+/// the next attempt is due or a running attempt completes, whatever
+/// happens first.
+/// @param begin An iterator pointing to the start of a sequence of
+/// endpoints.
+/// @param end An iterator pointing to the end of a sequence of endpoints.
+/// @param attempt_delay The time to wait for an attempt before starting the
+/// next one.
+/// @param handler The handler to be called when the connect operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation. if the sequence is empty, set to
+///   // asio::error::not_found. Otherwise, contains the
+///   // error from the last connection attempt.
+///   const error_code& error,
+
+///   // On success, an iterator denoting the successfully
+///   // connected endpoint. Otherwise, the end iterator.
+///   Iterator iterator
+/// );
+/// @endcode
+template <typename Iterator, typename ComposedConnectHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ComposedConnectHandler, void(error_code, Iterator))
+async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+              Iterator begin, Iterator end,
+              const asio::steady_timer::duration& attempt_delay,
+              ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler);
+
 /// @}
 
 ASIOEXT_NS_END
@@ -0,0 +1,362 @@
+/// @file
+/// Defines the basic_connection_pool class template and related types.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_CONNECTIONPOOL_HPP
+#define ASIOEXT_CONNECTIONPOOL_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/async_result.hpp"
+#include "asioext/chrono.hpp"
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/ip/tcp.hpp>
+# include <boost/asio/steady_timer.hpp>
+#else
+# include <asio/io_service.hpp>
+# include <asio/ip/tcp.hpp>
+# include <asio/steady_timer.hpp>
+#endif
+
+#include <memory>
+#include <string>
+#include <tuple>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+template <typename Socket>
+class connection_pool_state;
+}
+
+/// @ingroup net
+/// @defgroup connection_pool asioext::basic_connection_pool
+/// @{
+
+/// @brief Identifies the connections a @ref basic_connection_pool can
+/// share.
+///
+/// Connections are only reused for requests with an equal key, i.e. the
+/// same remote host and port, reached through the same proxy with the same
+/// credentials.
+struct connection_key
+{
+  /// @brief Construct an empty key.
+  connection_key()
+    : port(0)
+  {
+    // ctor
+  }
+
+  /// @brief Construct a key for a direct connection to @c host.
+  connection_key(const std::string& host, uint16_t port)
+    : host(host)
+    , port(port)
+  {
+    // ctor
+  }
+
+  /// @brief Construct a key for a connection to @c host through a SOCKS 5
+  /// proxy.
+  ///
+  /// @c host is resolved by the proxy.
+  connection_key(const std::string& host, uint16_t port,
+                 const asio::ip::tcp::endpoint& proxy,
+                 const std::string& username = std::string(),
+                 const std::string& password = std::string())
+    : host(host)
+    , port(port)
+    , proxy(proxy)
+    , username(username)
+    , password(password)
+  {
+    // ctor
+  }
+
+  /// @brief Check whether connections are established through a proxy.
+  bool uses_proxy() const ASIOEXT_NOEXCEPT
+  {
+    return proxy.port() != 0;
+  }
+
+  /// The remote host (name or address).
+  std::string host;
+
+  /// The remote port.
+  uint16_t port;
+
+  /// The SOCKS 5 proxy to connect through. A default-constructed
+  /// endpoint connects directly.
+  asio::ip::tcp::endpoint proxy;
+
+  /// Username for the proxy. Leave empty for anonymous access.
+  std::string username;
+
+  /// Password for the proxy.
+  std::string password;
+};
+
+inline bool operator==(const connection_key& a, const connection_key& b)
+{
+  return std::tie(a.host, a.port, a.proxy, a.username, a.password) ==
+         std::tie(b.host, b.port, b.proxy, b.username, b.password);
+}
+
+inline bool operator<(const connection_key& a, const connection_key& b)
+{
+  return std::tie(a.host, a.port, a.proxy, a.username, a.password) <
+         std::tie(b.host, b.port, b.proxy, b.username, b.password);
+}
+
+/// @brief A connection leased from a @ref basic_connection_pool.
+///
+/// basic_pooled_connection receives an established connection from
+/// basic_connection_pool::async_acquire() and returns it to its pool on
+/// destruction (or when release() is called). It is movable, but not
+/// copyable.
+///
+/// Only connections that are still in a reusable state may be returned:
+/// if a request was aborted half-way, or the peer announced it will close
+/// the connection, call discard() instead.
+///
+/// @par Example
+/// @code
+/// asioext::pooled_connection conn(io_service);
+/// pool.async_acquire(asioext::connection_key("example.com", 80), conn,
+///                    [&] (asioext::error_code ec) {
+///   if (!ec)
+///     send_request(conn.socket());
+/// });
+/// @endcode
+template <typename Socket = asio::ip::tcp::socket>
+class basic_pooled_connection
+{
+public:
+  /// The type of the socket.
+  typedef Socket socket_type;
+
+  /// @brief Construct an empty connection.
+  ///
+  /// @param io_service The io_service the socket uses. It has to be the
+  /// pool's io_service.
+  explicit basic_pooled_connection(asio::io_service& io_service)
+    : socket_(io_service)
+    , reused_(false)
+  {
+    // ctor
+  }
+
+  /// @brief Take ownership of the connection leased by @c other.
+  ///
+  /// Must not be called while an acquire operation for @c other is
+  /// outstanding.
+  basic_pooled_connection(basic_pooled_connection&& other)
+    : pool_(std::move(other.pool_))
+    , key_(std::move(other.key_))
+    , socket_(std::move(other.socket_))
+    , reused_(other.reused_)
+  {
+    // ctor
+  }
+
+  /// @brief Return the connection (if any) to its pool.
+  ~basic_pooled_connection()
+  {
+    release();
+  }
+
+  /// @brief Get the connected socket.
+  socket_type& socket() ASIOEXT_NOEXCEPT
+  {
+    return socket_;
+  }
+
+  /// @brief Get the key this connection was acquired for.
+  const connection_key& key() const ASIOEXT_NOEXCEPT
+  {
+    return key_;
+  }
+
+  /// @brief Check whether the connection has been used before.
+  ///
+  /// Reused connections can be closed by the peer at any time (e.g. when
+  /// its idle timeout expires just as a request is sent). Requests that
+  /// are safe to repeat should be retried on a new connection if they
+  /// fail on a reused one.
+  bool reused() const ASIOEXT_NOEXCEPT
+  {
+    return reused_;
+  }
+
+  /// @brief Check whether this object doesn't lease a connection.
+  bool empty() const ASIOEXT_NOEXCEPT
+  {
+    return !pool_;
+  }
+
+  /// @brief Return the connection to its pool.
+  ///
+  /// If the socket has been closed, only its slot is returned.
+  /// After this function returns, the object is empty.
+  void release();
+
+  /// @brief Close the connection and return its slot to the pool.
+  ///
+  /// After this function returns, the object is empty.
+  void discard();
+
+private:
+  template <typename Socket2>
+  friend class detail::connection_pool_state;
+
+  basic_pooled_connection(const basic_pooled_connection&) ASIOEXT_DELETED;
+  basic_pooled_connection& operator=(
+      const basic_pooled_connection&) ASIOEXT_DELETED;
+
+  std::shared_ptr<detail::connection_pool_state<Socket>> pool_;
+  connection_key key_;
+  Socket socket_;
+  bool reused_;
+};
+
+/// @brief Keeps established connections alive for reuse.
+///
+/// basic_connection_pool hands out connections to remote hosts, identified
+/// by a @ref connection_key. A connection is established by resolving the
+/// host and connecting to it using asioext::async_connect(), or by
+/// connecting to a SOCKS 5 proxy and performing socks::async_handshake().
+/// Connections returned to the pool are kept for later requests with the
+/// same key, saving the resolve, connect and handshake round trips.
+///
+/// Idle connections are validated before being handed out:
+///
+/// * Connections that were idle for longer than the idle timeout are
+/// closed. Servers tend to close idle connections after some time,
+/// so the timeout should be a bit shorter than the servers'.
+/// * Connections that were closed by the peer or that received
+/// unsolicited data are closed.
+///
+/// The most recently returned connection is handed out first.
+///
+/// The number of connections per key (established, leased and pending) is
+/// limited. Requests that exceed the limit wait until a connection is
+/// returned.
+///
+/// If establishing a connection fails, the longest-waiting request fails
+/// with that error.
+///
+/// @par Thread Safety
+/// @e Distinct @e objects: Safe.@n
+/// @e Shared @e objects: Unsafe.@n
+/// The pool's (and its connections') functions and handlers need to be
+/// serialized, e.g. by running the io_service on a single thread.
+template <typename Socket = asio::ip::tcp::socket>
+class basic_connection_pool
+{
+public:
+  /// The type of the pooled sockets.
+  typedef Socket socket_type;
+
+  /// The type of the connection leases.
+  typedef basic_pooled_connection<Socket> connection_type;
+
+  /// @brief Construct an empty pool.
+  ///
+  /// @param io_service The io_service used for all connections.
+  /// @param max_connections_per_key The maximum number of connections
+  /// per @ref connection_key.
+  /// @param idle_timeout The time after which idle connections are
+  /// closed.
+  explicit basic_connection_pool(
+      asio::io_service& io_service,
+      std::size_t max_connections_per_key = 6,
+      const asio::steady_timer::duration& idle_timeout =
+          chrono::seconds(60));
+
+  /// @brief Close the pool.
+  ///
+  /// See close().
+  ~basic_connection_pool();
+
+  /// @brief Asynchronously acquire a connection.
+  ///
+  /// This function hands out an idle connection for @c key, or establishes
+  /// a new one.
+  ///
+  /// @param key The remote end to connect to.
+  /// @param connection Receives the connection. Connections it currently
+  /// leases are released first. Must remain valid until the handler is
+  /// called.
+  /// @param handler The handler to be called when the acquire operation
+  /// completes. The function signature of the handler must be:
+  /// @code
+  /// void handler(
+  ///   // Result of operation.
+  ///   const error_code& error
+  /// );
+  /// @endcode
+  template <typename AcquireHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(AcquireHandler, void(error_code))
+  async_acquire(const connection_key& key, connection_type& connection,
+                ASIOEXT_MOVE_ARG(AcquireHandler) handler);
+
+  /// @brief Establish connections in advance.
+  ///
+  /// Starts establishing connections for @c key until @c count connections
+  /// are idle or pending (limited by the maximum number of connections).
+  /// Failures are ignored.
+  void warm(const connection_key& key, std::size_t count);
+
+  /// @brief Get the number of idle connections for @c key.
+  std::size_t idle_count(const connection_key& key) const;
+
+  /// @brief Get the number of connections for @c key.
+  ///
+  /// This includes idle, leased and pending connections.
+  std::size_t connection_count(const connection_key& key) const;
+
+  /// @brief Close all idle connections.
+  void clear();
+
+  /// @brief Close the pool.
+  ///
+  /// Closes all idle connections and cancels pending ones. Outstanding
+  /// acquire operations fail with @c asio::error::operation_aborted.
+  /// Connections that are still leased are closed once released.
+  void close();
+
+private:
+  basic_connection_pool(const basic_connection_pool&) ASIOEXT_DELETED;
+  basic_connection_pool& operator=(
+      const basic_connection_pool&) ASIOEXT_DELETED;
+
+  std::shared_ptr<detail::connection_pool_state<Socket>> state_;
+};
+
+/// @brief A pooled TCP connection.
+typedef basic_pooled_connection<> pooled_connection;
+
+/// @brief A pool of TCP connections.
+typedef basic_connection_pool<> connection_pool;
+
+/// @}
+
+ASIOEXT_NS_END
+
+#include "asioext/impl/connection_pool.hpp"
+
+#endif
@@ -0,0 +1,66 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_ALIGNEDMEMORY_HPP
+#define ASIOEXT_DETAIL_ALIGNEDMEMORY_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include <cstddef> // for size_t
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+namespace aligned_memory {
+
+// All allocation functions return nullptr on failure.
+
+// Allocate |size| bytes from the heap, aligned to |alignment| (a power of
+// two).
+ASIOEXT_DECL void* allocate(std::size_t size,
+                            std::size_t alignment) ASIOEXT_NOEXCEPT;
+
+// Free memory returned by allocate().
+ASIOEXT_DECL void deallocate(void* p) ASIOEXT_NOEXCEPT;
+
+// The size of a regular page.
+ASIOEXT_DECL std::size_t page_size() ASIOEXT_NOEXCEPT;
+
+// The size of a huge (large) page, or 0 if the system doesn't have them.
+ASIOEXT_DECL std::size_t huge_page_size() ASIOEXT_NOEXCEPT;
+
+// Map |size| bytes of zero-initialized anonymous memory. The size is
+// rounded up to a multiple of page_size().
+ASIOEXT_DECL void* map_pages(std::size_t size) ASIOEXT_NOEXCEPT;
+
+// Release a region returned by map_pages(). |size| has to be the value
+// passed to map_pages().
+ASIOEXT_DECL void unmap_pages(void* p, std::size_t size) ASIOEXT_NOEXCEPT;
+
+// Like map_pages(), but try to back the region with huge pages. Falls back
+// to (transparent huge page eligible) regular pages if no huge pages are
+// available. Regions smaller than huge_page_size() always use regular
+// pages. On POSIX systems, all others are aligned to huge_page_size(), so
+// transparent huge pages can back them completely.
+ASIOEXT_DECL void* map_huge_pages(std::size_t size) ASIOEXT_NOEXCEPT;
+
+// Release a region returned by map_huge_pages(). |size| has to be the value
+// passed to map_huge_pages().
+ASIOEXT_DECL void unmap_huge_pages(void* p, std::size_t size) ASIOEXT_NOEXCEPT;
+
+}
+}
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/detail/impl/aligned_memory.cpp"
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_BUFFERPAIR_HPP
+#define ASIOEXT_DETAIL_BUFFERPAIR_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/buffer.hpp>
+#else
+# include <asio/buffer.hpp>
+#endif
+
+#include <cstddef> // for size_t
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// A buffer sequence consisting of at most two buffers, e.g. the two
+// segments of a wrapped-around ring buffer.
+//
+// Models the MutableBufferSequence / ConstBufferSequence requirements
+// (depending on |Buffer|). A pair of mutable buffers converts to a pair
+// of const buffers.
+template <typename Buffer>
+class buffer_pair
+{
+public:
+  typedef Buffer value_type;
+  typedef const Buffer* const_iterator;
+
+  buffer_pair() ASIOEXT_NOEXCEPT
+    : count_(0)
+  {
+    // ctor
+  }
+
+  // Construct a sequence of |first| and |second|.
+  // Empty buffers are left out.
+  buffer_pair(const Buffer& first, const Buffer& second) ASIOEXT_NOEXCEPT
+    : count_(0)
+  {
+    if (asio::buffer_size(first) != 0)
+      buffers_[count_++] = first;
+    if (asio::buffer_size(second) != 0)
+      buffers_[count_++] = second;
+  }
+
+  template <typename OtherBuffer>
+  buffer_pair(const buffer_pair<OtherBuffer>& other) ASIOEXT_NOEXCEPT
+    : count_(0)
+  {
+    for (typename buffer_pair<OtherBuffer>::const_iterator it = other.begin(),
+         end = other.end(); it != end; ++it)
+      buffers_[count_++] = *it;
+  }
+
+  const_iterator begin() const ASIOEXT_NOEXCEPT
+  {
+    return buffers_;
+  }
+
+  const_iterator end() const ASIOEXT_NOEXCEPT
+  {
+    return buffers_ + count_;
+  }
+
+private:
+  Buffer buffers_[2];
+  std::size_t count_;
+};
+
+}
+
+ASIOEXT_NS_END
+
+#endif
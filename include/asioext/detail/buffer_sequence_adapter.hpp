@@ -11,18 +11,195 @@
 # pragma once
 #endif
 
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/asio_version.hpp"
+
 #if defined(ASIOEXT_USE_BOOST_ASIO)
-# include <boost/asio/detail/buffer_sequence_adapter.hpp>
+# include <boost/asio/buffer.hpp>
+#else
+# include <asio/buffer.hpp>
+#endif
+
+#include <cstddef> // for size_t
+#include <climits> // for IOV_MAX
+#include <type_traits> // for is_convertible
+
+#if !defined(ASIOEXT_WINDOWS)
+# include <sys/uio.h> // for iovec
+#endif
+
+#if (ASIOEXT_ASIO_VERSION >= 101100)
+# include <utility> // for declval
+#endif
+
+// Upper limit for the number of buffers passed to a single vectored
+// I/O call. Longer buffer sequences are processed in multiple chunks.
+// The iovecs live on the stack, so this is kept small (like Asio's 64).
+#if defined(IOV_MAX) && (IOV_MAX < 64)
+# define ASIOEXT_DETAIL_MAX_IOV_BUFFERS IOV_MAX
+#elif defined(IOV_MAX) || defined(UIO_MAXIOV)
+# define ASIOEXT_DETAIL_MAX_IOV_BUFFERS 64
 #else
-# include <asio/detail/buffer_sequence_adapter.hpp>
+// The minimum value POSIX guarantees (_XOPEN_IOV_MAX).
+# define ASIOEXT_DETAIL_MAX_IOV_BUFFERS 16
 #endif
 
 ASIOEXT_NS_BEGIN
 
 namespace detail {
 
-// TODO(tim): We shouldn't depend on asio's internals.
-using asio::detail::buffer_sequence_adapter;
+#if (ASIOEXT_ASIO_VERSION >= 101100)
+template <typename Buffers>
+struct buffer_sequence_range
+{
+  typedef decltype(asio::buffer_sequence_begin(
+      std::declval<const Buffers&>())) iterator;
+
+  static iterator begin(const Buffers& b) ASIOEXT_NOEXCEPT
+  { return asio::buffer_sequence_begin(b); }
+
+  static iterator end(const Buffers& b) ASIOEXT_NOEXCEPT
+  { return asio::buffer_sequence_end(b); }
+};
+#else
+template <typename Buffers>
+struct buffer_sequence_range
+{
+  typedef typename Buffers::const_iterator iterator;
+
+  static iterator begin(const Buffers& b) ASIOEXT_NOEXCEPT
+  { return b.begin(); }
+
+  static iterator end(const Buffers& b) ASIOEXT_NOEXCEPT
+  { return b.end(); }
+};
+#endif
+
+#if !defined(ASIOEXT_WINDOWS)
+inline void* buffer_address(const asio::mutable_buffer& b) ASIOEXT_NOEXCEPT
+{
+  return asio::buffer_cast<void*>(b);
+}
+
+inline void* buffer_address(const asio::const_buffer& b) ASIOEXT_NOEXCEPT
+{
+  return const_cast<void*>(asio::buffer_cast<const void*>(b));
+}
+
+// Converts a buffer sequence of arbitrary length into iovec arrays.
+//
+// Unlike asio::detail::buffer_sequence_adapter, which silently drops
+// everything after its 64th buffer, this adapter hands out the sequence in
+// chunks of up to ASIOEXT_DETAIL_MAX_IOV_BUFFERS entries. The iovecs are
+// kept on the stack, so no allocation takes place regardless of the
+// sequence's length. Single buffers only get a single iovec. Empty buffers
+// are skipped.
+//
+// Usage:
+//   buffer_sequence_adapter<asio::const_buffer, Buffers> bufs(buffers);
+//   do {
+//     writev(fd, bufs.buffers(), bufs.count());
+//   } while (bufs.next());
+template <typename Buffer, typename Buffers>
+class buffer_sequence_adapter
+{
+  typedef buffer_sequence_range<Buffers> range;
+
+public:
+  enum
+  {
+    max_buffers = std::is_convertible<Buffers, Buffer>::value ?
+        1 : ASIOEXT_DETAIL_MAX_IOV_BUFFERS
+  };
+
+  explicit buffer_sequence_adapter(const Buffers& buffers) ASIOEXT_NOEXCEPT
+    : next_(range::begin(buffers))
+    , end_(range::end(buffers))
+  {
+    fill();
+  }
+
+  // The current chunk.
+  iovec* buffers() ASIOEXT_NOEXCEPT
+  {
+    return buffers_;
+  }
+
+  // Number of iovecs in the current chunk.
+  int count() const ASIOEXT_NOEXCEPT
+  {
+    return count_;
+  }
+
+  // Number of bytes in the current chunk.
+  std::size_t total_size() const ASIOEXT_NOEXCEPT
+  {
+    return total_size_;
+  }
+
+  // Advance to the next chunk. Returns false if the sequence is exhausted.
+  bool next() ASIOEXT_NOEXCEPT
+  {
+    if (next_ == end_)
+      return false;
+
+    fill();
+    return count_ != 0;
+  }
+
+private:
+  void fill() ASIOEXT_NOEXCEPT
+  {
+    count_ = 0;
+    total_size_ = 0;
+    for (; next_ != end_ && count_ != max_buffers; ++next_) {
+      const Buffer b(*next_);
+      const std::size_t size = asio::buffer_size(b);
+      if (size == 0)
+        continue;
+
+      buffers_[count_].iov_base = buffer_address(b);
+      buffers_[count_].iov_len = size;
+      total_size_ += size;
+      ++count_;
+    }
+  }
+
+  typename range::iterator next_;
+  typename range::iterator end_;
+  iovec buffers_[max_buffers];
+  int count_;
+  std::size_t total_size_;
+};
+
+// Perform a positional vectored I/O operation on all chunks of |bufs|.
+//
+// |op| is called with (iovec*, count, bytes transferred so far, ec).
+// The next chunk is only started if the previous one was transferred
+// completely. Errors that occur after some data was transferred are not
+// reported; they will resurface on the next call.
+//
+// Only for *_at() operations: on pipes, ttys or sockets, the next call
+// could block although data was transferred already. Stream operations
+// transfer the first chunk only, as Asio's do.
+template <typename Adapter, typename Operation>
+std::size_t chunked_vector_io(Adapter& bufs, Operation op,
+                              error_code& ec) ASIOEXT_NOEXCEPT
+{
+  std::size_t total = 0;
+  while (true) {
+    const std::size_t n = op(bufs.buffers(), bufs.count(), total, ec);
+    total += n;
+    if (ec || n != bufs.total_size() || !bufs.next())
+      break;
+  }
+
+  if (ec && total != 0)
+    ec = error_code();
+  return total;
+}
+#endif
 
 }
 
@@ -0,0 +1,56 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_BYTESEARCH_HPP
+#define ASIOEXT_DETAIL_BYTESEARCH_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/detail/cstdint.hpp"
+
+#include <cstddef> // for size_t
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+namespace byte_search {
+
+// Vectorized searches over [first, last). All of them return |last| if
+// nothing was found.
+//
+// The implementation is selected once at runtime: AVX2 (32 bytes per
+// comparison) if the CPU supports it, SSE2 (16 bytes) on all other x86
+// CPUs and portable code everywhere else.
+
+// Find the first occurrence of |value|.
+ASIOEXT_DECL const uint8_t* find(const uint8_t* first, const uint8_t* last,
+                                 uint8_t value) ASIOEXT_NOEXCEPT;
+
+// Find the first byte that is contained in [set, set + set_size).
+ASIOEXT_DECL const uint8_t* find_any(const uint8_t* first,
+                                     const uint8_t* last,
+                                     const uint8_t* set,
+                                     std::size_t set_size) ASIOEXT_NOEXCEPT;
+
+// Find the first occurrence of [needle, needle + needle_size).
+// An empty needle is found at |first|.
+ASIOEXT_DECL const uint8_t* search(const uint8_t* first, const uint8_t* last,
+                                   const uint8_t* needle,
+                                   std::size_t needle_size) ASIOEXT_NOEXCEPT;
+
+}
+}
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/detail/impl/byte_search.cpp"
+#endif
+
+#endif
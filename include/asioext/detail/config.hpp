@@ -340,6 +340,19 @@
 # endif
 #endif
 
+// ASIOEXT_HAS_CO_AWAIT: Support for C++20 coroutines (co_await).
+#if !defined(ASIOEXT_HAS_CO_AWAIT)
+# if !defined(ASIOEXT_DISABLE_CO_AWAIT)
+#  if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902)
+#   if defined(__has_include)
+#    if __has_include(<coroutine>)
+#     define ASIOEXT_HAS_CO_AWAIT 1
+#    endif
+#   endif
+#  endif
+# endif
+#endif
+
 // ASIOEXT_WINDOWS_APP: Windows App target. Windows but with a limited API.
 #if !defined(ASIOEXT_WINDOWS_APP)
 # if defined(_WIN32_WINNT) && (_WIN32_WINNT >= 0x0603)
@@ -380,6 +393,16 @@
 # endif
 #endif
 
+// ASIOEXT_HAS_DIRECTORY_HANDLE: Support for reading directories in batches
+// (getdents64()).
+#if !defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+# if !defined(ASIOEXT_DISABLE_DIRECTORY_HANDLE)
+#  if defined(__linux__)
+#   define ASIOEXT_HAS_DIRECTORY_HANDLE 1
+#  endif
+# endif
+#endif
+
 #if !defined(ASIOEXT_HAS_BOOST_FILESYSTEM)
 # if !defined(ASIOEXT_DISABLE_BOOST_FILESYSTEM)
 #  if (BOOST_VERSION >= 104600)
@@ -0,0 +1,502 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_CONNECTIONPOOL_HPP
+#define ASIOEXT_DETAIL_CONNECTIONPOOL_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/connect.hpp"
+#include "asioext/bind_handler.hpp"
+#include "asioext/socks/client.hpp"
+
+#include "asioext/detail/handler_work.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/error.hpp>
+#else
+# include <asio/error.hpp>
+#endif
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// An acquire operation waiting for a connection.
+template <typename Socket>
+class connection_pool_waiter
+{
+public:
+  connection_pool_waiter(basic_pooled_connection<Socket>& connection,
+                         erased_handler_ptr<void (error_code)> handler)
+    : connection_(&connection)
+    , handler_(std::move(handler))
+  {
+    // ctor
+  }
+
+  basic_pooled_connection<Socket>& connection() ASIOEXT_NOEXCEPT
+  {
+    return *connection_;
+  }
+
+  // Post the handler.
+  void complete(const error_code& ec)
+  {
+    handler_.release()->post(ec);
+  }
+
+private:
+  basic_pooled_connection<Socket>* connection_;
+  erased_handler_ptr<void (error_code)> handler_;
+};
+
+// Check whether an idle connection can still be used, i.e. the peer
+// neither closed it nor sent anything we didn't ask for.
+template <typename Socket>
+bool is_connection_usable(Socket& socket)
+{
+  error_code ec;
+  const bool non_blocking = socket.non_blocking();
+  socket.non_blocking(true, ec);
+  if (ec)
+    return false;
+
+  uint8_t c;
+  socket.receive(asio::buffer(&c, 1), asio::socket_base::message_peek, ec);
+  const bool usable = ec == asio::error::would_block;
+
+  socket.non_blocking(non_blocking, ec);
+  return usable && !ec;
+}
+
+template <typename Socket>
+class connection_pool_connector;
+
+template <typename Socket>
+class connection_pool_state
+  : public std::enable_shared_from_this<connection_pool_state<Socket>>
+{
+public:
+  typedef asio::steady_timer::clock_type clock_type;
+  typedef connection_pool_waiter<Socket> waiter;
+
+  connection_pool_state(asio::io_service& io_service,
+                        std::size_t max_connections_per_key,
+                        const asio::steady_timer::duration& idle_timeout)
+    : io_service_(io_service)
+    , max_connections_per_key_(max_connections_per_key)
+    , idle_timeout_(idle_timeout)
+    , closed_(false)
+  {
+    // ctor
+  }
+
+  asio::io_service& get_io_service() ASIOEXT_NOEXCEPT
+  {
+    return io_service_;
+  }
+
+  void acquire(const connection_key& key, waiter w);
+  void release(basic_pooled_connection<Socket>& connection, bool reusable);
+  void warm(const connection_key& key, std::size_t count);
+  std::size_t idle_count(const connection_key& key) const;
+  std::size_t connection_count(const connection_key& key) const;
+  void clear();
+  void close();
+
+  void on_connected(connection_pool_connector<Socket>* connector,
+                    const connection_key& key, Socket& socket,
+                    const error_code& ec);
+
+private:
+  struct idle_connection
+  {
+    idle_connection(Socket&& socket, clock_type::time_point since)
+      : socket(std::move(socket))
+      , since(since)
+    {
+      // ctor
+    }
+
+    Socket socket;
+    clock_type::time_point since;
+  };
+
+  struct entry
+  {
+    entry()
+      : count(0)
+      , connecting(0)
+    {
+      // ctor
+    }
+
+    std::deque<idle_connection> idle;
+    std::deque<waiter> waiters;
+
+    // Idle, leased and pending connections.
+    std::size_t count;
+    std::size_t connecting;
+  };
+
+  typedef std::map<connection_key, entry> entry_map;
+
+  void prune(entry& e);
+  void connect(const connection_key& key, entry& e);
+  void connect_waiters(const connection_key& key, entry& e);
+  void hand_over(const connection_key& key, entry& e, Socket& socket,
+                 bool reused);
+  void hand_over(const connection_key& key, waiter& w, Socket& socket,
+                 bool reused);
+  void erase_if_unused(typename entry_map::iterator it);
+
+  asio::io_service& io_service_;
+  const std::size_t max_connections_per_key_;
+  const asio::steady_timer::duration idle_timeout_;
+  entry_map entries_;
+  std::set<connection_pool_connector<Socket>*> connectors_;
+  bool closed_;
+};
+
+// Establishes a single connection.
+template <typename Socket>
+class connection_pool_connector
+  : public std::enable_shared_from_this<connection_pool_connector<Socket>>
+{
+public:
+  connection_pool_connector(
+      const std::shared_ptr<connection_pool_state<Socket>>& state,
+      const connection_key& key)
+    : state_(state)
+    , key_(key)
+    , socket_(state->get_io_service())
+    , resolver_(state->get_io_service())
+  {
+    // ctor
+  }
+
+  void start();
+  void cancel();
+
+private:
+  void on_connect(const error_code& ec);
+  void finish(const error_code& ec);
+
+  std::shared_ptr<connection_pool_state<Socket>> state_;
+  connection_key key_;
+  Socket socket_;
+  asio::ip::tcp::resolver resolver_;
+  std::vector<asio::ip::tcp::endpoint> proxy_;
+  uint8_t storage_[socks::max_handshake_size];
+};
+
+template <typename Socket>
+void connection_pool_connector<Socket>::start()
+{
+  const std::shared_ptr<connection_pool_connector> self =
+      this->shared_from_this();
+
+  if (key_.uses_proxy()) {
+    proxy_.assign(1, key_.proxy);
+    asioext::async_connect(
+        socket_.lowest_layer(), proxy_.begin(), proxy_.end(),
+        chrono::milliseconds(default_connection_attempt_delay_ms),
+        [self] (error_code ec,
+                std::vector<asio::ip::tcp::endpoint>::iterator) {
+      self->on_connect(ec);
+    });
+    return;
+  }
+
+  const asio::ip::tcp::resolver::query q(
+      key_.host, std::to_string(key_.port),
+      asio::ip::tcp::resolver::query::numeric_service);
+  asioext::async_connect(
+      socket_.lowest_layer(), resolver_, q,
+      [self] (error_code ec, asio::ip::tcp::resolver::iterator) {
+    self->on_connect(ec);
+  });
+}
+
+template <typename Socket>
+void connection_pool_connector<Socket>::cancel()
+{
+  error_code ec;
+  resolver_.cancel();
+  socket_.lowest_layer().close(ec);
+}
+
+template <typename Socket>
+void connection_pool_connector<Socket>::on_connect(const error_code& ec)
+{
+  if (ec || !key_.uses_proxy()) {
+    finish(ec);
+    return;
+  }
+
+  const std::shared_ptr<connection_pool_connector> self =
+      this->shared_from_this();
+  socks::async_handshake(socket_, key_.username, key_.password,
+                         key_.host, key_.port,
+                         asio::buffer(storage_, sizeof(storage_)),
+                         [self] (error_code ec) {
+    self->finish(ec);
+  });
+}
+
+template <typename Socket>
+void connection_pool_connector<Socket>::finish(const error_code& ec)
+{
+  state_->on_connected(this, key_, socket_, ec);
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::acquire(const connection_key& key,
+                                            waiter w)
+{
+  if (closed_) {
+    w.complete(asio::error::operation_aborted);
+    return;
+  }
+
+  entry& e = entries_[key];
+  prune(e);
+
+  while (!e.idle.empty()) {
+    Socket socket(std::move(e.idle.back().socket));
+    e.idle.pop_back();
+
+    if (is_connection_usable(socket)) {
+      hand_over(key, w, socket, true);
+      return;
+    }
+
+    error_code ec;
+    socket.close(ec);
+    --e.count;
+  }
+
+  e.waiters.push_back(std::move(w));
+  connect_waiters(key, e);
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::release(
+    basic_pooled_connection<Socket>& connection, bool reusable)
+{
+  error_code ec;
+  if (closed_) {
+    connection.socket_.close(ec);
+    return;
+  }
+
+  const typename entry_map::iterator it = entries_.find(connection.key_);
+  entry& e = it->second;
+
+  if (reusable && connection.socket_.is_open()) {
+    if (!e.waiters.empty()) {
+      hand_over(connection.key_, e, connection.socket_, true);
+    } else {
+      e.idle.push_back(idle_connection(std::move(connection.socket_),
+                                       clock_type::now()));
+    }
+    return;
+  }
+
+  connection.socket_.close(ec);
+  --e.count;
+  connect_waiters(connection.key_, e);
+  erase_if_unused(it);
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::warm(const connection_key& key,
+                                         std::size_t count)
+{
+  if (closed_)
+    return;
+
+  entry& e = entries_[key];
+  prune(e);
+
+  while (e.idle.size() + e.connecting < count &&
+         e.count < max_connections_per_key_)
+    connect(key, e);
+}
+
+template <typename Socket>
+std::size_t connection_pool_state<Socket>::idle_count(
+    const connection_key& key) const
+{
+  const typename entry_map::const_iterator it = entries_.find(key);
+  return it != entries_.end() ? it->second.idle.size() : 0;
+}
+
+template <typename Socket>
+std::size_t connection_pool_state<Socket>::connection_count(
+    const connection_key& key) const
+{
+  const typename entry_map::const_iterator it = entries_.find(key);
+  return it != entries_.end() ? it->second.count : 0;
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::clear()
+{
+  error_code ec;
+  for (typename entry_map::iterator it = entries_.begin();
+       it != entries_.end(); ) {
+    entry& e = it->second;
+    for (std::size_t i = 0; i != e.idle.size(); ++i)
+      e.idle[i].socket.close(ec);
+
+    e.count -= e.idle.size();
+    e.idle.clear();
+    erase_if_unused(it++);
+  }
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::close()
+{
+  if (closed_)
+    return;
+
+  clear();
+  closed_ = true;
+
+  // Connectors remove themselves once their handlers ran.
+  const std::set<connection_pool_connector<Socket>*> connectors(
+      connectors_);
+  for (typename std::set<connection_pool_connector<Socket>*>::const_iterator
+       it = connectors.begin(); it != connectors.end(); ++it)
+    (*it)->cancel();
+
+  for (typename entry_map::iterator it = entries_.begin();
+       it != entries_.end(); ++it) {
+    std::deque<waiter>& waiters = it->second.waiters;
+    while (!waiters.empty()) {
+      waiters.front().complete(asio::error::operation_aborted);
+      waiters.pop_front();
+    }
+  }
+  entries_.clear();
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::on_connected(
+    connection_pool_connector<Socket>* connector,
+    const connection_key& key, Socket& socket, const error_code& ec)
+{
+  connectors_.erase(connector);
+  if (closed_)
+    return;
+
+  const typename entry_map::iterator it = entries_.find(key);
+  entry& e = it->second;
+  --e.connecting;
+
+  if (!ec) {
+    if (!e.waiters.empty())
+      hand_over(key, e, socket, false);
+    else
+      e.idle.push_back(idle_connection(std::move(socket), clock_type::now()));
+    return;
+  }
+
+  --e.count;
+  if (!e.waiters.empty()) {
+    e.waiters.front().complete(ec);
+    e.waiters.pop_front();
+  }
+  connect_waiters(key, e);
+  erase_if_unused(it);
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::prune(entry& e)
+{
+  const clock_type::time_point now = clock_type::now();
+
+  error_code ec;
+  while (!e.idle.empty() && now - e.idle.front().since >= idle_timeout_) {
+    e.idle.front().socket.close(ec);
+    e.idle.pop_front();
+    --e.count;
+  }
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::connect(const connection_key& key,
+                                            entry& e)
+{
+  ++e.count;
+  ++e.connecting;
+
+  const std::shared_ptr<connection_pool_connector<Socket>> connector =
+      std::make_shared<connection_pool_connector<Socket>>(
+          this->shared_from_this(), key);
+  connectors_.insert(connector.get());
+  connector->start();
+}
+
+// Start connecting for the waiters that won't be served by pending
+// connections.
+template <typename Socket>
+void connection_pool_state<Socket>::connect_waiters(const connection_key& key,
+                                                    entry& e)
+{
+  while (e.connecting < e.waiters.size() &&
+         e.count < max_connections_per_key_)
+    connect(key, e);
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::hand_over(const connection_key& key,
+                                              entry& e, Socket& socket,
+                                              bool reused)
+{
+  waiter w(std::move(e.waiters.front()));
+  e.waiters.pop_front();
+  hand_over(key, w, socket, reused);
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::hand_over(const connection_key& key,
+                                              waiter& w, Socket& socket,
+                                              bool reused)
+{
+  basic_pooled_connection<Socket>& connection = w.connection();
+  connection.pool_ = this->shared_from_this();
+  connection.key_ = key;
+  connection.socket_ = std::move(socket);
+  connection.reused_ = reused;
+  w.complete(error_code());
+}
+
+template <typename Socket>
+void connection_pool_state<Socket>::erase_if_unused(
+    typename entry_map::iterator it)
+{
+  if (it->second.count == 0 && it->second.waiters.empty())
+    entries_.erase(it);
+}
+
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,199 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_CONSUMINGBUFFERS_HPP
+#define ASIOEXT_DETAIL_CONSUMINGBUFFERS_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/buffer_sequence_adapter.hpp"
+#include "asioext/detail/cstdint.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/buffer.hpp>
+# include <boost/asio/error.hpp>
+#else
+# include <asio/buffer.hpp>
+# include <asio/error.hpp>
+#endif
+
+#include <cstddef> // for size_t, ptrdiff_t
+#include <iterator>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// A view of the not yet transferred part of a buffer sequence.
+//
+// Unlike asio::detail::consuming_buffers, the view isn't limited to
+// a fixed number of buffers, so it can be handed to vectored I/O functions
+// as a whole. It models the MutableBufferSequence / ConstBufferSequence
+// requirements (depending on |Buffer|).
+template <typename Buffer, typename Buffers>
+class consuming_buffers
+{
+  typedef buffer_sequence_range<Buffers> range;
+  typedef typename range::iterator base_iterator;
+
+public:
+  typedef Buffer value_type;
+
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Buffer value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Buffer* pointer;
+    typedef Buffer reference;
+
+    const_iterator(base_iterator it, std::size_t offset)
+      : it_(it)
+      , offset_(offset)
+    {
+      // ctor
+    }
+
+    Buffer operator*() const
+    {
+      return Buffer(*it_) + offset_;
+    }
+
+    const_iterator& operator++()
+    {
+      ++it_;
+      offset_ = 0;
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(const const_iterator& a, const const_iterator& b)
+    {
+      return a.it_ == b.it_ && a.offset_ == b.offset_;
+    }
+
+    friend bool operator!=(const const_iterator& a, const const_iterator& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    base_iterator it_;
+    std::size_t offset_;
+  };
+
+  explicit consuming_buffers(const Buffers& buffers)
+    : begin_(range::begin(buffers))
+    , end_(range::end(buffers))
+    , offset_(0)
+    , size_(asio::buffer_size(buffers))
+    , consumed_(0)
+  {
+    // ctor
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(begin_, offset_);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(end_, 0);
+  }
+
+  // Check whether all bytes of the sequence were consumed.
+  bool empty() const
+  {
+    return consumed_ == size_;
+  }
+
+  std::size_t total_consumed() const
+  {
+    return consumed_;
+  }
+
+  void consume(std::size_t n)
+  {
+    consumed_ += n;
+    while (n != 0 && begin_ != end_) {
+      const std::size_t size = asio::buffer_size(Buffer(*begin_)) - offset_;
+      if (n < size) {
+        offset_ += n;
+        return;
+      }
+
+      n -= size;
+      offset_ = 0;
+      ++begin_;
+    }
+  }
+
+private:
+  base_iterator begin_;
+  base_iterator end_;
+  std::size_t offset_;
+  std::size_t size_;
+  std::size_t consumed_;
+};
+
+// The error reported for a transfer of zero bytes that didn't fail:
+// There's nothing left to read, or no space left to write to.
+inline error_code zero_transfer_error(const asio::mutable_buffer*)
+{
+  return asio::error::eof;
+}
+
+inline error_code zero_transfer_error(const asio::const_buffer*)
+{
+  return make_error_code(errc::no_space_on_device);
+}
+
+// Repeatedly call |op| until all of |buffers| were transferred or an error
+// occurred.
+//
+// |op| is called with (offset, const consuming_buffers<>&, ec) and returns
+// the number of bytes it transferred.
+template <typename Buffer, typename Buffers, typename Operation>
+std::size_t transfer_all_at(uint64_t offset, const Buffers& buffers,
+                            Operation& op, error_code& ec)
+{
+  consuming_buffers<Buffer, Buffers> bufs(buffers);
+  ec = error_code();
+  while (!bufs.empty()) {
+    const std::size_t n = op(offset + bufs.total_consumed(), bufs, ec);
+    bufs.consume(n);
+    if (ec)
+      break;
+
+    // A transfer of zero bytes without an error (e.g. a full disk on some
+    // platforms) would make us loop forever. Don't report success for
+    // the partial transfer either.
+    if (n == 0) {
+      ec = zero_transfer_error(static_cast<const Buffer*>(0));
+      break;
+    }
+  }
+  return bufs.total_consumed();
+}
+
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,154 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_FILEIOTRACE_HPP
+#define ASIOEXT_DETAIL_FILEIOTRACE_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/file_io_observer.hpp"
+#include "asioext/error_code.hpp"
+#include "asioext/chrono.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+
+#include <cstddef> // for size_t
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// Scope guard used by the platform file ops to report a single operation to
+// the installed file_io_observer. The result is reported on destruction,
+// using the (by then final) value of the referenced error_code.
+//
+// Without ASIOEXT_ENABLE_FILE_IO_OBSERVER all members are empty and the
+// object is optimized away entirely.
+#if defined(ASIOEXT_ENABLE_FILE_IO_OBSERVER)
+class file_io_trace
+{
+public:
+  file_io_trace(file_io_operation op,
+                file_io_event::native_handle_type handle,
+                uint64_t offset, std::size_t size,
+                const error_code& ec) ASIOEXT_NOEXCEPT
+    : observer_(get_file_io_observer())
+    , ec_(ec)
+  {
+    if (observer_)
+      start(op, handle, offset, size, 1);
+  }
+
+  template <typename Buffer>
+  file_io_trace(file_io_operation op,
+                file_io_event::native_handle_type handle,
+                uint64_t offset, const Buffer* bufs, int count,
+                const error_code& ec) ASIOEXT_NOEXCEPT
+    : observer_(get_file_io_observer())
+    , ec_(ec)
+  {
+    if (observer_) {
+      std::size_t size = 0;
+      for (int i = 0; i != count; ++i)
+        size += bufs[i].iov_len;
+      start(op, handle, offset, size, static_cast<std::size_t>(count));
+    }
+  }
+
+  ~file_io_trace()
+  {
+    if (observer_) {
+      event_.duration = chrono::duration_cast<chrono::nanoseconds>(
+          chrono::steady_clock::now() - start_);
+      event_.ec = ec_;
+      observer_->on_file_io(event_);
+    }
+  }
+
+  void path(const char* p) ASIOEXT_NOEXCEPT
+  {
+    event_.path = p;
+  }
+
+  file_io_event::native_handle_type opened(
+      file_io_event::native_handle_type handle) ASIOEXT_NOEXCEPT
+  {
+    event_.handle = handle;
+    return handle;
+  }
+
+  template <typename Size>
+  Size transferred(Size n) ASIOEXT_NOEXCEPT
+  {
+    event_.transferred = static_cast<std::size_t>(n);
+    return n;
+  }
+
+private:
+  file_io_trace(const file_io_trace&) ASIOEXT_DELETED;
+  file_io_trace& operator=(const file_io_trace&) ASIOEXT_DELETED;
+
+  void start(file_io_operation op, file_io_event::native_handle_type handle,
+             uint64_t offset, std::size_t size,
+             std::size_t count) ASIOEXT_NOEXCEPT
+  {
+    event_.operation = op;
+    event_.handle = handle;
+    event_.path = 0;
+    event_.offset = offset;
+    event_.size = size;
+    event_.buffer_count = count;
+    event_.transferred = 0;
+    start_ = chrono::steady_clock::now();
+  }
+
+  file_io_observer* observer_;
+  const error_code& ec_;
+  chrono::steady_clock::time_point start_;
+  file_io_event event_;
+};
+#else
+class file_io_trace
+{
+public:
+  file_io_trace(file_io_operation, file_io_event::native_handle_type,
+                uint64_t, std::size_t, const error_code&) ASIOEXT_NOEXCEPT
+  {
+  }
+
+  template <typename Buffer>
+  file_io_trace(file_io_operation, file_io_event::native_handle_type,
+                uint64_t, const Buffer*, int,
+                const error_code&) ASIOEXT_NOEXCEPT
+  {
+  }
+
+  void path(const char*) ASIOEXT_NOEXCEPT
+  {
+  }
+
+  file_io_event::native_handle_type opened(
+      file_io_event::native_handle_type handle) ASIOEXT_NOEXCEPT
+  {
+    return handle;
+  }
+
+  template <typename Size>
+  Size transferred(Size n) ASIOEXT_NOEXCEPT
+  {
+    return n;
+  }
+};
+#endif
+
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,36 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_FRAMEALLOCATOR_HPP
+#define ASIOEXT_DETAIL_FRAMEALLOCATOR_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include <cstddef> // for size_t
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// Allocator for coroutine frames. Freed frames are kept in a small
+// per-thread cache and handed out again for frames of the same or a
+// smaller size, so coroutines that are started over and over again
+// (e.g. one per request) don't touch the heap once the cache is warm.
+ASIOEXT_DECL void* frame_allocate(std::size_t size);
+ASIOEXT_DECL void frame_deallocate(void* p) ASIOEXT_NOEXCEPT;
+
+}
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/detail/impl/frame_allocator.cpp"
+#endif
+
+#endif
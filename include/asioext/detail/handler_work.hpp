@@ -0,0 +1,246 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_HANDLERWORK_HPP
+#define ASIOEXT_DETAIL_HANDLERWORK_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/bind_handler.hpp"
+#include "asioext/composed_operation.hpp"
+
+#include "asioext/detail/asio_version.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# if ASIOEXT_ASIO_VERSION >= 101200
+#  include <boost/asio/associated_allocator.hpp>
+#  include <boost/asio/associated_executor.hpp>
+#  include <boost/asio/dispatch.hpp>
+#  include <boost/asio/executor_work_guard.hpp>
+#  include <boost/asio/post.hpp>
+# endif
+#else
+# include <asio/io_service.hpp>
+# if ASIOEXT_ASIO_VERSION >= 101200
+#  include <asio/associated_allocator.hpp>
+#  include <asio/associated_executor.hpp>
+#  include <asio/dispatch.hpp>
+#  include <asio/executor_work_guard.hpp>
+#  include <asio/post.hpp>
+# endif
+#endif
+
+#include <memory>
+#include <new>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// Post a completion handler for an operation that finished immediately.
+// Handlers must not be called from inside the initiating function, so
+// this can't dispatch. With executor support, the handler runs on its
+// associated executor (defaulting to the I/O object's) and the post
+// allocates through the handler's associated allocator.
+template <typename IoObject, typename Handler>
+void post_handler(IoObject& io_object, ASIOEXT_MOVE_ARG(Handler) handler)
+{
+#if ASIOEXT_ASIO_VERSION >= 101200
+  asio::post(io_object.get_executor(), ASIOEXT_MOVE_CAST(Handler)(handler));
+#else
+  io_object.get_io_service().post(ASIOEXT_MOVE_CAST(Handler)(handler));
+#endif
+}
+
+template <typename Handler>
+void post_handler(asio::io_service& io_service,
+                  ASIOEXT_MOVE_ARG(Handler) handler)
+{
+#if ASIOEXT_ASIO_VERSION >= 101200
+  asio::post(io_service.get_executor(), ASIOEXT_MOVE_CAST(Handler)(handler));
+#else
+  io_service.post(ASIOEXT_MOVE_CAST(Handler)(handler));
+#endif
+}
+
+// Get something other I/O objects can be constructed from, so that they
+// share |io_object|'s executor.
+#if ASIOEXT_ASIO_VERSION >= 101400
+template <typename IoObject>
+typename IoObject::executor_type get_io_executor(IoObject& io_object)
+{
+  return io_object.get_executor();
+}
+#else
+template <typename IoObject>
+asio::io_service& get_io_executor(IoObject& io_object)
+{
+  return io_object.get_io_service();
+}
+#endif
+
+// Keeps the handler's executor from running out of work until the
+// handler was submitted to it. Used by operations that complete on a
+// different thread or context than the handler's.
+template <typename Handler>
+class handler_work
+{
+public:
+#if ASIOEXT_ASIO_VERSION >= 101200
+  typedef typename asio::associated_executor<
+    Handler, asio::io_service::executor_type
+  >::type executor_type;
+#endif
+
+  handler_work(const Handler& handler, asio::io_service& io_service)
+#if ASIOEXT_ASIO_VERSION >= 101200
+    : work_(asio::get_associated_executor(handler,
+                                          io_service.get_executor()))
+#else
+    : work_(io_service)
+#endif
+  {
+    // ctor
+  }
+
+  // Run |function| on the handler's executor. It is invoked inline if
+  // the executor allows it (e.g. we're already running on it).
+  template <typename Function>
+  void dispatch(ASIOEXT_MOVE_ARG(Function) function)
+  {
+#if ASIOEXT_ASIO_VERSION >= 101200
+    asio::dispatch(work_.get_executor(),
+                   ASIOEXT_MOVE_CAST(Function)(function));
+#else
+    work_.get_io_service().dispatch(ASIOEXT_MOVE_CAST(Function)(function));
+#endif
+  }
+
+  // Run |function| on the handler's executor, never inline.
+  template <typename Function>
+  void post(ASIOEXT_MOVE_ARG(Function) function)
+  {
+#if ASIOEXT_ASIO_VERSION >= 101200
+    asio::post(work_.get_executor(), ASIOEXT_MOVE_CAST(Function)(function));
+#else
+    work_.get_io_service().post(ASIOEXT_MOVE_CAST(Function)(function));
+#endif
+  }
+
+private:
+#if ASIOEXT_ASIO_VERSION >= 101200
+  asio::executor_work_guard<executor_type> work_;
+#else
+  asio::io_service::work work_;
+#endif
+};
+
+// A type-erased handler that is completed later, possibly from another
+// thread. Used by objects that queue requests, where the handler's type
+// can't be part of the queue's type.
+template <typename Signature>
+class erased_handler;
+
+template <typename... Args>
+class erased_handler<void (Args...)>
+{
+public:
+  // Post the handler with |args| and destroy this object.
+  virtual void post(Args... args) = 0;
+
+  // Destroy this object without calling the handler.
+  virtual void destroy() ASIOEXT_NOEXCEPT = 0;
+
+protected:
+  ~erased_handler()
+  {
+  }
+};
+
+struct erased_handler_deleter
+{
+  template <typename T>
+  void operator()(T* p) const ASIOEXT_NOEXCEPT
+  {
+    p->destroy();
+  }
+};
+
+template <typename Signature>
+using erased_handler_ptr =
+    std::unique_ptr<erased_handler<Signature>, erased_handler_deleter>;
+
+// Memory for the erased handler comes from the handler's allocator, and
+// is freed before the handler is posted so that it can be reused.
+template <typename Handler, typename... Args>
+class erased_handler_impl : public erased_handler<void (Args...)>
+{
+  typedef handler_allocator_type<
+    Handler, erased_handler_impl
+  > allocator_helper;
+  typedef typename allocator_helper::type allocator_type;
+  typedef std::allocator_traits<allocator_type> traits;
+
+public:
+  static erased_handler_ptr<void (Args...)> create(
+      Handler& handler, asio::io_service& io_service)
+  {
+    allocator_type alloc(allocator_helper::get(handler));
+    erased_handler_impl* p = traits::allocate(alloc, 1);
+    try {
+      new (p) erased_handler_impl(handler, io_service);
+    } catch (...) {
+      traits::deallocate(alloc, p, 1);
+      throw;
+    }
+    return erased_handler_ptr<void (Args...)>(p);
+  }
+
+  void post(Args... args)
+  {
+    allocator_type alloc(allocator_helper::get(handler_));
+    Handler handler(ASIOEXT_MOVE_CAST(Handler)(handler_));
+    handler_work<Handler> work(ASIOEXT_MOVE_CAST(handler_work<Handler>)(
+        work_));
+    free(alloc);
+
+    work.post(bind_handler(ASIOEXT_MOVE_CAST(Handler)(handler), args...));
+  }
+
+  void destroy() ASIOEXT_NOEXCEPT
+  {
+    allocator_type alloc(allocator_helper::get(handler_));
+    free(alloc);
+  }
+
+private:
+  erased_handler_impl(Handler& handler, asio::io_service& io_service)
+    : handler_(ASIOEXT_MOVE_CAST(Handler)(handler))
+    , work_(handler_, io_service)
+  {
+    // ctor
+  }
+
+  void free(allocator_type& alloc) ASIOEXT_NOEXCEPT
+  {
+    this->~erased_handler_impl();
+    traits::deallocate(alloc, this, 1);
+  }
+
+  Handler handler_;
+  handler_work<Handler> work_;
+};
+
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,226 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/detail/aligned_memory.hpp"
+
+#if defined(ASIOEXT_WINDOWS)
+# include <malloc.h>
+# include <windows.h>
+#else
+# include <cstdint>
+# include <cstdio>
+# include <cstdlib>
+# include <unistd.h>
+# include <sys/mman.h>
+# if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#  define MAP_ANONYMOUS MAP_ANON
+# endif
+#endif
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+namespace aligned_memory {
+
+namespace {
+
+std::size_t round_up(std::size_t size, std::size_t granularity) ASIOEXT_NOEXCEPT
+{
+  if (size == 0)
+    size = 1;
+  return (size + granularity - 1) / granularity * granularity;
+}
+
+// Regions of at least one huge page get rounded to whole huge pages, all
+// others to regular pages.
+std::size_t huge_region_size(std::size_t size) ASIOEXT_NOEXCEPT
+{
+  const std::size_t huge = huge_page_size();
+  if (huge != 0 && size >= huge)
+    return round_up(size, huge);
+  return round_up(size, page_size());
+}
+
+#if !defined(ASIOEXT_WINDOWS)
+std::size_t query_huge_page_size() ASIOEXT_NOEXCEPT
+{
+# if defined(__linux__)
+  std::size_t size = 2 * 1024 * 1024;
+  if (std::FILE* f = std::fopen("/proc/meminfo", "r")) {
+    char line[128];
+    unsigned long kb;
+    while (std::fgets(line, sizeof(line), f)) {
+      if (std::sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+        size = static_cast<std::size_t>(kb) * 1024;
+        break;
+      }
+    }
+    std::fclose(f);
+  }
+  return size;
+# else
+  return 0;
+# endif
+}
+#endif
+
+}
+
+#if defined(ASIOEXT_WINDOWS)
+void* allocate(std::size_t size, std::size_t alignment) ASIOEXT_NOEXCEPT
+{
+  return ::_aligned_malloc(size != 0 ? size : 1, alignment);
+}
+
+void deallocate(void* p) ASIOEXT_NOEXCEPT
+{
+  ::_aligned_free(p);
+}
+
+std::size_t page_size() ASIOEXT_NOEXCEPT
+{
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwPageSize;
+}
+
+std::size_t huge_page_size() ASIOEXT_NOEXCEPT
+{
+  return ::GetLargePageMinimum();
+}
+
+void* map_pages(std::size_t size) ASIOEXT_NOEXCEPT
+{
+  return ::VirtualAlloc(NULL, round_up(size, page_size()),
+                        MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+void unmap_pages(void* p, std::size_t /*size*/) ASIOEXT_NOEXCEPT
+{
+  ::VirtualFree(p, 0, MEM_RELEASE);
+}
+
+void* map_huge_pages(std::size_t size) ASIOEXT_NOEXCEPT
+{
+  const std::size_t region_size = huge_region_size(size);
+
+  // Large pages require the SeLockMemoryPrivilege, which most processes
+  // don't have.
+  if (region_size >= huge_page_size() && huge_page_size() != 0) {
+    if (void* p = ::VirtualAlloc(NULL, region_size,
+                                 MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                 PAGE_READWRITE))
+      return p;
+  }
+
+  return ::VirtualAlloc(NULL, region_size, MEM_RESERVE | MEM_COMMIT,
+                        PAGE_READWRITE);
+}
+
+void unmap_huge_pages(void* p, std::size_t /*size*/) ASIOEXT_NOEXCEPT
+{
+  ::VirtualFree(p, 0, MEM_RELEASE);
+}
+#else
+void* allocate(std::size_t size, std::size_t alignment) ASIOEXT_NOEXCEPT
+{
+  // posix_memalign() only accepts multiples of sizeof(void*).
+  if (alignment < sizeof(void*))
+    alignment = sizeof(void*);
+
+  void* p;
+  if (::posix_memalign(&p, alignment, size != 0 ? size : 1) != 0)
+    return nullptr;
+  return p;
+}
+
+void deallocate(void* p) ASIOEXT_NOEXCEPT
+{
+  std::free(p);
+}
+
+std::size_t page_size() ASIOEXT_NOEXCEPT
+{
+  static const std::size_t size =
+      static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+std::size_t huge_page_size() ASIOEXT_NOEXCEPT
+{
+  static const std::size_t size = query_huge_page_size();
+  return size;
+}
+
+void* map_pages(std::size_t size) ASIOEXT_NOEXCEPT
+{
+  void* p = ::mmap(nullptr, round_up(size, page_size()),
+                   PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return p != MAP_FAILED ? p : nullptr;
+}
+
+void unmap_pages(void* p, std::size_t size) ASIOEXT_NOEXCEPT
+{
+  ::munmap(p, round_up(size, page_size()));
+}
+
+void* map_huge_pages(std::size_t size) ASIOEXT_NOEXCEPT
+{
+  const std::size_t region_size = huge_region_size(size);
+  const bool huge = huge_page_size() != 0 && region_size >= huge_page_size();
+
+# if defined(MAP_HUGETLB)
+  // Explicit huge pages have to be reserved by the administrator
+  // (vm.nr_hugepages), so this fails on most systems.
+  if (huge) {
+    void* p = ::mmap(nullptr, region_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED)
+      return p;
+  }
+# endif
+
+  if (!huge) {
+    void* p = ::mmap(nullptr, region_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p != MAP_FAILED ? p : nullptr;
+  }
+
+  // mmap() only guarantees page alignment, but the kernel can only use huge
+  // pages for the aligned part of a region. Reserve an extra huge page and
+  // trim the region to an aligned one.
+  const std::size_t alignment = huge_page_size();
+  const std::size_t reserved_size = region_size + alignment;
+  void* reserved = ::mmap(nullptr, reserved_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reserved == MAP_FAILED)
+    return nullptr;
+
+  const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(reserved);
+  const std::size_t head = round_up(begin, alignment) - begin;
+  const std::size_t tail = reserved_size - head - region_size;
+  char* p = static_cast<char*>(reserved) + head;
+  if (head != 0)
+    ::munmap(reserved, head);
+  if (tail != 0)
+    ::munmap(p + region_size, tail);
+
+# if defined(MADV_HUGEPAGE)
+  // Let the kernel back the region with transparent huge pages instead.
+  ::madvise(p, region_size, MADV_HUGEPAGE);
+# endif
+  return p;
+}
+
+void unmap_huge_pages(void* p, std::size_t size) ASIOEXT_NOEXCEPT
+{
+  ::munmap(p, huge_region_size(size));
+}
+#endif
+
+}
+}
+
+ASIOEXT_NS_END
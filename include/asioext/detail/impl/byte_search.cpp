@@ -0,0 +1,340 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/detail/byte_search.hpp"
+
+#include <cstring>
+
+// SSE2 is part of every x86-64 CPU. AVX2 code is compiled separately
+// (target attribute) and only used if the CPU supports it.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define ASIOEXT_BYTE_SEARCH_SSE2 1
+# include <emmintrin.h>
+# if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define ASIOEXT_BYTE_SEARCH_AVX2 1
+#  define ASIOEXT_BYTE_SEARCH_TARGET_AVX2 __attribute__((target("avx2")))
+#  include <immintrin.h>
+# elif defined(_MSC_VER)
+#  define ASIOEXT_BYTE_SEARCH_AVX2 1
+#  define ASIOEXT_BYTE_SEARCH_TARGET_AVX2
+#  include <immintrin.h>
+#  include <intrin.h>
+# endif
+#endif
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+namespace byte_search {
+
+namespace {
+
+typedef const uint8_t* (*find_fn)(const uint8_t*, const uint8_t*, uint8_t);
+typedef const uint8_t* (*find_any_fn)(const uint8_t*, const uint8_t*,
+                                      const uint8_t*, std::size_t);
+typedef const uint8_t* (*search_fn)(const uint8_t*, const uint8_t*,
+                                    const uint8_t*, std::size_t);
+
+// Sets with more bytes than this are searched with a lookup table.
+const std::size_t max_vector_set_size = 16;
+
+// Portable implementations, also used for the tails of the vectorized ones.
+
+const uint8_t* find_generic(const uint8_t* first, const uint8_t* last,
+                            uint8_t value) ASIOEXT_NOEXCEPT
+{
+  if (first == last)
+    return last;
+
+  const void* p = std::memchr(first, value, last - first);
+  return p ? static_cast<const uint8_t*>(p) : last;
+}
+
+const uint8_t* find_any_generic(const uint8_t* first, const uint8_t* last,
+                                const uint8_t* set,
+                                std::size_t set_size) ASIOEXT_NOEXCEPT
+{
+  bool table[256] = {};
+  for (std::size_t i = 0; i != set_size; ++i)
+    table[set[i]] = true;
+
+  for (; first != last; ++first) {
+    if (table[*first])
+      return first;
+  }
+  return last;
+}
+
+const uint8_t* search_generic(const uint8_t* first, const uint8_t* last,
+                              const uint8_t* needle,
+                              std::size_t needle_size) ASIOEXT_NOEXCEPT
+{
+  while (static_cast<std::size_t>(last - first) >= needle_size) {
+    first = find_generic(first, last - needle_size + 1, needle[0]);
+    if (first == last - needle_size + 1)
+      break;
+    if (std::memcmp(first + 1, needle + 1, needle_size - 1) == 0)
+      return first;
+    ++first;
+  }
+  return last;
+}
+
+#if defined(ASIOEXT_BYTE_SEARCH_SSE2)
+inline unsigned count_trailing_zeros(uint32_t mask) ASIOEXT_NOEXCEPT
+{
+# if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned>(index);
+# else
+  return static_cast<unsigned>(__builtin_ctz(mask));
+# endif
+}
+
+const uint8_t* find_sse2(const uint8_t* first, const uint8_t* last,
+                         uint8_t value) ASIOEXT_NOEXCEPT
+{
+  const __m128i v = _mm_set1_epi8(static_cast<char>(value));
+  for (; last - first >= 16; first += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, v));
+    if (mask != 0)
+      return first + count_trailing_zeros(mask);
+  }
+
+  for (; first != last; ++first) {
+    if (*first == value)
+      return first;
+  }
+  return last;
+}
+
+const uint8_t* find_any_sse2(const uint8_t* first, const uint8_t* last,
+                             const uint8_t* set,
+                             std::size_t set_size) ASIOEXT_NOEXCEPT
+{
+  if (set_size > max_vector_set_size)
+    return find_any_generic(first, last, set, set_size);
+
+  __m128i v[max_vector_set_size];
+  for (std::size_t i = 0; i != set_size; ++i)
+    v[i] = _mm_set1_epi8(static_cast<char>(set[i]));
+
+  for (; last - first >= 16; first += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    __m128i eq = _mm_setzero_si128();
+    for (std::size_t i = 0; i != set_size; ++i)
+      eq = _mm_or_si128(eq, _mm_cmpeq_epi8(x, v[i]));
+
+    const uint32_t mask = _mm_movemask_epi8(eq);
+    if (mask != 0)
+      return first + count_trailing_zeros(mask);
+  }
+
+  return find_any_generic(first, last, set, set_size);
+}
+
+// Compare the first and last byte of the needle against 16 candidate
+// positions at once and only verify the positions where both match.
+const uint8_t* search_sse2(const uint8_t* first, const uint8_t* last,
+                           const uint8_t* needle,
+                           std::size_t needle_size) ASIOEXT_NOEXCEPT
+{
+  const __m128i f = _mm_set1_epi8(static_cast<char>(needle[0]));
+  const __m128i l = _mm_set1_epi8(static_cast<char>(needle[needle_size - 1]));
+
+  for (; static_cast<std::size_t>(last - first) >= needle_size - 1 + 16;
+       first += 16) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    const __m128i b = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(first + needle_size - 1));
+    uint32_t mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, f), _mm_cmpeq_epi8(b, l)));
+
+    while (mask != 0) {
+      const unsigned i = count_trailing_zeros(mask);
+      if (std::memcmp(first + i + 1, needle + 1, needle_size - 2) == 0)
+        return first + i;
+      mask &= mask - 1;
+    }
+  }
+
+  return search_generic(first, last, needle, needle_size);
+}
+#endif
+
+#if defined(ASIOEXT_BYTE_SEARCH_AVX2)
+bool has_avx2() ASIOEXT_NOEXCEPT
+{
+# if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+
+  // The OS has to save the YMM registers (OSXSAVE and XCR0 bits 1 and 2).
+  __cpuid(info, 1);
+  if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+# else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+# endif
+}
+
+ASIOEXT_BYTE_SEARCH_TARGET_AVX2
+const uint8_t* find_avx2(const uint8_t* first, const uint8_t* last,
+                         uint8_t value) ASIOEXT_NOEXCEPT
+{
+  const __m256i v = _mm256_set1_epi8(static_cast<char>(value));
+  for (; last - first >= 32; first += 32) {
+    const __m256i x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    const uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, v));
+    if (mask != 0)
+      return first + count_trailing_zeros(mask);
+  }
+
+  return find_sse2(first, last, value);
+}
+
+ASIOEXT_BYTE_SEARCH_TARGET_AVX2
+const uint8_t* find_any_avx2(const uint8_t* first, const uint8_t* last,
+                             const uint8_t* set,
+                             std::size_t set_size) ASIOEXT_NOEXCEPT
+{
+  if (set_size > max_vector_set_size)
+    return find_any_generic(first, last, set, set_size);
+
+  __m256i v[max_vector_set_size];
+  for (std::size_t i = 0; i != set_size; ++i)
+    v[i] = _mm256_set1_epi8(static_cast<char>(set[i]));
+
+  for (; last - first >= 32; first += 32) {
+    const __m256i x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    __m256i eq = _mm256_setzero_si256();
+    for (std::size_t i = 0; i != set_size; ++i)
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(x, v[i]));
+
+    const uint32_t mask = _mm256_movemask_epi8(eq);
+    if (mask != 0)
+      return first + count_trailing_zeros(mask);
+  }
+
+  return find_any_sse2(first, last, set, set_size);
+}
+
+ASIOEXT_BYTE_SEARCH_TARGET_AVX2
+const uint8_t* search_avx2(const uint8_t* first, const uint8_t* last,
+                           const uint8_t* needle,
+                           std::size_t needle_size) ASIOEXT_NOEXCEPT
+{
+  const __m256i f = _mm256_set1_epi8(static_cast<char>(needle[0]));
+  const __m256i l =
+      _mm256_set1_epi8(static_cast<char>(needle[needle_size - 1]));
+
+  for (; static_cast<std::size_t>(last - first) >= needle_size - 1 + 32;
+       first += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    const __m256i b = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(first + needle_size - 1));
+    uint32_t mask = _mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(a, f), _mm256_cmpeq_epi8(b, l)));
+
+    while (mask != 0) {
+      const unsigned i = count_trailing_zeros(mask);
+      if (std::memcmp(first + i + 1, needle + 1, needle_size - 2) == 0)
+        return first + i;
+      mask &= mask - 1;
+    }
+  }
+
+  return search_sse2(first, last, needle, needle_size);
+}
+#endif
+
+find_fn select_find() ASIOEXT_NOEXCEPT
+{
+#if defined(ASIOEXT_BYTE_SEARCH_AVX2)
+  if (has_avx2())
+    return &find_avx2;
+#endif
+#if defined(ASIOEXT_BYTE_SEARCH_SSE2)
+  return &find_sse2;
+#else
+  return &find_generic;
+#endif
+}
+
+find_any_fn select_find_any() ASIOEXT_NOEXCEPT
+{
+#if defined(ASIOEXT_BYTE_SEARCH_AVX2)
+  if (has_avx2())
+    return &find_any_avx2;
+#endif
+#if defined(ASIOEXT_BYTE_SEARCH_SSE2)
+  return &find_any_sse2;
+#else
+  return &find_any_generic;
+#endif
+}
+
+search_fn select_search() ASIOEXT_NOEXCEPT
+{
+#if defined(ASIOEXT_BYTE_SEARCH_AVX2)
+  if (has_avx2())
+    return &search_avx2;
+#endif
+#if defined(ASIOEXT_BYTE_SEARCH_SSE2)
+  return &search_sse2;
+#else
+  return &search_generic;
+#endif
+}
+
+}
+
+const uint8_t* find(const uint8_t* first, const uint8_t* last,
+                    uint8_t value) ASIOEXT_NOEXCEPT
+{
+  static const find_fn fn = select_find();
+  return fn(first, last, value);
+}
+
+const uint8_t* find_any(const uint8_t* first, const uint8_t* last,
+                        const uint8_t* set,
+                        std::size_t set_size) ASIOEXT_NOEXCEPT
+{
+  if (set_size == 1)
+    return find(first, last, set[0]);
+
+  static const find_any_fn fn = select_find_any();
+  return fn(first, last, set, set_size);
+}
+
+const uint8_t* search(const uint8_t* first, const uint8_t* last,
+                      const uint8_t* needle,
+                      std::size_t needle_size) ASIOEXT_NOEXCEPT
+{
+  if (needle_size == 0)
+    return first;
+  if (needle_size == 1)
+    return find(first, last, needle[0]);
+
+  static const search_fn fn = select_search();
+  return fn(first, last, needle, needle_size);
+}
+
+}
+}
+
+ASIOEXT_NS_END
@@ -0,0 +1,97 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/detail/frame_allocator.hpp"
+
+#include <new>
+#include <utility>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+namespace {
+
+// Frame sizes are rounded up to this, so that frames of coroutines with
+// slightly different sizes can share cached blocks.
+const std::size_t frame_granularity = 64;
+
+// Maximum number of cached frames per thread.
+const std::size_t frame_cache_size = 8;
+
+// Every block starts with its capacity. The header keeps the frame
+// suitably aligned.
+union frame_header
+{
+  std::size_t capacity;
+  std::max_align_t align;
+};
+
+struct frame_cache
+{
+  ~frame_cache()
+  {
+    for (std::size_t i = 0; i != frame_cache_size; ++i) {
+      ::operator delete(blocks[i]);
+      blocks[i] = nullptr;
+    }
+  }
+
+  frame_header* blocks[frame_cache_size];
+};
+
+thread_local frame_cache cache = {};
+
+}
+
+void* frame_allocate(std::size_t size)
+{
+  // Use the smallest cached block that is large enough.
+  std::size_t best = frame_cache_size;
+  for (std::size_t i = 0; i != frame_cache_size; ++i) {
+    frame_header* h = cache.blocks[i];
+    if (h && h->capacity >= size &&
+        (best == frame_cache_size ||
+         h->capacity < cache.blocks[best]->capacity))
+      best = i;
+  }
+
+  if (best != frame_cache_size) {
+    frame_header* h = cache.blocks[best];
+    cache.blocks[best] = nullptr;
+    return h + 1;
+  }
+
+  const std::size_t capacity =
+      (size + frame_granularity - 1) / frame_granularity * frame_granularity;
+  frame_header* h = static_cast<frame_header*>(
+      ::operator new(sizeof(frame_header) + capacity));
+  h->capacity = capacity;
+  return h + 1;
+}
+
+void frame_deallocate(void* p) ASIOEXT_NOEXCEPT
+{
+  frame_header* h = static_cast<frame_header*>(p) - 1;
+
+  // Keep the larger blocks, they can be used for more frames.
+  std::size_t smallest = 0;
+  for (std::size_t i = 0; i != frame_cache_size; ++i) {
+    if (!cache.blocks[i]) {
+      cache.blocks[i] = h;
+      return;
+    }
+    if (cache.blocks[i]->capacity < cache.blocks[smallest]->capacity)
+      smallest = i;
+  }
+
+  if (cache.blocks[smallest]->capacity < h->capacity)
+    std::swap(cache.blocks[smallest], h);
+  ::operator delete(h);
+}
+
+}
+
+ASIOEXT_NS_END
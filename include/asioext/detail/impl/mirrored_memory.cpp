@@ -0,0 +1,108 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/detail/mirrored_memory.hpp"
+
+#if defined(ASIOEXT_HAS_MIRRORED_MEMORY)
+
+#include "asioext/detail/error.hpp"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+namespace mirrored_memory {
+
+namespace {
+
+void set_error(error_code& ec, int e) ASIOEXT_NOEXCEPT
+{
+  ec = error_code(e, asio::error::get_system_category());
+}
+
+// Create an anonymous file that backs both views.
+int create_backing_file(std::size_t size, error_code& ec) ASIOEXT_NOEXCEPT
+{
+#if defined(SYS_memfd_create)
+  // Not every libc has a memfd_create() wrapper.
+  const int fd = static_cast<int>(::syscall(SYS_memfd_create,
+                                            "asioext-mirror", 1u /*CLOEXEC*/));
+#else
+  const int fd = -1;
+  errno = ENOSYS;
+#endif
+  if (fd == -1) {
+    set_error(ec, errno);
+    return -1;
+  }
+
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    set_error(ec, errno);
+    ::close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+}
+
+std::size_t granularity() ASIOEXT_NOEXCEPT
+{
+  static const std::size_t page_size =
+      static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+
+uint8_t* map(std::size_t size, error_code& ec) ASIOEXT_NOEXCEPT
+{
+  const int fd = create_backing_file(size, ec);
+  if (fd == -1)
+    return nullptr;
+
+  // Reserve the address range for both views first, so that nobody else
+  // can map anything in between.
+  void* base = ::mmap(nullptr, 2 * size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    set_error(ec, errno);
+    ::close(fd);
+    return nullptr;
+  }
+
+  uint8_t* p = static_cast<uint8_t*>(base);
+  if (::mmap(p, size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+      ::mmap(p + size, size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    set_error(ec, errno);
+    ::munmap(base, 2 * size);
+    ::close(fd);
+    return nullptr;
+  }
+
+  // The mappings keep the file alive.
+  ::close(fd);
+  ec = error_code();
+  return p;
+}
+
+void unmap(uint8_t* p, std::size_t size) ASIOEXT_NOEXCEPT
+{
+  ::munmap(p, 2 * size);
+}
+
+}
+}
+
+ASIOEXT_NS_END
+
+#endif
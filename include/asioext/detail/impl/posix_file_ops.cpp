@@ -7,6 +7,7 @@
 #include "asioext/detail/posix_file_ops.hpp"
 #include "asioext/detail/chrono.hpp"
 #include "asioext/detail/error.hpp"
+#include "asioext/detail/file_io_trace.hpp"
 
 #ifndef _FILE_OFFSET_BITS
 #define _FILE_OFFSET_BITS 64
@@ -20,6 +21,22 @@
 #include <sys/types.h> // for off_t etc.
 #include <sys/time.h> // for utimes
 
+// ASIOEXT_HAS_STATX: Support for statx() (glibc 2.28+).
+#if !defined(ASIOEXT_HAS_STATX) && !defined(ASIOEXT_DISABLE_STATX)
+# if defined(__linux__) && defined(STATX_BASIC_STATS)
+#  define ASIOEXT_HAS_STATX 1
+# endif
+#endif
+
+#if defined(ASIOEXT_HAS_STATX)
+# include <atomic>
+#endif
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+# include <dirent.h> // for DT_*
+# include <sys/syscall.h> // for SYS_getdents64
+#endif
+
 #if !defined(ASIOEXT_USE_FUTIMENS) && !defined(ASIOEXT_DISABLE_FUTIMENS)
 # if defined(__linux__)
 // __USE_XOPEN2K8 should be enough
@@ -238,9 +255,19 @@ int parse_open_flags(open_flags flags) ASIOEXT_NOEXCEPT
 handle_type open(const char* path, const open_args& args,
                  error_code& ec) ASIOEXT_NOEXCEPT
 {
+  return openat(AT_FDCWD, path, args, ec);
+}
+
+handle_type openat(handle_type dir, const char* path, const open_args& args,
+                   error_code& ec) ASIOEXT_NOEXCEPT
+{
+  file_io_trace trace(file_io_operation::open, -1, 0, 0, ec);
+  trace.path(path);
+
   mode_t mode = static_cast<mode_t>(args.mode());
   while (true) {
-    handle_type fd = ::open(path, O_CLOEXEC | args.native_flags(), mode);
+    handle_type fd = ::openat(dir, path, O_CLOEXEC | args.native_flags(),
+                              mode);
     if (fd != -1) {
       // Skip calling set_attributes() in case we don't support
       // attributes at all. TODO(tim): Fail in case attrs were requested?
@@ -255,7 +282,7 @@ handle_type open(const char* path, const open_args& args,
 #endif
 
       ec = error_code();
-      return fd;
+      return trace.opened(fd);
     }
 
     const int e = errno;
@@ -269,6 +296,8 @@ handle_type open(const char* path, const open_args& args,
 
 void close(handle_type fd, error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::close, fd, 0, 0, ec);
+
   // By the time close() returns, the fd is already gone
   // and could be re-used by another thread. Retrying the call would then
   // close someone elses' fd, which is certainly not what we want to do.
@@ -444,6 +473,159 @@ void get_times(handle_type fd, file_time_type& ctime, file_time_type& atime,
   set_error(ec, errno);
 }
 
+file_type mode_to_file_type(mode_t mode) ASIOEXT_NOEXCEPT
+{
+  switch (mode & S_IFMT) {
+    case S_IFREG: return file_type::regular;
+    case S_IFDIR: return file_type::directory;
+    case S_IFLNK: return file_type::symlink;
+    case S_IFBLK: return file_type::block;
+    case S_IFCHR: return file_type::character;
+    case S_IFIFO: return file_type::fifo;
+    case S_IFSOCK: return file_type::socket;
+    default: return file_type::unknown;
+  }
+}
+
+#if defined(ASIOEXT_HAS_STATX)
+// Set once statx() failed with ENOSYS (or EPERM, which some seccomp
+// filters return for unknown syscalls).
+static std::atomic<bool> statx_unsupported(false);
+
+bool statx_status(handle_type dir, const char* path, int flags,
+                  file_status_mask mask, file_status& st,
+                  error_code& ec) ASIOEXT_NOEXCEPT
+{
+  unsigned int native_mask = 0;
+  if ((mask & file_status_mask::type) != file_status_mask::none)
+    native_mask |= STATX_TYPE;
+  if ((mask & file_status_mask::size) != file_status_mask::none)
+    native_mask |= STATX_SIZE;
+  if ((mask & file_status_mask::perms) != file_status_mask::none)
+    native_mask |= STATX_MODE;
+  if ((mask & file_status_mask::times) != file_status_mask::none)
+    native_mask |= STATX_BTIME | STATX_ATIME | STATX_MTIME;
+
+  struct statx stx;
+  if (::statx(dir, path, flags | AT_STATX_SYNC_AS_STAT,
+              native_mask, &stx) != 0) {
+    const int e = errno;
+    if (e == ENOSYS || e == EPERM) {
+      statx_unsupported.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    set_error(ec, e);
+    return true;
+  }
+
+  if ((mask & file_status_mask::type) != file_status_mask::none)
+    st.type = mode_to_file_type(stx.stx_mode);
+  if ((mask & file_status_mask::size) != file_status_mask::none)
+    st.size = stx.stx_size;
+  if ((mask & file_status_mask::perms) != file_status_mask::none)
+    st.perms = static_cast<file_perms>(stx.stx_mode) & file_perms::all;
+
+  if ((mask & file_status_mask::times) != file_status_mask::none) {
+    file_time_type::duration ctim, atim, mtim;
+    // Not all file systems record the creation time.
+    if ((stx.stx_mask & STATX_BTIME) == 0) {
+      stx.stx_btime.tv_sec = 0;
+      stx.stx_btime.tv_nsec = 0;
+    }
+    if (!compose_time(chrono::seconds(stx.stx_btime.tv_sec),
+                      chrono::nanoseconds(stx.stx_btime.tv_nsec), ctim) ||
+        !compose_time(chrono::seconds(stx.stx_atime.tv_sec),
+                      chrono::nanoseconds(stx.stx_atime.tv_nsec), atim) ||
+        !compose_time(chrono::seconds(stx.stx_mtime.tv_sec),
+                      chrono::nanoseconds(stx.stx_mtime.tv_nsec), mtim)) {
+      ec = make_error_code(errc::value_too_large);
+      return true;
+    }
+    st.ctime = file_time_type(ctim);
+    st.atime = file_time_type(atim);
+    st.mtime = file_time_type(mtim);
+  }
+
+  ec = error_code();
+  return true;
+}
+#endif
+
+void stat_to_status(const struct stat& s, file_status_mask mask,
+                    file_status& st, error_code& ec) ASIOEXT_NOEXCEPT
+{
+  if ((mask & file_status_mask::type) != file_status_mask::none)
+    st.type = mode_to_file_type(s.st_mode);
+  if ((mask & file_status_mask::size) != file_status_mask::none)
+    st.size = s.st_size;
+  if ((mask & file_status_mask::perms) != file_status_mask::none)
+    st.perms = static_cast<file_perms>(s.st_mode) & file_perms::all;
+#if ASIOEXT_HAS_FILE_FLAGS
+  if ((mask & file_status_mask::attrs) != file_status_mask::none)
+    st.attrs = native_to_file_attrs(s.st_flags);
+#endif
+
+  if ((mask & file_status_mask::times) != file_status_mask::none &&
+      !stat_to_times(s, st.ctime, st.atime, st.mtime)) {
+    st = file_status();
+    ec = make_error_code(errc::value_too_large);
+    return;
+  }
+
+  st.mask = mask;
+  ec = error_code();
+}
+
+void status(handle_type fd, file_status_mask mask, file_status& st,
+            error_code& ec) ASIOEXT_NOEXCEPT
+{
+  st = file_status();
+
+#if defined(ASIOEXT_HAS_STATX)
+  if (!statx_unsupported.load(std::memory_order_relaxed) &&
+      statx_status(fd, "", AT_EMPTY_PATH, mask, st, ec)) {
+    if (!ec)
+      st.mask = mask;
+    else
+      st = file_status();
+    return;
+  }
+#endif
+
+  struct stat s;
+  if (::fstat(fd, &s) != 0) {
+    set_error(ec, errno);
+    return;
+  }
+
+  stat_to_status(s, mask, st, ec);
+}
+
+void status_at(handle_type dir, const char* path, file_status_mask mask,
+               file_status& st, error_code& ec) ASIOEXT_NOEXCEPT
+{
+  st = file_status();
+
+#if defined(ASIOEXT_HAS_STATX)
+  if (!statx_unsupported.load(std::memory_order_relaxed) &&
+      statx_status(dir, path, AT_SYMLINK_NOFOLLOW, mask, st, ec)) {
+    if (!ec)
+      st.mask = mask;
+    else
+      st = file_status();
+    return;
+  }
+#endif
+
+  struct stat s;
+  if (::fstatat(dir, path, &s, AT_SYMLINK_NOFOLLOW) != 0) {
+    set_error(ec, errno);
+    return;
+  }
+
+  stat_to_status(s, mask, st, ec);
+}
+
 void set_times(handle_type fd, file_time_type ctime, file_time_type atime,
                file_time_type mtime, error_code& ec) ASIOEXT_NOEXCEPT
 {
@@ -519,12 +701,14 @@ void set_times(handle_type fd, file_time_type ctime, file_time_type atime,
 std::size_t readv(handle_type fd, iovec* bufs, int count,
                   error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::read, fd, 0, bufs, count, ec);
+
   while (true) {
     const ssize_t r = ::readv(fd, bufs, count);
     if (r != 0) {
       if (r != -1) {
         ec = error_code();
-        return static_cast<std::size_t>(r);
+        return trace.transferred(static_cast<std::size_t>(r));
       }
 
       const int e = errno;
@@ -551,11 +735,13 @@ std::size_t readv(handle_type fd, iovec* bufs, int count,
 std::size_t writev(handle_type fd, const iovec* bufs, int count,
                    error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::write, fd, 0, bufs, count, ec);
+
   while (true) {
     const ssize_t r = ::writev(fd, bufs, count);
     if (r != -1) {
       ec = error_code();
-      return static_cast<std::size_t>(r);
+      return trace.transferred(static_cast<std::size_t>(r));
     }
 
     const int e = errno;
@@ -570,13 +756,15 @@ std::size_t writev(handle_type fd, const iovec* bufs, int count,
 std::size_t pread(handle_type fd, void* buffer, std::size_t size,
                   uint64_t offset, error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::read_at, fd, offset, size, ec);
+
   while (true) {
     const ssize_t r = ::pread(fd, buffer, size,
                               static_cast<off_t>(offset));
     if (r != 0) {
       if (r != -1) {
         ec = error_code();
-        return static_cast<std::size_t>(r);
+        return trace.transferred(static_cast<std::size_t>(r));
       }
 
       const int e = errno;
@@ -598,12 +786,14 @@ std::size_t pread(handle_type fd, void* buffer, std::size_t size,
 std::size_t pwrite(handle_type fd, const void* buffer, std::size_t size,
                    uint64_t offset, error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::write_at, fd, offset, size, ec);
+
   while (true) {
     const ssize_t r = ::pwrite(fd, buffer, size,
                                static_cast<off_t>(offset));
     if (r != -1) {
       ec = error_code();
-      return static_cast<std::size_t>(r);
+      return trace.transferred(static_cast<std::size_t>(r));
     }
 
     const int e = errno;
@@ -619,12 +809,15 @@ std::size_t pwrite(handle_type fd, const void* buffer, std::size_t size,
 std::size_t preadv(handle_type fd, iovec* bufs, int count, uint64_t offset,
                    error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::read_at, fd, offset, bufs, count,
+                      ec);
+
   while (true) {
     const ssize_t r = ::preadv(fd, bufs, count, static_cast<off_t>(offset));
     if (r != 0) {
       if (r != -1) {
         ec = error_code();
-        return static_cast<std::size_t>(r);
+        return trace.transferred(static_cast<std::size_t>(r));
       }
 
       const int e = errno;
@@ -651,9 +844,81 @@ std::size_t preadv(handle_type fd, iovec* bufs, int count, uint64_t offset,
 std::size_t pwritev(handle_type fd, const iovec* bufs, int count,
                     uint64_t offset, error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::write_at, fd, offset, bufs, count,
+                      ec);
+
   while (true) {
     const ssize_t r = ::pwritev(fd, bufs, count, static_cast<off_t>(offset));
     if (r != -1) {
+      ec = error_code();
+      return trace.transferred(static_cast<std::size_t>(r));
+    }
+
+    const int e = errno;
+    if (e == EINTR)
+      continue;
+
+    set_error(ec, e);
+    return 0;
+  }
+}
+
+#if defined(ASIOEXT_HAS_NOWAIT_READS)
+std::size_t preadv_nowait(handle_type fd, iovec* bufs, int count,
+                          uint64_t offset, error_code& ec) ASIOEXT_NOEXCEPT
+{
+  file_io_trace trace(file_io_operation::read_at, fd, offset, bufs, count,
+                      ec);
+
+  while (true) {
+    const ssize_t r = ::preadv2(fd, bufs, count, static_cast<off_t>(offset),
+                                RWF_NOWAIT);
+    if (r != 0) {
+      if (r != -1) {
+        ec = error_code();
+        return trace.transferred(static_cast<std::size_t>(r));
+      }
+
+      const int e = errno;
+      if (e == EINTR)
+        continue;
+
+      set_error(ec, e);
+      return 0;
+    }
+    break;
+  }
+
+  for (int i = 0; i != count; ++i) {
+    if (bufs[i].iov_len != 0) {
+      ec = asio::error::eof;
+      return 0;
+    }
+  }
+
+  ec = error_code();
+  return 0;
+}
+#endif
+#endif
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+handle_type open_directory(handle_type dir, const char* path,
+                           const open_args& args,
+                           error_code& ec) ASIOEXT_NOEXCEPT
+{
+  open_args dir_args(args);
+  dir_args.native_flags(args.native_flags() | O_DIRECTORY);
+  return openat(dir, path, dir_args, ec);
+}
+
+std::size_t getdents(handle_type fd, void* buffer, std::size_t size,
+                     error_code& ec) ASIOEXT_NOEXCEPT
+{
+  while (true) {
+    // glibc only provides a getdents64() wrapper since 2.30.
+    const long r = ::syscall(SYS_getdents64, fd, buffer, size);
+    if (r >= 0) {
       ec = error_code();
       return static_cast<std::size_t>(r);
     }
@@ -666,6 +931,20 @@ std::size_t pwritev(handle_type fd, const iovec* bufs, int count,
     return 0;
   }
 }
+
+file_type native_to_file_type(unsigned char d_type) ASIOEXT_NOEXCEPT
+{
+  switch (d_type) {
+    case DT_REG: return file_type::regular;
+    case DT_DIR: return file_type::directory;
+    case DT_LNK: return file_type::symlink;
+    case DT_BLK: return file_type::block;
+    case DT_CHR: return file_type::character;
+    case DT_FIFO: return file_type::fifo;
+    case DT_SOCK: return file_type::socket;
+    default: return file_type::unknown;
+  }
+}
 #endif
 
 }
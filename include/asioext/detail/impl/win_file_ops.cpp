@@ -8,6 +8,7 @@
 #include "asioext/detail/win_file_ops.hpp"
 #include "asioext/detail/chrono.hpp"
 #include "asioext/detail/error.hpp"
+#include "asioext/detail/file_io_trace.hpp"
 
 #if defined(ASIOEXT_WINDOWS_USE_UTF8_FILENAMES) || defined(ASIOEXT_WINDOWS_APP)
 # include "asioext/detail/win_path.hpp"
@@ -124,6 +125,10 @@ void parse_open_flags(open_flags flags, file_perms perms, file_attrs attrs,
 handle_type open(const char* filename, const open_args& args,
                  error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::open, INVALID_HANDLE_VALUE, 0, 0,
+                      ec);
+  trace.path(filename);
+
 #if defined(ASIOEXT_WINDOWS_USE_UTF8_FILENAMES) || defined(ASIOEXT_WINDOWS_APP)
   detail::win_path p(filename, std::strlen(filename), ec);
   if (ec) return INVALID_HANDLE_VALUE;
@@ -154,12 +159,15 @@ handle_type open(const char* filename, const open_args& args,
   else
     ec = error_code();
 
-  return h;
+  return trace.opened(h);
 }
 
 handle_type open(const wchar_t* filename, const open_args& args,
                  error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::open, INVALID_HANDLE_VALUE, 0, 0,
+                      ec);
+
 #if !defined(ASIOEXT_WINDOWS_APP)
   const handle_type h =
       ::CreateFileW(filename, args.desired_access(), args.share_mode(), NULL,
@@ -180,11 +188,13 @@ handle_type open(const wchar_t* filename, const open_args& args,
   else
     set_error(ec);
 
-  return h;
+  return trace.opened(h);
 }
 
 void close(handle_type fd, error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::close, fd, 0, 0, ec);
+
   if (::CloseHandle(fd))
     ec = error_code();
   else
@@ -448,6 +458,44 @@ void attributes(handle_type fd, file_attrs attrs, file_attr_options opts,
 #endif
 }
 
+void status(handle_type fd, file_status_mask mask, file_status& st,
+            error_code& ec) ASIOEXT_NOEXCEPT
+{
+  ASIOEXT_CONSTEXPR file_perms write_perms = file_perms::owner_write |
+                                             file_perms::group_write |
+                                             file_perms::others_write;
+
+  st = file_status();
+
+  BY_HANDLE_FILE_INFORMATION info;
+  if (!::GetFileInformationByHandle(fd, &info)) {
+    set_error(ec);
+    return;
+  }
+
+  st.mask = mask;
+  if ((mask & file_status_mask::type) != file_status_mask::none) {
+    st.type = info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ?
+              file_type::directory : file_type::regular;
+  }
+  if ((mask & file_status_mask::size) != file_status_mask::none) {
+    st.size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) |
+              info.nFileSizeLow;
+  }
+  if ((mask & file_status_mask::perms) != file_status_mask::none) {
+    st.perms = info.dwFileAttributes & FILE_ATTRIBUTE_READONLY ?
+               file_perms::all & ~write_perms : file_perms::all;
+  }
+  if ((mask & file_status_mask::attrs) != file_status_mask::none)
+    st.attrs = native_to_file_attrs(info.dwFileAttributes);
+  if ((mask & file_status_mask::times) != file_status_mask::none) {
+    st.ctime = filetime_to_chrono(info.ftCreationTime);
+    st.atime = filetime_to_chrono(info.ftLastAccessTime);
+    st.mtime = filetime_to_chrono(info.ftLastWriteTime);
+  }
+  ec = error_code();
+}
+
 void get_times(handle_type fd, file_time_type& ctime, file_time_type& atime,
                file_time_type& mtime, error_code& ec) ASIOEXT_NOEXCEPT
 {
@@ -478,6 +526,8 @@ void set_times(handle_type fd, file_time_type ctime, file_time_type atime,
 uint32_t read(handle_type fd, void* buffer, uint32_t size,
               error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::read, fd, 0, size, ec);
+
   DWORD bytesRead = 0;
   if (!::ReadFile(fd, buffer, size, &bytesRead, NULL)) {
     set_error(ec);
@@ -487,24 +537,28 @@ uint32_t read(handle_type fd, void* buffer, uint32_t size,
   if (bytesRead == 0 && size != 0)
     ec = asio::error::eof;
 
-  return bytesRead;
+  return trace.transferred(bytesRead);
 }
 
 uint32_t write(handle_type fd, const void* buffer, uint32_t size,
                error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::write, fd, 0, size, ec);
+
   DWORD bytesWritten = 0;
   if (!::WriteFile(fd, buffer, size, &bytesWritten, NULL)) {
     set_error(ec);
     return 0;
   }
 
-  return bytesWritten;
+  return trace.transferred(bytesWritten);
 }
 
 uint32_t pread(handle_type fd, void* buffer, uint32_t size, uint64_t offset,
                error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::read_at, fd, offset, size, ec);
+
   LARGE_INTEGER offset2;
   offset2.QuadPart = offset;
 
@@ -521,12 +575,14 @@ uint32_t pread(handle_type fd, void* buffer, uint32_t size, uint64_t offset,
   if (bytesRead == 0 && size != 0)
     ec = asio::error::eof;
 
-  return bytesRead;
+  return trace.transferred(bytesRead);
 }
 
 uint32_t pwrite(handle_type fd, const void* buffer, uint32_t size,
                 uint64_t offset, error_code& ec) ASIOEXT_NOEXCEPT
 {
+  file_io_trace trace(file_io_operation::write_at, fd, offset, size, ec);
+
   LARGE_INTEGER offset2;
   offset2.QuadPart = offset;
 
@@ -540,7 +596,7 @@ uint32_t pwrite(handle_type fd, const void* buffer, uint32_t size,
     return 0;
   }
 
-  return bytesWritten;
+  return trace.transferred(bytesWritten);
 }
 
 }
@@ -0,0 +1,119 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_INLINESTORAGEALLOCATOR_HPP
+#define ASIOEXT_DETAIL_INLINESTORAGEALLOCATOR_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/detail/cstdint.hpp"
+
+#include <memory>
+#include <type_traits>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// Byte storage for up to |N| bytes. Used as the first base of classes that
+// hand it to an inline_storage_allocator, so it outlives the allocations.
+template <std::size_t N>
+struct inline_storage
+{
+  uint8_t storage_[N];
+};
+
+// Allocator that serves requests of up to |N| bytes from external storage
+// and forwards everything else (or requests made while the storage is in
+// use) to |Allocator|.
+//
+// The storage belongs to one particular container, so the allocator must
+// never propagate. Copies made with select_on_container_copy_construction()
+// don't refer to the storage at all.
+template <std::size_t N, typename Allocator>
+class inline_storage_allocator
+{
+  typedef std::allocator_traits<Allocator> traits_type;
+
+public:
+  typedef uint8_t value_type;
+
+  typedef std::false_type propagate_on_container_copy_assignment;
+  typedef std::false_type propagate_on_container_move_assignment;
+  typedef std::false_type propagate_on_container_swap;
+  typedef std::false_type is_always_equal;
+
+  inline_storage_allocator(uint8_t* storage, const Allocator& a)
+      ASIOEXT_NOEXCEPT
+    : allocator_(a)
+    , storage_(storage)
+    , storage_used_(false)
+  {
+    // ctor
+  }
+
+  uint8_t* allocate(std::size_t n)
+  {
+    if (storage_ && !storage_used_ && n <= N) {
+      storage_used_ = true;
+      return storage_;
+    }
+    return traits_type::allocate(allocator_, n);
+  }
+
+  void deallocate(uint8_t* p, std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    if (p == storage_)
+      storage_used_ = false;
+    else
+      traits_type::deallocate(allocator_, p, n);
+  }
+
+  std::size_t max_size() const ASIOEXT_NOEXCEPT
+  {
+    return traits_type::max_size(allocator_);
+  }
+
+  inline_storage_allocator select_on_container_copy_construction() const
+  {
+    return inline_storage_allocator(nullptr,
+        traits_type::select_on_container_copy_construction(allocator_));
+  }
+
+  const Allocator& inner_allocator() const ASIOEXT_NOEXCEPT
+  {
+    return allocator_;
+  }
+
+  // Memory obtained from one allocator can be freed by another one
+  // as long as their inner allocators are equal, since the storage
+  // is never handed out to anyone but its owner.
+  friend bool operator==(const inline_storage_allocator& a,
+                         const inline_storage_allocator& b)
+  {
+    return a.allocator_ == b.allocator_;
+  }
+
+  friend bool operator!=(const inline_storage_allocator& a,
+                         const inline_storage_allocator& b)
+  {
+    return !(a == b);
+  }
+
+private:
+  Allocator allocator_;
+  uint8_t* storage_;
+  bool storage_used_;
+};
+
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,59 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DETAIL_MIRROREDMEMORY_HPP
+#define ASIOEXT_DETAIL_MIRROREDMEMORY_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+
+#include <cstddef> // for size_t
+
+// ASIOEXT_HAS_MIRRORED_MEMORY: Support for mapping the same pages twice
+// at adjacent addresses (memfd_create(), Linux 3.17+).
+#if !defined(ASIOEXT_HAS_MIRRORED_MEMORY)
+# if !defined(ASIOEXT_DISABLE_MIRRORED_MEMORY)
+#  if defined(__linux__)
+#   define ASIOEXT_HAS_MIRRORED_MEMORY 1
+#  endif
+# endif
+#endif
+
+#if defined(ASIOEXT_HAS_MIRRORED_MEMORY)
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+namespace mirrored_memory {
+
+// The size of a mapping has to be a multiple of this (the page size).
+ASIOEXT_DECL std::size_t granularity() ASIOEXT_NOEXCEPT;
+
+// Map |size| bytes twice, back to back. Writing to p[i] also changes
+// p[i + size] and vice versa. |size| has to be a multiple of granularity().
+ASIOEXT_DECL uint8_t* map(std::size_t size, error_code& ec) ASIOEXT_NOEXCEPT;
+
+// Release a region returned by map().
+ASIOEXT_DECL void unmap(uint8_t* p, std::size_t size) ASIOEXT_NOEXCEPT;
+
+}
+}
+
+ASIOEXT_NS_END
+
+# if defined(ASIOEXT_HEADER_ONLY)
+#  include "asioext/detail/impl/mirrored_memory.cpp"
+# endif
+
+#endif
+
+#endif
@@ -14,13 +14,9 @@
 
 #include "asioext/composed_operation.hpp"
 
-#include "asioext/detail/asio_version.hpp"
+#include "asioext/bind_handler.hpp"
 
-#if defined(ASIOEXT_USE_BOOST_ASIO)
-# include <boost/asio/io_service.hpp>
-#else
-# include <asio/io_service.hpp>
-#endif
+#include "asioext/detail/handler_work.hpp"
 
 ASIOEXT_NS_BEGIN
 
@@ -32,8 +28,9 @@ namespace detail {
 /// that support user-supplied Handlers.
 ///
 /// The operation class assumes that the the given Handler needs to be
-/// executed on a specific io_service. It ensures that said io_service
-/// doesn't run out of work until the handler was dispatched.
+/// executed on a specific io_service, or on the Handler's associated
+/// executor if it has one. It ensures that said executor doesn't run out
+/// of work until the handler was dispatched.
 ///
 /// This class is intended for custom operations that are executed
 /// on different io_service(s) than the user-supplied handler.
@@ -44,20 +41,23 @@ template <typename Handler>
 class operation : public composed_operation<Handler>
 {
 public:
-  operation(ASIOEXT_MOVE_ARG(Handler) handler, asio::io_service& executor)
+  operation(ASIOEXT_MOVE_ARG(Handler) handler, asio::io_service& io_service)
     : composed_operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler))
-    , executor_(executor)
-    , work_(executor)
+    , work_(this->handler_, io_service)
   {
     // ctor
   }
 
-  /// Get a reference to the assigned io_service.
-  asio::io_service& get_executor() ASIOEXT_NOEXCEPT { return executor_; }
+  /// Dispatch the handler with the given arguments on its executor.
+  template <typename... Args>
+  void complete(ASIOEXT_MOVE_ARG(Args)... args)
+  {
+    work_.dispatch(bind_handler(ASIOEXT_MOVE_CAST(Handler)(this->handler_),
+                                ASIOEXT_MOVE_CAST(Args)(args)...));
+  }
 
 private:
-  asio::io_service& executor_;
-  asio::io_service::work work_;
+  handler_work<Handler> work_;
 };
 
 // Operations aren't executed on the user's context
@@ -15,6 +15,8 @@
 #include "asioext/seek_origin.hpp"
 #include "asioext/file_perms.hpp"
 #include "asioext/file_attrs.hpp"
+#include "asioext/file_type.hpp"
+#include "asioext/file_status.hpp"
 #include "asioext/error_code.hpp"
 #include "asioext/chrono.hpp"
 
@@ -27,6 +29,16 @@
 
 #undef _FILE_OFFSET_BITS
 
+// ASIOEXT_HAS_NOWAIT_READS: Support for non-blocking reads of cached data
+// (preadv2() with RWF_NOWAIT, Linux 4.14+).
+#if !defined(ASIOEXT_HAS_NOWAIT_READS)
+# if !defined(ASIOEXT_DISABLE_NOWAIT_READS)
+#  if defined(__linux__) && defined(RWF_NOWAIT)
+#   define ASIOEXT_HAS_NOWAIT_READS 1
+#  endif
+# endif
+#endif
+
 ASIOEXT_NS_BEGIN
 
 class open_args;
@@ -46,6 +58,11 @@ ASIOEXT_DECL int parse_open_flags(open_flags flags) ASIOEXT_NOEXCEPT;
 ASIOEXT_DECL handle_type open(const char* path, const open_args& args,
                               error_code& ec) ASIOEXT_NOEXCEPT;
 
+// Relative paths are resolved relative to the directory |dir|.
+ASIOEXT_DECL handle_type openat(handle_type dir, const char* path,
+                                const open_args& args,
+                                error_code& ec) ASIOEXT_NOEXCEPT;
+
 ASIOEXT_DECL void close(handle_type fd, error_code& ec) ASIOEXT_NOEXCEPT;
 
 ASIOEXT_DECL handle_type duplicate(handle_type fd,
@@ -83,6 +100,16 @@ ASIOEXT_DECL void set_times(handle_type fd, file_time_type ctime,
                             file_time_type atime, file_time_type mtime,
                             error_code& ec) ASIOEXT_NOEXCEPT;
 
+// Uses a single statx() call (Linux 4.11+) or fstat().
+ASIOEXT_DECL void status(handle_type fd, file_status_mask mask,
+                         file_status& st, error_code& ec) ASIOEXT_NOEXCEPT;
+
+// Like status(), but for |path| relative to the directory |dir|.
+// Symbolic links are not followed.
+ASIOEXT_DECL void status_at(handle_type dir, const char* path,
+                            file_status_mask mask, file_status& st,
+                            error_code& ec) ASIOEXT_NOEXCEPT;
+
 ASIOEXT_DECL std::size_t readv(handle_type fd,
                                iovec* bufs,
                                int count,
@@ -117,6 +144,32 @@ ASIOEXT_DECL std::size_t pwritev(handle_type fd,
                                  error_code& ec) ASIOEXT_NOEXCEPT;
 #endif
 
+#if defined(ASIOEXT_HAS_NOWAIT_READS)
+// Only succeeds if the data can be read without waiting for the disk.
+// Otherwise |ec| is set to asio::error::would_block.
+ASIOEXT_DECL std::size_t preadv_nowait(handle_type fd,
+                                       iovec* bufs,
+                                       int count,
+                                       uint64_t offset,
+                                       error_code& ec) ASIOEXT_NOEXCEPT;
+#endif
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+// Opens |path| (relative to |dir|) with O_DIRECTORY added to the flags.
+ASIOEXT_DECL handle_type open_directory(handle_type dir, const char* path,
+                                        const open_args& args,
+                                        error_code& ec) ASIOEXT_NOEXCEPT;
+
+// Fills |buffer| with linux_dirent64 records. Returns 0 once the end of
+// the directory is reached.
+ASIOEXT_DECL std::size_t getdents(handle_type fd,
+                                  void* buffer, std::size_t size,
+                                  error_code& ec) ASIOEXT_NOEXCEPT;
+
+// Maps a d_type value (DT_*) to file_type.
+ASIOEXT_DECL file_type native_to_file_type(unsigned char d_type) ASIOEXT_NOEXCEPT;
+#endif
+
 }
 }
 
@@ -15,6 +15,7 @@
 #include "asioext/seek_origin.hpp"
 #include "asioext/file_perms.hpp"
 #include "asioext/file_attrs.hpp"
+#include "asioext/file_status.hpp"
 #include "asioext/error_code.hpp"
 #include "asioext/chrono.hpp"
 
@@ -79,6 +80,10 @@ ASIOEXT_DECL void attributes(handle_type fd, file_attrs attrs,
                              file_attr_options opts,
                              error_code& ec) ASIOEXT_NOEXCEPT;
 
+// Uses a single GetFileInformationByHandle() call.
+ASIOEXT_DECL void status(handle_type fd, file_status_mask mask,
+                         file_status& st, error_code& ec) ASIOEXT_NOEXCEPT;
+
 ASIOEXT_DECL void get_times(handle_type fd, file_time_type& ctime,
                             file_time_type& atime, file_time_type& mtime,
                             error_code& ec) ASIOEXT_NOEXCEPT;
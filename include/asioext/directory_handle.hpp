@@ -0,0 +1,434 @@
+/// @file
+/// Defines the directory_handle class
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_DIRECTORYHANDLE_HPP
+#define ASIOEXT_DIRECTORYHANDLE_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE) || defined(ASIOEXT_IS_DOCUMENTATION)
+
+#include "asioext/file_type.hpp"
+#include "asioext/open_args.hpp"
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/posix_file_ops.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/buffer.hpp>
+#else
+# include <asio/buffer.hpp>
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+ASIOEXT_NS_BEGIN
+
+class directory_entries;
+
+/// @ingroup files_handle
+/// @brief A single entry of a directory.
+///
+/// directory_entry objects are views into the buffer that was passed to
+/// @ref directory_handle::read_entries. They are only valid as long as the
+/// buffer's contents are left untouched.
+///
+/// All information is taken from the directory itself, so none of the
+/// accessors needs to @c stat() the entry.
+class directory_entry
+{
+public:
+  /// @brief Get the entry's inode number.
+  uint64_t inode() const ASIOEXT_NOEXCEPT
+  {
+    uint64_t ino;
+    std::memcpy(&ino, data_, sizeof(ino));
+    return ino;
+  }
+
+  /// @brief Get the entry's type.
+  ///
+  /// @return The type of the entry, or @ref file_type::unknown if the
+  /// file system doesn't report types for directory entries. Callers need
+  /// to fall back to @c stat() in that case.
+  ///
+  /// Symbolic links are not followed.
+  file_type type() const ASIOEXT_NOEXCEPT
+  {
+    return detail::posix_file_ops::native_to_file_type(data_[type_offset]);
+  }
+
+  /// @brief Get the entry's (NUL-terminated) name.
+  ///
+  /// The name is relative to the directory. The special entries
+  /// @c "." and @c ".." are included.
+  const char* name() const ASIOEXT_NOEXCEPT
+  {
+    return reinterpret_cast<const char*>(data_ + name_offset);
+  }
+
+private:
+  friend class directory_entries;
+
+  // Offsets of the members of the kernel's linux_dirent64 record.
+  // The records in the user's buffer aren't necessarily aligned,
+  // so they are accessed byte-wise.
+  static const std::size_t reclen_offset = 16;
+  static const std::size_t type_offset = 18;
+  static const std::size_t name_offset = 19;
+
+  directory_entry() ASIOEXT_NOEXCEPT
+    : data_(0)
+  {
+    // ctor
+  }
+
+  std::size_t record_size() const ASIOEXT_NOEXCEPT
+  {
+    unsigned short reclen;
+    std::memcpy(&reclen, data_ + reclen_offset, sizeof(reclen));
+    return reclen;
+  }
+
+  const unsigned char* data_;
+};
+
+/// @ingroup files_handle
+/// @brief A batch of entries returned by @ref directory_handle::read_entries.
+///
+/// This class is a lightweight view of the records stored in the caller's
+/// buffer and can be iterated over like a container of
+/// @ref directory_entry objects.
+///
+/// @par Example
+/// @code
+/// char buffer[32 * 1024];
+/// asioext::directory_handle dir;
+/// dir.open("/var/spool/ingest", asioext::open_flags::access_read |
+///                               asioext::open_flags::open_existing);
+///
+/// for (;;) {
+///   asioext::directory_entries entries =
+///       dir.read_entries(asio::buffer(buffer));
+///   if (entries.empty())
+///     break;
+///
+///   for (const asioext::directory_entry& e : entries) {
+///     if (e.type() == asioext::file_type::regular)
+///       process(dir, e.name(), e.inode());
+///   }
+/// }
+/// @endcode
+class directory_entries
+{
+public:
+  /// @brief Forward iterator over the entries of a batch.
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef directory_entry value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const directory_entry* pointer;
+    typedef const directory_entry& reference;
+
+    const_iterator() ASIOEXT_NOEXCEPT
+    {
+      // ctor
+    }
+
+    reference operator*() const ASIOEXT_NOEXCEPT
+    {
+      return entry_;
+    }
+
+    pointer operator->() const ASIOEXT_NOEXCEPT
+    {
+      return &entry_;
+    }
+
+    const_iterator& operator++() ASIOEXT_NOEXCEPT
+    {
+      entry_.data_ += entry_.record_size();
+      return *this;
+    }
+
+    const_iterator operator++(int) ASIOEXT_NOEXCEPT
+    {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const const_iterator& other) const ASIOEXT_NOEXCEPT
+    {
+      return entry_.data_ == other.entry_.data_;
+    }
+
+    bool operator!=(const const_iterator& other) const ASIOEXT_NOEXCEPT
+    {
+      return entry_.data_ != other.entry_.data_;
+    }
+
+  private:
+    friend class directory_entries;
+
+    explicit const_iterator(const unsigned char* data) ASIOEXT_NOEXCEPT
+    {
+      entry_.data_ = data;
+    }
+
+    directory_entry entry_;
+  };
+
+  /// Same as const_iterator, the entries cannot be modified.
+  typedef const_iterator iterator;
+
+  /// @brief Construct an empty batch.
+  directory_entries() ASIOEXT_NOEXCEPT
+    : data_(0)
+    , size_(0)
+  {
+    // ctor
+  }
+
+  /// @brief Construct a batch from the records stored in a buffer.
+  ///
+  /// @param data Pointer to the first record.
+  ///
+  /// @param size The total size of all records, as returned
+  /// by @c getdents64().
+  directory_entries(const void* data, std::size_t size) ASIOEXT_NOEXCEPT
+    : data_(static_cast<const unsigned char*>(data))
+    , size_(size)
+  {
+    // ctor
+  }
+
+  /// @brief Check whether the batch contains no entries.
+  ///
+  /// An empty batch signals the end of the directory.
+  bool empty() const ASIOEXT_NOEXCEPT
+  {
+    return size_ == 0;
+  }
+
+  /// @brief Get the total size of the records in bytes.
+  std::size_t size_bytes() const ASIOEXT_NOEXCEPT
+  {
+    return size_;
+  }
+
+  const_iterator begin() const ASIOEXT_NOEXCEPT
+  {
+    return const_iterator(data_);
+  }
+
+  const_iterator end() const ASIOEXT_NOEXCEPT
+  {
+    return const_iterator(data_ + size_);
+  }
+
+private:
+  const unsigned char* data_;
+  std::size_t size_;
+};
+
+/// @ingroup files_handle
+/// @brief An owning handle to an open directory.
+///
+/// The directory_handle class reads the entries of a directory in batches,
+/// filling a caller-supplied buffer with as many entries as fit into it
+/// using a single @c getdents64() call. For each entry the name, inode number
+/// and type are available without additional @c stat() calls.
+///
+/// A directory_handle can also serve as the base of relative paths for
+/// @ref open, which avoids resolving the directory's path over and over
+/// again.
+///
+/// directory_handle objects cannot be copied, but are move-constructible/
+/// move-assignable if a compiler with C++11 support is used.
+///
+/// @par Thread Safety:
+/// @e Distinct @e objects: Safe.@n
+/// @e Shared @e objects: Unsafe.
+///
+/// @note Only available on Linux
+/// (i.e. if @c ASIOEXT_HAS_DIRECTORY_HANDLE is defined).
+class directory_handle
+{
+public:
+  /// The native representation of a directory handle.
+  typedef detail::posix_file_ops::handle_type native_handle_type;
+
+  /// @brief Construct an empty directory_handle.
+  ASIOEXT_DECL directory_handle() ASIOEXT_NOEXCEPT;
+
+  /// @brief Construct a directory_handle using a native handle.
+  ///
+  /// This constructor takes ownership of the given native handle.
+  ASIOEXT_DECL explicit directory_handle(
+      const native_handle_type& handle) ASIOEXT_NOEXCEPT;
+
+  /// Destroy a directory_handle.
+  ///
+  /// This destructor attempts to close the currently owned handle.
+  /// Failures are silently ignored.
+  ASIOEXT_DECL ~directory_handle();
+
+#ifdef ASIOEXT_HAS_MOVE
+  /// @brief Move-construct a directory_handle from another.
+  ///
+  /// @note Following the move, the moved-from object is in the same state as if
+  /// constructed using the @c directory_handle() constructor.
+  ASIOEXT_DECL directory_handle(directory_handle&& other) ASIOEXT_NOEXCEPT;
+
+  /// @brief Move-assign a directory_handle from another.
+  ///
+  /// If this object already owns a handle, the current handle will be
+  /// closed.
+  ///
+  /// @note Following the move, the moved-from object is in the same state as if
+  /// constructed using the @c directory_handle() constructor.
+  ASIOEXT_DECL directory_handle& operator=(directory_handle&& other);
+#endif
+
+  /// @brief Open a directory.
+  ///
+  /// This function opens the specified directory. If the directory_handle
+  /// already owns a handle, it is closed first.
+  ///
+  /// @param path The path of the directory to open.
+  ///
+  /// @param args Options used to open the directory. Usually
+  /// <tt>open_flags::access_read | open_flags::open_existing</tt>.
+  /// Opening anything else than a directory fails with @c ENOTDIR.
+  ///
+  /// @throws asio::system_error Thrown on failure.
+  ASIOEXT_DECL void open(const char* path, const open_args& args);
+
+  /// @brief Open a directory.
+  ///
+  /// @copydetails open(const char*,const open_args&)
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ASIOEXT_DECL void open(const char* path, const open_args& args,
+                         error_code& ec) ASIOEXT_NOEXCEPT;
+
+  /// @brief Open a directory relative to another one.
+  ///
+  /// This function opens the directory @c path, which is interpreted
+  /// relative to @c dir (unless it is absolute).
+  ///
+  /// @throws asio::system_error Thrown on failure.
+  ASIOEXT_DECL void open(const directory_handle& dir, const char* path,
+                         const open_args& args);
+
+  /// @brief Open a directory relative to another one.
+  ///
+  /// This function opens the directory @c path, which is interpreted
+  /// relative to @c dir (unless it is absolute).
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ASIOEXT_DECL void open(const directory_handle& dir, const char* path,
+                         const open_args& args,
+                         error_code& ec) ASIOEXT_NOEXCEPT;
+
+  /// @brief Determine whether the handle is open.
+  bool is_open() const ASIOEXT_NOEXCEPT
+  {
+    return handle_ != -1;
+  }
+
+  /// @brief Get the native handle representation.
+  ///
+  /// Ownership is not transferred to the caller.
+  native_handle_type native_handle() const ASIOEXT_NOEXCEPT
+  {
+    return handle_;
+  }
+
+  /// @brief Take ownership of the contained native handle.
+  ///
+  /// The directory_handle object is reset to an empty state.
+  ASIOEXT_DECL native_handle_type release() ASIOEXT_NOEXCEPT;
+
+  /// @brief Close the handle.
+  ///
+  /// @throws asio::system_error Thrown on failure.
+  ASIOEXT_DECL void close();
+
+  /// @brief Close the handle.
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ASIOEXT_DECL void close(error_code& ec) ASIOEXT_NOEXCEPT;
+
+  /// @brief Read the next batch of entries.
+  ///
+  /// This function fills the given buffer with as many entries as fit into
+  /// it, using a single system call. Larger buffers mean fewer calls; 32 KiB
+  /// hold roughly a thousand entries with typical name lengths.
+  ///
+  /// @param buffer The buffer the entries are stored in. It must be able to
+  /// hold at least the next entry (i.e. be larger than @c NAME_MAX + 20
+  /// bytes), otherwise the call fails with @c EINVAL.
+  ///
+  /// @return A view of the entries stored in @c buffer. An empty batch
+  /// means that the end of the directory was reached.
+  ///
+  /// @throws asio::system_error Thrown on failure.
+  ASIOEXT_DECL directory_entries read_entries(
+      const asio::mutable_buffer& buffer);
+
+  /// @brief Read the next batch of entries.
+  ///
+  /// @copydetails read_entries(const asio::mutable_buffer&)
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ASIOEXT_DECL directory_entries read_entries(
+      const asio::mutable_buffer& buffer, error_code& ec) ASIOEXT_NOEXCEPT;
+
+  /// @brief Restart reading at the directory's first entry.
+  ///
+  /// @throws asio::system_error Thrown on failure.
+  ASIOEXT_DECL void rewind();
+
+  /// @brief Restart reading at the directory's first entry.
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ASIOEXT_DECL void rewind(error_code& ec) ASIOEXT_NOEXCEPT;
+
+private:
+  // Prevent copying
+  directory_handle(const directory_handle&) ASIOEXT_DELETED;
+  directory_handle& operator=(const directory_handle&) ASIOEXT_DELETED;
+
+  native_handle_type handle_;
+};
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/impl/directory_handle.cpp"
+#endif
+
+#endif
+
+#endif
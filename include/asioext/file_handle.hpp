@@ -15,6 +15,7 @@
 #endif
 
 #include "asioext/seek_origin.hpp"
+#include "asioext/file_status.hpp"
 #include "asioext/error_code.hpp"
 #include "asioext/chrono.hpp"
 
@@ -473,6 +474,39 @@ public:
   ASIOEXT_DECL void times(const file_times& new_times,
                           error_code& ec) ASIOEXT_NOEXCEPT;
 
+  /// @brief Get multiple metadata values at once.
+  ///
+  /// This function retrieves the requested members of a @c file_status
+  /// structure with a single system call (@c statx() on Linux,
+  /// @c fstat() on other POSIX systems), where calling size(),
+  /// permissions(), attributes() and times() separately would require
+  /// one call each.
+  ///
+  /// @param mask The members to retrieve. Unrequested members
+  /// are zero-initialized.
+  ///
+  /// @return The file's metadata.
+  ///
+  /// @throws asio::system_error Thrown on failure.
+  ASIOEXT_DECL file_status status(
+      file_status_mask mask = file_status_mask::all);
+
+  /// @brief Get multiple metadata values at once.
+  ///
+  /// This function retrieves the requested members of a @c file_status
+  /// structure with a single system call (@c statx() on Linux,
+  /// @c fstat() on other POSIX systems).
+  ///
+  /// @param mask The members to retrieve. Unrequested members
+  /// are zero-initialized.
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ///
+  /// @return The file's metadata.
+  ASIOEXT_DECL file_status status(file_status_mask mask,
+                                  error_code& ec) ASIOEXT_NOEXCEPT;
+
   /// @}
 
   /// @name SyncReadStream functions
@@ -0,0 +1,178 @@
+/// @file
+/// Declares the asioext::file_io_observer interface.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_FILEIOOBSERVER_HPP
+#define ASIOEXT_FILEIOOBSERVER_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/error_code.hpp"
+#include "asioext/chrono.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+
+#include <cstddef> // for size_t
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup files
+/// @defgroup file_io_observer File I/O tracing
+/// @brief Observe the system calls made on file handles.
+///
+/// AsioExt can report every file system call it makes (@c open, @c close,
+/// @c read, @c pread, ...) to a user-supplied @ref file_io_observer.
+/// This is intended for feeding tracing systems or profilers that need to
+/// find hot files or pathological access patterns (e.g. many small reads).
+///
+/// Since this adds a clock read and an indirect call to each operation,
+/// support is compiled in only if @ref ASIOEXT_ENABLE_FILE_IO_OBSERVER is
+/// defined. Otherwise the tracing hooks are empty inline functions and
+/// disappear completely.
+///
+/// @par Example
+/// @code
+/// class printing_observer : public asioext::file_io_observer
+/// {
+/// public:
+///   void on_file_io(const asioext::file_io_event& ev) ASIOEXT_NOEXCEPT
+///   {
+///     std::printf("op %d: %zu/%zu bytes in %lld ns\n",
+///                 static_cast<int>(ev.operation), ev.transferred, ev.size,
+///                 static_cast<long long>(ev.duration.count()));
+///   }
+/// };
+///
+/// printing_observer obs;
+/// asioext::set_file_io_observer(&obs);
+/// @endcode
+///
+/// @{
+
+/// @brief Type of a traced file operation.
+enum class file_io_operation
+{
+  /// @brief A file was opened. @c handle is the new handle.
+  open,
+
+  /// @brief A file handle was closed.
+  close,
+
+  /// @brief Data was read from the current file position.
+  read,
+
+  /// @brief Data was written to the current file position.
+  write,
+
+  /// @brief Data was read from a specific offset.
+  read_at,
+
+  /// @brief Data was written to a specific offset.
+  write_at,
+};
+
+/// @brief Description of a single traced file operation.
+struct file_io_event
+{
+#if defined(ASIOEXT_IS_DOCUMENTATION)
+  /// @brief The platform-specific handle type.
+  typedef implementation_defined native_handle_type;
+#elif defined(ASIOEXT_WINDOWS)
+  typedef void* native_handle_type;
+#else
+  typedef int native_handle_type;
+#endif
+
+  /// @brief The traced operation.
+  file_io_operation operation;
+
+  /// @brief The handle the operation was performed on.
+  ///
+  /// For @ref file_io_operation::open this is the newly opened handle
+  /// (or the platform's invalid handle value if the call failed).
+  native_handle_type handle;
+
+  /// @brief The filename passed to @c open().
+  ///
+  /// Only set for @ref file_io_operation::open with narrow-character
+  /// filenames. @c NULL otherwise.
+  const char* path;
+
+  /// @brief The file offset for @c read_at and @c write_at. Zero otherwise.
+  uint64_t offset;
+
+  /// @brief The number of bytes requested.
+  std::size_t size;
+
+  /// @brief The number of buffers the request was split into.
+  std::size_t buffer_count;
+
+  /// @brief The number of bytes actually transferred.
+  std::size_t transferred;
+
+  /// @brief Time spent inside the system call(s).
+  chrono::nanoseconds duration;
+
+  /// @brief The result of the operation.
+  error_code ec;
+};
+
+/// @brief Interface for receiving file_io_event notifications.
+///
+/// Implementations are invoked synchronously on the thread that performed the
+/// operation, which for asynchronous file services is one of the service's
+/// worker threads. Implementations therefore need to be thread-safe and
+/// should return quickly.
+class file_io_observer
+{
+public:
+  virtual ~file_io_observer() {}
+
+  /// @brief Called after a file operation completed.
+  ///
+  /// @param ev Description of the completed operation. The referenced
+  /// object (including @c ev.path) is only valid for the duration
+  /// of the call.
+  ///
+  /// @note This function must not throw.
+  virtual void on_file_io(const file_io_event& ev) ASIOEXT_NOEXCEPT = 0;
+};
+
+#if defined(ASIOEXT_ENABLE_FILE_IO_OBSERVER) || \
+    defined(ASIOEXT_IS_DOCUMENTATION)
+/// @brief Install the process-wide file_io_observer.
+///
+/// @param observer The new observer or @c NULL to disable tracing.
+/// The observer has to remain valid until it is replaced.
+///
+/// @return The previously installed observer.
+///
+/// @note Only available if @ref ASIOEXT_ENABLE_FILE_IO_OBSERVER is defined.
+ASIOEXT_DECL file_io_observer* set_file_io_observer(
+    file_io_observer* observer) ASIOEXT_NOEXCEPT;
+
+/// @brief Get the currently installed file_io_observer.
+///
+/// @return The current observer or @c NULL if none is installed.
+///
+/// @note Only available if @ref ASIOEXT_ENABLE_FILE_IO_OBSERVER is defined.
+ASIOEXT_DECL file_io_observer* get_file_io_observer() ASIOEXT_NOEXCEPT;
+#endif
+
+/// @}
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY) && defined(ASIOEXT_ENABLE_FILE_IO_OBSERVER)
+# include "asioext/impl/file_io_observer.cpp"
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+/// @file
+/// Defines the file_status struct and the file_status_mask enum.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_FILESTATUS_HPP
+#define ASIOEXT_FILESTATUS_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/file_type.hpp"
+#include "asioext/file_perms.hpp"
+#include "asioext/file_attrs.hpp"
+#include "asioext/chrono.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/enum.hpp"
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup files_meta
+/// @brief Selects the members of a @ref file_status.
+///
+/// @c file_status_mask meets the requirements
+/// of [BitmaskType](http://en.cppreference.com/w/cpp/concept/BitmaskType).
+enum class file_status_mask
+{
+  /// No members.
+  none = 0,
+
+  /// @ref file_status::type
+  type = 1 << 0,
+
+  /// @ref file_status::size
+  size = 1 << 1,
+
+  /// @ref file_status::perms
+  perms = 1 << 2,
+
+  /// @ref file_status::attrs
+  attrs = 1 << 3,
+
+  /// @ref file_status::ctime, @ref file_status::atime and
+  /// @ref file_status::mtime
+  times = 1 << 4,
+
+  /// All members.
+  all = type | size | perms | attrs | times,
+};
+
+ASIOEXT_ENUM_CLASS_BITMASK_OPS(file_status_mask)
+
+/// @ingroup files_meta
+/// @brief Metadata of a file, as returned by
+/// @ref file_handle::status(file_status_mask).
+///
+/// Only the members selected by @ref mask are set, all others are
+/// zero-initialized.
+struct file_status
+{
+  file_status() ASIOEXT_NOEXCEPT
+    : mask(file_status_mask::none)
+    , type(file_type::unknown)
+    , size(0)
+    , perms(file_perms::none)
+    , attrs(file_attrs::none)
+    , ctime()
+    , atime()
+    , mtime()
+  {
+    // ctor
+  }
+
+  /// @brief The members that were requested.
+  file_status_mask mask;
+
+  /// @brief The file's type.
+  file_type type;
+
+  /// @brief The file's size in bytes.
+  uint64_t size;
+
+  /// @brief The file's permissions.
+  file_perms perms;
+
+  /// @brief The file's attributes.
+  file_attrs attrs;
+
+  /// @brief The file's creation time. Zero if the platform or
+  /// file system doesn't record it.
+  file_time_type ctime;
+
+  /// @brief The file's last access time.
+  file_time_type atime;
+
+  /// @brief The file's last modification time.
+  file_time_type mtime;
+};
+
+ASIOEXT_NS_END
+
+#endif
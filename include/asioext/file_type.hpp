@@ -0,0 +1,52 @@
+/// @file
+/// Defines the file_type enum
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_FILETYPE_HPP
+#define ASIOEXT_FILETYPE_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup files_handle
+/// @brief Specifies the type of a file system object.
+enum class file_type
+{
+  /// The type isn't known, e.g. because the file system doesn't
+  /// report it for directory entries.
+  unknown,
+
+  /// A regular file.
+  regular,
+
+  /// A directory.
+  directory,
+
+  /// A symbolic link.
+  symlink,
+
+  /// A block device.
+  block,
+
+  /// A character device.
+  character,
+
+  /// A named pipe.
+  fifo,
+
+  /// A Unix domain socket.
+  socket,
+};
+
+ASIOEXT_NS_END
+
+#endif
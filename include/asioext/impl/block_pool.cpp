@@ -0,0 +1,52 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/block_pool.hpp"
+
+#include <new>
+
+ASIOEXT_NS_BEGIN
+
+block_pool::~block_pool()
+{
+  release();
+}
+
+uint8_t* block_pool::allocate()
+{
+  if (free_list_) {
+    free_block* b = free_list_;
+    free_list_ = b->next;
+    --cached_blocks_;
+    return reinterpret_cast<uint8_t*>(b);
+  }
+
+  return static_cast<uint8_t*>(::operator new(block_size_));
+}
+
+void block_pool::deallocate(uint8_t* block) ASIOEXT_NOEXCEPT
+{
+  if (cached_blocks_ == max_cached_blocks_) {
+    ::operator delete(block);
+    return;
+  }
+
+  free_block* b = reinterpret_cast<free_block*>(block);
+  b->next = free_list_;
+  free_list_ = b;
+  ++cached_blocks_;
+}
+
+void block_pool::release() ASIOEXT_NOEXCEPT
+{
+  while (free_list_) {
+    free_block* b = free_list_;
+    free_list_ = b->next;
+    ::operator delete(b);
+  }
+  cached_blocks_ = 0;
+}
+
+ASIOEXT_NS_END
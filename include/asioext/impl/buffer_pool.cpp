@@ -0,0 +1,498 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/buffer_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <utility>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// Counters are only ever written by the thread owning the cache, so a
+// relaxed load/store pair is enough and avoids locked instructions.
+template <typename T>
+inline void increment(std::atomic<T>& counter, T n) ASIOEXT_NOEXCEPT
+{
+  counter.store(counter.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+}
+
+struct buffer_pool_thread_cache
+{
+  explicit buffer_pool_thread_cache(std::size_t num_classes)
+    : lists(num_classes)
+    , active(true)
+    , allocations(0)
+    , hits(0)
+    , shared_hits(0)
+    , misses(0)
+    , cached_bytes(0)
+    , allocated_bytes(0)
+    , deallocated_bytes(0)
+  {
+    for (std::size_t i = 0; i != num_classes; ++i) {
+      lists[i].head = nullptr;
+      lists[i].count = 0;
+    }
+  }
+
+  std::vector<buffer_pool::free_list> lists;
+
+  // Whether a thread currently owns this cache. Protected by the pool's
+  // mutex.
+  bool active;
+
+  std::atomic<uint64_t> allocations;
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> shared_hits;
+  std::atomic<uint64_t> misses;
+  std::atomic<std::size_t> cached_bytes;
+  std::atomic<std::size_t> allocated_bytes;
+  std::atomic<std::size_t> deallocated_bytes;
+};
+
+// All live pools, so that exiting threads know whether the pools they have
+// caches for still exist.
+struct buffer_pool_registry
+{
+  buffer_pool_registry()
+    : last_id(0)
+  {
+    // ctor
+  }
+
+  static buffer_pool_registry& instance()
+  {
+    static buffer_pool_registry registry;
+    return registry;
+  }
+
+  uint64_t next_id()
+  {
+    return ++last_id;
+  }
+
+  // Requires |pools_mutex| to be held.
+  buffer_pool* find(uint64_t id) const ASIOEXT_NOEXCEPT
+  {
+    for (std::size_t i = 0, n = pools.size(); i != n; ++i) {
+      if (pools[i].first == id)
+        return pools[i].second;
+    }
+    return nullptr;
+  }
+
+  mutex pools_mutex;
+  std::vector<std::pair<uint64_t, buffer_pool*> > pools;
+  std::atomic<uint64_t> last_id;
+};
+
+// The calling thread's caches of all pools it used.
+class buffer_pool_tls
+{
+public:
+  static buffer_pool_tls& instance()
+  {
+    static thread_local buffer_pool_tls tls;
+    return tls;
+  }
+
+  buffer_pool_tls()
+    : last_id_(0)
+    , last_cache_(nullptr)
+    , prune_threshold_(16)
+  {
+    // ctor
+  }
+
+  ~buffer_pool_tls()
+  {
+    buffer_pool_registry& registry = buffer_pool_registry::instance();
+    mutex::scoped_lock lock(registry.pools_mutex);
+    for (std::size_t i = 0, n = entries_.size(); i != n; ++i) {
+      if (buffer_pool* pool = registry.find(entries_[i].first))
+        pool->retire(*entries_[i].second);
+    }
+  }
+
+  buffer_pool_thread_cache* find(uint64_t id) ASIOEXT_NOEXCEPT
+  {
+    if (last_id_ == id)
+      return last_cache_;
+
+    for (std::size_t i = 0, n = entries_.size(); i != n; ++i) {
+      if (entries_[i].first == id) {
+        last_id_ = id;
+        last_cache_ = entries_[i].second;
+        return last_cache_;
+      }
+    }
+    return nullptr;
+  }
+
+  // Make sure that the next add() doesn't throw.
+  void reserve()
+  {
+    if (entries_.size() >= prune_threshold_)
+      prune();
+    entries_.reserve(entries_.size() + 1);
+  }
+
+  void add(uint64_t id, buffer_pool_thread_cache* cache) ASIOEXT_NOEXCEPT
+  {
+    entries_.push_back(std::make_pair(id, cache));
+    last_id_ = id;
+    last_cache_ = cache;
+  }
+
+private:
+  // Forget the caches of pools that were destroyed in the meantime.
+  void prune() ASIOEXT_NOEXCEPT
+  {
+    buffer_pool_registry& registry = buffer_pool_registry::instance();
+    mutex::scoped_lock lock(registry.pools_mutex);
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0, n = entries_.size(); i != n; ++i) {
+      if (registry.find(entries_[i].first))
+        entries_[kept++] = entries_[i];
+    }
+    entries_.resize(kept);
+
+    last_id_ = 0;
+    last_cache_ = nullptr;
+    prune_threshold_ = (std::max)(std::size_t(16), 2 * kept);
+  }
+
+  std::vector<std::pair<uint64_t, buffer_pool_thread_cache*> > entries_;
+  uint64_t last_id_;
+  buffer_pool_thread_cache* last_cache_;
+  std::size_t prune_threshold_;
+};
+
+}
+
+pooled_buffer& pooled_buffer::operator=(pooled_buffer&& other) ASIOEXT_NOEXCEPT
+{
+  if (this != &other) {
+    reset();
+    pool_ = other.pool_;
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    other.pool_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = other.capacity_ = 0;
+  }
+  return *this;
+}
+
+void pooled_buffer::reset() ASIOEXT_NOEXCEPT
+{
+  if (data_) {
+    pool_->deallocate(data_, size_);
+    pool_ = nullptr;
+    data_ = nullptr;
+    size_ = capacity_ = 0;
+  }
+}
+
+buffer_pool::buffer_pool(std::size_t min_buffer_size,
+                         std::size_t max_buffer_size,
+                         std::size_t thread_cache_size)
+  : id_(detail::buffer_pool_registry::instance().next_id())
+  , min_buffer_size_(sizeof(free_block))
+  , max_buffer_size_(0)
+  , num_classes_(1)
+  , thread_cache_size_(thread_cache_size)
+  , shared_bytes_(0)
+{
+  while (min_buffer_size_ < min_buffer_size)
+    min_buffer_size_ <<= 1;
+
+  max_buffer_size_ = min_buffer_size_;
+  while (max_buffer_size_ < max_buffer_size) {
+    max_buffer_size_ <<= 1;
+    ++num_classes_;
+  }
+
+  free_list empty = { nullptr, 0 };
+  shared_.assign(num_classes_, empty);
+
+  detail::buffer_pool_registry& registry =
+      detail::buffer_pool_registry::instance();
+  detail::mutex::scoped_lock lock(registry.pools_mutex);
+  registry.pools.push_back(std::make_pair(id_, this));
+}
+
+buffer_pool::~buffer_pool()
+{
+  {
+    detail::buffer_pool_registry& registry =
+        detail::buffer_pool_registry::instance();
+    detail::mutex::scoped_lock lock(registry.pools_mutex);
+    for (std::size_t i = 0, n = registry.pools.size(); i != n; ++i) {
+      if (registry.pools[i].first == id_) {
+        registry.pools.erase(registry.pools.begin() + i);
+        break;
+      }
+    }
+  }
+
+  // Threads that used this pool still refer to their caches, but never
+  // touch them again since the pool isn't registered anymore.
+  for (std::size_t i = 0; i != num_classes_; ++i)
+    free_all(shared_[i]);
+
+  for (std::size_t i = 0, n = caches_.size(); i != n; ++i) {
+    for (std::size_t j = 0; j != num_classes_; ++j)
+      free_all(caches_[i]->lists[j]);
+    delete caches_[i];
+  }
+}
+
+std::size_t buffer_pool::buffer_size(std::size_t size) const ASIOEXT_NOEXCEPT
+{
+  if (size > max_buffer_size_)
+    return size;
+  return min_buffer_size_ << size_class(size);
+}
+
+pooled_buffer buffer_pool::acquire(std::size_t size)
+{
+  uint8_t* data = static_cast<uint8_t*>(allocate(size));
+  return pooled_buffer(this, data, size, buffer_size(size));
+}
+
+void* buffer_pool::allocate(std::size_t size)
+{
+  detail::buffer_pool_thread_cache& cache = thread_cache();
+  detail::increment(cache.allocations, uint64_t(1));
+
+  if (size > max_buffer_size_) {
+    void* p = ::operator new(size);
+    detail::increment(cache.misses, uint64_t(1));
+    detail::increment(cache.allocated_bytes, size);
+    return p;
+  }
+
+  const std::size_t index = size_class(size);
+  const std::size_t bytes = min_buffer_size_ << index;
+  free_list& list = cache.lists[index];
+
+  std::atomic<uint64_t>* hit_counter = &cache.hits;
+  if (!list.head) {
+    // Refill half of the cache from the overflow list.
+    const std::size_t batch = (std::max)(thread_cache_size_ / 2,
+                                         std::size_t(1));
+
+    detail::mutex::scoped_lock lock(mutex_);
+    free_list& shared = shared_[index];
+    std::size_t n = 0;
+    for (; n != batch && shared.head; ++n) {
+      free_block* b = shared.head;
+      shared.head = b->next;
+      b->next = list.head;
+      list.head = b;
+    }
+
+    shared.count -= n;
+    shared_bytes_ -= n * bytes;
+    list.count += n;
+    detail::increment(cache.cached_bytes, n * bytes);
+    hit_counter = &cache.shared_hits;
+  }
+
+  if (list.head) {
+    free_block* b = list.head;
+    list.head = b->next;
+    --list.count;
+    detail::increment(*hit_counter, uint64_t(1));
+    detail::increment(cache.cached_bytes, 0 - bytes);
+    detail::increment(cache.allocated_bytes, bytes);
+    return b;
+  }
+
+  void* p = ::operator new(bytes);
+  detail::increment(cache.misses, uint64_t(1));
+  detail::increment(cache.allocated_bytes, bytes);
+  return p;
+}
+
+void buffer_pool::deallocate(void* p, std::size_t size) ASIOEXT_NOEXCEPT
+{
+  if (!p)
+    return;
+
+  detail::buffer_pool_thread_cache* cache;
+  try {
+    cache = &thread_cache();
+  } catch (...) {
+    cache = nullptr;
+  }
+
+  if (size > max_buffer_size_) {
+    ::operator delete(p);
+    if (cache)
+      detail::increment(cache->deallocated_bytes, size);
+    return;
+  }
+
+  const std::size_t index = size_class(size);
+  const std::size_t bytes = min_buffer_size_ << index;
+  free_block* b = static_cast<free_block*>(p);
+
+  if (!cache) {
+    // Out of memory for a thread cache: hand the buffer to the overflow
+    // list directly.
+    detail::mutex::scoped_lock lock(mutex_);
+    b->next = shared_[index].head;
+    shared_[index].head = b;
+    ++shared_[index].count;
+    shared_bytes_ += bytes;
+    return;
+  }
+
+  free_list& list = cache->lists[index];
+  b->next = list.head;
+  list.head = b;
+  ++list.count;
+  detail::increment(cache->cached_bytes, bytes);
+  detail::increment(cache->deallocated_bytes, bytes);
+
+  if (list.count > thread_cache_size_) {
+    // Move half of the cache to the overflow list.
+    std::size_t n = list.count - thread_cache_size_ / 2;
+    free_block* first = list.head;
+    free_block* last = first;
+    for (std::size_t i = 1; i != n; ++i)
+      last = last->next;
+
+    list.head = last->next;
+    list.count -= n;
+    detail::increment(cache->cached_bytes, 0 - n * bytes);
+
+    detail::mutex::scoped_lock lock(mutex_);
+    last->next = shared_[index].head;
+    shared_[index].head = first;
+    shared_[index].count += n;
+    shared_bytes_ += n * bytes;
+  }
+}
+
+buffer_pool_stats buffer_pool::stats() const
+{
+  buffer_pool_stats s = buffer_pool_stats();
+  std::size_t allocated = 0, deallocated = 0;
+
+  detail::mutex::scoped_lock lock(mutex_);
+  s.bytes_cached = shared_bytes_;
+  for (std::size_t i = 0, n = caches_.size(); i != n; ++i) {
+    const detail::buffer_pool_thread_cache& c = *caches_[i];
+    s.allocations += c.allocations.load(std::memory_order_relaxed);
+    s.thread_cache_hits += c.hits.load(std::memory_order_relaxed);
+    s.shared_hits += c.shared_hits.load(std::memory_order_relaxed);
+    s.misses += c.misses.load(std::memory_order_relaxed);
+    s.bytes_cached += c.cached_bytes.load(std::memory_order_relaxed);
+    allocated += c.allocated_bytes.load(std::memory_order_relaxed);
+    deallocated += c.deallocated_bytes.load(std::memory_order_relaxed);
+  }
+
+  // Buffers can be freed by a different thread than the one that
+  // allocated them, so only the sum is meaningful.
+  s.bytes_in_use = allocated - deallocated;
+  return s;
+}
+
+void buffer_pool::release() ASIOEXT_NOEXCEPT
+{
+  if (detail::buffer_pool_thread_cache* cache =
+          detail::buffer_pool_tls::instance().find(id_)) {
+    for (std::size_t i = 0; i != num_classes_; ++i)
+      free_all(cache->lists[i]);
+    cache->cached_bytes.store(0, std::memory_order_relaxed);
+  }
+
+  detail::mutex::scoped_lock lock(mutex_);
+  for (std::size_t i = 0; i != num_classes_; ++i)
+    free_all(shared_[i]);
+  shared_bytes_ = 0;
+}
+
+std::size_t buffer_pool::size_class(std::size_t size) const ASIOEXT_NOEXCEPT
+{
+  std::size_t index = 0;
+  for (std::size_t class_size = min_buffer_size_; class_size < size;
+       class_size <<= 1)
+    ++index;
+  return index;
+}
+
+detail::buffer_pool_thread_cache& buffer_pool::thread_cache()
+{
+  detail::buffer_pool_tls& tls = detail::buffer_pool_tls::instance();
+  if (detail::buffer_pool_thread_cache* cache = tls.find(id_))
+    return *cache;
+
+  tls.reserve();
+
+  // Reuse the cache of a thread that exited, if there is one.
+  detail::mutex::scoped_lock lock(mutex_);
+  detail::buffer_pool_thread_cache* cache = nullptr;
+  for (std::size_t i = 0, n = caches_.size(); i != n; ++i) {
+    if (!caches_[i]->active) {
+      cache = caches_[i];
+      cache->active = true;
+      break;
+    }
+  }
+
+  if (!cache) {
+    caches_.reserve(caches_.size() + 1);
+    cache = new detail::buffer_pool_thread_cache(num_classes_);
+    caches_.push_back(cache);
+  }
+
+  tls.add(id_, cache);
+  return *cache;
+}
+
+void buffer_pool::retire(
+    detail::buffer_pool_thread_cache& cache) ASIOEXT_NOEXCEPT
+{
+  detail::mutex::scoped_lock lock(mutex_);
+  for (std::size_t i = 0; i != num_classes_; ++i) {
+    free_list& list = cache.lists[i];
+    while (list.head) {
+      free_block* b = list.head;
+      list.head = b->next;
+      b->next = shared_[i].head;
+      shared_[i].head = b;
+    }
+
+    shared_[i].count += list.count;
+    shared_bytes_ += list.count * (min_buffer_size_ << i);
+    list.count = 0;
+  }
+
+  cache.cached_bytes.store(0, std::memory_order_relaxed);
+  cache.active = false;
+}
+
+void buffer_pool::free_all(free_list& list) ASIOEXT_NOEXCEPT
+{
+  while (list.head) {
+    free_block* b = list.head;
+    list.head = b->next;
+    ::operator delete(b);
+  }
+  list.count = 0;
+}
+
+ASIOEXT_NS_END
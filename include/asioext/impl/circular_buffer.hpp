@@ -0,0 +1,186 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_IMPL_CIRCULARBUFFER_HPP
+#define ASIOEXT_IMPL_CIRCULARBUFFER_HPP
+
+#include <cstring>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// Round |n| up to the next power of two. Returns 0 on overflow.
+inline std::size_t next_power_of_two(std::size_t n) ASIOEXT_NOEXCEPT
+{
+  if (n <= 1)
+    return 1;
+
+  std::size_t p = 1;
+  while (p < n && p != 0)
+    p <<= 1;
+  return p;
+}
+
+}
+
+template <typename Allocator>
+basic_circular_buffer<Allocator>::basic_circular_buffer(
+    std::size_t initial_capacity, std::size_t maximum_size)
+  : rep_()
+  , capacity_(0)
+  , head_(0)
+  , size_(0)
+  , prepared_(0)
+  , max_size_((std::min)(allocator_traits_type::max_size(rep_),
+                         maximum_size))
+{
+  if (initial_capacity != 0)
+    grow(initial_capacity);
+}
+
+template <typename Allocator>
+basic_circular_buffer<Allocator>::basic_circular_buffer(
+    const basic_circular_buffer& other)
+  : rep_()
+  , capacity_(0)
+  , head_(0)
+  , size_(0)
+  , prepared_(0)
+  , max_size_(other.max_size_)
+{
+  if (other.size_ != 0) {
+    grow(other.size_);
+    size_ = asio::buffer_copy(segments(0, other.size_), other.data());
+  }
+}
+
+template <typename Allocator>
+basic_circular_buffer<Allocator>& basic_circular_buffer<Allocator>::operator=(
+    const basic_circular_buffer& other)
+{
+  if (this == &other)
+    return *this;
+
+  clear();
+  if (other.size_ > capacity_)
+    grow(other.size_);
+
+  size_ = asio::buffer_copy(segments(0, other.size_), other.data());
+  return *this;
+}
+
+#if defined(ASIOEXT_HAS_MOVE)
+template <typename Allocator>
+basic_circular_buffer<Allocator>& basic_circular_buffer<Allocator>::operator=(
+    basic_circular_buffer&& other)
+    ASIOEXT_NOEXCEPT_IF(allocator_traits_type::
+                        propagate_on_container_move_assignment::value)
+{
+  if (this == &other)
+    return *this;
+
+  const bool propagate =
+      allocator_traits_type::propagate_on_container_move_assignment::value;
+  if (!propagate && static_cast<allocator_type&>(rep_) !=
+                    static_cast<allocator_type&>(other.rep_)) {
+    // We can't free memory allocated by |other|'s allocator.
+    max_size_ = other.max_size_;
+    *this = static_cast<const basic_circular_buffer&>(other);
+    other.clear();
+    return *this;
+  }
+
+  if (rep_.data_)
+    allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
+
+  move_allocator(other, std::integral_constant<bool, propagate>());
+  rep_.data_ = other.rep_.data_;
+  capacity_ = other.capacity_;
+  head_ = other.head_;
+  size_ = other.size_;
+  prepared_ = other.prepared_;
+  max_size_ = other.max_size_;
+
+  other.rep_.data_ = nullptr;
+  other.capacity_ = other.head_ = other.size_ = other.prepared_ = 0;
+  return *this;
+}
+#endif
+
+template <typename Allocator>
+typename basic_circular_buffer<Allocator>::mutable_buffers_type
+basic_circular_buffer<Allocator>::prepare(std::size_t n)
+{
+  if (size_ > max_size_ || max_size_ - size_ < n) {
+    std::length_error ex("basic_circular_buffer too long");
+    detail::throw_exception(ex);
+  }
+
+  if (size_ + n > capacity_)
+    grow(size_ + n);
+
+  prepared_ = n;
+  return segments((head_ + size_) & (capacity_ - 1), n);
+}
+
+template <typename Allocator>
+typename basic_circular_buffer<Allocator>::mutable_buffers_type
+basic_circular_buffer<Allocator>::prepare(std::size_t n, error_code& ec)
+{
+  if (size_ > max_size_ || max_size_ - size_ < n) {
+    ec = asio::error::no_memory;
+    return mutable_buffers_type();
+  }
+
+  ec = error_code();
+  return prepare(n);
+}
+
+template <typename Allocator>
+void basic_circular_buffer<Allocator>::append(const void* data, std::size_t n)
+{
+  asio::buffer_copy(prepare(n), asio::buffer(data, n));
+  commit(n);
+}
+
+template <typename Allocator>
+void basic_circular_buffer<Allocator>::reserve(std::size_t n)
+{
+  if (n > max_size_) {
+    std::length_error ex("basic_circular_buffer too long");
+    detail::throw_exception(ex);
+  }
+
+  if (n > capacity_)
+    grow(n);
+}
+
+template <typename Allocator>
+void basic_circular_buffer<Allocator>::grow(std::size_t n)
+{
+  const std::size_t cap = detail::next_power_of_two(n);
+  if (cap == 0 || cap > allocator_traits_type::max_size(rep_)) {
+    std::length_error ex("basic_circular_buffer too long");
+    detail::throw_exception(ex);
+  }
+
+  uint8_t* new_buffer = allocator_traits_type::allocate(rep_, cap);
+  if (rep_.data_) {
+    // Linearize the input sequence.
+    const std::size_t first = (std::min)(size_, capacity_ - head_);
+    std::memcpy(new_buffer, rep_.data_ + head_, first);
+    std::memcpy(new_buffer + first, rep_.data_, size_ - first);
+    allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
+  }
+
+  rep_.data_ = new_buffer;
+  capacity_ = cap;
+  head_ = 0;
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -8,33 +8,379 @@
 
 #include "asioext/composed_operation.hpp"
 #include "asioext/bind_handler.hpp"
+#include "asioext/chrono.hpp"
+
+#include "asioext/detail/asio_version.hpp"
+#include "asioext/detail/handler_work.hpp"
 
 #if defined(ASIOEXT_USE_BOOST_ASIO)
-# include <boost/asio/connect.hpp>
+# include <boost/asio/error.hpp>
+# include <boost/asio/strand.hpp>
+# if ASIOEXT_ASIO_VERSION >= 101200
+#  include <boost/asio/associated_executor.hpp>
+#  include <boost/asio/post.hpp>
+# endif
 #else
-# include <asio/connect.hpp>
+# include <asio/error.hpp>
+# include <asio/strand.hpp>
+# if ASIOEXT_ASIO_VERSION >= 101200
+#  include <asio/associated_executor.hpp>
+#  include <asio/post.hpp>
+# endif
 #endif
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 ASIOEXT_NS_BEGIN
 
 namespace detail {
 
+template <typename State>
+class happy_eyeballs_handler
+{
+#if !defined(ASIOEXT_IS_DOCUMENTATION) && (ASIOEXT_ASIO_VERSION >= 101100)
+  template <typename T, typename Executor>
+  friend struct asio::associated_allocator;
+
+  template <typename T, typename Allocator>
+  friend struct asio::associated_executor;
+#endif
+
+  // All intermediate handlers share the state's handler, so they forward
+  // their memory hooks to it. They are invoked through the state's strand
+  // instead of the handler's asio_handler_invoke(), which might run them
+  // outside of it.
+  friend void* asio_handler_allocate(std::size_t size,
+                                     happy_eyeballs_handler* this_handler)
+  {
+    return ASIOEXT_HANDLER_ALLOC_HELPERS_NS::allocate(
+        size, this_handler->state_->handler());
+  }
+
+  friend void asio_handler_deallocate(void* pointer, std::size_t size,
+                                      happy_eyeballs_handler* this_handler)
+  {
+    ASIOEXT_HANDLER_ALLOC_HELPERS_NS::deallocate(
+        pointer, size, this_handler->state_->handler());
+  }
+
+  friend bool asio_handler_is_continuation(
+      happy_eyeballs_handler* this_handler)
+  {
+    return ASIOEXT_HANDLER_CONT_HELPERS_NS::is_continuation(
+        this_handler->state_->handler());
+  }
+
+  std::shared_ptr<State> state_;
+  std::size_t index_;
+
+public:
+  happy_eyeballs_handler(const std::shared_ptr<State>& state,
+                         std::size_t index)
+    : state_(state)
+    , index_(index)
+  {
+    // ctor
+  }
+
+  void operator()(error_code ec)
+  {
+    if (state_->on_complete(index_, ec))
+      State::complete(ASIOEXT_MOVE_CAST(std::shared_ptr<State>)(state_));
+  }
+};
+
+// Races connection attempts to a list of endpoints as described by
+// RFC 8305. Each attempt uses its own socket, the winner is moved into the
+// caller's socket. The state and its containers are allocated with the
+// handler's allocator.
+//
+// All intermediate handlers run on |strand_|, so they never access the
+// state concurrently, even if the io_service is run by multiple threads.
+// With executor support, the strand runs on the handler's associated
+// executor, so the handler itself can be called from there as well.
+template <typename Iterator, typename Handler>
+class happy_eyeballs_state
+  : public std::enable_shared_from_this<happy_eyeballs_state<Iterator,
+                                                             Handler>>
+{
+  template <typename State>
+  friend class happy_eyeballs_handler;
+
+  typedef happy_eyeballs_handler<happy_eyeballs_state> handler_type;
+
+  typedef typename handler_allocator_type<
+    Handler, Iterator
+  >::type iterator_allocator;
+
+  typedef typename handler_allocator_type<
+    Handler, asio::ip::tcp::socket
+  >::type socket_allocator;
+
+  // Indices used by the handlers of the attempt delay timer and of start().
+  static const std::size_t timer_index = static_cast<std::size_t>(-1);
+  static const std::size_t start_index = static_cast<std::size_t>(-2);
+
+public:
+  typedef Handler completion_handler_type;
+
+#if ASIOEXT_ASIO_VERSION >= 101200
+  typedef asio::strand<typename asio::associated_executor<
+    Handler, asio::ip::tcp::socket::lowest_layer_type::executor_type
+  >::type> strand_type;
+#else
+  typedef asio::io_service::strand strand_type;
+#endif
+
+  happy_eyeballs_state(ASIOEXT_MOVE_ARG(Handler) handler,
+                       asio::ip::tcp::socket::lowest_layer_type& socket,
+                       Iterator begin, Iterator end,
+                       const asio::steady_timer::duration& attempt_delay)
+    : handler_(ASIOEXT_MOVE_CAST(Handler)(handler))
+    , socket_(socket)
+#if ASIOEXT_ASIO_VERSION >= 101200
+    , strand_(asio::get_associated_executor(handler_, socket.get_executor()))
+#else
+    , strand_(socket.get_io_service())
+#endif
+    , timer_(get_io_executor(socket))
+    , attempt_delay_(attempt_delay)
+    , endpoints_(handler_allocator_type<Handler, Iterator>::get(handler_))
+    , attempts_(handler_allocator_type<
+          Handler, asio::ip::tcp::socket>::get(handler_))
+    , winner_(end)
+    , next_(0)
+    , pending_(0)
+    , running_(0)
+    , ec_(asio::error::not_found)
+    , done_(false)
+  {
+    // Alternate between address families, starting with the family
+    // of the first endpoint. Otherwise the resolver's order is kept.
+    const iterator_allocator alloc(endpoints_.get_allocator());
+    std::vector<Iterator, iterator_allocator> preferred(alloc), other(alloc);
+    for (Iterator it = begin; it != end; ++it) {
+      const asio::ip::tcp::endpoint ep = *it;
+      const asio::ip::tcp::endpoint first = *begin;
+      if (ep.protocol() == first.protocol())
+        preferred.push_back(it);
+      else
+        other.push_back(it);
+    }
+
+    endpoints_.reserve(preferred.size() + other.size());
+    for (std::size_t i = 0; i != (std::max)(preferred.size(), other.size());
+         ++i) {
+      if (i < preferred.size())
+        endpoints_.push_back(preferred[i]);
+      if (i < other.size())
+        endpoints_.push_back(other[i]);
+    }
+
+    // Attempt sockets are never moved while their operations are
+    // outstanding.
+    attempts_.reserve(endpoints_.size());
+  }
+
+  Handler& handler() ASIOEXT_NOEXCEPT
+  {
+    return handler_;
+  }
+
+  const strand_type& strand() const ASIOEXT_NOEXCEPT
+  {
+    return strand_;
+  }
+
+  // Start the first attempt on the strand. Never completes immediately.
+  void start()
+  {
+    ++pending_;
+#if ASIOEXT_ASIO_VERSION >= 101200
+    asio::post(strand_, bind_handler(make_handler(start_index),
+                                     error_code()));
+#else
+    strand_.post(bind_handler(make_handler(start_index), error_code()));
+#endif
+  }
+
+  // Call the handler. Its allocator provided the state's memory, which is
+  // freed first so that the handler can reuse it. |state| has to be the
+  // last reference.
+  static void complete(std::shared_ptr<happy_eyeballs_state> state)
+  {
+    const error_code ec = state->ec_;
+    const Iterator result = state->winner_;
+    Handler handler(ASIOEXT_MOVE_CAST(Handler)(state->handler_));
+    state.reset();
+    handler(ec, result);
+  }
+
+private:
+  handler_type make_handler(std::size_t index)
+  {
+    return handler_type(this->shared_from_this(), index);
+  }
+
+  void start_next()
+  {
+    while (next_ != endpoints_.size()) {
+      const std::size_t index = next_++;
+      const asio::ip::tcp::endpoint ep = *endpoints_[index];
+
+      attempts_.emplace_back(get_io_executor(socket_));
+
+      error_code ec;
+      attempts_[index].open(ep.protocol(), ec);
+      if (ec) {
+        ec_ = ec;
+        continue;
+      }
+
+      ++pending_;
+      ++running_;
+#if ASIOEXT_ASIO_VERSION >= 101200
+      attempts_[index].async_connect(ep, make_handler(index));
+#else
+      attempts_[index].async_connect(ep, strand_.wrap(make_handler(index)));
+#endif
+
+      if (next_ != endpoints_.size())
+        arm_timer();
+      return;
+    }
+
+    if (running_ == 0)
+      finish();
+  }
+
+  // The timer starts the next attempt.
+  void arm_timer()
+  {
+    // Re-arming cancels a wait that is still outstanding.
+    ++pending_;
+    timer_.expires_from_now(attempt_delay_);
+#if ASIOEXT_ASIO_VERSION >= 101200
+    timer_.async_wait(make_handler(timer_index));
+#else
+    timer_.async_wait(strand_.wrap(make_handler(timer_index)));
+#endif
+  }
+
+  // Returns true once the handler can be called.
+  bool on_complete(std::size_t index, error_code ec)
+  {
+    --pending_;
+
+    // A closed socket is noticed whenever something completes. There is
+    // nothing to wait for it, so attempts that are already running (and
+    // no longer need the timer) have to complete first.
+    if (index == start_index) {
+      // An empty sequence doesn't open the socket.
+      if (!socket_.is_open() && !endpoints_.empty())
+        cancel();
+      else
+        start_next();
+    } else if (index == timer_index) {
+      if (!done_ && ec != asio::error::operation_aborted) {
+        if (!socket_.is_open())
+          cancel();
+        else
+          start_next();
+      }
+    } else {
+      error_code ignored_ec;
+      --running_;
+      if (done_) {
+        attempts_[index].close(ignored_ec);
+      } else if (!socket_.is_open()) {
+        cancel();
+      } else if (!ec) {
+        socket_.close(ignored_ec);
+        socket_ = ASIOEXT_MOVE_CAST(asio::ip::tcp::socket)(attempts_[index]);
+        winner_ = endpoints_[index];
+        ec_ = error_code();
+        finish();
+      } else {
+        attempts_[index].close(ignored_ec);
+        ec_ = ec;
+        start_next();
+      }
+    }
+
+    return done_ && pending_ == 0;
+  }
+
+  // The caller closed the socket.
+  void cancel()
+  {
+    ec_ = asio::error::operation_aborted;
+    finish();
+  }
+
+  // Stop the attempts that are still running. Their handlers (and the
+  // timer's) complete with operation_aborted.
+  void finish()
+  {
+    done_ = true;
+
+    error_code ignored_ec;
+    timer_.cancel(ignored_ec);
+    for (std::size_t i = 0; i != attempts_.size(); ++i)
+      attempts_[i].close(ignored_ec);
+  }
+
+  Handler handler_;
+  asio::ip::tcp::socket::lowest_layer_type& socket_;
+  strand_type strand_;
+  asio::steady_timer timer_;
+  asio::steady_timer::duration attempt_delay_;
+  std::vector<Iterator, iterator_allocator> endpoints_;
+  std::vector<asio::ip::tcp::socket, socket_allocator> attempts_;
+  Iterator winner_;
+  std::size_t next_;
+  std::size_t pending_;
+  std::size_t running_;
+  error_code ec_;
+  bool done_;
+};
+
+template <typename Iterator, typename Handler>
+void start_happy_eyeballs(asio::ip::tcp::socket::lowest_layer_type& socket,
+                          Iterator begin, Iterator end,
+                          const asio::steady_timer::duration& attempt_delay,
+                          ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef happy_eyeballs_state<Iterator, Handler> state_type;
+
+  const typename handler_allocator_type<Handler, state_type>::type alloc(
+      handler_allocator_type<Handler, state_type>::get(handler));
+  std::allocate_shared<state_type>(
+      alloc, ASIOEXT_MOVE_CAST(Handler)(handler), socket, begin, end,
+      attempt_delay)->start();
+}
+
 template <class Handler>
 class connect_op
 {
 public:
+  template <typename Resolver>
   connect_op(Handler& handler,
              asio::ip::tcp::socket::lowest_layer_type& socket,
-             asio::ip::tcp::resolver& resolver,
-             const asio::ip::tcp::resolver::query& q)
+             Resolver& resolver,
+             const asio::ip::tcp::resolver::query& q,
+             const asio::steady_timer::duration& attempt_delay)
     : socket_(socket)
+    , attempt_delay_(attempt_delay)
   {
     // Open the socket to give the caller something to close to cancel the
     // asynchronous operation.
     error_code ec;
     socket_.open(asio::ip::tcp::v4(), ec);
     if (ec) {
-      socket_.get_io_service().post(bind_handler(
+      detail::post_handler(socket_, bind_handler(
           ASIOEXT_MOVE_CAST(Handler)(handler), ec,
           asio::ip::tcp::resolver::iterator()));
       return;
@@ -49,6 +395,7 @@ public:
 
 private:
   asio::ip::tcp::socket::lowest_layer_type& socket_;
+  asio::steady_timer::duration attempt_delay_;
 };
 
 template <class Handler>
@@ -56,8 +403,12 @@ void connect_op<Handler>::operator()(ASIOEXT_MOVE_ARG(Handler) handler,
                                      error_code ec,
                                      asio::ip::tcp::resolver::iterator iter)
 {
+  if (!ec && !socket_.is_open())
+    ec = asio::error::operation_aborted;
+
   if (!ec) {
-    asio::async_connect(socket_, iter, ASIOEXT_MOVE_CAST(Handler)(handler));
+    start_happy_eyeballs(socket_, iter, asio::ip::tcp::resolver::iterator(),
+                         attempt_delay_, ASIOEXT_MOVE_CAST(Handler)(handler));
     return;
   }
   handler(ec, asio::ip::tcp::resolver::iterator());
@@ -72,6 +423,55 @@ async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
               asio::ip::tcp::resolver& resolver,
               const asio::ip::tcp::resolver::query& q,
               ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler)
+{
+  return async_connect(
+      socket, resolver, q,
+      chrono::milliseconds(default_connection_attempt_delay_ms),
+      ASIOEXT_MOVE_CAST(ComposedConnectHandler)(handler));
+}
+
+template <typename ComposedConnectHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ComposedConnectHandler,
+                           void(error_code, asio::ip::tcp::resolver::iterator))
+async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+              asio::ip::tcp::resolver& resolver,
+              const asio::ip::tcp::resolver::query& q,
+              const asio::steady_timer::duration& attempt_delay,
+              ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler)
+{
+  typedef async_completion<
+    ComposedConnectHandler,
+    void (error_code, asio::ip::tcp::resolver::iterator)
+  > init_t;
+
+  init_t init(handler);
+  detail::connect_op<typename init_t::completion_handler_type>(
+    init.completion_handler, socket, resolver, q, attempt_delay);
+  return init.result.get();
+}
+
+template <typename ComposedConnectHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ComposedConnectHandler,
+                           void(error_code, asio::ip::tcp::resolver::iterator))
+async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+              resolver_cache& resolver,
+              const asio::ip::tcp::resolver::query& q,
+              ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler)
+{
+  return async_connect(
+      socket, resolver, q,
+      chrono::milliseconds(default_connection_attempt_delay_ms),
+      ASIOEXT_MOVE_CAST(ComposedConnectHandler)(handler));
+}
+
+template <typename ComposedConnectHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ComposedConnectHandler,
+                           void(error_code, asio::ip::tcp::resolver::iterator))
+async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+              resolver_cache& resolver,
+              const asio::ip::tcp::resolver::query& q,
+              const asio::steady_timer::duration& attempt_delay,
+              ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler)
 {
   typedef async_completion<
     ComposedConnectHandler,
@@ -80,10 +480,86 @@ async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
 
   init_t init(handler);
   detail::connect_op<typename init_t::completion_handler_type>(
-    init.completion_handler, socket, resolver, q);
+    init.completion_handler, socket, resolver, q, attempt_delay);
+  return init.result.get();
+}
+
+template <typename Iterator, typename ComposedConnectHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ComposedConnectHandler, void(error_code, Iterator))
+async_connect(asio::ip::tcp::socket::lowest_layer_type& socket,
+              Iterator begin, Iterator end,
+              const asio::steady_timer::duration& attempt_delay,
+              ASIOEXT_MOVE_ARG(ComposedConnectHandler) handler)
+{
+  typedef async_completion<
+    ComposedConnectHandler, void (error_code, Iterator)
+  > init_t;
+
+  init_t init(handler);
+
+  // See connect_op.
+  error_code ec;
+  if (begin != end && !socket.is_open()) {
+    const asio::ip::tcp::endpoint ep = *begin;
+    socket.open(ep.protocol(), ec);
+  }
+
+  if (!ec) {
+    detail::start_happy_eyeballs(
+        socket, begin, end, attempt_delay,
+        ASIOEXT_MOVE_CAST(typename init_t::completion_handler_type)(
+            init.completion_handler));
+  } else {
+    detail::post_handler(socket, bind_handler(
+        ASIOEXT_MOVE_CAST(typename init_t::completion_handler_type)(
+            init.completion_handler), ec, end));
+  }
   return init.result.get();
 }
 
 ASIOEXT_NS_END
 
+#if !defined(ASIOEXT_IS_DOCUMENTATION) && (ASIOEXT_ASIO_VERSION >= 101100)
+# if defined(ASIOEXT_USE_BOOST_ASIO)
+namespace boost {
+# endif
+namespace asio {
+
+template <typename State, typename Allocator>
+struct associated_allocator<
+    asioext::detail::happy_eyeballs_handler<State>, Allocator>
+{
+  typedef typename associated_allocator<
+    typename State::completion_handler_type, Allocator>::type type;
+
+  static type get(const asioext::detail::happy_eyeballs_handler<State>& h,
+                  const Allocator& a = Allocator()) ASIOEXT_NOEXCEPT
+  {
+    return associated_allocator<
+      typename State::completion_handler_type, Allocator>::get(
+          h.state_->handler(), a);
+  }
+};
+
+// Intermediate handlers run on the state's strand, which in turn runs on
+// the handler's executor.
+template <typename State, typename Executor>
+struct associated_executor<
+    asioext::detail::happy_eyeballs_handler<State>, Executor>
+{
+  typedef typename State::strand_type type;
+
+  static type get(const asioext::detail::happy_eyeballs_handler<State>& h,
+                  const Executor& = Executor()) ASIOEXT_NOEXCEPT
+  {
+    return h.state_->strand();
+  }
+};
+
+}
+# if defined(ASIOEXT_USE_BOOST_ASIO)
+}
+# endif
+#endif
+
 #endif
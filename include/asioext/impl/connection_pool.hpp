@@ -0,0 +1,104 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_IMPL_CONNECTIONPOOL_HPP
+#define ASIOEXT_IMPL_CONNECTIONPOOL_HPP
+
+#include "asioext/detail/connection_pool.hpp"
+
+ASIOEXT_NS_BEGIN
+
+template <typename Socket>
+void basic_pooled_connection<Socket>::release()
+{
+  if (pool_) {
+    const std::shared_ptr<detail::connection_pool_state<Socket>> pool(
+        std::move(pool_));
+    pool->release(*this, true);
+  }
+}
+
+template <typename Socket>
+void basic_pooled_connection<Socket>::discard()
+{
+  if (pool_) {
+    const std::shared_ptr<detail::connection_pool_state<Socket>> pool(
+        std::move(pool_));
+    pool->release(*this, false);
+  }
+}
+
+template <typename Socket>
+basic_connection_pool<Socket>::basic_connection_pool(
+    asio::io_service& io_service,
+    std::size_t max_connections_per_key,
+    const asio::steady_timer::duration& idle_timeout)
+  : state_(std::make_shared<detail::connection_pool_state<Socket>>(
+        io_service, max_connections_per_key, idle_timeout))
+{
+  // ctor
+}
+
+template <typename Socket>
+basic_connection_pool<Socket>::~basic_connection_pool()
+{
+  state_->close();
+}
+
+template <typename Socket>
+template <typename AcquireHandler>
+ASIOEXT_INITFN_RESULT_TYPE(AcquireHandler, void(error_code))
+basic_connection_pool<Socket>::async_acquire(
+    const connection_key& key, connection_type& connection,
+    ASIOEXT_MOVE_ARG(AcquireHandler) handler)
+{
+  typedef async_completion<AcquireHandler, void (error_code)> init_t;
+
+  init_t init(handler);
+  connection.release();
+
+  state_->acquire(key, detail::connection_pool_waiter<Socket>(
+      connection, detail::erased_handler_impl<
+          typename init_t::completion_handler_type, error_code
+      >::create(init.completion_handler, state_->get_io_service())));
+  return init.result.get();
+}
+
+template <typename Socket>
+void basic_connection_pool<Socket>::warm(const connection_key& key,
+                                         std::size_t count)
+{
+  state_->warm(key, count);
+}
+
+template <typename Socket>
+std::size_t basic_connection_pool<Socket>::idle_count(
+    const connection_key& key) const
+{
+  return state_->idle_count(key);
+}
+
+template <typename Socket>
+std::size_t basic_connection_pool<Socket>::connection_count(
+    const connection_key& key) const
+{
+  return state_->connection_count(key);
+}
+
+template <typename Socket>
+void basic_connection_pool<Socket>::clear()
+{
+  state_->clear();
+}
+
+template <typename Socket>
+void basic_connection_pool<Socket>::close()
+{
+  state_->close();
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,151 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/directory_handle.hpp"
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+
+#include "asioext/detail/throw_error.hpp"
+
+#include <fcntl.h> // for AT_FDCWD
+
+ASIOEXT_NS_BEGIN
+
+directory_handle::directory_handle() ASIOEXT_NOEXCEPT
+  : handle_(-1)
+{
+  // ctor
+}
+
+directory_handle::directory_handle(
+    const native_handle_type& handle) ASIOEXT_NOEXCEPT
+  : handle_(handle)
+{
+  // ctor
+}
+
+directory_handle::~directory_handle()
+{
+  error_code ec;
+  close(ec);
+  // error is swallowed
+}
+
+#ifdef ASIOEXT_HAS_MOVE
+
+directory_handle::directory_handle(directory_handle&& other) ASIOEXT_NOEXCEPT
+  : handle_(other.handle_)
+{
+  other.handle_ = -1;
+}
+
+directory_handle& directory_handle::operator=(directory_handle&& other)
+{
+  if (handle_ != -1)
+    close();
+
+  handle_ = other.handle_;
+  other.handle_ = -1;
+  return *this;
+}
+
+#endif
+
+void directory_handle::open(const char* path, const open_args& args)
+{
+  error_code ec;
+  open(path, args, ec);
+  detail::throw_error(ec);
+}
+
+void directory_handle::open(const char* path, const open_args& args,
+                            error_code& ec) ASIOEXT_NOEXCEPT
+{
+  close(ec);
+  if (!ec)
+    handle_ = detail::posix_file_ops::open_directory(AT_FDCWD, path, args, ec);
+}
+
+void directory_handle::open(const directory_handle& dir, const char* path,
+                            const open_args& args)
+{
+  error_code ec;
+  open(dir, path, args, ec);
+  detail::throw_error(ec);
+}
+
+void directory_handle::open(const directory_handle& dir, const char* path,
+                            const open_args& args,
+                            error_code& ec) ASIOEXT_NOEXCEPT
+{
+  // |dir| might be *this, so we can't close our handle first.
+  const native_handle_type h = detail::posix_file_ops::open_directory(
+      dir.handle_, path, args, ec);
+  if (ec)
+    return;
+
+  close(ec);
+  handle_ = h;
+}
+
+directory_handle::native_handle_type
+directory_handle::release() ASIOEXT_NOEXCEPT
+{
+  const native_handle_type h = handle_;
+  handle_ = -1;
+  return h;
+}
+
+void directory_handle::close()
+{
+  error_code ec;
+  close(ec);
+  detail::throw_error(ec);
+}
+
+void directory_handle::close(error_code& ec) ASIOEXT_NOEXCEPT
+{
+  if (handle_ == -1) {
+    ec = error_code();
+    return;
+  }
+
+  detail::posix_file_ops::close(handle_, ec);
+  handle_ = -1;
+}
+
+directory_entries directory_handle::read_entries(
+    const asio::mutable_buffer& buffer)
+{
+  error_code ec;
+  const directory_entries entries = read_entries(buffer, ec);
+  detail::throw_error(ec);
+  return entries;
+}
+
+directory_entries directory_handle::read_entries(
+    const asio::mutable_buffer& buffer, error_code& ec) ASIOEXT_NOEXCEPT
+{
+  void* data = asio::buffer_cast<void*>(buffer);
+  const std::size_t size = detail::posix_file_ops::getdents(
+      handle_, data, asio::buffer_size(buffer), ec);
+  return directory_entries(data, size);
+}
+
+void directory_handle::rewind()
+{
+  error_code ec;
+  rewind(ec);
+  detail::throw_error(ec);
+}
+
+void directory_handle::rewind(error_code& ec) ASIOEXT_NOEXCEPT
+{
+  detail::posix_file_ops::seek(handle_, seek_origin::from_begin, 0, ec);
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -126,4 +126,12 @@ void file_handle::times(const file_times& new_times)
   detail::throw_error(ec, "times");
 }
 
+file_status file_handle::status(file_status_mask mask)
+{
+  error_code ec;
+  file_status st = status(mask, ec);
+  detail::throw_error(ec, "status");
+  return st;
+}
+
 ASIOEXT_NS_END
@@ -13,10 +13,46 @@
 
 ASIOEXT_NS_BEGIN
 
+namespace detail {
+
+#if defined(ASIOEXT_HAS_PVEC_IO_FUNCTIONS)
+// Adapters for detail::chunked_vector_io(). They advance their offset by
+// the bytes already transferred.
+
+struct preadv_op
+{
+  std::size_t operator()(iovec* bufs, int count, std::size_t transferred,
+                         error_code& ec) const ASIOEXT_NOEXCEPT
+  {
+    return posix_file_ops::preadv(fd, bufs, count, offset + transferred,
+                                  ec);
+  }
+
+  posix_file_ops::handle_type fd;
+  uint64_t offset;
+};
+
+struct pwritev_op
+{
+  std::size_t operator()(const iovec* bufs, int count, std::size_t transferred,
+                         error_code& ec) const ASIOEXT_NOEXCEPT
+  {
+    return posix_file_ops::pwritev(fd, bufs, count, offset + transferred,
+                                   ec);
+  }
+
+  posix_file_ops::handle_type fd;
+  uint64_t offset;
+};
+#endif
+
+}
+
 template <typename MutableBufferSequence>
 std::size_t file_handle::read_some(const MutableBufferSequence& buffers,
                                    error_code& ec) ASIOEXT_NOEXCEPT
 {
+  // Only the first chunk is read, a second call could block.
   detail::buffer_sequence_adapter<asio::mutable_buffer, MutableBufferSequence>
       bufs(buffers);
   return detail::posix_file_ops::readv(handle_, bufs.buffers(), bufs.count(),
@@ -27,6 +63,7 @@ template <typename ConstBufferSequence>
 std::size_t file_handle::write_some(const ConstBufferSequence& buffers,
                                     error_code& ec) ASIOEXT_NOEXCEPT
 {
+  // Only the first chunk is written, a second call could block.
   detail::buffer_sequence_adapter<asio::const_buffer, ConstBufferSequence>
       bufs(buffers);
   return detail::posix_file_ops::writev(handle_, bufs.buffers(), bufs.count(),
@@ -41,8 +78,8 @@ std::size_t file_handle::read_some_at(uint64_t offset,
 #if defined(ASIOEXT_HAS_PVEC_IO_FUNCTIONS)
   detail::buffer_sequence_adapter<asio::mutable_buffer, MutableBufferSequence>
       bufs(buffers);
-  return detail::posix_file_ops::preadv(handle_, bufs.buffers(), bufs.count(),
-                                        offset, ec);
+  const detail::preadv_op op = {handle_, offset};
+  return detail::chunked_vector_io(bufs, op, ec);
 #else
   const asio::mutable_buffer buf = asioext::first_mutable_buffer(buffers);
   return detail::posix_file_ops::pread(handle_,
@@ -60,8 +97,8 @@ std::size_t file_handle::write_some_at(uint64_t offset,
 #if defined(ASIOEXT_HAS_PVEC_IO_FUNCTIONS)
   detail::buffer_sequence_adapter<asio::const_buffer, ConstBufferSequence>
       bufs(buffers);
-  return detail::posix_file_ops::pwritev(handle_, bufs.buffers(), bufs.count(),
-                                         offset, ec);
+  const detail::pwritev_op op = {handle_, offset};
+  return detail::chunked_vector_io(bufs, op, ec);
 #else
   const asio::const_buffer buf = asioext::first_const_buffer(buffers);
   return detail::posix_file_ops::pwrite(handle_,
@@ -97,4 +97,12 @@ void file_handle::times(const file_times& new_times,
                                   new_times.mtime, ec);
 }
 
+file_status file_handle::status(file_status_mask mask,
+                                error_code& ec) ASIOEXT_NOEXCEPT
+{
+  file_status st;
+  detail::win_file_ops::status(handle_, mask, st, ec);
+  return st;
+}
+
 ASIOEXT_NS_END
@@ -0,0 +1,40 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/file_io_observer.hpp"
+
+#if defined(ASIOEXT_ENABLE_FILE_IO_OBSERVER)
+
+#include <atomic>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// Function-local static, so header-only builds share a single instance.
+ASIOEXT_DECL std::atomic<file_io_observer*>& file_io_observer_instance()
+    ASIOEXT_NOEXCEPT
+{
+  static std::atomic<file_io_observer*> instance(0);
+  return instance;
+}
+
+}
+
+file_io_observer* set_file_io_observer(
+    file_io_observer* observer) ASIOEXT_NOEXCEPT
+{
+  return detail::file_io_observer_instance().exchange(
+      observer, std::memory_order_acq_rel);
+}
+
+file_io_observer* get_file_io_observer() ASIOEXT_NOEXCEPT
+{
+  return detail::file_io_observer_instance().load(std::memory_order_acquire);
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -13,13 +13,68 @@
 
 ASIOEXT_NS_BEGIN
 
+namespace detail {
+
+// Convert the result of a detail::byte_search function to an offset.
+inline std::size_t linear_search_result(const uint8_t* data,
+                                        const uint8_t* last,
+                                        const uint8_t* p) ASIOEXT_NOEXCEPT
+{
+  return p != last ? static_cast<std::size_t>(p - data)
+                   : static_cast<std::size_t>(-1);
+}
+
+inline std::size_t linear_find(const uint8_t* data, std::size_t size,
+                               uint8_t value,
+                               std::size_t pos) ASIOEXT_NOEXCEPT
+{
+  if (pos >= size)
+    return static_cast<std::size_t>(-1);
+
+  return linear_search_result(data, data + size,
+      byte_search::find(data + pos, data + size, value));
+}
+
+inline std::size_t linear_find(const uint8_t* data, std::size_t size,
+                               const void* s, std::size_t n,
+                               std::size_t pos) ASIOEXT_NOEXCEPT
+{
+  if (pos > size)
+    return static_cast<std::size_t>(-1);
+  if (n == 0)
+    return pos;
+
+  return linear_search_result(data, data + size,
+      byte_search::search(data + pos, data + size,
+                          static_cast<const uint8_t*>(s), n));
+}
+
+inline std::size_t linear_find_any(const uint8_t* data, std::size_t size,
+                                   const void* set, std::size_t n,
+                                   std::size_t pos) ASIOEXT_NOEXCEPT
+{
+  if (pos >= size)
+    return static_cast<std::size_t>(-1);
+
+  return linear_search_result(data, data + size,
+      byte_search::find_any(data + pos, data + size,
+                            static_cast<const uint8_t*>(set), n));
+}
+
+}
+
+template <class Allocator>
+const std::size_t basic_linear_buffer<Allocator>::npos;
+
 template <typename Allocator>
 basic_linear_buffer<Allocator>::basic_linear_buffer(
     const basic_linear_buffer& other)
-  : rep_()
+  : rep_(allocator_traits_type::select_on_container_copy_construction(
+        other.get_allocator()))
   , capacity_(other.size_)
   , size_(other.size_)
   , max_size_(other.max_size_)
+  , growth_(other.growth_)
 {
   rep_.data_ = allocator_traits_type::allocate(rep_, other.size_);
   std::memcpy(rep_.data_, other.rep_.data_, size_);
@@ -36,7 +91,7 @@ basic_linear_buffer<Allocator>& basic_linear_buffer<Allocator>::operator=(
   }
 
   if (n > capacity_)
-    reallocate(calculate_capacity(n), [this] (uint8_t* new_buffer) {});
+    reallocate(calculate_capacity(n), [] (uint8_t*) {});
 
   std::memcpy(rep_.data_, other.rep_.data_, n);
   size_ = n;
@@ -46,7 +101,9 @@ basic_linear_buffer<Allocator>& basic_linear_buffer<Allocator>::operator=(
 #ifdef ASIOEXT_HAS_MOVE
 template <class Allocator>
 basic_linear_buffer<Allocator>& basic_linear_buffer<Allocator>::operator=(
-    basic_linear_buffer&& other) ASIOEXT_NOEXCEPT
+    basic_linear_buffer&& other)
+    ASIOEXT_NOEXCEPT_IF(allocator_traits_type::
+                        propagate_on_container_move_assignment::value)
 {
   move_assign(other, std::integral_constant<bool,
       allocator_traits_type::propagate_on_container_move_assignment::value>());
@@ -87,12 +144,12 @@ void basic_linear_buffer<Allocator>::insert(std::size_t before_this,
                [this, before_this, data, n] (uint8_t* new_buffer) {
       std::memcpy(new_buffer, rep_.data_, before_this);
       std::memcpy(new_buffer + before_this, data, n);
-      std::memcpy(new_buffer + before_this + n, rep_.data + before_this,
+      std::memcpy(new_buffer + before_this + n, rep_.data_ + before_this,
                   size_ - before_this);
     });
   } else {
-    std::memmove(rep_.data_ + before_this,
-                 rep_.data_ + before_this + n,
+    std::memmove(rep_.data_ + before_this + n,
+                 rep_.data_ + before_this,
                  size_ - before_this);
     std::memcpy(rep_.data_ + before_this, data, n);
   }
@@ -100,6 +157,27 @@ void basic_linear_buffer<Allocator>::insert(std::size_t before_this,
   size_ += n;
 }
 
+template <class Allocator>
+std::size_t basic_linear_buffer<Allocator>::find(
+    uint8_t value, std::size_t pos) const ASIOEXT_NOEXCEPT
+{
+  return detail::linear_find(rep_.data_, size_, value, pos);
+}
+
+template <class Allocator>
+std::size_t basic_linear_buffer<Allocator>::find(
+    const void* s, std::size_t n, std::size_t pos) const ASIOEXT_NOEXCEPT
+{
+  return detail::linear_find(rep_.data_, size_, s, n, pos);
+}
+
+template <class Allocator>
+std::size_t basic_linear_buffer<Allocator>::find_any(
+    const void* set, std::size_t n, std::size_t pos) const ASIOEXT_NOEXCEPT
+{
+  return detail::linear_find_any(rep_.data_, size_, set, n, pos);
+}
+
 template <class Allocator>
 void basic_linear_buffer<Allocator>::erase(std::size_t pos)
 {
@@ -116,6 +194,24 @@ void basic_linear_buffer<Allocator>::erase(std::size_t first, std::size_t last)
   size_ -= n;
 }
 
+template <class Allocator>
+void basic_linear_buffer<Allocator>::shrink_to_fit()
+{
+  if (capacity_ == size_)
+    return;
+
+  if (size_ == 0) {
+    allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
+    rep_.data_ = nullptr;
+    capacity_ = 0;
+    return;
+  }
+
+  reallocate(size_, [this] (uint8_t* new_buffer) {
+    std::memcpy(new_buffer, rep_.data_, size_);
+  });
+}
+
 template <class Allocator>
 void basic_linear_buffer<Allocator>::reserve(std::size_t min_cap)
 {
@@ -158,15 +254,18 @@ void basic_linear_buffer<Allocator>::move_assign(basic_linear_buffer& other,
 {
   if (static_cast<allocator_type&>(rep_) !=
       static_cast<allocator_type&>(other.rep_)) {
-    if (rep_.data_)
-      allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
+    // We can't steal the other buffer's memory, since our allocator
+    // can't free it.
+    if (other.size_ > capacity_)
+      reallocate(other.size_, [] (uint8_t*) {});
 
-    capacity_ = other.capacity_;
     size_ = other.size_;
-    rep_.data_ = allocator_traits_type::allocate(rep_, capacity_);
     std::memcpy(rep_.data_, other.rep_.data_, size_);
   } else {
-    move_assign(other, std::false_type());
+    if (rep_.data_)
+      allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
+
+    steal(other);
   }
 }
 
@@ -175,28 +274,95 @@ void basic_linear_buffer<Allocator>::move_assign(basic_linear_buffer& other,
                                                  std::true_type)
   ASIOEXT_NOEXCEPT_IF(std::is_nothrow_move_assignable<allocator_type>::value)
 {
+  // Free our memory while we still have the allocator that allocated it.
+  if (rep_.data_)
+    allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
+
   static_cast<allocator_type&>(rep_) =
       std::move(static_cast<allocator_type&>(other.rep_));
+  steal(other);
+}
+
+template <class Allocator>
+void basic_linear_buffer<Allocator>::steal(
+    basic_linear_buffer& other) ASIOEXT_NOEXCEPT
+{
   rep_.data_ = other.rep_.data_;
   capacity_ = other.capacity_;
   size_ = other.size_;
   max_size_ = other.max_size_;
+  growth_ = other.growth_;
   other.rep_.data_ = nullptr;
   other.capacity_ = other.size_ = 0;
 }
 #endif
 
+template <class Allocator>
+std::size_t basic_linear_buffer<Allocator>::calculate_capacity(
+    std::size_t required) const ASIOEXT_NOEXCEPT
+{
+  const std::size_t page_size = 4096;
+
+  std::size_t cap = required;
+  switch (growth_) {
+    case linear_buffer_growth::exact:
+      break;
+    case linear_buffer_growth::factor_1_5:
+      if (capacity_ < max_size_ / 3 * 2)
+        cap = capacity_ + capacity_ / 2;
+      else
+        cap = max_size_;
+      break;
+    case linear_buffer_growth::factor_2:
+      if (capacity_ < max_size_ / 2)
+        cap = 2 * capacity_;
+      else
+        cap = max_size_;
+      break;
+    case linear_buffer_growth::page_rounded:
+      if (required <= max_size_ - (page_size - 1))
+        cap = (required + page_size - 1) & ~(page_size - 1);
+      else
+        cap = max_size_;
+      break;
+  }
+
+  return (std::min)((std::max)(cap, required), max_size_);
+}
+
 template <class Allocator>
 template <typename Function>
 void basic_linear_buffer<Allocator>::reallocate(std::size_t cap, Function&& fn)
 {
   uint8_t* new_buffer = allocator_traits_type::allocate(rep_, cap);
   fn(new_buffer);
-  allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
+  if (rep_.data_)
+    allocator_traits_type::deallocate(rep_, rep_.data_, capacity_);
   rep_.data_ = new_buffer;
   capacity_ = cap;
 }
 
+template <class Allocator>
+std::size_t dynamic_linear_buffer<Allocator>::find(
+    uint8_t value, std::size_t pos) const ASIOEXT_NOEXCEPT
+{
+  return detail::linear_find(data_.data(), size_, value, pos);
+}
+
+template <class Allocator>
+std::size_t dynamic_linear_buffer<Allocator>::find(
+    const void* s, std::size_t n, std::size_t pos) const ASIOEXT_NOEXCEPT
+{
+  return detail::linear_find(data_.data(), size_, s, n, pos);
+}
+
+template <class Allocator>
+std::size_t dynamic_linear_buffer<Allocator>::find_any(
+    const void* set, std::size_t n, std::size_t pos) const ASIOEXT_NOEXCEPT
+{
+  return detail::linear_find_any(data_.data(), size_, set, n, pos);
+}
+
 template <class Allocator>
 typename dynamic_linear_buffer<Allocator>::mutable_buffers_type
 dynamic_linear_buffer<Allocator>::prepare(std::size_t n)
@@ -0,0 +1,104 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/mirrored_circular_buffer.hpp"
+
+#if defined(ASIOEXT_HAS_MIRRORED_MEMORY)
+
+#include "asioext/detail/throw_error.hpp"
+
+#include <cstring>
+
+ASIOEXT_NS_BEGIN
+
+#if defined(ASIOEXT_HAS_MOVE)
+mirrored_circular_buffer& mirrored_circular_buffer::operator=(
+    mirrored_circular_buffer&& other) ASIOEXT_NOEXCEPT
+{
+  if (this == &other)
+    return *this;
+
+  if (data_)
+    detail::mirrored_memory::unmap(data_, capacity_);
+
+  data_ = other.data_;
+  capacity_ = other.capacity_;
+  head_ = other.head_;
+  size_ = other.size_;
+  prepared_ = other.prepared_;
+  max_size_ = other.max_size_;
+
+  other.data_ = nullptr;
+  other.capacity_ = other.head_ = other.size_ = other.prepared_ = 0;
+  return *this;
+}
+#endif
+
+mirrored_circular_buffer::mutable_buffers_type
+mirrored_circular_buffer::prepare(std::size_t n)
+{
+  if (size_ > max_size_ || max_size_ - size_ < n) {
+    std::length_error ex("mirrored_circular_buffer too long");
+    detail::throw_exception(ex);
+  }
+
+  error_code ec;
+  mutable_buffers_type b = prepare(n, ec);
+  detail::throw_error(ec, "prepare");
+  return b;
+}
+
+mirrored_circular_buffer::mutable_buffers_type
+mirrored_circular_buffer::prepare(std::size_t n,
+                                  error_code& ec) ASIOEXT_NOEXCEPT
+{
+  if (size_ > max_size_ || max_size_ - size_ < n) {
+    ec = asio::error::no_memory;
+    return mutable_buffers_type(nullptr, 0);
+  }
+
+  if (size_ + n > capacity_) {
+    grow(size_ + n, ec);
+    if (ec)
+      return mutable_buffers_type(nullptr, 0);
+  } else {
+    ec = error_code();
+  }
+
+  prepared_ = n;
+
+  // Thanks to the second view, the output sequence never wraps.
+  return mutable_buffers_type(data_ + ((head_ + size_) & (capacity_ - 1)), n);
+}
+
+void mirrored_circular_buffer::grow(std::size_t n,
+                                    error_code& ec) ASIOEXT_NOEXCEPT
+{
+  std::size_t cap = detail::next_power_of_two(n);
+  if (cap == 0) {
+    ec = asio::error::no_memory;
+    return;
+  }
+
+  // The page size is a power of two as well.
+  cap = (std::max)(cap, detail::mirrored_memory::granularity());
+
+  uint8_t* new_data = detail::mirrored_memory::map(cap, ec);
+  if (!new_data)
+    return;
+
+  if (data_) {
+    std::memcpy(new_data, data_ + head_, size_);
+    detail::mirrored_memory::unmap(data_, capacity_);
+  }
+
+  data_ = new_data;
+  capacity_ = cap;
+  head_ = 0;
+}
+
+ASIOEXT_NS_END
+
+#endif
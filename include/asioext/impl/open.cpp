@@ -51,6 +51,24 @@ unique_file_handle open(const wchar_t* filename, const open_args& args,
 }
 #endif
 
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+unique_file_handle open(const directory_handle& dir, const char* filename,
+                        const open_args& args)
+{
+  error_code ec;
+  unique_file_handle h = open(dir, filename, args, ec);
+  detail::throw_error(ec);
+  return h;
+}
+
+unique_file_handle open(const directory_handle& dir, const char* filename,
+                        const open_args& args, error_code& ec) ASIOEXT_NOEXCEPT
+{
+  return unique_file_handle(detail::posix_file_ops::openat(
+      dir.native_handle(), filename, args, ec));
+}
+#endif
+
 #if defined(ASIOEXT_HAS_BOOST_FILESYSTEM)
 unique_file_handle open(const boost::filesystem::path& filename,
                         const open_args& args)
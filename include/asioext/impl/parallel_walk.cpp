@@ -0,0 +1,417 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/parallel_walk.hpp"
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+
+#include "asioext/detail/posix_file_ops.hpp"
+#include "asioext/detail/thread_group.hpp"
+#include "asioext/detail/throw_error.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// A directory whose handle is kept open so that its subdirectories can be
+// opened relative to it. Shared by all tasks for these subdirectories.
+struct walk_node
+{
+  walk_node() ASIOEXT_NOEXCEPT
+    : retained(0)
+  {
+    // ctor
+  }
+
+  ~walk_node()
+  {
+    if (retained)
+      retained->fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  directory_handle dir;
+  std::atomic<std::size_t>* retained;
+};
+
+struct walk_task
+{
+  walk_task() ASIOEXT_NOEXCEPT
+    : name_offset(0)
+    , depth(0)
+  {
+    // ctor
+  }
+
+  // If empty, |path| is opened relative to the root directory.
+  std::shared_ptr<walk_node> parent;
+
+  // Path relative to the root directory. Empty for the root itself.
+  std::string path;
+
+  // Offset of the directory's name in |path|.
+  std::size_t name_offset;
+
+  std::size_t depth;
+};
+
+// Each thread owns a queue of directories. New directories are pushed to
+// and taken from its back, so a thread walks its part of the tree
+// depth-first, which keeps the number of pending directories (and retained
+// handles) low. Idle threads steal from the front of other queues, i.e. the
+// directories closest to the root, which usually carry the most work.
+class parallel_walker
+{
+public:
+  parallel_walker(const walk_visitor& visitor,
+                  const walk_options& options) ASIOEXT_NOEXCEPT
+    : visitor_(visitor)
+    , options_(options)
+    , num_workers_(0)
+    , pending_(0)
+    , queued_(0)
+    , idle_(0)
+    , retained_(0)
+    , stopped_(false)
+  {
+    // ctor
+  }
+
+  void run(const char* root, error_code& ec)
+  {
+    root_.open(root, open_flags::access_read | open_flags::open_existing, ec);
+    if (ec)
+      return;
+
+    num_workers_ = options_.threads;
+    if (num_workers_ == 0)
+      num_workers_ = std::thread::hardware_concurrency();
+    if (num_workers_ == 0)
+      num_workers_ = 1;
+
+    workers_.reset(new worker[num_workers_]);
+    for (std::size_t i = 0; i != num_workers_; ++i)
+      workers_[i].buffer.reset(new char[options_.buffer_size]);
+
+    push(0, walk_task());
+
+    {
+      thread_group threads;
+      for (std::size_t i = 1; i != num_workers_; ++i)
+        threads.create_thread(worker_function(this, i));
+
+      work(0);
+    }
+
+    if (exception_)
+      std::rethrow_exception(exception_);
+
+    ec = ec_;
+  }
+
+private:
+  struct worker
+  {
+    std::mutex mutex;
+    std::deque<walk_task> tasks;
+    std::unique_ptr<char[]> buffer;
+  };
+
+  struct worker_function
+  {
+    worker_function(parallel_walker* walker, std::size_t index)
+      : walker(walker)
+      , index(index)
+    {
+      // ctor
+    }
+
+    void operator()()
+    {
+      walker->work(index);
+    }
+
+    parallel_walker* walker;
+    std::size_t index;
+  };
+
+  void work(std::size_t index)
+  {
+    walk_task task;
+    while (pop(index, task)) {
+      try {
+        walk_directory(index, task);
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(error_mutex_);
+          if (!exception_)
+            exception_ = std::current_exception();
+        }
+        stop();
+      }
+
+      // Release our reference to the parent now, so its handle
+      // doesn't stay open while we wait for more work.
+      task = walk_task();
+
+      if (pending_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_cv_.notify_all();
+      }
+    }
+  }
+
+  void push(std::size_t index, walk_task&& task)
+  {
+    pending_.fetch_add(1);
+
+    {
+      worker& w = workers_[index];
+      std::lock_guard<std::mutex> lock(w.mutex);
+      w.tasks.push_back(std::move(task));
+    }
+
+    // Pairs with the increment of |idle_| in pop(): Either the idle thread
+    // sees our task, or we see the idle thread.
+    queued_.fetch_add(1);
+    if (idle_.load() != 0) {
+      std::lock_guard<std::mutex> lock(idle_mutex_);
+      idle_cv_.notify_one();
+    }
+  }
+
+  bool try_pop(std::size_t index, walk_task& task)
+  {
+    if (queued_.load() == 0)
+      return false;
+
+    for (std::size_t i = 0; i != num_workers_; ++i) {
+      worker& w = workers_[(index + i) % num_workers_];
+      std::lock_guard<std::mutex> lock(w.mutex);
+      if (w.tasks.empty())
+        continue;
+
+      if (i == 0) {
+        task = std::move(w.tasks.back());
+        w.tasks.pop_back();
+      } else {
+        task = std::move(w.tasks.front());
+        w.tasks.pop_front();
+      }
+
+      queued_.fetch_sub(1);
+      return true;
+    }
+    return false;
+  }
+
+  // Returns false once all directories have been walked or the walk
+  // was stopped.
+  bool pop(std::size_t index, walk_task& task)
+  {
+    for (;;) {
+      if (stopped_.load(std::memory_order_relaxed))
+        return false;
+
+      if (try_pop(index, task))
+        return true;
+
+      std::unique_lock<std::mutex> lock(idle_mutex_);
+      idle_.fetch_add(1);
+      while (queued_.load() == 0 && pending_.load() != 0 &&
+             !stopped_.load(std::memory_order_relaxed))
+        idle_cv_.wait(lock);
+      idle_.fetch_sub(1);
+
+      if (pending_.load() == 0)
+        return false;
+    }
+  }
+
+  void stop()
+  {
+    stopped_.store(true, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    idle_cv_.notify_all();
+  }
+
+  void handle_error(const std::string& path, const error_code& ec)
+  {
+    if (options_.on_error && options_.on_error(path, ec) != walk_action::stop)
+      return;
+
+    {
+      std::lock_guard<std::mutex> lock(error_mutex_);
+      if (!ec_)
+        ec_ = ec;
+    }
+    stop();
+  }
+
+  void walk_directory(std::size_t index, walk_task& task)
+  {
+    const open_args args(open_flags::access_read | open_flags::open_existing);
+    const std::shared_ptr<walk_node> node = std::make_shared<walk_node>();
+
+    error_code ec;
+    if (task.parent) {
+      node->dir.open(task.parent->dir, task.path.c_str() + task.name_offset,
+                     args, ec);
+    } else {
+      node->dir.open(root_, task.path.empty() ? "." : task.path.c_str(),
+                     args, ec);
+    }
+    task.parent.reset();
+
+    if (ec) {
+      if (ec != errc::no_such_file_or_directory)
+        handle_error(task.path, ec);
+      return;
+    }
+
+    // Keep the handle open for our subdirectories if the limit allows it.
+    // Otherwise they're opened relative to the root directory, and our handle
+    // is closed once we're done here.
+    std::shared_ptr<walk_node> parent;
+    if (retained_.fetch_add(1, std::memory_order_relaxed) <
+        options_.max_open_directories) {
+      node->retained = &retained_;
+      parent = node;
+    } else {
+      retained_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::string path(task.path);
+    if (!path.empty())
+      path += '/';
+    const std::size_t prefix = path.size();
+
+    walk_entry entry;
+    entry.directory_ = &node->dir;
+    entry.path_ = &path;
+    entry.depth_ = task.depth + 1;
+
+    const asio::mutable_buffer buffer(workers_[index].buffer.get(),
+                                      options_.buffer_size);
+    for (;;) {
+      const directory_entries entries = node->dir.read_entries(buffer, ec);
+      if (ec) {
+        handle_error(task.path, ec);
+        return;
+      }
+
+      if (entries.empty())
+        return;
+
+      for (directory_entries::const_iterator it = entries.begin(),
+           end = entries.end(); it != end; ++it) {
+        if (stopped_.load(std::memory_order_relaxed))
+          return;
+
+        const char* name = it->name();
+        if (name[0] == '.' &&
+            (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+          continue;
+
+        path.resize(prefix);
+        path += name;
+
+        entry.name_ = name;
+        entry.inode_ = it->inode();
+        entry.type_ = it->type();
+
+        file_status_mask mask = options_.status_mask;
+        if (entry.type_ == file_type::unknown)
+          mask |= file_status_mask::type;
+
+        if (mask != file_status_mask::none) {
+          posix_file_ops::status_at(node->dir.native_handle(), name, mask,
+                                    entry.status_, ec);
+          if (ec) {
+            if (ec != errc::no_such_file_or_directory)
+              handle_error(path, ec);
+            continue;
+          }
+
+          if (entry.type_ == file_type::unknown)
+            entry.type_ = entry.status_.type;
+        }
+
+        const walk_action action = visitor_(entry);
+        if (action == walk_action::stop) {
+          stop();
+          return;
+        }
+
+        if (action == walk_action::proceed &&
+            entry.type_ == file_type::directory) {
+          walk_task child;
+          child.parent = parent;
+          child.path = path;
+          child.name_offset = prefix;
+          child.depth = entry.depth_;
+          push(index, std::move(child));
+        }
+      }
+    }
+  }
+
+  const walk_visitor& visitor_;
+  const walk_options& options_;
+
+  directory_handle root_;
+
+  std::size_t num_workers_;
+  std::unique_ptr<worker[]> workers_;
+
+  // Directories that haven't been completely walked yet.
+  std::atomic<std::size_t> pending_;
+
+  // Directories that are waiting in a queue.
+  std::atomic<std::size_t> queued_;
+
+  // Threads waiting for |idle_cv_|.
+  std::atomic<std::size_t> idle_;
+
+  // Handles kept open for subdirectories.
+  std::atomic<std::size_t> retained_;
+
+  std::atomic<bool> stopped_;
+
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
+
+  std::mutex error_mutex_;
+  error_code ec_;
+  std::exception_ptr exception_;
+};
+
+}
+
+void parallel_walk(const char* root, const walk_visitor& visitor,
+                   const walk_options& options)
+{
+  error_code ec;
+  parallel_walk(root, visitor, options, ec);
+  detail::throw_error(ec, "parallel_walk");
+}
+
+void parallel_walk(const char* root, const walk_visitor& visitor,
+                   const walk_options& options, error_code& ec)
+{
+  detail::parallel_walker walker(visitor, options);
+  walker.run(root, ec);
+}
+
+ASIOEXT_NS_END
+
+#endif
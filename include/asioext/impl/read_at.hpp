@@ -0,0 +1,64 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_IMPL_READAT_HPP
+#define ASIOEXT_IMPL_READAT_HPP
+
+#include "asioext/detail/consuming_buffers.hpp"
+#include "asioext/detail/throw_error.hpp"
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+template <typename RandomAccessReadDevice>
+struct read_some_at_fn
+{
+  template <typename MutableBufferSequence>
+  std::size_t operator()(uint64_t offset,
+                         const MutableBufferSequence& buffers,
+                         error_code& ec)
+  {
+    return device.read_some_at(offset, buffers, ec);
+  }
+
+  RandomAccessReadDevice& device;
+};
+
+}
+
+template <typename RandomAccessReadDevice, typename MutableBufferSequence>
+std::size_t read_at(RandomAccessReadDevice& device, uint64_t offset,
+                    const MutableBufferSequence& buffers)
+{
+  error_code ec;
+  const std::size_t n = read_at(device, offset, buffers, ec);
+  detail::throw_error(ec, "read_at");
+  return n;
+}
+
+template <typename RandomAccessReadDevice, typename MutableBufferSequence>
+std::size_t read_at(RandomAccessReadDevice& device, uint64_t offset,
+                    const MutableBufferSequence& buffers, error_code& ec)
+{
+  detail::read_some_at_fn<RandomAccessReadDevice> op = {device};
+  return detail::transfer_all_at<asio::mutable_buffer>(offset, buffers,
+                                                       op, ec);
+}
+
+template <typename FileService, typename MutableBufferSequence,
+          typename ReadHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+async_read_at(basic_file<FileService>& file, uint64_t offset,
+              const MutableBufferSequence& buffers,
+              ASIOEXT_MOVE_ARG(ReadHandler) handler)
+{
+  return file.async_read_at(offset, buffers,
+                            ASIOEXT_MOVE_CAST(ReadHandler)(handler));
+}
+
+ASIOEXT_NS_END
+
+#endif
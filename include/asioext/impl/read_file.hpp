@@ -20,9 +20,38 @@
 #endif
 
 #include <limits>
+#include <string>
 
 ASIOEXT_NS_BEGIN
 
+namespace detail {
+
+// Resize |c| to |n| elements that are about to be overwritten, skipping
+// their initialization where the container allows it.
+template <class RawByteContainer>
+auto resize_for_overwrite(RawByteContainer& c, std::size_t n, int)
+    -> decltype(c.resize_uninitialized(n), void())
+{
+  c.resize_uninitialized(n);
+}
+
+#if defined(__cpp_lib_string_resize_and_overwrite)
+template <class CharT, class Traits, class Allocator>
+void resize_for_overwrite(std::basic_string<CharT, Traits, Allocator>& s,
+                          std::size_t n, int)
+{
+  s.resize_and_overwrite(n, [] (CharT*, std::size_t size) { return size; });
+}
+#endif
+
+template <class RawByteContainer>
+void resize_for_overwrite(RawByteContainer& c, std::size_t n, long)
+{
+  c.resize(static_cast<typename RawByteContainer::size_type>(n));
+}
+
+}
+
 template <class RawByteContainer>
 ASIOEXT_DETAIL_RF_RAW_RET(RawByteContainer)
     read_file(const char* filename, RawByteContainer& c)
@@ -112,7 +141,7 @@ ASIOEXT_DETAIL_RF_RAW_RET(RawByteContainer)
   }
 
   if (size != 0) {
-    c.resize(static_cast<typename RawByteContainer::size_type>(size));
+    detail::resize_for_overwrite(c, static_cast<std::size_t>(size), 0);
     asio::read(file, asio::buffer(&c[0], c.size()), ec);
   } else {
     c.clear();
@@ -0,0 +1,256 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_IMPL_READUNTIL_HPP
+#define ASIOEXT_IMPL_READUNTIL_HPP
+
+#include "asioext/composed_operation.hpp"
+#include "asioext/bind_handler.hpp"
+
+#include "asioext/detail/handler_work.hpp"
+#include "asioext/detail/throw_error.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/error.hpp>
+#else
+# include <asio/error.hpp>
+#endif
+
+#include <algorithm>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// Search the input sequence for [delim, delim + delim_size), starting at
+// |search_start|. Returns the end of the match, or 0 in which case
+// |search_start| is advanced past everything that cannot start a match.
+template <typename Allocator>
+std::size_t read_until_search(const dynamic_linear_buffer<Allocator>& buffer,
+                              const char* delim, std::size_t delim_size,
+                              std::size_t& search_start)
+{
+  const std::size_t pos = delim_size == 1
+      ? buffer.find(static_cast<uint8_t>(delim[0]), search_start)
+      : buffer.find(delim, delim_size, search_start);
+  if (pos != basic_linear_buffer<Allocator>::npos)
+    return pos + delim_size;
+
+  const std::size_t size = buffer.size();
+  search_start = size + 1 > delim_size ? size + 1 - delim_size : 0;
+  return 0;
+}
+
+// Number of bytes to ask the stream for. Tries to make use of the existing
+// capacity, but doesn't grow the buffer by more than 64k at once.
+template <typename Allocator>
+std::size_t read_until_read_size(const dynamic_linear_buffer<Allocator>& buffer)
+{
+  const std::size_t size = buffer.size();
+  return (std::min)(
+      (std::max<std::size_t>)(512, buffer.capacity() - size),
+      (std::min<std::size_t>)(65536, buffer.max_size() - size));
+}
+
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator>& buffer,
+                       const char* delim, std::size_t delim_size,
+                       error_code& ec)
+{
+  // An empty delimiter is found at the start of the input sequence.
+  if (delim_size == 0) {
+    ec = error_code();
+    return 0;
+  }
+
+  std::size_t search_start = 0;
+  for (;;) {
+    const std::size_t n = read_until_search(buffer, delim, delim_size,
+                                            search_start);
+    if (n != 0) {
+      ec = error_code();
+      return n;
+    }
+
+    if (buffer.size() == buffer.max_size()) {
+      ec = asio::error::not_found;
+      return 0;
+    }
+
+    typename dynamic_linear_buffer<Allocator>::mutable_buffers_type b =
+        buffer.prepare(read_until_read_size(buffer), ec);
+    if (ec)
+      return 0;
+
+    buffer.commit(s.read_some(b, ec));
+    if (ec)
+      return 0;
+  }
+}
+
+template <typename AsyncReadStream, typename Allocator, typename Handler>
+class read_until_op
+{
+public:
+  read_until_op(Handler& handler, AsyncReadStream& stream,
+                dynamic_linear_buffer<Allocator>& buffer,
+                const std::string& delim)
+    : stream_(stream)
+    , buffer_(ASIOEXT_MOVE_CAST(dynamic_linear_buffer<Allocator>)(buffer))
+    , delim_(delim)
+    , search_start_(0)
+  {
+    error_code ec;
+    const std::size_t n = !delim_.empty() ? search(ec) : 0;
+    if (n != 0 || ec || delim_.empty()) {
+      detail::post_handler(stream_, bind_handler(
+          ASIOEXT_MOVE_CAST(Handler)(handler), ec, n));
+      return;
+    }
+    read(handler);
+  }
+
+  void operator()(ASIOEXT_MOVE_ARG(Handler) handler,
+                  error_code ec, std::size_t size);
+
+private:
+  // Returns the number of bytes up to and including the delimiter, or 0
+  // if more data is needed. Sets |ec| if the buffer is full.
+  std::size_t search(error_code& ec)
+  {
+    const std::size_t n = read_until_search(buffer_, delim_.data(),
+                                            delim_.size(), search_start_);
+    if (n == 0 && buffer_.size() == buffer_.max_size())
+      ec = asio::error::not_found;
+    return n;
+  }
+
+  void read(Handler& handler)
+  {
+    error_code ec;
+    typename dynamic_linear_buffer<Allocator>::mutable_buffers_type b =
+        buffer_.prepare(read_until_read_size(buffer_), ec);
+    if (ec) {
+      detail::post_handler(stream_, bind_handler(
+          ASIOEXT_MOVE_CAST(Handler)(handler), ec, std::size_t(0)));
+      return;
+    }
+
+    stream_.async_read_some(b, asioext::make_composed_operation(
+        ASIOEXT_MOVE_CAST(Handler)(handler),
+        ASIOEXT_MOVE_CAST(read_until_op)(*this)));
+  }
+
+  AsyncReadStream& stream_;
+  dynamic_linear_buffer<Allocator> buffer_;
+  std::string delim_;
+  std::size_t search_start_;
+};
+
+template <typename AsyncReadStream, typename Allocator, typename Handler>
+void read_until_op<AsyncReadStream, Allocator, Handler>::operator()(
+    ASIOEXT_MOVE_ARG(Handler) handler, error_code ec, std::size_t size)
+{
+  buffer_.commit(size);
+  if (!ec) {
+    const std::size_t n = search(ec);
+    if (n == 0 && !ec) {
+      read(handler);
+      return;
+    }
+    if (!ec) {
+      handler(ec, n);
+      return;
+    }
+  }
+  handler(ec, 0);
+}
+
+template <typename AsyncReadStream, typename Allocator, typename Handler>
+void start_read_until_op(Handler& handler, AsyncReadStream& stream,
+                         dynamic_linear_buffer<Allocator>& buffer,
+                         const std::string& delim)
+{
+  read_until_op<AsyncReadStream, Allocator, Handler>(handler, stream,
+                                                     buffer, delim);
+}
+
+}
+
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator> buffer,
+                       char delim)
+{
+  error_code ec;
+  const std::size_t n = detail::read_until(s, buffer, &delim, 1, ec);
+  detail::throw_error(ec, "read_until");
+  return n;
+}
+
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator> buffer,
+                       char delim, error_code& ec)
+{
+  return detail::read_until(s, buffer, &delim, 1, ec);
+}
+
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator> buffer,
+                       const std::string& delim)
+{
+  error_code ec;
+  const std::size_t n = detail::read_until(s, buffer, delim.data(),
+                                           delim.size(), ec);
+  detail::throw_error(ec, "read_until");
+  return n;
+}
+
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator> buffer,
+                       const std::string& delim, error_code& ec)
+{
+  return detail::read_until(s, buffer, delim.data(), delim.size(), ec);
+}
+
+template <typename AsyncReadStream, typename Allocator, typename ReadHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+async_read_until(AsyncReadStream& s,
+                 dynamic_linear_buffer<Allocator> buffer,
+                 char delim, ASIOEXT_MOVE_ARG(ReadHandler) handler)
+{
+  typedef async_completion<
+    ReadHandler, void (error_code, std::size_t)
+  > init_t;
+
+  init_t init(handler);
+  detail::start_read_until_op(init.completion_handler, s, buffer,
+                              std::string(1, delim));
+  return init.result.get();
+}
+
+template <typename AsyncReadStream, typename Allocator, typename ReadHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+async_read_until(AsyncReadStream& s,
+                 dynamic_linear_buffer<Allocator> buffer,
+                 const std::string& delim,
+                 ASIOEXT_MOVE_ARG(ReadHandler) handler)
+{
+  typedef async_completion<
+    ReadHandler, void (error_code, std::size_t)
+  > init_t;
+
+  init_t init(handler);
+  detail::start_read_until_op(init.completion_handler, s, buffer, delim);
+  return init.result.get();
+}
+
+ASIOEXT_NS_END
+
+#endif
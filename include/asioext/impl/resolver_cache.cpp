@@ -0,0 +1,216 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/resolver_cache.hpp"
+
+#include "asioext/detail/mutex.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/error.hpp>
+#else
+# include <asio/error.hpp>
+#endif
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// host name, service name, flags, family, socket type, protocol
+typedef std::tuple<std::string, std::string, int, int, int, int>
+    resolver_cache_key;
+
+struct resolver_cache_state
+{
+  typedef asio::steady_timer::clock_type clock_type;
+
+  struct entry
+  {
+    asio::ip::tcp::resolver::iterator result;
+    error_code ec;
+    clock_type::time_point expiry;
+  };
+
+  typedef std::map<resolver_cache_key, entry> entry_map;
+  typedef erased_handler_ptr<
+    void (error_code, asio::ip::tcp::resolver::iterator)
+  > waiter_ptr;
+
+  typedef std::map<
+    resolver_cache_key, std::vector<waiter_ptr>
+  > pending_map;
+
+  resolver_cache_state(asio::io_service& io_service,
+                       const asio::steady_timer::duration& ttl,
+                       const asio::steady_timer::duration& negative_ttl,
+                       std::size_t max_entries)
+    : io_service(io_service)
+    , ttl(ttl)
+    , negative_ttl(negative_ttl)
+    , max_entries(max_entries)
+    , resolver(io_service)
+  {
+    // ctor
+  }
+
+  void on_resolved(const resolver_cache_key& key, const error_code& ec,
+                   const asio::ip::tcp::resolver::iterator& it);
+
+  // Make room for a new entry.
+  void evict(clock_type::time_point now);
+
+  asio::io_service& io_service;
+  const asio::steady_timer::duration ttl;
+  const asio::steady_timer::duration negative_ttl;
+  const std::size_t max_entries;
+
+  mutable mutex mutex_;
+
+  // All of these are protected by |mutex_|.
+  asio::ip::tcp::resolver resolver;
+  entry_map entries;
+  pending_map pending;
+};
+
+namespace {
+
+resolver_cache_key make_key(const asio::ip::tcp::resolver::query& q)
+{
+  const addrinfo& hints = q.hints();
+  return resolver_cache_key(q.host_name(), q.service_name(),
+                            hints.ai_flags, hints.ai_family,
+                            hints.ai_socktype, hints.ai_protocol);
+}
+
+// Only errors that say the name doesn't exist are worth remembering.
+bool is_cacheable(const error_code& ec)
+{
+  return !ec || ec == asio::error::host_not_found ||
+         ec == asio::error::no_data;
+}
+
+}
+
+void resolver_cache_state::on_resolved(
+    const resolver_cache_key& key, const error_code& ec,
+    const asio::ip::tcp::resolver::iterator& it)
+{
+  std::vector<waiter_ptr> waiters;
+  {
+    mutex::scoped_lock lock(mutex_);
+    const pending_map::iterator p = pending.find(key);
+    waiters.swap(p->second);
+    pending.erase(p);
+
+    const asio::steady_timer::duration d = ec ? negative_ttl : ttl;
+    if (is_cacheable(ec) && d > asio::steady_timer::duration::zero() &&
+        max_entries != 0) {
+      const clock_type::time_point now = clock_type::now();
+      if (entries.size() >= max_entries && entries.count(key) == 0)
+        evict(now);
+
+      entry& e = entries[key];
+      e.result = ec ? asio::ip::tcp::resolver::iterator() : it;
+      e.ec = ec;
+      e.expiry = now + d;
+    }
+  }
+
+  for (std::size_t i = 0; i != waiters.size(); ++i)
+    waiters[i].release()->post(ec, it);
+}
+
+void resolver_cache_state::evict(clock_type::time_point now)
+{
+  entry_map::iterator first = entries.end();
+  for (entry_map::iterator it = entries.begin(); it != entries.end(); ) {
+    if (it->second.expiry <= now) {
+      entries.erase(it++);
+      continue;
+    }
+    if (first == entries.end() || it->second.expiry < first->second.expiry)
+      first = it;
+    ++it;
+  }
+
+  if (entries.size() >= max_entries)
+    entries.erase(first);
+}
+
+}
+
+resolver_cache::resolver_cache(
+    asio::io_service& io_service,
+    const asio::steady_timer::duration& ttl,
+    const asio::steady_timer::duration& negative_ttl,
+    std::size_t max_entries)
+  : state_(std::make_shared<detail::resolver_cache_state>(
+        io_service, ttl, negative_ttl, max_entries))
+{
+  // ctor
+}
+
+resolver_cache::~resolver_cache()
+{
+  detail::mutex::scoped_lock lock(state_->mutex_);
+  state_->resolver.cancel();
+}
+
+asio::io_service& resolver_cache::get_io_service() ASIOEXT_NOEXCEPT
+{
+  return state_->io_service;
+}
+
+std::size_t resolver_cache::size() const
+{
+  detail::mutex::scoped_lock lock(state_->mutex_);
+  return state_->entries.size();
+}
+
+void resolver_cache::clear()
+{
+  detail::mutex::scoped_lock lock(state_->mutex_);
+  state_->entries.clear();
+}
+
+void resolver_cache::resolve(const asio::ip::tcp::resolver::query& q,
+                             waiter_ptr w)
+{
+  typedef detail::resolver_cache_state state_type;
+
+  const detail::resolver_cache_key key = detail::make_key(q);
+  detail::mutex::scoped_lock lock(state_->mutex_);
+
+  const state_type::entry_map::iterator it = state_->entries.find(key);
+  if (it != state_->entries.end()) {
+    if (it->second.expiry > state_type::clock_type::now()) {
+      const error_code ec = it->second.ec;
+      const asio::ip::tcp::resolver::iterator result = it->second.result;
+      lock.unlock();
+      w.release()->post(ec, result);
+      return;
+    }
+    state_->entries.erase(it);
+  }
+
+  // Lookups of the same query share the first one's result.
+  std::vector<waiter_ptr>& waiters =
+      state_->pending[key];
+  waiters.push_back(std::move(w));
+  if (waiters.size() != 1)
+    return;
+
+  const std::shared_ptr<state_type> state = state_;
+  state_->resolver.async_resolve(q,
+      [state, key] (error_code ec, asio::ip::tcp::resolver::iterator it) {
+    state->on_resolved(key, ec, it);
+  });
+}
+
+ASIOEXT_NS_END
@@ -0,0 +1,33 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_IMPL_RESOLVERCACHE_HPP
+#define ASIOEXT_IMPL_RESOLVERCACHE_HPP
+
+#include "asioext/detail/handler_work.hpp"
+
+ASIOEXT_NS_BEGIN
+
+template <typename ResolveHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ResolveHandler,
+    void(error_code, asio::ip::tcp::resolver::iterator))
+resolver_cache::async_resolve(const asio::ip::tcp::resolver::query& q,
+                              ASIOEXT_MOVE_ARG(ResolveHandler) handler)
+{
+  typedef async_completion<
+    ResolveHandler, void (error_code, asio::ip::tcp::resolver::iterator)
+  > init_t;
+
+  init_t init(handler);
+  resolve(q, detail::erased_handler_impl<
+      typename init_t::completion_handler_type,
+      error_code, asio::ip::tcp::resolver::iterator
+  >::create(init.completion_handler, get_io_service()));
+  return init.result.get();
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,121 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/segmented_buffer.hpp"
+
+#include "asioext/detail/error.hpp"
+#include "asioext/detail/throw_exception.hpp"
+
+#include <stdexcept>
+
+ASIOEXT_NS_BEGIN
+
+segmented_buffer::mutable_buffers_type segmented_buffer::prepare(std::size_t n)
+{
+  if (size_ > max_size_ || max_size_ - size_ < n) {
+    std::length_error ex("segmented_buffer too long");
+    detail::throw_exception(ex);
+  }
+
+  const std::size_t block_size = pool_->block_size();
+  const std::size_t end = offset_ + size_ + n;
+  const std::size_t needed = (end + block_size - 1) / block_size;
+
+  while (blocks_.size() < needed) {
+    uint8_t* block = pool_->allocate();
+    try {
+      blocks_.push_back(block);
+    } catch (...) {
+      pool_->deallocate(block);
+      throw;
+    }
+  }
+
+  // Blocks left over from an earlier, larger prepare() call aren't needed
+  // anymore.
+  while (blocks_.size() > needed && blocks_.size() > 1) {
+    pool_->deallocate(blocks_.back());
+    blocks_.pop_back();
+  }
+
+  prepared_ = n;
+
+  const std::size_t pos = offset_ + size_;
+  return mutable_buffers_type(blocks_.begin() + pos / block_size,
+                              pos % block_size, n, block_size);
+}
+
+segmented_buffer::mutable_buffers_type segmented_buffer::prepare(
+    std::size_t n, error_code& ec)
+{
+  if (size_ > max_size_ || max_size_ - size_ < n) {
+    ec = asio::error::no_memory;
+    return mutable_buffers_type();
+  }
+
+  ec = error_code();
+  return prepare(n);
+}
+
+void segmented_buffer::consume(std::size_t n) ASIOEXT_NOEXCEPT
+{
+  if (n >= size_) {
+    clear();
+    return;
+  }
+
+  const std::size_t block_size = pool_->block_size();
+  offset_ += n;
+  size_ -= n;
+  prepared_ = 0;
+
+  while (offset_ >= block_size) {
+    pool_->deallocate(blocks_.front());
+    blocks_.pop_front();
+    offset_ -= block_size;
+  }
+}
+
+void segmented_buffer::append(const void* data, std::size_t n)
+{
+  asio::buffer_copy(prepare(n), asio::buffer(data, n));
+  commit(n);
+}
+
+void segmented_buffer::clear() ASIOEXT_NOEXCEPT
+{
+  for (std::deque<uint8_t*>::iterator it = blocks_.begin(),
+       end = blocks_.end(); it != end; ++it)
+    pool_->deallocate(*it);
+
+  blocks_.clear();
+  offset_ = size_ = prepared_ = 0;
+}
+
+dynamic_segmented_buffer::mutable_buffers_type
+dynamic_segmented_buffer::prepare(std::size_t n)
+{
+  const std::size_t size = data_.size();
+  if (size > max_size_ || max_size_ - size < n) {
+    std::length_error ex("dynamic_segmented_buffer too long");
+    detail::throw_exception(ex);
+  }
+
+  return data_.prepare(n);
+}
+
+dynamic_segmented_buffer::mutable_buffers_type
+dynamic_segmented_buffer::prepare(std::size_t n, error_code& ec)
+{
+  const std::size_t size = data_.size();
+  if (size > max_size_ || max_size_ - size < n) {
+    ec = asio::error::no_memory;
+    return mutable_buffers_type();
+  }
+
+  return data_.prepare(n, ec);
+}
+
+ASIOEXT_NS_END
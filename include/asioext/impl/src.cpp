@@ -8,18 +8,31 @@
 
 #include "asioext/detail/config.hpp"
 
+#include "asioext/impl/block_pool.cpp"
+#include "asioext/impl/buffer_pool.cpp"
 #include "asioext/impl/cancellation_token.cpp"
 #include "asioext/impl/chrono.cpp"
 #include "asioext/impl/connect.cpp"
+#include "asioext/impl/directory_handle.cpp"
 #include "asioext/impl/duplicate.cpp"
+#include "asioext/impl/file_io_observer.cpp"
 #include "asioext/impl/file_handle.cpp"
+#include "asioext/impl/mirrored_circular_buffer.cpp"
 #include "asioext/impl/open.cpp"
 #include "asioext/impl/open_flags.cpp"
+#include "asioext/impl/parallel_walk.cpp"
+#include "asioext/impl/resolver_cache.cpp"
+#include "asioext/impl/segmented_buffer.cpp"
 #include "asioext/impl/standard_streams.cpp"
 #include "asioext/impl/thread_pool_file_service.cpp"
 #include "asioext/impl/unique_file_handle.cpp"
 #include "asioext/socks/impl/error.cpp"
 #include "asioext/socks/detail/impl/protocol.cpp"
+#include "asioext/socks/impl/server.cpp"
+#include "asioext/socks/impl/udp.cpp"
+#include "asioext/detail/impl/aligned_memory.cpp"
+#include "asioext/detail/impl/byte_search.cpp"
+#include "asioext/detail/impl/frame_allocator.cpp"
 
 #if defined(ASIOEXT_WINDOWS)
 # include "asioext/impl/file_handle_win.cpp"
@@ -28,4 +41,5 @@
 #else
 # include "asioext/impl/file_handle_posix.cpp"
 # include "asioext/detail/impl/posix_file_ops.cpp"
+# include "asioext/detail/impl/mirrored_memory.cpp"
 #endif
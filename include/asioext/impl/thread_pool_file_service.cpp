@@ -8,6 +8,12 @@
 
 #include "asioext/detail/error.hpp"
 
+#if !defined(ASIOEXT_WINDOWS)
+# include "asioext/detail/posix_file_ops.hpp"
+#endif
+
+#include <cerrno>
+
 ASIOEXT_NS_BEGIN
 
 void thread_pool_file_service::thread_function::operator()()
@@ -22,6 +28,13 @@ thread_pool_file_service::thread_pool_file_service(
   : service_base(io_service)
   , work_(pool_)
   , impl_list_(0)
+#if defined(ASIOEXT_HAS_NOWAIT_READS)
+  , nowait_reads_(true)
+#else
+  , nowait_reads_(false)
+#endif
+  , nowait_hits_(0)
+  , nowait_misses_(0)
 {
   work_.on_work_started();
 
@@ -60,8 +73,16 @@ void thread_pool_file_service::move_construct(
   impl.handle_ = other_impl.handle_;
   other_impl.handle_.clear();
 
-  impl.cancel_token_ =
-      ASIOEXT_MOVE_CAST(cancellation_token_source)(other_impl.cancel_token_);
+  // Pending async_open() calls refer to |other_impl|, so they must not
+  // inherit our tokens. They are cancelled along with everything else,
+  // and |impl| keeps its fresh token source.
+  if (other_impl.pending_opens_ != 0) {
+    other_impl.cancel_token_.destroy();
+    other_impl.pending_opens_ = 0;
+  } else {
+    impl.cancel_token_ =
+        ASIOEXT_MOVE_CAST(cancellation_token_source)(other_impl.cancel_token_);
+  }
 
   // Insert implementation into linked list of all implementations.
   detail::mutex::scoped_lock lock(mutex_);
@@ -78,6 +99,17 @@ void thread_pool_file_service::move_assign(
 {
   close_for_destruction(impl);
 
+  // Pending async_open() calls would assign a handle to one of the two
+  // implementations after the fact.
+  if (impl.pending_opens_ != 0) {
+    impl.cancel_token_.cancel();
+    impl.pending_opens_ = 0;
+  }
+  if (other_impl.pending_opens_ != 0) {
+    other_impl.cancel_token_.cancel();
+    other_impl.pending_opens_ = 0;
+  }
+
   if (this != &other_service) {
     // Remove implementation from linked list of all implementations.
     detail::mutex::scoped_lock lock(mutex_);
@@ -110,6 +142,9 @@ void thread_pool_file_service::destroy(implementation_type& impl)
 {
   close_for_destruction(impl);
 
+  // Pending async_open() calls must not touch |impl| anymore.
+  impl.cancel_token_.destroy();
+
   // Remove implementation from linked list of all implementations.
   detail::mutex::scoped_lock lock(mutex_);
   if (impl_list_ == &impl)
@@ -261,18 +296,70 @@ void thread_pool_file_service::times(implementation_type& impl,
   impl.handle_.times(new_times, ec);
 }
 
+file_status thread_pool_file_service::status(implementation_type& impl,
+                                             file_status_mask mask,
+                                             error_code& ec) ASIOEXT_NOEXCEPT
+{
+  return impl.handle_.status(mask, ec);
+}
+
 void thread_pool_file_service::cancel(implementation_type& impl,
                                       error_code& ec) ASIOEXT_NOEXCEPT
 {
-  if (!impl.handle_.is_open()) {
+  if (!impl.handle_.is_open() && impl.pending_opens_ == 0) {
     ec = asio::error::bad_descriptor;
     return;
   }
 
   impl.cancel_token_.cancel();
+  impl.pending_opens_ = 0;
+  ec = error_code();
   // TODO(tim): log handler operation
 }
 
+void thread_pool_file_service::nowait_reads(bool enabled) ASIOEXT_NOEXCEPT
+{
+#if defined(ASIOEXT_HAS_NOWAIT_READS)
+  nowait_reads_.store(enabled, std::memory_order_relaxed);
+#else
+  (void)enabled;
+#endif
+}
+
+bool thread_pool_file_service::nowait_reads() const ASIOEXT_NOEXCEPT
+{
+  return nowait_reads_.load(std::memory_order_relaxed);
+}
+
+thread_pool_file_service::nowait_read_stats
+thread_pool_file_service::nowait_stats() const ASIOEXT_NOEXCEPT
+{
+  nowait_read_stats stats;
+  stats.hits = nowait_hits_.load(std::memory_order_relaxed);
+  stats.misses = nowait_misses_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void thread_pool_file_service::nowait_read_result(
+    const error_code& ec) ASIOEXT_NOEXCEPT
+{
+  // Only these complete without the thread pool. All other errors make
+  // the caller retry the read there.
+  if (!ec || ec == asio::error::eof) {
+    nowait_hits_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  if (ec == asio::error::operation_not_supported ||
+      ec == asio::error::invalid_argument ||
+      ec.value() == ENOSYS) {
+    // Old kernels reject the flag (or preadv2 altogether) and some file
+    // systems don't implement it. Don't bother trying again.
+    nowait_reads_.store(false, std::memory_order_relaxed);
+  }
+  nowait_misses_.fetch_add(1, std::memory_order_relaxed);
+}
+
 void thread_pool_file_service::close_for_destruction(implementation_type& impl)
 {
   if (impl.handle_.is_open()) {
@@ -7,14 +7,20 @@
 #define ASIOEXT_IMPL_THREADPOOLFILESERVICE_HPP
 
 #include "asioext/file_handle.hpp"
+#include "asioext/open.hpp"
 #include "asioext/composed_operation.hpp"
 #include "asioext/error_code.hpp"
 #include "asioext/bind_handler.hpp"
 
+#include "asioext/detail/buffer_sequence_adapter.hpp"
+#include "asioext/detail/consuming_buffers.hpp"
 #include "asioext/detail/error.hpp"
+#include "asioext/detail/handler_work.hpp"
 #include "asioext/detail/move_support.hpp"
 #include "asioext/detail/operation.hpp"
 
+#include <string>
+
 ASIOEXT_NS_BEGIN
 
 namespace detail {
@@ -116,6 +122,290 @@ private:
   ConstBufferSequence buffers_;
 };
 
+template <typename MutableBufferSequence, typename Handler>
+class read_at_op : public operation<Handler>
+{
+public:
+  read_at_op(const cancellation_token_source& source, file_handle handle,
+             uint64_t offset, const MutableBufferSequence& buffers,
+             Handler& handler, asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , handle_(handle)
+    , cancel_token_(source)
+    , offset_(offset)
+    , buffers_(buffers)
+  {
+    // ctor
+  }
+
+  void operator()();
+
+  // Called by transfer_all_at() for every partial read.
+  template <typename Buffers>
+  std::size_t operator()(uint64_t offset, const Buffers& buffers,
+                         error_code& ec)
+  {
+    if (cancel_token_.cancelled()) {
+      ec = asio::error::operation_aborted;
+      return 0;
+    }
+    return handle_.read_some_at(offset, buffers, ec);
+  }
+
+private:
+  file_handle handle_;
+  cancellation_token cancel_token_;
+  uint64_t offset_;
+  MutableBufferSequence buffers_;
+};
+
+template <typename ConstBufferSequence, typename Handler>
+class write_at_op : public operation<Handler>
+{
+public:
+  write_at_op(const cancellation_token_source& source, file_handle handle,
+              uint64_t offset, const ConstBufferSequence& buffers,
+              Handler& handler, asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , handle_(handle)
+    , cancel_token_(source)
+    , offset_(offset)
+    , buffers_(buffers)
+  {
+    // ctor
+  }
+
+  void operator()();
+
+  // Called by transfer_all_at() for every partial write.
+  template <typename Buffers>
+  std::size_t operator()(uint64_t offset, const Buffers& buffers,
+                         error_code& ec)
+  {
+    if (cancel_token_.cancelled()) {
+      ec = asio::error::operation_aborted;
+      return 0;
+    }
+    return handle_.write_some_at(offset, buffers, ec);
+  }
+
+private:
+  file_handle handle_;
+  cancellation_token cancel_token_;
+  uint64_t offset_;
+  ConstBufferSequence buffers_;
+};
+
+template <typename Handler>
+class open_op : public operation<Handler>
+{
+public:
+  open_op(const cancellation_token_source& source, const char* filename,
+          const open_args& args, Handler& handler,
+          asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , cancel_token_(source)
+    , filename_(filename)
+    , args_(args)
+  {
+    // ctor
+  }
+
+  void operator()()
+  {
+    error_code ec;
+    file_handle handle;
+    if (cancel_token_.cancelled()) {
+      ec = asio::error::operation_aborted;
+    } else {
+      handle = asioext::open(filename_.c_str(), args_, ec).release();
+    }
+    this->complete(ec, handle);
+  }
+
+private:
+  cancellation_token cancel_token_;
+  std::string filename_;
+  open_args args_;
+};
+
+template <typename Handler>
+class close_op : public operation<Handler>
+{
+public:
+  close_op(file_handle handle, Handler& handler, asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , handle_(handle)
+  {
+    // ctor
+  }
+
+  void operator()()
+  {
+    error_code ec;
+    handle_.close(ec);
+    this->complete(ec);
+  }
+
+private:
+  file_handle handle_;
+};
+
+template <typename Handler>
+class size_op : public operation<Handler>
+{
+public:
+  size_op(const cancellation_token_source& source, file_handle handle,
+          Handler& handler, asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , handle_(handle)
+    , cancel_token_(source)
+  {
+    // ctor
+  }
+
+  void operator()()
+  {
+    error_code ec;
+    uint64_t size = 0;
+    if (cancel_token_.cancelled()) {
+      ec = asio::error::operation_aborted;
+    } else {
+      size = handle_.size(ec);
+    }
+    this->complete(ec, size);
+  }
+
+private:
+  file_handle handle_;
+  cancellation_token cancel_token_;
+};
+
+template <typename Handler>
+class resize_op : public operation<Handler>
+{
+public:
+  resize_op(const cancellation_token_source& source, file_handle handle,
+            uint64_t new_size, Handler& handler,
+            asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , handle_(handle)
+    , cancel_token_(source)
+    , new_size_(new_size)
+  {
+    // ctor
+  }
+
+  void operator()()
+  {
+    error_code ec;
+    if (cancel_token_.cancelled()) {
+      ec = asio::error::operation_aborted;
+    } else {
+      handle_.size(new_size_, ec);
+    }
+    this->complete(ec);
+  }
+
+private:
+  file_handle handle_;
+  cancellation_token cancel_token_;
+  uint64_t new_size_;
+};
+
+template <typename Handler>
+class times_op : public operation<Handler>
+{
+public:
+  times_op(const cancellation_token_source& source, file_handle handle,
+           Handler& handler, asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , handle_(handle)
+    , cancel_token_(source)
+  {
+    // ctor
+  }
+
+  void operator()()
+  {
+    error_code ec;
+    file_times times;
+    if (cancel_token_.cancelled()) {
+      ec = asio::error::operation_aborted;
+    } else {
+      times = handle_.times(ec);
+    }
+    this->complete(ec, times);
+  }
+
+private:
+  file_handle handle_;
+  cancellation_token cancel_token_;
+};
+
+template <typename Handler>
+class status_op : public operation<Handler>
+{
+public:
+  status_op(const cancellation_token_source& source, file_handle handle,
+            file_status_mask mask, Handler& handler,
+            asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , handle_(handle)
+    , cancel_token_(source)
+    , mask_(mask)
+  {
+    // ctor
+  }
+
+  void operator()()
+  {
+    error_code ec;
+    file_status status;
+    if (cancel_token_.cancelled()) {
+      ec = asio::error::operation_aborted;
+    } else {
+      status = handle_.status(mask_, ec);
+    }
+    this->complete(ec, status);
+  }
+
+private:
+  file_handle handle_;
+  cancellation_token cancel_token_;
+  file_status_mask mask_;
+};
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+template <typename Handler>
+class read_entries_op : public operation<Handler>
+{
+public:
+  read_entries_op(directory_handle::native_handle_type handle,
+                  const asio::mutable_buffer& buffer,
+                  Handler& handler, asio::io_service& io_service)
+    : operation<Handler>(ASIOEXT_MOVE_CAST(Handler)(handler), io_service)
+    , handle_(handle)
+    , buffer_(buffer)
+  {
+    // ctor
+  }
+
+  void operator()()
+  {
+    error_code ec;
+    void* data = asio::buffer_cast<void*>(buffer_);
+    const std::size_t size = posix_file_ops::getdents(
+        handle_, data, asio::buffer_size(buffer_), ec);
+    this->complete(ec, directory_entries(data, size));
+  }
+
+private:
+  directory_handle::native_handle_type handle_;
+  asio::mutable_buffer buffer_;
+};
+#endif
+
 template <typename MutableBufferSequence, typename Handler>
 void read_some_op<MutableBufferSequence, Handler>::operator()()
 {
@@ -126,8 +416,7 @@ void read_some_op<MutableBufferSequence, Handler>::operator()()
   } else {
     bytes_transferred = handle_.read_some(buffers_, ec);
   }
-  this->get_executor().dispatch(bind_handler(
-      ASIOEXT_MOVE_CAST(Handler)(this->handler_), ec, bytes_transferred));
+  this->complete(ec, bytes_transferred);
 }
 
 template <typename ConstBufferSequence, typename Handler>
@@ -140,8 +429,7 @@ void write_some_op<ConstBufferSequence, Handler>::operator()()
   } else {
     bytes_transferred = handle_.write_some(buffers_, ec);
   }
-  this->get_executor().dispatch(bind_handler(
-      ASIOEXT_MOVE_CAST(Handler)(this->handler_), ec, bytes_transferred));
+  this->complete(ec, bytes_transferred);
 }
 
 template <typename MutableBufferSequence, typename Handler>
@@ -154,8 +442,7 @@ void read_some_at_op<MutableBufferSequence, Handler>::operator()()
   } else {
     bytes_transferred = handle_.read_some_at(offset_, buffers_, ec);
   }
-  this->get_executor().dispatch(bind_handler(
-      ASIOEXT_MOVE_CAST(Handler)(this->handler_), ec, bytes_transferred));
+  this->complete(ec, bytes_transferred);
 }
 
 template <typename ConstBufferSequence, typename Handler>
@@ -168,8 +455,25 @@ void write_some_at_op<ConstBufferSequence, Handler>::operator()()
   } else {
     bytes_transferred = handle_.write_some_at(offset_, buffers_, ec);
   }
-  this->get_executor().dispatch(bind_handler(
-      ASIOEXT_MOVE_CAST(Handler)(this->handler_), ec, bytes_transferred));
+  this->complete(ec, bytes_transferred);
+}
+
+template <typename MutableBufferSequence, typename Handler>
+void read_at_op<MutableBufferSequence, Handler>::operator()()
+{
+  error_code ec;
+  const std::size_t bytes_transferred =
+      transfer_all_at<asio::mutable_buffer>(offset_, buffers_, *this, ec);
+  this->complete(ec, bytes_transferred);
+}
+
+template <typename ConstBufferSequence, typename Handler>
+void write_at_op<ConstBufferSequence, Handler>::operator()()
+{
+  error_code ec;
+  const std::size_t bytes_transferred =
+      transfer_all_at<asio::const_buffer>(offset_, buffers_, *this, ec);
+  this->complete(ec, bytes_transferred);
 }
 
 }
@@ -242,6 +546,34 @@ thread_pool_file_service::async_write_some(implementation_type& impl,
   return init.result.get();
 }
 
+template <typename MutableBufferSequence>
+bool thread_pool_file_service::try_read_some_at_nowait(
+    implementation_type& impl, uint64_t offset,
+    const MutableBufferSequence& buffers,
+    std::size_t& bytes_transferred, error_code& ec) ASIOEXT_NOEXCEPT
+{
+#if defined(ASIOEXT_HAS_NOWAIT_READS)
+  if (!nowait_reads_.load(std::memory_order_relaxed) ||
+      !impl.handle_.is_open())
+    return false;
+
+  // Only the first chunk is read, which is fine for a *_some operation.
+  detail::buffer_sequence_adapter<asio::mutable_buffer, MutableBufferSequence>
+      bufs(buffers);
+  bytes_transferred = detail::posix_file_ops::preadv_nowait(
+      impl.handle_.native_handle(), bufs.buffers(), bufs.count(), offset, ec);
+  nowait_read_result(ec);
+  return !ec || ec == asio::error::eof;
+#else
+  (void)impl;
+  (void)offset;
+  (void)buffers;
+  (void)bytes_transferred;
+  (void)ec;
+  return false;
+#endif
+}
+
 template <typename MutableBufferSequence, typename Handler>
 ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, std::size_t))
 thread_pool_file_service::async_read_some_at(
@@ -255,6 +587,17 @@ thread_pool_file_service::async_read_some_at(
   > operation;
 
   init_t init(handler);
+
+  // Fast path: The data is cached, so we can complete immediately.
+  error_code ec;
+  std::size_t bytes_transferred = 0;
+  if (try_read_some_at_nowait(impl, offset, buffers, bytes_transferred, ec)) {
+    detail::post_handler(this->get_io_service(), bind_handler(
+        ASIOEXT_MOVE_CAST(typename init_t::completion_handler_type)(
+            init.completion_handler), ec, bytes_transferred));
+    return init.result.get();
+  }
+
   operation op(impl.cancel_token_, impl.handle_, offset, buffers,
                init.completion_handler, this->get_io_service());
   pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
@@ -279,6 +622,229 @@ thread_pool_file_service::async_write_some_at(
   return init.result.get();
 }
 
+template <typename MutableBufferSequence, typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, std::size_t))
+thread_pool_file_service::async_read_at(
+    implementation_type& impl, uint64_t offset,
+    const MutableBufferSequence& buffers,
+    ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<Handler, void (error_code, std::size_t)> init_t;
+  typedef detail::read_at_op<MutableBufferSequence,
+      typename init_t::completion_handler_type
+  > operation;
+
+  init_t init(handler);
+  operation op(impl.cancel_token_, impl.handle_, offset, buffers,
+               init.completion_handler, this->get_io_service());
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+
+template <typename ConstBufferSequence, typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, std::size_t))
+thread_pool_file_service::async_write_at(
+    implementation_type& impl, uint64_t offset,
+    const ConstBufferSequence& buffers, ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<Handler, void (error_code, std::size_t)> init_t;
+  typedef detail::write_at_op<ConstBufferSequence,
+      typename init_t::completion_handler_type
+  > operation;
+
+  init_t init(handler);
+  operation op(impl.cancel_token_, impl.handle_, offset, buffers,
+               init.completion_handler, this->get_io_service());
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+
+// Runs on the handler's executor, which is the only place where the
+// implementation may be modified.
+class thread_pool_file_service::open_completion
+{
+public:
+  explicit open_completion(implementation_type& impl)
+    : impl_(&impl)
+    , cancel_token_(impl.cancel_token_)
+  {
+    // ctor
+  }
+
+  template <typename Handler>
+  void operator()(Handler&& handler, error_code ec, file_handle handle)
+  {
+    // The token is cancelled if the implementation was cancelled, closed,
+    // moved or destroyed in the meantime, so |impl_| mustn't be touched.
+    if (cancel_token_.cancelled()) {
+      if (!ec) {
+        error_code ignored;
+        handle.close(ignored);
+        ec = asio::error::operation_aborted;
+      }
+    } else {
+      --impl_->pending_opens_;
+      if (!ec) {
+        if (impl_->handle_.is_open()) {
+          error_code ignored;
+          handle.close(ignored);
+          ec = asio::error::already_open;
+        } else {
+          impl_->handle_ = handle;
+        }
+      }
+    }
+    handler(ec);
+  }
+
+private:
+  implementation_type* impl_;
+  cancellation_token cancel_token_;
+};
+
+template <typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code))
+thread_pool_file_service::async_open(implementation_type& impl,
+                                     const char* filename,
+                                     const open_args& args,
+                                     ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<Handler, void (error_code)> init_t;
+  typedef typename init_t::completion_handler_type handler_type;
+  typedef detail::composed_op<handler_type, open_completion> completion_type;
+  typedef detail::open_op<completion_type> operation;
+
+  init_t init(handler);
+  if (impl.handle_.is_open()) {
+    const error_code ec = asio::error::already_open;
+    detail::post_handler(this->get_io_service(), bind_handler(
+        ASIOEXT_MOVE_CAST(handler_type)(init.completion_handler), ec));
+    return init.result.get();
+  }
+
+  completion_type completion(
+      ASIOEXT_MOVE_CAST(handler_type)(init.completion_handler),
+      open_completion(impl));
+  operation op(impl.cancel_token_, filename, args, completion,
+               this->get_io_service());
+  ++impl.pending_opens_;
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+
+template <typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code))
+thread_pool_file_service::async_close(implementation_type& impl,
+                                      ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<Handler, void (error_code)> init_t;
+  typedef detail::close_op<
+    typename init_t::completion_handler_type
+  > operation;
+
+  init_t init(handler);
+  operation op(impl.handle_, init.completion_handler, this->get_io_service());
+
+  impl.handle_.clear();
+  impl.cancel_token_.cancel();
+  impl.pending_opens_ = 0;
+
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+
+template <typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, uint64_t))
+thread_pool_file_service::async_size(implementation_type& impl,
+                                     ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<Handler, void (error_code, uint64_t)> init_t;
+  typedef detail::size_op<
+    typename init_t::completion_handler_type
+  > operation;
+
+  init_t init(handler);
+  operation op(impl.cancel_token_, impl.handle_, init.completion_handler,
+               this->get_io_service());
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+
+template <typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code))
+thread_pool_file_service::async_size(implementation_type& impl,
+                                     uint64_t new_size,
+                                     ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<Handler, void (error_code)> init_t;
+  typedef detail::resize_op<
+    typename init_t::completion_handler_type
+  > operation;
+
+  init_t init(handler);
+  operation op(impl.cancel_token_, impl.handle_, new_size,
+               init.completion_handler, this->get_io_service());
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+
+template <typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, file_times))
+thread_pool_file_service::async_times(implementation_type& impl,
+                                      ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<Handler, void (error_code, file_times)> init_t;
+  typedef detail::times_op<
+    typename init_t::completion_handler_type
+  > operation;
+
+  init_t init(handler);
+  operation op(impl.cancel_token_, impl.handle_, init.completion_handler,
+               this->get_io_service());
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+
+template <typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, file_status))
+thread_pool_file_service::async_status(implementation_type& impl,
+                                       file_status_mask mask,
+                                       ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<Handler, void (error_code, file_status)> init_t;
+  typedef detail::status_op<
+    typename init_t::completion_handler_type
+  > operation;
+
+  init_t init(handler);
+  operation op(impl.cancel_token_, impl.handle_, mask, init.completion_handler,
+               this->get_io_service());
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+template <typename Handler>
+ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, directory_entries))
+thread_pool_file_service::async_read_entries(
+    directory_handle& dir, const asio::mutable_buffer& buffer,
+    ASIOEXT_MOVE_ARG(Handler) handler)
+{
+  typedef async_completion<
+    Handler, void (error_code, directory_entries)
+  > init_t;
+  typedef detail::read_entries_op<
+    typename init_t::completion_handler_type
+  > operation;
+
+  init_t init(handler);
+  operation op(dir.native_handle(), buffer, init.completion_handler,
+               this->get_io_service());
+  pool_.post(ASIOEXT_MOVE_CAST(operation)(op));
+  return init.result.get();
+}
+#endif
+
 ASIOEXT_NS_END
 
 #endif
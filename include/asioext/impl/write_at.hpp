@@ -0,0 +1,64 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_IMPL_WRITEAT_HPP
+#define ASIOEXT_IMPL_WRITEAT_HPP
+
+#include "asioext/detail/consuming_buffers.hpp"
+#include "asioext/detail/throw_error.hpp"
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+template <typename RandomAccessWriteDevice>
+struct write_some_at_fn
+{
+  template <typename ConstBufferSequence>
+  std::size_t operator()(uint64_t offset,
+                         const ConstBufferSequence& buffers,
+                         error_code& ec)
+  {
+    return device.write_some_at(offset, buffers, ec);
+  }
+
+  RandomAccessWriteDevice& device;
+};
+
+}
+
+template <typename RandomAccessWriteDevice, typename ConstBufferSequence>
+std::size_t write_at(RandomAccessWriteDevice& device, uint64_t offset,
+                     const ConstBufferSequence& buffers)
+{
+  error_code ec;
+  const std::size_t n = write_at(device, offset, buffers, ec);
+  detail::throw_error(ec, "write_at");
+  return n;
+}
+
+template <typename RandomAccessWriteDevice, typename ConstBufferSequence>
+std::size_t write_at(RandomAccessWriteDevice& device, uint64_t offset,
+                     const ConstBufferSequence& buffers, error_code& ec)
+{
+  detail::write_some_at_fn<RandomAccessWriteDevice> op = {device};
+  return detail::transfer_all_at<asio::const_buffer>(offset, buffers,
+                                                     op, ec);
+}
+
+template <typename FileService, typename ConstBufferSequence,
+          typename WriteHandler>
+ASIOEXT_INITFN_RESULT_TYPE(WriteHandler, void(error_code, std::size_t))
+async_write_at(basic_file<FileService>& file, uint64_t offset,
+               const ConstBufferSequence& buffers,
+               ASIOEXT_MOVE_ARG(WriteHandler) handler)
+{
+  return file.async_write_at(offset, buffers,
+                             ASIOEXT_MOVE_CAST(WriteHandler)(handler));
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -48,6 +48,10 @@ ASIOEXT_NS_BEGIN
 /// | ---------- | ----------- | ------- | ------------ | ------------- |
 /// | `a.resize(n)` | void | erases or appends elements to meet `size() == n` | | `a.size() == n` |
 ///
+/// If `a.resize_uninitialized(n)` is valid as well, functions that overwrite
+/// the resized range anyway (e.g. @ref read_file()) use it instead of
+/// `a.resize(n)` to avoid initializing the new elements.
+///
 /// @{
 
 #if defined(ASIOEXT_IS_DOCUMENTATION)
@@ -16,6 +16,7 @@
 
 #include "asioext/error_code.hpp"
 #include "asioext/detail/buffer.hpp"
+#include "asioext/detail/byte_search.hpp"
 #include "asioext/detail/is_raw_byte_container.hpp"
 #include "asioext/detail/move_support.hpp"
 #include "asioext/detail/cstdint.hpp"
@@ -26,6 +27,27 @@
 
 ASIOEXT_NS_BEGIN
 
+/// @ingroup core
+/// @brief Specifies how a @c basic_linear_buffer grows its capacity.
+///
+/// Regardless of the policy, the new capacity is always large enough for
+/// the requested size and never exceeds the buffer's maximum size.
+enum class linear_buffer_growth
+{
+  /// Allocate exactly the required size. Repeated appends reallocate
+  /// every time.
+  exact,
+
+  /// Grow the capacity by a factor of 1.5.
+  factor_1_5,
+
+  /// Double the capacity. This is the default.
+  factor_2,
+
+  /// Allocate the required size, rounded up to a multiple of 4096 bytes.
+  page_rounded,
+};
+
 /// @ingroup core
 /// @brief Basic container-like wrapper around a dynamic size byte array.
 ///
@@ -64,6 +86,9 @@ public:
   static_assert(std::is_same<typename allocator_type::value_type, uint8_t>::value,
                 "Allocator::value_type must be uint8_t");
 
+  /// The value returned by the find functions if nothing was found.
+  static const std::size_t npos = static_cast<std::size_t>(-1);
+
   /// @brief Default-construct a basic_linear_buffer.
   ///
   /// The constructed basic_linear_buffer is empty and doesn't have
@@ -73,6 +98,7 @@ public:
     , capacity_(0)
     , size_(0)
     , max_size_(allocator_traits_type::max_size(rep_))
+    , growth_(linear_buffer_growth::factor_2)
   {
   }
 
@@ -87,6 +113,7 @@ public:
     , capacity_(0)
     , size_(0)
     , max_size_(allocator_traits_type::max_size(rep_))
+    , growth_(linear_buffer_growth::factor_2)
   {
   }
 
@@ -102,6 +129,7 @@ public:
     , size_(initial_size)
     , max_size_((std::min)(allocator_traits_type::max_size(rep_),
                            maximum_size))
+    , growth_(linear_buffer_growth::factor_2)
   {
     rep_.data_ = allocator_traits_type::allocate(rep_, initial_size);
   }
@@ -119,6 +147,7 @@ public:
     , size_(initial_size)
     , max_size_((std::min)(allocator_traits_type::max_size(rep_),
                            maximum_size))
+    , growth_(linear_buffer_growth::factor_2)
   {
     rep_.data_ = allocator_traits_type::allocate(rep_, initial_size);
   }
@@ -136,6 +165,7 @@ public:
     , capacity_(other.capacity_)
     , size_(other.size_)
     , max_size_(other.max_size_)
+    , growth_(other.growth_)
   {
     other.capacity_ = other.size_ = 0;
   }
@@ -158,9 +188,20 @@ public:
   ///
   /// After the move, @c other is an empty buffer with no allocated memory
   /// (as-if just default-constructed).
-  basic_linear_buffer& operator=(basic_linear_buffer&& other) ASIOEXT_NOEXCEPT;
+  ///
+  /// If the allocator doesn't propagate on move assignment and differs from
+  /// @c other's, the data is copied, which may throw.
+  basic_linear_buffer& operator=(basic_linear_buffer&& other)
+      ASIOEXT_NOEXCEPT_IF(allocator_traits_type::
+                          propagate_on_container_move_assignment::value);
 #endif
 
+  /// @brief Get a copy of the allocator used by this buffer.
+  allocator_type get_allocator() const ASIOEXT_NOEXCEPT
+  {
+    return static_cast<const allocator_type&>(rep_);
+  }
+
   /// @brief Get the size of the input sequence.
   std::size_t size() const ASIOEXT_NOEXCEPT
   {
@@ -257,6 +298,40 @@ public:
     return rep_.data_[i];
   }
 
+  /// @brief Find the first occurrence of a byte.
+  ///
+  /// The search compares 16 or 32 bytes at once (SSE2 / AVX2, selected at
+  /// runtime) where available.
+  ///
+  /// @param value The byte to search for.
+  /// @param pos The offset at which to start the search.
+  ///
+  /// @returns The offset of the first occurrence at or after @c pos,
+  /// or @c npos if there is none.
+  std::size_t find(uint8_t value, std::size_t pos = 0) const ASIOEXT_NOEXCEPT;
+
+  /// @brief Find the first occurrence of a byte sequence.
+  ///
+  /// @param s Pointer to the sequence to search for.
+  /// @param n Size of the sequence. An empty sequence is found at @c pos.
+  /// @param pos The offset at which to start the search.
+  ///
+  /// @returns The offset of the first occurrence at or after @c pos,
+  /// or @c npos if there is none.
+  std::size_t find(const void* s, std::size_t n,
+                   std::size_t pos = 0) const ASIOEXT_NOEXCEPT;
+
+  /// @brief Find the first byte that is part of a set.
+  ///
+  /// @param set Pointer to the set of bytes to search for.
+  /// @param n Number of bytes in the set.
+  /// @param pos The offset at which to start the search.
+  ///
+  /// @returns The offset of the first matching byte at or after @c pos,
+  /// or @c npos if there is none.
+  std::size_t find_any(const void* set, std::size_t n,
+                       std::size_t pos = 0) const ASIOEXT_NOEXCEPT;
+
   /// @brief Append the given data to the buffer.
   ///
   /// This function appends the given raw data to the buffer,
@@ -368,6 +443,42 @@ public:
   /// (including the `end()` iterator) are invalidated.
   void resize(std::size_t new_size);
 
+  /// @brief Resize the buffer without initializing new bytes.
+  ///
+  /// Equivalent to resize(). This function exists so that generic code
+  /// (e.g. @ref read_file()) can detect containers that don't need to
+  /// initialize memory which is about to be overwritten anyway.
+  ///
+  /// If the buffer is resized, all iterators and references
+  /// (including the `end()` iterator) are invalidated.
+  void resize_uninitialized(std::size_t new_size)
+  {
+    resize(new_size);
+  }
+
+  /// @brief Release unused capacity.
+  ///
+  /// Reallocates the buffer to fit exactly size() bytes. An empty buffer
+  /// frees all of its memory.
+  ///
+  /// If the buffer is reallocated, all iterators and references
+  /// (including the `end()` iterator) are invalidated.
+  void shrink_to_fit();
+
+  /// @brief Get the policy used to grow the buffer's capacity.
+  linear_buffer_growth growth_policy() const ASIOEXT_NOEXCEPT
+  {
+    return growth_;
+  }
+
+  /// @brief Set the policy used to grow the buffer's capacity.
+  ///
+  /// Only affects future reallocations.
+  void growth_policy(linear_buffer_growth policy) ASIOEXT_NOEXCEPT
+  {
+    growth_ = policy;
+  }
+
   /// @brief Clear the buffer.
   ///
   /// Resets the buffer to a size of zero without deallocating
@@ -408,6 +519,9 @@ private:
   };
 
 #ifdef ASIOEXT_HAS_MOVE
+  // Take over |other|'s memory. Our own has to be freed already.
+  void steal(basic_linear_buffer& other) ASIOEXT_NOEXCEPT;
+
   void move_assign(basic_linear_buffer& other, std::false_type)
 # if defined(ASIOEXT_HAS_ALLOCATOR_ALWAYS_EQUAL)
     ASIOEXT_NOEXCEPT_IF(allocator_traits_type::is_always_equal::value)
@@ -421,18 +535,15 @@ private:
   template <typename Function>
   void reallocate(std::size_t cap, Function&& cb);
 
-  ASIOEXT_CONSTEXPR std::size_t calculate_capacity(std::size_t n)
-      const ASIOEXT_NOEXCEPT
-  {
-    return capacity_ < max_size_ / 2 ?
-        (std::max)(size_ + n, 2 * capacity_) :
-        max_size_ - 1;
-  }
+  // Get the capacity to allocate if |required| bytes don't fit.
+  std::size_t calculate_capacity(std::size_t required) const ASIOEXT_NOEXCEPT;
 
   representation_type rep_;
   std::size_t capacity_;
   std::size_t size_;
   std::size_t max_size_;
+
+  linear_buffer_growth growth_;
 };
 
 template <typename Allocator>
@@ -488,6 +599,18 @@ public:
   {
   }
 
+  /// @brief Copy-construct a dynamic buffer.
+  ///
+  /// The copy refers to the same @c basic_linear_buffer. Only one of the two
+  /// objects should be used to modify it, since each tracks the size of the
+  /// input sequence on its own.
+  dynamic_linear_buffer(const dynamic_linear_buffer& other) ASIOEXT_NOEXCEPT
+    : data_(other.data_)
+    , size_(other.size_)
+    , max_size_(other.max_size_)
+  {
+  }
+
 #if defined(ASIOEXT_HAS_MOVE)
   /// @brief Move-construct a dynamic buffer.
   ///
@@ -619,6 +742,40 @@ public:
     size_ -= consume_length;
   }
 
+  /// @brief Find the first occurrence of a byte in the input
+  /// sequence.
+  ///
+  /// @param value The byte to search for.
+  /// @param pos The offset at which to start the search.
+  ///
+  /// @returns The offset of the first occurrence at or after @c pos,
+  /// or @c basic_linear_buffer::npos if there is none.
+  std::size_t find(uint8_t value, std::size_t pos = 0) const ASIOEXT_NOEXCEPT;
+
+  /// @brief Find the first occurrence of a byte sequence in the input
+  /// sequence.
+  ///
+  /// @param s Pointer to the sequence to search for.
+  /// @param n Size of the sequence. An empty sequence is found at @c pos.
+  /// @param pos The offset at which to start the search.
+  ///
+  /// @returns The offset of the first occurrence at or after @c pos,
+  /// or @c basic_linear_buffer::npos if there is none.
+  std::size_t find(const void* s, std::size_t n,
+                   std::size_t pos = 0) const ASIOEXT_NOEXCEPT;
+
+  /// @brief Find the first byte of the input sequence that is
+  /// part of a set.
+  ///
+  /// @param set Pointer to the set of bytes to search for.
+  /// @param n Number of bytes in the set.
+  /// @param pos The offset at which to start the search.
+  ///
+  /// @returns The offset of the first matching byte at or after @c pos,
+  /// or @c basic_linear_buffer::npos if there is none.
+  std::size_t find_any(const void* set, std::size_t n,
+                       std::size_t pos = 0) const ASIOEXT_NOEXCEPT;
+
 private:
   basic_linear_buffer<Allocator>& data_;
   std::size_t size_;
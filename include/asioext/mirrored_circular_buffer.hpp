@@ -0,0 +1,268 @@
+/// @file
+/// Defines the mirrored_circular_buffer class.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_MIRROREDCIRCULARBUFFER_HPP
+#define ASIOEXT_MIRROREDCIRCULARBUFFER_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/circular_buffer.hpp"
+
+#include "asioext/detail/mirrored_memory.hpp"
+
+#if defined(ASIOEXT_HAS_MIRRORED_MEMORY) || defined(ASIOEXT_IS_DOCUMENTATION)
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup core
+/// @brief Circular buffer whose contents are always contiguous.
+///
+/// The storage of a mirrored_circular_buffer is mapped twice into adjacent
+/// virtual address ranges, so data that wraps around the end of the ring
+/// continues seamlessly in the second view. The input and output sequences
+/// thus always consist of a single buffer and can be handed to parsers that
+/// expect contiguous memory, while consuming data is just as cheap as with
+/// @ref basic_circular_buffer.
+///
+/// The capacity is always zero or a power of two that is at least the
+/// system's page size. Memory is obtained directly from the operating
+/// system, so this class doesn't take an allocator.
+///
+/// Only available if @c ASIOEXT_HAS_MIRRORED_MEMORY is defined
+/// (currently on Linux).
+class mirrored_circular_buffer
+{
+public:
+  typedef std::size_t size_type;
+
+  /// The type used to represent the input sequence as a list of buffers.
+  typedef asio::const_buffers_1 const_buffers_type;
+
+  /// The type used to represent the output sequence as a list of buffers.
+  typedef asio::mutable_buffers_1 mutable_buffers_type;
+
+  /// @brief Default-construct a mirrored_circular_buffer.
+  ///
+  /// The constructed buffer is empty and doesn't have any allocated memory.
+  mirrored_circular_buffer() ASIOEXT_NOEXCEPT
+    : data_(nullptr)
+    , capacity_(0)
+    , head_(0)
+    , size_(0)
+    , prepared_(0)
+    , max_size_((std::numeric_limits<std::size_t>::max)() / 4)
+  {
+  }
+
+  /// @brief Construct an empty buffer with a maximum size.
+  ///
+  /// @param maximum_size Specifies a maximum size for the buffer, in bytes.
+  explicit mirrored_circular_buffer(std::size_t maximum_size) ASIOEXT_NOEXCEPT
+    : data_(nullptr)
+    , capacity_(0)
+    , head_(0)
+    , size_(0)
+    , prepared_(0)
+    , max_size_((std::min)((std::numeric_limits<std::size_t>::max)() / 4,
+                           maximum_size))
+  {
+  }
+
+#if defined(ASIOEXT_HAS_MOVE)
+  /// @brief Move-construct a mirrored circular buffer.
+  ///
+  /// After the move, @c other is an empty buffer with no allocated memory
+  /// (as-if just default-constructed).
+  mirrored_circular_buffer(mirrored_circular_buffer&& other) ASIOEXT_NOEXCEPT
+    : data_(other.data_)
+    , capacity_(other.capacity_)
+    , head_(other.head_)
+    , size_(other.size_)
+    , prepared_(other.prepared_)
+    , max_size_(other.max_size_)
+  {
+    other.data_ = nullptr;
+    other.capacity_ = other.head_ = other.size_ = other.prepared_ = 0;
+  }
+
+  /// @brief Move-assign a mirrored circular buffer.
+  ASIOEXT_DECL mirrored_circular_buffer& operator=(
+      mirrored_circular_buffer&& other) ASIOEXT_NOEXCEPT;
+#endif
+
+  /// @brief Destroy the mirrored_circular_buffer.
+  ///
+  /// Releases all owned memory.
+  ~mirrored_circular_buffer()
+  {
+    if (data_)
+      detail::mirrored_memory::unmap(data_, capacity_);
+  }
+
+  /// @brief Get the size of the input sequence.
+  std::size_t size() const ASIOEXT_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// @brief Check whether the input sequence is empty.
+  bool empty() const ASIOEXT_NOEXCEPT
+  {
+    return size_ == 0;
+  }
+
+  /// @brief Get the maximum size of the buffer.
+  std::size_t max_size() const ASIOEXT_NOEXCEPT
+  {
+    return max_size_;
+  }
+
+  /// @brief Get the current capacity of the buffer.
+  ///
+  /// @returns Zero or a power of two.
+  std::size_t capacity() const ASIOEXT_NOEXCEPT
+  {
+    return capacity_;
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  ///
+  /// @returns A single buffer.
+  ///
+  /// @note The returned object is invalidated by any member function that
+  /// modifies the input sequence or output sequence.
+  mutable_buffers_type data() ASIOEXT_NOEXCEPT
+  {
+    return mutable_buffers_type(data_ + head_, size_);
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  ///
+  /// @returns A single buffer.
+  ///
+  /// @note The returned object is invalidated by any member function that
+  /// modifies the input sequence or output sequence.
+  const_buffers_type data() const ASIOEXT_NOEXCEPT
+  {
+    return const_buffers_type(data_ + head_, size_);
+  }
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// Ensures that the output sequence can accommodate @c n bytes, growing the
+  /// storage as necessary.
+  ///
+  /// @param n Total number of bytes the output sequence has to accommodate.
+  ///
+  /// @returns A single buffer of size @c n.
+  ///
+  /// @throws std::length_error If <tt>size() + n > max_size()</tt>.
+  ///
+  /// @throws asio::system_error Thrown if the memory couldn't be mapped.
+  ASIOEXT_DECL mutable_buffers_type prepare(std::size_t n);
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// Ensures that the output sequence can accommodate @c n bytes, growing the
+  /// storage as necessary.
+  ///
+  /// @param n Total number of bytes the output sequence has to accommodate.
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ///
+  /// @returns A single buffer of size @c n.
+  ///
+  /// @note This function is not part of the DynamicBuffer requirements.
+  ASIOEXT_DECL mutable_buffers_type prepare(std::size_t n,
+                                            error_code& ec) ASIOEXT_NOEXCEPT;
+
+  /// @brief Move bytes from the output sequence to the input sequence.
+  ///
+  /// @note If @c n is greater than the size of the output sequence, the entire
+  /// output sequence is moved to the input sequence and no error is issued.
+  void commit(std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    size_ += (std::min)(n, prepared_);
+    prepared_ = 0;
+  }
+
+  /// @brief Remove bytes from the input sequence.
+  ///
+  /// @note If @c n is greater than the size of the input sequence, the entire
+  /// input sequence is consumed and no error is issued.
+  void consume(std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    if (n >= size_) {
+      head_ = size_ = 0;
+    } else {
+      head_ = (head_ + n) & (capacity_ - 1);
+      size_ -= n;
+    }
+    prepared_ = 0;
+  }
+
+  /// @brief Remove all data from the buffer.
+  ///
+  /// Doesn't release any memory.
+  void clear() ASIOEXT_NOEXCEPT
+  {
+    head_ = size_ = prepared_ = 0;
+  }
+
+private:
+  // Map a new ring of at least |n| bytes and move the data there.
+  ASIOEXT_DECL void grow(std::size_t n, error_code& ec) ASIOEXT_NOEXCEPT;
+
+  // Mapped twice, i.e. data_[i] and data_[i + capacity_] are the same byte.
+  uint8_t* data_;
+  std::size_t capacity_;
+  std::size_t head_;
+  std::size_t size_;
+  std::size_t prepared_;
+  std::size_t max_size_;
+};
+
+/// @ingroup core
+/// @brief Create a new dynamic buffer that represents the
+/// given @c mirrored_circular_buffer.
+///
+/// @returns <tt>dynamic_circular_buffer<mirrored_circular_buffer>(data)</tt>.
+inline dynamic_circular_buffer<mirrored_circular_buffer>
+dynamic_buffer(mirrored_circular_buffer& data) ASIOEXT_NOEXCEPT
+{
+  return dynamic_circular_buffer<mirrored_circular_buffer>(data);
+}
+
+/// @ingroup core
+/// @brief Create a new dynamic buffer that represents the
+/// given @c mirrored_circular_buffer.
+///
+/// @returns <tt>dynamic_circular_buffer<mirrored_circular_buffer>(
+/// data, max_size)</tt>.
+inline dynamic_circular_buffer<mirrored_circular_buffer>
+dynamic_buffer(mirrored_circular_buffer& data,
+               std::size_t max_size) ASIOEXT_NOEXCEPT
+{
+  return dynamic_circular_buffer<mirrored_circular_buffer>(data, max_size);
+}
+
+ASIOEXT_NS_END
+
+# if defined(ASIOEXT_HEADER_ONLY)
+#  include "asioext/impl/mirrored_circular_buffer.cpp"
+# endif
+
+#endif
+
+#endif
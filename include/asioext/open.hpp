@@ -16,6 +16,7 @@
 
 #include "asioext/unique_file_handle.hpp"
 #include "asioext/open_args.hpp"
+#include "asioext/directory_handle.hpp"
 #include "asioext/error_code.hpp"
 
 #if defined(ASIOEXT_HAS_BOOST_FILESYSTEM) || defined(ASIOEXT_IS_DOCUMENTATION)
@@ -103,6 +104,54 @@ ASIOEXT_DECL unique_file_handle open(
     error_code& ec) ASIOEXT_NOEXCEPT;
 #endif
 
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE) || defined(ASIOEXT_IS_DOCUMENTATION)
+/// @brief Open a file relative to a directory and return its handle.
+///
+/// This function opens the specified file using @c openat().
+/// Relative filenames are resolved relative to @c dir instead of the
+/// current working directory, so only the last path components
+/// need to be looked up.
+///
+/// @param dir The directory relative filenames are resolved against.
+///
+/// @param filename The path of the file to open.
+///
+/// @param args Additional options used to open the file.
+///
+/// @return A handle to the opened file. Ownership is transferred to the
+/// caller. Handles are not inherited by child processes.
+///
+/// @throws asio::system_error Thrown on failure.
+///
+/// @note Only available if @c ASIOEXT_HAS_DIRECTORY_HANDLE is defined.
+ASIOEXT_DECL unique_file_handle open(const directory_handle& dir,
+                                     const char* filename,
+                                     const open_args& args);
+
+/// @brief Open a file relative to a directory and return its handle.
+///
+/// This function opens the specified file using @c openat().
+/// Relative filenames are resolved relative to @c dir instead of the
+/// current working directory.
+///
+/// @param dir The directory relative filenames are resolved against.
+///
+/// @param filename The path of the file to open.
+///
+/// @param args Additional options used to open the file.
+///
+/// @param ec Set to indicate what error occurred. If no error occurred,
+/// the object is reset.
+///
+/// @return A handle to the opened file (or an empty handle in case
+/// of failure). Ownership is transferred to the caller.
+///
+/// @note Only available if @c ASIOEXT_HAS_DIRECTORY_HANDLE is defined.
+ASIOEXT_DECL unique_file_handle open(
+    const directory_handle& dir, const char* filename, const open_args& args,
+    error_code& ec) ASIOEXT_NOEXCEPT;
+#endif
+
 #if defined(ASIOEXT_HAS_BOOST_FILESYSTEM) || defined(ASIOEXT_IS_DOCUMENTATION)
 /// @copydoc open(const char*,const open_args&)
 ///
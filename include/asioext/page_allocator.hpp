@@ -0,0 +1,193 @@
+/// @file
+/// Defines the page_allocator and hugepage_allocator class templates.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_PAGEALLOCATOR_HPP
+#define ASIOEXT_PAGEALLOCATOR_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/detail/aligned_memory.hpp"
+#include "asioext/detail/throw_exception.hpp"
+
+#include <algorithm>
+#include <cstddef> // for size_t
+#include <limits>
+#include <new>
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup core
+/// @brief Allocator that maps whole pages directly from the OS.
+///
+/// Every allocation is a separate anonymous mapping (@c mmap() or
+/// @c VirtualAlloc()), so it is page-aligned and its size is rounded up to a
+/// multiple of the page size. This makes the allocator a good fit for large,
+/// long-lived buffers used for unbuffered (direct) I/O, but a poor one for
+/// small objects.
+///
+/// This class satisfies the <em>Allocator</em> requirements and can be used
+/// with any allocator-aware container, e.g. @ref basic_linear_buffer or
+/// std::vector.
+template <class T>
+class page_allocator
+{
+public:
+  typedef T value_type;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  page_allocator() ASIOEXT_NOEXCEPT
+  {
+    // ctor
+  }
+
+  template <class U>
+  page_allocator(const page_allocator<U>&) ASIOEXT_NOEXCEPT
+  {
+    // ctor
+  }
+
+  /// @brief Get the size of a page.
+  static std::size_t page_size() ASIOEXT_NOEXCEPT
+  {
+    return detail::aligned_memory::page_size();
+  }
+
+  /// @brief Allocate storage for @c n objects.
+  ///
+  /// @throws std::bad_alloc Thrown if the allocation failed.
+  T* allocate(std::size_t n)
+  {
+    if (n > ((std::numeric_limits<std::size_t>::max)() - page_size()) /
+            sizeof(T)) {
+      std::bad_alloc ex;
+      detail::throw_exception(ex);
+    }
+
+    void* p = detail::aligned_memory::map_pages(n * sizeof(T));
+    if (!p) {
+      std::bad_alloc ex;
+      detail::throw_exception(ex);
+    }
+    return static_cast<T*>(p);
+  }
+
+  /// @brief Free storage obtained from allocate().
+  void deallocate(T* p, std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    detail::aligned_memory::unmap_pages(p, n * sizeof(T));
+  }
+};
+
+template <class T, class U>
+bool operator==(const page_allocator<T>&,
+                const page_allocator<U>&) ASIOEXT_NOEXCEPT
+{
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const page_allocator<T>&,
+                const page_allocator<U>&) ASIOEXT_NOEXCEPT
+{
+  return false;
+}
+
+/// @ingroup core
+/// @brief Allocator that prefers huge pages.
+///
+/// Allocations of at least huge_page_size() bytes are rounded up to whole
+/// huge pages and backed by explicit huge pages (@c MAP_HUGETLB,
+/// @c MEM_LARGE_PAGES) if the system has any available. Otherwise they
+/// transparently fall back to regular pages, which on Linux are marked as
+/// eligible for transparent huge pages (@c MADV_HUGEPAGE).
+///
+/// Smaller allocations behave like @ref page_allocator.
+///
+/// Huge pages reduce TLB pressure for large buffers that are accessed
+/// sequentially, such as multi-megabyte I/O buffers.
+///
+/// This class satisfies the <em>Allocator</em> requirements and can be used
+/// with any allocator-aware container, e.g. @ref basic_linear_buffer or
+/// std::vector.
+template <class T>
+class hugepage_allocator
+{
+public:
+  typedef T value_type;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  hugepage_allocator() ASIOEXT_NOEXCEPT
+  {
+    // ctor
+  }
+
+  template <class U>
+  hugepage_allocator(const hugepage_allocator<U>&) ASIOEXT_NOEXCEPT
+  {
+    // ctor
+  }
+
+  /// @brief Get the size of a huge page.
+  ///
+  /// @returns The size of a huge page, or 0 if the system doesn't support
+  /// them.
+  static std::size_t huge_page_size() ASIOEXT_NOEXCEPT
+  {
+    return detail::aligned_memory::huge_page_size();
+  }
+
+  /// @brief Allocate storage for @c n objects.
+  ///
+  /// @throws std::bad_alloc Thrown if the allocation failed.
+  T* allocate(std::size_t n)
+  {
+    const std::size_t granularity =
+        (std::max)(huge_page_size(), detail::aligned_memory::page_size());
+    if (n > ((std::numeric_limits<std::size_t>::max)() - granularity) /
+            sizeof(T)) {
+      std::bad_alloc ex;
+      detail::throw_exception(ex);
+    }
+
+    void* p = detail::aligned_memory::map_huge_pages(n * sizeof(T));
+    if (!p) {
+      std::bad_alloc ex;
+      detail::throw_exception(ex);
+    }
+    return static_cast<T*>(p);
+  }
+
+  /// @brief Free storage obtained from allocate().
+  void deallocate(T* p, std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    detail::aligned_memory::unmap_huge_pages(p, n * sizeof(T));
+  }
+};
+
+template <class T, class U>
+bool operator==(const hugepage_allocator<T>&,
+                const hugepage_allocator<U>&) ASIOEXT_NOEXCEPT
+{
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const hugepage_allocator<T>&,
+                const hugepage_allocator<U>&) ASIOEXT_NOEXCEPT
+{
+  return false;
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,262 @@
+/// @file
+/// Defines the parallel_walk function
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_PARALLELWALK_HPP
+#define ASIOEXT_PARALLELWALK_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE) || defined(ASIOEXT_IS_DOCUMENTATION)
+
+#include "asioext/directory_handle.hpp"
+#include "asioext/file_status.hpp"
+#include "asioext/file_type.hpp"
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+class parallel_walker;
+}
+
+/// @ingroup files_handle
+/// @brief Tells @ref parallel_walk how to proceed after an entry was visited.
+enum class walk_action
+{
+  /// Continue the walk. Directories are descended into.
+  proceed,
+
+  /// Continue the walk, but don't descend into this directory.
+  /// Same as @ref proceed for all other entries.
+  prune,
+
+  /// Stop the walk as soon as possible.
+  ///
+  /// Entries that are already being visited by other threads are
+  /// still completed.
+  stop,
+};
+
+/// @ingroup files_handle
+/// @brief An entry visited by @ref parallel_walk.
+///
+/// walk_entry objects are only valid during the visitor call they are
+/// passed to.
+class walk_entry
+{
+public:
+  /// @brief Get the open directory containing this entry.
+  ///
+  /// The handle can be used to open the entry (e.g. with
+  /// <tt>open(entry.directory(), entry.name(), ...)</tt>) without resolving
+  /// its full path again. It must not be read from or closed.
+  const directory_handle& directory() const ASIOEXT_NOEXCEPT
+  {
+    return *directory_;
+  }
+
+  /// @brief Get the entry's path, relative to the walk's root directory.
+  const std::string& path() const ASIOEXT_NOEXCEPT
+  {
+    return *path_;
+  }
+
+  /// @brief Get the entry's name, relative to @ref directory.
+  const char* name() const ASIOEXT_NOEXCEPT
+  {
+    return name_;
+  }
+
+  /// @brief Get the entry's type.
+  ///
+  /// Unlike @ref directory_entry::type, this is never
+  /// @ref file_type::unknown for entries that exist. Symbolic links
+  /// are not followed.
+  file_type type() const ASIOEXT_NOEXCEPT
+  {
+    return type_;
+  }
+
+  /// @brief Get the entry's inode number.
+  uint64_t inode() const ASIOEXT_NOEXCEPT
+  {
+    return inode_;
+  }
+
+  /// @brief Get the entry's depth.
+  ///
+  /// Entries of the root directory have a depth of 1.
+  std::size_t depth() const ASIOEXT_NOEXCEPT
+  {
+    return depth_;
+  }
+
+  /// @brief Get the entry's metadata.
+  ///
+  /// The members selected by @ref walk_options::status_mask have
+  /// already been fetched by the walking thread.
+  const file_status& status() const ASIOEXT_NOEXCEPT
+  {
+    return status_;
+  }
+
+private:
+  friend class detail::parallel_walker;
+
+  walk_entry() ASIOEXT_NOEXCEPT
+    : directory_(0)
+    , path_(0)
+    , name_(0)
+    , type_(file_type::unknown)
+    , inode_(0)
+    , depth_(0)
+  {
+    // ctor
+  }
+
+  const directory_handle* directory_;
+  const std::string* path_;
+  const char* name_;
+  file_type type_;
+  uint64_t inode_;
+  std::size_t depth_;
+  file_status status_;
+};
+
+/// @ingroup files_handle
+/// @brief Options for @ref parallel_walk.
+struct walk_options
+{
+  walk_options()
+    : threads(0)
+    , max_open_directories(64)
+    , buffer_size(32 * 1024)
+    , status_mask(file_status_mask::none)
+  {
+    // ctor
+  }
+
+  /// @brief The number of threads walking the tree, including the
+  /// calling thread.
+  ///
+  /// Zero selects the number of hardware threads.
+  std::size_t threads;
+
+  /// @brief The number of directory handles kept open for opening their
+  /// subdirectories relative to them.
+  ///
+  /// Subdirectories of directories that weren't kept open are opened
+  /// relative to the root directory instead. At most
+  /// <tt>1 + threads + max_open_directories</tt> directory handles are
+  /// open at any time.
+  std::size_t max_open_directories;
+
+  /// @brief The size of each thread's buffer for
+  /// @ref directory_handle::read_entries.
+  std::size_t buffer_size;
+
+  /// @brief The metadata to fetch for each entry before it is visited.
+  ///
+  /// By default, nothing beyond what the directory itself stores is
+  /// fetched.
+  file_status_mask status_mask;
+
+  /// @brief Called if a directory cannot be opened or read, or an entry's
+  /// metadata cannot be fetched.
+  ///
+  /// The first argument is the path (relative to the root directory) of the
+  /// affected entry. Returning @ref walk_action::stop ends the walk and
+  /// reports the error to the caller of @ref parallel_walk, all other
+  /// values skip the entry.
+  ///
+  /// If empty, every error ends the walk. Entries that are removed while
+  /// the tree is walked are skipped silently.
+  std::function<walk_action (const std::string&, const error_code&)> on_error;
+};
+
+/// @ingroup files_handle
+/// @brief The function object type called for each entry by
+/// @ref parallel_walk.
+typedef std::function<walk_action (const walk_entry&)> walk_visitor;
+
+/// @ingroup files_handle
+/// @brief Walk a directory tree using multiple threads.
+///
+/// This function visits all entries below @c root (excluding @c root itself
+/// as well as the special entries @c "." and @c ".."), calling @c visitor for
+/// each one. Directories are read in batches of
+/// @ref walk_options::buffer_size bytes. Subdirectories are opened relative
+/// to their (still open) parent directory where possible, so their full
+/// paths don't need to be resolved by the kernel again.
+///
+/// Each thread processes the directories it discovers itself (depth-first)
+/// and takes directories from other threads only when it runs out of work.
+/// Symbolic links are not followed.
+///
+/// The function returns after the whole tree has been walked, or once the
+/// walk was stopped.
+///
+/// @param root The directory to walk.
+///
+/// @param visitor The function object to call for each entry. It is called
+/// concurrently from multiple threads. Its return value decides whether
+/// directories are descended into. If it throws, the walk is stopped and
+/// the exception is rethrown by this function.
+///
+/// @param options Options controlling the walk.
+///
+/// @throws asio::system_error Thrown on failure.
+///
+/// @par Example
+/// @code
+/// asioext::walk_options options;
+/// options.status_mask = asioext::file_status_mask::size |
+///                       asioext::file_status_mask::times;
+///
+/// std::atomic<std::uint64_t> total(0);
+/// asioext::parallel_walk("/srv/data", [&] (const asioext::walk_entry& e) {
+///   if (e.type() == asioext::file_type::directory &&
+///       std::strcmp(e.name(), ".snapshot") == 0)
+///     return asioext::walk_action::prune;
+///
+///   total += e.status().size;
+///   return asioext::walk_action::proceed;
+/// }, options);
+/// @endcode
+ASIOEXT_DECL void parallel_walk(const char* root, const walk_visitor& visitor,
+                                const walk_options& options = walk_options());
+
+/// @ingroup files_handle
+/// @brief Walk a directory tree using multiple threads.
+///
+/// @copydetails parallel_walk(const char*,const walk_visitor&,const walk_options&)
+///
+/// @param ec Set to indicate what error occurred. If no error occurred,
+/// the object is reset.
+ASIOEXT_DECL void parallel_walk(const char* root, const walk_visitor& visitor,
+                                const walk_options& options, error_code& ec);
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/impl/parallel_walk.cpp"
+#endif
+
+#endif
+
+#endif
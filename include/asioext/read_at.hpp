@@ -0,0 +1,122 @@
+/// @file
+/// Declares the asioext::read_at and asioext::async_read_at functions.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_READAT_HPP
+#define ASIOEXT_READAT_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/basic_file.hpp"
+#include "asioext/error_code.hpp"
+#include "asioext/async_result.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#include <cstddef> // for size_t
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup files
+/// @defgroup read_at asioext::read_at()
+/// Read a specific amount of data at a specific offset.
+///
+/// Unlike @c asio::read_at, these functions only require a
+/// @c read_some_at member function (e.g. @ref file_handle,
+/// @ref unique_file_handle or @ref basic_file).
+///
+///@{
+
+/// Read data from a file at the specified offset.
+///
+/// This function reads from @c device until @c buffers are full or an
+/// error occurred. It is implemented in terms of zero or more calls to
+/// @c device.read_some_at().
+///
+/// @param device The device to read from, e.g. a @ref file_handle.
+///
+/// @param offset The offset at which the data will be read.
+///
+/// @param buffers One or more buffers into which the data will be read.
+///
+/// @returns The number of bytes read. If this is less than
+/// <tt>asio::buffer_size(buffers)</tt>, the end of the file was reached.
+///
+/// @throws asio::system_error Thrown on failure. Reaching the end of the
+/// file is an error.
+template <typename RandomAccessReadDevice, typename MutableBufferSequence>
+std::size_t read_at(RandomAccessReadDevice& device, uint64_t offset,
+                    const MutableBufferSequence& buffers);
+
+/// Read data from a file at the specified offset.
+///
+/// This function reads from @c device until @c buffers are full or an
+/// error occurred. It is implemented in terms of zero or more calls to
+/// @c device.read_some_at().
+///
+/// @param device The device to read from, e.g. a @ref file_handle.
+///
+/// @param offset The offset at which the data will be read.
+///
+/// @param buffers One or more buffers into which the data will be read.
+///
+/// @param ec Set to indicate what error occurred. If no error occurred,
+/// the object is reset. If the end of the file was reached, @c ec is set to
+/// @c asio::error::eof.
+///
+/// @returns The number of bytes read.
+template <typename RandomAccessReadDevice, typename MutableBufferSequence>
+std::size_t read_at(RandomAccessReadDevice& device, uint64_t offset,
+                    const MutableBufferSequence& buffers, error_code& ec);
+
+/// Start an asynchronous read at the specified offset.
+///
+/// This function reads from @c file until @c buffers are full or an
+/// error occurred. The function call always returns immediately.
+///
+/// In contrast to @c asio::async_read_at, the whole operation is executed
+/// by the @c FileService, so a @ref thread_pool_file_service performs all
+/// partial reads on a single pool thread and only invokes @c handler once.
+///
+/// @param file The file to read from.
+///
+/// @param offset The offset at which the data will be read.
+///
+/// @param buffers One or more buffers into which the data will be read.
+/// Although the buffers object may be copied as necessary, ownership of the
+/// underlying memory blocks is retained by the caller, which must guarantee
+/// that they remain valid until the handler is called.
+///
+/// @param handler The handler to be called when the read operation
+/// completes.
+/// Copies will be made of the handler as required. The function signature of
+/// the handler must be:
+/// @code void handler(
+///   const error_code& error, // Result of operation.
+///   std::size_t bytes_transferred // Number of bytes read.
+/// ); @endcode
+/// Invocation of the handler will be performed in a manner equivalent to
+/// using asio::io_service::post().
+template <typename FileService, typename MutableBufferSequence,
+          typename ReadHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+async_read_at(basic_file<FileService>& file, uint64_t offset,
+              const MutableBufferSequence& buffers,
+              ASIOEXT_MOVE_ARG(ReadHandler) handler);
+
+///@}
+
+ASIOEXT_NS_END
+
+#include "asioext/impl/read_at.hpp"
+
+#endif
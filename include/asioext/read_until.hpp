@@ -0,0 +1,174 @@
+/// @file
+/// Declares the asioext::read_until utility functions.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_READUNTIL_HPP
+#define ASIOEXT_READUNTIL_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/linear_buffer.hpp"
+#include "asioext/error_code.hpp"
+#include "asioext/async_result.hpp"
+
+#include "asioext/detail/move_support.hpp"
+
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup files
+/// @defgroup read_until asioext::read_until()
+/// @{
+
+/// @brief Read data into a linear buffer until it contains a delimiter.
+///
+/// This function reads data from the stream into the dynamic buffer until
+/// the buffer's input sequence contains the given delimiter. The call blocks
+/// until one of the following conditions is true:
+///
+/// @li The input sequence contains the delimiter.
+/// @li An error occurred.
+///
+/// If the input sequence already contains the delimiter, the function returns
+/// immediately. Data following the delimiter may be left in the buffer.
+///
+/// The buffer is searched with the vectorized
+/// @ref basic_linear_buffer::find() functions, so that only newly read data
+/// needs to be scanned.
+///
+/// @param s The stream to read from. The type must support the
+/// <em>SyncReadStream</em> concept (e.g. @ref basic_file, @ref file_handle,
+/// asio::ip::tcp::socket).
+/// @param buffer The dynamic buffer that receives the data.
+/// @param delim The delimiter character.
+///
+/// @returns The number of bytes in the input sequence up to and including
+/// the delimiter.
+///
+/// @throws asio::system_error Thrown on failure. If the buffer's maximum size
+/// is reached before the delimiter was found, the associated error_code is
+/// @c asio::error::not_found.
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator> buffer,
+                       char delim);
+
+/// @brief Read data into a linear buffer until it contains a delimiter.
+///
+/// See the throwing overload for details.
+///
+/// @param s The stream to read from.
+/// @param buffer The dynamic buffer that receives the data.
+/// @param delim The delimiter character.
+/// @param ec Set to indicate what error occurred, if any. If the buffer's
+/// maximum size is reached before the delimiter was found, set to
+/// @c asio::error::not_found.
+///
+/// @returns The number of bytes in the input sequence up to and including
+/// the delimiter, or 0 if an error occurred.
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator> buffer,
+                       char delim, error_code& ec);
+
+/// @brief Read data into a linear buffer until it contains a delimiter.
+///
+/// See the single character overload for details.
+///
+/// @param s The stream to read from.
+/// @param buffer The dynamic buffer that receives the data.
+/// @param delim The delimiter string.
+///
+/// @returns The number of bytes in the input sequence up to and including
+/// the delimiter.
+///
+/// @throws asio::system_error Thrown on failure.
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator> buffer,
+                       const std::string& delim);
+
+/// @brief Read data into a linear buffer until it contains a delimiter.
+///
+/// See the single character overload for details.
+///
+/// @param s The stream to read from.
+/// @param buffer The dynamic buffer that receives the data.
+/// @param delim The delimiter string.
+/// @param ec Set to indicate what error occurred, if any.
+///
+/// @returns The number of bytes in the input sequence up to and including
+/// the delimiter, or 0 if an error occurred.
+template <typename SyncReadStream, typename Allocator>
+std::size_t read_until(SyncReadStream& s,
+                       dynamic_linear_buffer<Allocator> buffer,
+                       const std::string& delim, error_code& ec);
+
+/// @brief Asynchronously read data into a linear buffer until it contains
+/// a delimiter.
+///
+/// This function starts an asynchronous operation that reads data from the
+/// stream into the dynamic buffer until the buffer's input sequence contains
+/// the given delimiter. It is implemented in terms of zero or more calls
+/// to the stream's @c async_read_some() function.
+///
+/// @param s The stream to read from. The type must support the
+/// <em>AsyncReadStream</em> concept (e.g. @ref basic_file,
+/// asio::ip::tcp::socket).
+/// @param buffer The dynamic buffer that receives the data. The underlying
+/// @ref basic_linear_buffer must remain valid until the handler is called.
+/// @param delim The delimiter character.
+/// @param handler The handler to be called when the read operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation.
+///   const error_code& error,
+///
+///   // The number of bytes in the input sequence up to and
+///   // including the delimiter. 0 if an error occurred.
+///   std::size_t bytes_transferred
+/// );
+/// @endcode
+template <typename AsyncReadStream, typename Allocator, typename ReadHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+async_read_until(AsyncReadStream& s,
+                 dynamic_linear_buffer<Allocator> buffer,
+                 char delim, ASIOEXT_MOVE_ARG(ReadHandler) handler);
+
+/// @brief Asynchronously read data into a linear buffer until it contains
+/// a delimiter.
+///
+/// See the single character overload for details.
+///
+/// @param s The stream to read from.
+/// @param buffer The dynamic buffer that receives the data.
+/// @param delim The delimiter string. A copy is kept by the operation.
+/// @param handler The handler to be called when the read operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(const error_code& error, std::size_t bytes_transferred);
+/// @endcode
+template <typename AsyncReadStream, typename Allocator, typename ReadHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+async_read_until(AsyncReadStream& s,
+                 dynamic_linear_buffer<Allocator> buffer,
+                 const std::string& delim,
+                 ASIOEXT_MOVE_ARG(ReadHandler) handler);
+
+/// @}
+
+ASIOEXT_NS_END
+
+#include "asioext/impl/read_until.hpp"
+
+#endif
@@ -0,0 +1,148 @@
+/// @file
+/// Defines the resolver_cache class.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_RESOLVERCACHE_HPP
+#define ASIOEXT_RESOLVERCACHE_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/async_result.hpp"
+#include "asioext/chrono.hpp"
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/handler_work.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/ip/tcp.hpp>
+# include <boost/asio/steady_timer.hpp>
+#else
+# include <asio/io_service.hpp>
+# include <asio/ip/tcp.hpp>
+# include <asio/steady_timer.hpp>
+#endif
+
+#include <memory>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+struct resolver_cache_state;
+}
+
+/// @ingroup net
+/// @brief Caching, coalescing name resolver.
+///
+/// resolver_cache is a drop-in replacement for asio::ip::tcp::resolver's
+/// async_resolve() that keeps the results for a while:
+///
+/// * Successful lookups are cached for @c ttl. The system resolver
+/// doesn't report the records' TTLs, so a fixed value is used.
+/// * Lookups of names that don't exist (@c asio::error::host_not_found and
+/// @c asio::error::no_data) are cached for @c negative_ttl. Other errors
+/// aren't cached.
+/// * Concurrent lookups of the same query are coalesced: only the first
+/// one is passed to the system resolver, the others wait for its result.
+///
+/// Queries are equal if their host name, service name and hints (flags,
+/// family, socket type and protocol) are equal.
+///
+/// The cache can be passed to asioext::async_connect() instead of a
+/// resolver.
+///
+/// @par Thread Safety
+/// @e Distinct @e objects: Safe.@n
+/// @e Shared @e objects: Safe.
+class resolver_cache
+{
+public:
+  /// @brief Construct an empty cache.
+  ///
+  /// @param io_service The io_service used for lookups and handlers.
+  /// @param ttl The time successful lookups are cached.
+  /// @param negative_ttl The time failed lookups are cached.
+  /// @param max_entries The maximum number of cached queries. If the cache
+  /// is full, expired entries are removed, or the one that expires first.
+  ASIOEXT_DECL explicit resolver_cache(
+      asio::io_service& io_service,
+      const asio::steady_timer::duration& ttl = chrono::seconds(60),
+      const asio::steady_timer::duration& negative_ttl = chrono::seconds(5),
+      std::size_t max_entries = 1024);
+
+  /// @brief Destroy the cache.
+  ///
+  /// Outstanding lookups are cancelled, their handlers are called with
+  /// @c asio::error::operation_aborted.
+  ASIOEXT_DECL ~resolver_cache();
+
+  /// @brief Get the io_service used by this cache.
+  ASIOEXT_DECL asio::io_service& get_io_service() ASIOEXT_NOEXCEPT;
+
+  /// @brief Asynchronously resolve a query, using cached results if
+  /// possible.
+  ///
+  /// The handler is never invoked inline, not even for cached results.
+  ///
+  /// @param q A query object that determines what endpoints will be
+  /// returned.
+  /// @param handler The handler to be called when the resolve operation
+  /// completes. The function signature of the handler must be:
+  /// @code
+  /// void handler(
+  ///   // Result of operation.
+  ///   const error_code& error,
+  ///
+  ///   // On success, an iterator denoting the first endpoint.
+  ///   // Otherwise, the end iterator.
+  ///   asio::ip::tcp::resolver::iterator iterator
+  /// );
+  /// @endcode
+  template <typename ResolveHandler>
+  ASIOEXT_INITFN_RESULT_TYPE(ResolveHandler,
+      void(error_code, asio::ip::tcp::resolver::iterator))
+  async_resolve(const asio::ip::tcp::resolver::query& q,
+                ASIOEXT_MOVE_ARG(ResolveHandler) handler);
+
+  /// @brief Get the number of cached queries.
+  ///
+  /// This includes expired queries that haven't been removed yet.
+  ASIOEXT_DECL std::size_t size() const;
+
+  /// @brief Remove all cached results.
+  ///
+  /// Outstanding lookups aren't affected.
+  ASIOEXT_DECL void clear();
+
+private:
+  resolver_cache(const resolver_cache&) ASIOEXT_DELETED;
+  resolver_cache& operator=(const resolver_cache&) ASIOEXT_DELETED;
+
+  typedef detail::erased_handler_ptr<
+    void (error_code, asio::ip::tcp::resolver::iterator)
+  > waiter_ptr;
+
+  ASIOEXT_DECL void resolve(const asio::ip::tcp::resolver::query& q,
+                            waiter_ptr w);
+
+  std::shared_ptr<detail::resolver_cache_state> state_;
+};
+
+ASIOEXT_NS_END
+
+#include "asioext/impl/resolver_cache.hpp"
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/impl/resolver_cache.cpp"
+#endif
+
+#endif
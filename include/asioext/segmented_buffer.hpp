@@ -0,0 +1,484 @@
+/// @file
+/// Defines the segmented_buffer class.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SEGMENTEDBUFFER_HPP
+#define ASIOEXT_SEGMENTEDBUFFER_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/block_pool.hpp"
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/buffer.hpp>
+#else
+# include <asio/buffer.hpp>
+#endif
+
+#include <algorithm>
+#include <cstddef> // for size_t, ptrdiff_t
+#include <deque>
+#include <iterator>
+#include <limits>
+
+ASIOEXT_NS_BEGIN
+
+namespace detail {
+
+// A buffer sequence spanning a byte range of a list of equally-sized blocks.
+//
+// Models the MutableBufferSequence / ConstBufferSequence requirements
+// (depending on |Buffer|). Each block contributes one buffer.
+template <typename Buffer>
+class block_sequence
+{
+public:
+  typedef std::deque<uint8_t*>::const_iterator block_iterator;
+
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Buffer value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Buffer* pointer;
+    typedef Buffer reference;
+
+    const_iterator() ASIOEXT_NOEXCEPT
+      : block_(), offset_(0), remaining_(0), block_size_(0)
+    {
+      // ctor
+    }
+
+    const_iterator(block_iterator block, std::size_t offset,
+                   std::size_t remaining,
+                   std::size_t block_size) ASIOEXT_NOEXCEPT
+      : block_(block)
+      , offset_(offset)
+      , remaining_(remaining)
+      , block_size_(block_size)
+    {
+      // ctor
+    }
+
+    Buffer operator*() const ASIOEXT_NOEXCEPT
+    {
+      return Buffer(*block_ + offset_, length());
+    }
+
+    const_iterator& operator++() ASIOEXT_NOEXCEPT
+    {
+      remaining_ -= length();
+      offset_ = 0;
+      ++block_;
+      return *this;
+    }
+
+    const_iterator operator++(int) ASIOEXT_NOEXCEPT
+    {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    // Iterators of the same sequence are identified by the number of
+    // bytes that are left.
+    friend bool operator==(const const_iterator& a,
+                           const const_iterator& b) ASIOEXT_NOEXCEPT
+    {
+      return a.remaining_ == b.remaining_;
+    }
+
+    friend bool operator!=(const const_iterator& a,
+                           const const_iterator& b) ASIOEXT_NOEXCEPT
+    {
+      return !(a == b);
+    }
+
+  private:
+    std::size_t length() const ASIOEXT_NOEXCEPT
+    {
+      return (std::min)(block_size_ - offset_, remaining_);
+    }
+
+    block_iterator block_;
+    std::size_t offset_;
+    std::size_t remaining_;
+    std::size_t block_size_;
+  };
+
+  typedef Buffer value_type;
+
+  block_sequence() ASIOEXT_NOEXCEPT
+    : first_(), offset_(0), size_(0), block_size_(0)
+  {
+    // ctor
+  }
+
+  // |size| bytes starting at |offset| bytes into |*first|.
+  block_sequence(block_iterator first, std::size_t offset,
+                 std::size_t size, std::size_t block_size) ASIOEXT_NOEXCEPT
+    : first_(first), offset_(offset), size_(size), block_size_(block_size)
+  {
+    // ctor
+  }
+
+  template <typename OtherBuffer>
+  block_sequence(const block_sequence<OtherBuffer>& other) ASIOEXT_NOEXCEPT
+    : first_(other.first_)
+    , offset_(other.offset_)
+    , size_(other.size_)
+    , block_size_(other.block_size_)
+  {
+    // ctor
+  }
+
+  const_iterator begin() const ASIOEXT_NOEXCEPT
+  {
+    return const_iterator(first_, offset_, size_, block_size_);
+  }
+
+  const_iterator end() const ASIOEXT_NOEXCEPT
+  {
+    return const_iterator();
+  }
+
+private:
+  template <typename OtherBuffer>
+  friend class block_sequence;
+
+  block_iterator first_;
+  std::size_t offset_;
+  std::size_t size_;
+  std::size_t block_size_;
+};
+
+}
+
+/// @ingroup core
+/// @brief Byte FIFO made of fixed-size blocks from a @ref block_pool.
+///
+/// Unlike a @c basic_linear_buffer, a segmented_buffer never copies its
+/// contents when it grows: it just appends another block. The input and
+/// output sequences consist of one buffer per block and can be passed to
+/// vectored I/O functions (e.g. @ref file_handle::write_some() or a socket's
+/// @c write_some()) as a whole.
+///
+/// Blocks are taken from the pool as the output sequence grows and
+/// returned as soon as they were consumed completely.
+///
+/// segmented_buffer provides the DynamicBuffer member functions
+/// (@c data(), @c prepare(), @c commit(), @c consume()) itself.
+/// Use @ref dynamic_buffer() to obtain a copyable DynamicBuffer referring to
+/// it.
+class segmented_buffer
+{
+public:
+  /// The type used to represent the input sequence as a list of buffers.
+  typedef detail::block_sequence<asio::const_buffer> const_buffers_type;
+
+  /// The type used to represent the output sequence as a list of buffers.
+  typedef detail::block_sequence<asio::mutable_buffer> mutable_buffers_type;
+
+  /// @brief Construct an empty segmented buffer.
+  ///
+  /// @param pool The pool from which blocks are taken. The pool has to
+  /// outlive the buffer.
+  ///
+  /// @param maximum_size Specifies a maximum size for the buffer, in bytes.
+  explicit segmented_buffer(block_pool& pool,
+      std::size_t maximum_size = (std::numeric_limits<std::size_t>::max)())
+      ASIOEXT_NOEXCEPT
+    : pool_(&pool)
+    , offset_(0)
+    , size_(0)
+    , prepared_(0)
+    , max_size_(maximum_size)
+  {
+    // ctor
+  }
+
+#if defined(ASIOEXT_HAS_MOVE)
+  /// @brief Move-construct a segmented buffer.
+  ///
+  /// After the move, @c other is empty and owns no blocks.
+  segmented_buffer(segmented_buffer&& other)
+    : pool_(other.pool_)
+    , blocks_(std::move(other.blocks_))
+    , offset_(other.offset_)
+    , size_(other.size_)
+    , prepared_(other.prepared_)
+    , max_size_(other.max_size_)
+  {
+    other.blocks_.clear();
+    other.offset_ = other.size_ = other.prepared_ = 0;
+  }
+#endif
+
+  /// @brief Destroy the segmented buffer.
+  ///
+  /// Returns all blocks to the pool.
+  ~segmented_buffer()
+  {
+    clear();
+  }
+
+  /// @brief Get the pool used by this buffer.
+  block_pool& pool() const ASIOEXT_NOEXCEPT
+  {
+    return *pool_;
+  }
+
+  /// @brief Get the size of the input sequence.
+  std::size_t size() const ASIOEXT_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// @brief Check whether the input sequence is empty.
+  bool empty() const ASIOEXT_NOEXCEPT
+  {
+    return size_ == 0;
+  }
+
+  /// @brief Get the maximum size of the buffer.
+  std::size_t max_size() const ASIOEXT_NOEXCEPT
+  {
+    return max_size_;
+  }
+
+  /// @brief Get the number of bytes the buffer can hold without taking more
+  /// blocks from the pool.
+  std::size_t capacity() const ASIOEXT_NOEXCEPT
+  {
+    return blocks_.size() * pool_->block_size() - offset_;
+  }
+
+  /// @brief Get the number of blocks currently owned by the buffer.
+  std::size_t block_count() const ASIOEXT_NOEXCEPT
+  {
+    return blocks_.size();
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  ///
+  /// @returns A sequence with one buffer per block.
+  ///
+  /// @note The returned object is invalidated by any member function that
+  /// modifies the input sequence or output sequence.
+  mutable_buffers_type data() ASIOEXT_NOEXCEPT
+  {
+    return mutable_buffers_type(blocks_.begin(), offset_, size_,
+                                pool_->block_size());
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  ///
+  /// @returns A sequence with one buffer per block.
+  ///
+  /// @note The returned object is invalidated by any member function that
+  /// modifies the input sequence or output sequence.
+  const_buffers_type data() const ASIOEXT_NOEXCEPT
+  {
+    return const_buffers_type(blocks_.begin(), offset_, size_,
+                              pool_->block_size());
+  }
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// Takes as many blocks from the pool as necessary to accommodate @c n
+  /// bytes. Existing data is never moved.
+  ///
+  /// @param n Total number of bytes the output sequence has to accommodate.
+  ///
+  /// @throws std::length_error If <tt>size() + n > max_size()</tt>.
+  ///
+  /// @note The returned object is invalidated by any member function that
+  /// modifies the input sequence or output sequence.
+  ASIOEXT_DECL mutable_buffers_type prepare(std::size_t n);
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// @param n Total number of bytes the output sequence has to accommodate.
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ///
+  /// @note This function is not part of the DynamicBuffer requirements.
+  ASIOEXT_DECL mutable_buffers_type prepare(std::size_t n, error_code& ec);
+
+  /// @brief Move bytes from the output sequence to the input sequence.
+  ///
+  /// @note If @c n is greater than the size of the output sequence, the entire
+  /// output sequence is moved to the input sequence and no error is issued.
+  void commit(std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    size_ += (std::min)(n, prepared_);
+    prepared_ = 0;
+  }
+
+  /// @brief Remove bytes from the input sequence.
+  ///
+  /// Blocks that were consumed completely are returned to the pool.
+  ///
+  /// @note If @c n is greater than the size of the input sequence, the entire
+  /// input sequence is consumed and no error is issued.
+  ASIOEXT_DECL void consume(std::size_t n) ASIOEXT_NOEXCEPT;
+
+  /// @brief Append data to the input sequence.
+  ///
+  /// @throws std::length_error If <tt>size() + n > max_size()</tt>.
+  ASIOEXT_DECL void append(const void* data, std::size_t n);
+
+  /// @brief Remove all data and return all blocks to the pool.
+  ASIOEXT_DECL void clear() ASIOEXT_NOEXCEPT;
+
+private:
+  segmented_buffer(const segmented_buffer&) ASIOEXT_DELETED;
+  segmented_buffer& operator=(const segmented_buffer&) ASIOEXT_DELETED;
+
+  block_pool* pool_;
+
+  // The input sequence starts |offset_| bytes into the first block.
+  std::deque<uint8_t*> blocks_;
+  std::size_t offset_;
+  std::size_t size_;
+  std::size_t prepared_;
+  std::size_t max_size_;
+};
+
+/// @ingroup core
+/// @brief Adapt a @c segmented_buffer to the DynamicBuffer requirements.
+///
+/// The adapter only refers to the buffer, so the buffer keeps its contents
+/// after the adapter is gone, e.g. when an asynchronous read operation
+/// completes.
+class dynamic_segmented_buffer
+{
+public:
+  /// The type used to represent the input sequence as a list of buffers.
+  typedef segmented_buffer::const_buffers_type const_buffers_type;
+
+  /// The type used to represent the output sequence as a list of buffers.
+  typedef segmented_buffer::mutable_buffers_type mutable_buffers_type;
+
+  /// @brief Construct a dynamic buffer from a @c segmented_buffer.
+  ///
+  /// @param b The segmented_buffer to be used as backing storage for the
+  /// dynamic buffer. The object stores a reference to the buffer and the
+  /// user is responsible for ensuring that the buffer object remains valid
+  /// until the dynamic_segmented_buffer object is destroyed.
+  ///
+  /// @param maximum_size Specifies a maximum size for the buffer, in bytes.
+  explicit dynamic_segmented_buffer(segmented_buffer& b,
+      std::size_t maximum_size =
+        (std::numeric_limits<std::size_t>::max)()) ASIOEXT_NOEXCEPT
+    : data_(b)
+    , max_size_((std::min)(b.max_size(), maximum_size))
+  {
+  }
+
+  /// @brief Get the size of the input sequence.
+  std::size_t size() const ASIOEXT_NOEXCEPT
+  {
+    return data_.size();
+  }
+
+  /// @brief Get the maximum size of the dynamic buffer.
+  std::size_t max_size() const ASIOEXT_NOEXCEPT
+  {
+    return max_size_;
+  }
+
+  /// @brief Get the current capacity of the dynamic buffer.
+  std::size_t capacity() const ASIOEXT_NOEXCEPT
+  {
+    return data_.capacity();
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  mutable_buffers_type data() ASIOEXT_NOEXCEPT
+  {
+    return data_.data();
+  }
+
+  /// @brief Get a list of buffers that represents the input sequence.
+  const_buffers_type data() const ASIOEXT_NOEXCEPT
+  {
+    return static_cast<const segmented_buffer&>(data_).data();
+  }
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// @throws std::length_error If <tt>size() + n > max_size()</tt>.
+  ASIOEXT_DECL mutable_buffers_type prepare(std::size_t n);
+
+  /// @brief Get a list of buffers that represents the output sequence, with
+  /// the given size.
+  ///
+  /// @param ec Set to indicate what error occurred. If no error occurred,
+  /// the object is reset.
+  ///
+  /// @note This function is not part of the DynamicBuffer requirements.
+  ASIOEXT_DECL mutable_buffers_type prepare(std::size_t n, error_code& ec);
+
+  /// @brief Move bytes from the output sequence to the input sequence.
+  void commit(std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    data_.commit(n);
+  }
+
+  /// @brief Remove bytes from the input sequence.
+  void consume(std::size_t n) ASIOEXT_NOEXCEPT
+  {
+    data_.consume(n);
+  }
+
+private:
+  segmented_buffer& data_;
+  std::size_t max_size_;
+};
+
+/// @ingroup core
+/// @brief Create a new dynamic buffer that represents the
+/// given @c segmented_buffer.
+///
+/// @returns <tt>dynamic_segmented_buffer(data)</tt>.
+inline dynamic_segmented_buffer dynamic_buffer(
+    segmented_buffer& data) ASIOEXT_NOEXCEPT
+{
+  return dynamic_segmented_buffer(data);
+}
+
+/// @ingroup core
+/// @brief Create a new dynamic buffer that represents the
+/// given @c segmented_buffer.
+///
+/// @returns <tt>dynamic_segmented_buffer(data, max_size)</tt>.
+inline dynamic_segmented_buffer dynamic_buffer(
+    segmented_buffer& data, std::size_t max_size) ASIOEXT_NOEXCEPT
+{
+  return dynamic_segmented_buffer(data, max_size);
+}
+
+ASIOEXT_NS_END
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/impl/segmented_buffer.cpp"
+#endif
+
+#endif
@@ -0,0 +1,252 @@
+/// @file
+/// Defines the basic_small_linear_buffer class template.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SMALLLINEARBUFFER_HPP
+#define ASIOEXT_SMALLLINEARBUFFER_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/linear_buffer.hpp"
+#include "asioext/detail/inline_storage_allocator.hpp"
+
+#include <cstring>
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup core
+/// @brief A @c basic_linear_buffer with inline storage for small contents.
+///
+/// The first @c N bytes are stored inside the object itself, so buffers
+/// that never grow past @c N don't allocate any memory. Once more space is
+/// needed, the contents are moved to memory obtained from the allocator,
+/// just like with a plain @c basic_linear_buffer.
+///
+/// The inline storage is managed by the allocator of the underlying
+/// @c basic_linear_buffer, so the buffer can be used wherever a
+/// @c basic_linear_buffer is accepted as a template (e.g. with
+/// @ref dynamic_buffer()). It is a different type than
+/// <tt>basic_linear_buffer<Allocator></tt> though, so memory can't be
+/// moved between the two.
+///
+/// @note Moving a buffer whose contents are stored inline copies them.
+/// Unlike those of @c basic_linear_buffer, moves are therefore not
+/// @c noexcept.
+template <std::size_t N, typename Allocator = std::allocator<uint8_t>>
+class basic_small_linear_buffer
+  : private detail::inline_storage<N>
+  , public basic_linear_buffer<detail::inline_storage_allocator<N, Allocator>>
+{
+  typedef detail::inline_storage_allocator<N, Allocator> storage_allocator;
+  typedef basic_linear_buffer<storage_allocator> base_type;
+
+  static_assert(N != 0, "N must be greater than zero");
+
+public:
+  typedef Allocator allocator_type;
+
+  /// The number of bytes that can be stored without allocating memory.
+  static const std::size_t inline_capacity = N;
+
+  /// @brief Default-construct a basic_small_linear_buffer.
+  ///
+  /// The constructed buffer is empty and uses its inline storage.
+  basic_small_linear_buffer() ASIOEXT_NOEXCEPT
+    : base_type(storage_allocator(this->storage_, Allocator()), N)
+  {
+    this->clear();
+  }
+
+  /// @brief Construct an empty buffer with the given allocator.
+  explicit basic_small_linear_buffer(const Allocator& a) ASIOEXT_NOEXCEPT
+    : base_type(storage_allocator(this->storage_, a), N)
+  {
+    this->clear();
+  }
+
+  /// @brief Construct a buffer with a specific initial size.
+  ///
+  /// @param initial_size The initial size of the buffer. Memory is only
+  /// allocated if this exceeds @c N.
+  ///
+  /// @param maximum_size Specifies a maximum size for the buffer, in bytes.
+  explicit basic_small_linear_buffer(std::size_t initial_size,
+      std::size_t maximum_size = (std::numeric_limits<std::size_t>::max)())
+    : base_type(storage_allocator(this->storage_, Allocator()),
+                (std::min)(N, maximum_size), maximum_size)
+  {
+    this->resize(initial_size);
+  }
+
+  /// @brief Construct a buffer with a specific initial size.
+  ///
+  /// @param initial_size The initial size of the buffer. Memory is only
+  /// allocated if this exceeds @c N.
+  ///
+  /// @param maximum_size Specifies a maximum size for the buffer, in bytes.
+  ///
+  /// @param a The allocator to use.
+  basic_small_linear_buffer(std::size_t initial_size,
+                            std::size_t maximum_size, const Allocator& a)
+    : base_type(storage_allocator(this->storage_, a),
+                (std::min)(N, maximum_size), maximum_size)
+  {
+    this->resize(initial_size);
+  }
+
+  /// @brief Copy-construct a buffer.
+  basic_small_linear_buffer(const basic_small_linear_buffer& other)
+    : base_type(storage_allocator(this->storage_,
+                                  copy_allocator(other.get_allocator())),
+                (std::min)(N, other.max_size()), other.max_size())
+  {
+    this->clear();
+    this->growth_policy(other.growth_policy());
+    this->append(other.data(), other.size());
+  }
+
+  /// @brief Construct a buffer from a copy of a plain linear buffer.
+  explicit basic_small_linear_buffer(
+      const basic_linear_buffer<Allocator>& other)
+    : base_type(storage_allocator(this->storage_,
+                                  copy_allocator(other.get_allocator())),
+                (std::min)(N, other.max_size()), other.max_size())
+  {
+    this->clear();
+    this->growth_policy(other.growth_policy());
+    this->append(other.data(), other.size());
+  }
+
+#if defined(ASIOEXT_HAS_MOVE)
+  /// @brief Move-construct a buffer.
+  ///
+  /// If @c other has allocated memory, it is transferred to the new buffer.
+  /// Otherwise its contents are copied into the inline storage, which
+  /// doesn't allocate either. Afterwards @c other is empty.
+  basic_small_linear_buffer(basic_small_linear_buffer&& other)
+    : base_type(storage_allocator(this->storage_, other.get_allocator()),
+                (std::min)(N, other.max_size()), other.max_size())
+  {
+    this->clear();
+    this->growth_policy(other.growth_policy());
+    move_from(other);
+  }
+#endif
+
+  /// @brief Copy-assign a buffer.
+  basic_small_linear_buffer& operator=(const basic_small_linear_buffer& other)
+  {
+    base_type::operator=(other);
+    return *this;
+  }
+
+#if defined(ASIOEXT_HAS_MOVE)
+  /// @brief Move-assign a buffer.
+  ///
+  /// If @c other has allocated memory and the allocators are equal, it is
+  /// transferred to this buffer. Otherwise the contents are copied.
+  /// Afterwards @c other is empty.
+  basic_small_linear_buffer& operator=(basic_small_linear_buffer&& other)
+  {
+    if (this != &other)
+      move_from(other);
+    return *this;
+  }
+#endif
+
+  /// @brief Get a copy of the allocator used by this buffer.
+  allocator_type get_allocator() const ASIOEXT_NOEXCEPT
+  {
+    return base_type::get_allocator().inner_allocator();
+  }
+
+  /// @brief Check whether the contents reside in the inline storage.
+  ///
+  /// @returns @c true if no memory is currently allocated.
+  bool is_inline() const ASIOEXT_NOEXCEPT
+  {
+    return this->data() == this->storage_;
+  }
+
+  /// @brief Release unused capacity.
+  ///
+  /// If the data fits into the inline storage, it is moved back there and
+  /// the allocated memory is freed. Otherwise the buffer is reallocated to
+  /// fit exactly size() bytes.
+  ///
+  /// If the buffer is reallocated, all iterators and references
+  /// (including the `end()` iterator) are invalidated.
+  void shrink_to_fit()
+  {
+    const std::size_t size = this->size();
+    if (size > N) {
+      base_type::shrink_to_fit();
+      return;
+    }
+
+    if (is_inline())
+      return;
+
+    uint8_t data[N];
+    std::memcpy(data, this->data(), size);
+    reset_storage();
+    this->append(data, size);
+  }
+
+private:
+  static Allocator copy_allocator(const Allocator& a)
+  {
+    return std::allocator_traits<Allocator>::
+        select_on_container_copy_construction(a);
+  }
+
+  // Free the allocated memory (if any) and go back to the inline storage.
+  // None of this allocates: Emptying the buffer frees its memory, after
+  // which the inline storage is available again.
+  void reset_storage()
+  {
+    this->clear();
+    base_type::shrink_to_fit();
+    this->reserve((std::min)(N, this->max_size()));
+  }
+
+#if defined(ASIOEXT_HAS_MOVE)
+  void move_from(basic_small_linear_buffer& other)
+  {
+    if (other.is_inline()) {
+      // Release our memory, just like taking over other's would.
+      reset_storage();
+      base_type::operator=(static_cast<const base_type&>(other));
+      other.clear();
+    } else {
+      base_type::operator=(std::move(static_cast<base_type&>(other)));
+      // With unequal allocators the contents were copied, so |other| might
+      // still have its memory. Either way, it goes back to inline storage.
+      other.reset_storage();
+    }
+  }
+#endif
+};
+
+template <std::size_t N, typename Allocator>
+const std::size_t basic_small_linear_buffer<N, Allocator>::inline_capacity;
+
+/// @brief A small linear buffer using the default allocator.
+template <std::size_t N>
+using small_linear_buffer = basic_small_linear_buffer<N>;
+
+template <std::size_t N, class Allocator>
+struct is_raw_byte_container<basic_small_linear_buffer<N, Allocator>>
+  : std::true_type
+{};
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,110 @@
+/// @file
+/// Defines awaitable versions of the SOCKS client operations.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SOCKS_AWAITABLE_HPP
+#define ASIOEXT_SOCKS_AWAITABLE_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#if defined(ASIOEXT_HAS_CO_AWAIT) || defined(ASIOEXT_IS_DOCUMENTATION)
+
+#include "asioext/awaitable.hpp"
+#include "asioext/socks/client.hpp"
+
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+
+/// @ingroup net_socks
+/// @{
+
+/// @brief Await socks::async_handshake().
+///
+/// @throws asio::system_error Thrown on failure.
+template <typename Socket>
+auto await_handshake(Socket& socket,
+                     const std::string& username,
+                     const std::string& password,
+                     const asio::ip::tcp::endpoint& remote,
+                     const asio::mutable_buffer& storage)
+{
+  return asioext::detail::make_async_awaiter<>(
+      [&socket, &username, &password, remote, storage] (auto handler) {
+    socks::async_handshake(socket, username, password, remote, storage,
+                           std::move(handler));
+  }, nullptr, "handshake");
+}
+
+/// @brief Await socks::async_handshake().
+///
+/// @param ec Set to indicate what error occurred, if any.
+template <typename Socket>
+auto await_handshake(Socket& socket,
+                     const std::string& username,
+                     const std::string& password,
+                     const asio::ip::tcp::endpoint& remote,
+                     const asio::mutable_buffer& storage, error_code& ec)
+{
+  return asioext::detail::make_async_awaiter<>(
+      [&socket, &username, &password, remote, storage] (auto handler) {
+    socks::async_handshake(socket, username, password, remote, storage,
+                           std::move(handler));
+  }, &ec, "handshake");
+}
+
+/// @brief Await socks::async_handshake() for a remote host name.
+///
+/// @throws asio::system_error Thrown on failure.
+template <typename Socket>
+auto await_handshake(Socket& socket,
+                     const std::string& username,
+                     const std::string& password,
+                     const std::string& remote, uint16_t port,
+                     const asio::mutable_buffer& storage)
+{
+  return asioext::detail::make_async_awaiter<>(
+      [&socket, &username, &password, &remote, port, storage]
+      (auto handler) {
+    socks::async_handshake(socket, username, password, remote, port,
+                           storage, std::move(handler));
+  }, nullptr, "handshake");
+}
+
+/// @brief Await socks::async_handshake() for a remote host name.
+///
+/// @param ec Set to indicate what error occurred, if any.
+template <typename Socket>
+auto await_handshake(Socket& socket,
+                     const std::string& username,
+                     const std::string& password,
+                     const std::string& remote, uint16_t port,
+                     const asio::mutable_buffer& storage, error_code& ec)
+{
+  return asioext::detail::make_async_awaiter<>(
+      [&socket, &username, &password, &remote, port, storage]
+      (auto handler) {
+    socks::async_handshake(socket, username, password, remote, port,
+                           storage, std::move(handler));
+  }, &ec, "handshake");
+}
+
+/// @}
+
+}
+
+ASIOEXT_NS_END
+
+#endif
+
+#endif
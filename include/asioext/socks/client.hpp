@@ -153,6 +153,88 @@ async_execute(Socket& socket, command cmd,
               ASIOEXT_MOVE_ARG(DynamicBuffer) buffer,
               ASIOEXT_MOVE_ARG(ExecuteHandler) handler);
 
+/// @brief Storage size that suffices for every async_handshake() call.
+///
+/// Greeting (3 bytes), login (up to 513 bytes) and connect request
+/// (up to 262 bytes).
+const std::size_t max_handshake_size = 3 + 513 + 262;
+
+/// @brief Asynchronously perform a complete SOCKS 5 handshake.
+///
+/// This function performs the greeting, the (optional) login and a
+/// @c command::connect with as few round trips as possible:
+/// All requests are sent with a single write and the replies are read
+/// afterwards. Since the server is only offered one authentication method,
+/// it has no choice that would invalidate the pipelined requests
+/// (optimistic authentication):
+///
+/// * If @c username is empty, only @c auth_method::none is offered.
+/// * Otherwise, only @c auth_method::username_password is offered.
+///
+/// Compared to async_greet(), async_login() and async_execute() this saves
+/// up to two round trips. No memory is allocated by the operation itself;
+/// all packets are encoded into @c storage.
+///
+/// Servers that don't accept pipelined requests (i.e. that discard data
+/// received before their reply was sent) are rare, but for these the
+/// individual operations need to be used.
+///
+/// @param socket The connected socket. The remote endpoint
+/// needs to be a SOCKS 5 proxy.
+/// @param username Username on the remote end. Leave empty for anonymous
+/// access.
+/// @param password Password of the remote user.
+/// @param remote The remote endpoint to connect to.
+/// @param storage Storage for the sent and received packets. Needs to remain
+/// valid until the handler is called. @ref max_handshake_size bytes are always
+/// sufficient. If too small, the operation fails with
+/// @c asio::error::no_buffer_space.
+/// @param handler The handler to be called when the handshake operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation.
+///   const error_code& error,
+/// );
+/// @endcode
+template <typename Socket, typename HandshakeHandler>
+ASIOEXT_INITFN_RESULT_TYPE(HandshakeHandler, void(error_code))
+async_handshake(Socket& socket,
+                const std::string& username,
+                const std::string& password,
+                const asio::ip::tcp::endpoint& remote,
+                const asio::mutable_buffer& storage,
+                ASIOEXT_MOVE_ARG(HandshakeHandler) handler);
+
+/// @brief Asynchronously perform a complete SOCKS 5 handshake.
+///
+/// See the endpoint overload for details.
+///
+/// @param socket The connected socket. The remote endpoint
+/// needs to be a SOCKS 5 proxy.
+/// @param username Username on the remote end. Leave empty for anonymous
+/// access.
+/// @param password Password of the remote user.
+/// @param remote Hostname of the remote endpoint.
+/// @param port Port of the remote endpoint.
+/// @param storage Storage for the sent and received packets.
+/// @param handler The handler to be called when the handshake operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation.
+///   const error_code& error,
+/// );
+/// @endcode
+template <typename Socket, typename HandshakeHandler>
+ASIOEXT_INITFN_RESULT_TYPE(HandshakeHandler, void(error_code))
+async_handshake(Socket& socket,
+                const std::string& username,
+                const std::string& password,
+                const std::string& remote, uint16_t port,
+                const asio::mutable_buffer& storage,
+                ASIOEXT_MOVE_ARG(HandshakeHandler) handler);
+
 /// @}
 
 }
@@ -18,6 +18,7 @@
 
 #include "asioext/socks/detail/protocol.hpp"
 #include "asioext/detail/coroutine.hpp"
+#include "asioext/detail/handler_work.hpp"
 #include "asioext/detail/move_support.hpp"
 
 #if defined(ASIOEXT_USE_BOOST_ASIO)
@@ -33,69 +34,62 @@ ASIOEXT_NS_BEGIN
 namespace socks {
 namespace detail {
 
-template <typename Socket, typename DynamicBuffer, typename Handler>
+// The following operations are started with allocate_composed_operation(),
+// so their DynamicBuffer is only moved once and not on every step.
+template <typename Socket, typename DynamicBuffer>
 class socks_sgreet_op : asio::coroutine
 {
 public:
-  socks_sgreet_op(Handler& handler, Socket& socket,
+  socks_sgreet_op(Socket& socket,
                   const auth_method* auth_methods,
                   std::size_t num_auth_methods,
                   DynamicBuffer& buffer)
     : socket_(socket)
     , buffer_(ASIOEXT_MOVE_CAST(DynamicBuffer)(buffer))
+    , size_(get_sgreet_packet_size(auth_methods, num_auth_methods))
   {
-    const std::size_t size =
-        get_sgreet_packet_size(auth_methods, num_auth_methods);
-
-    if (0 == size) {
-      socket_.get_io_service().post(asioext::bind_handler(
-          ASIOEXT_MOVE_CAST(Handler)(handler), asio::error::invalid_argument,
-          auth_method::no_acceptable));
-      return;
+    if (0 != size_) {
+      asio::mutable_buffer buf = buffer_.prepare(size_);
+      encode_sgreet_packet(auth_methods, num_auth_methods,
+                           asio::buffer_cast<uint8_t*>(buf));
+      buffer_.commit(size_);
     }
-
-    asio::mutable_buffer buf = buffer_.prepare(size);
-    encode_sgreet_packet(auth_methods, num_auth_methods,
-                         asio::buffer_cast<uint8_t*>(buf));
-    buffer_.commit(size);
-
-    asio::async_write(
-        socket, buffer_.data(),
-        asioext::make_composed_operation(
-            ASIOEXT_MOVE_CAST(Handler)(handler),
-            ASIOEXT_MOVE_CAST(socks_sgreet_op)(*this)));
   }
 
-  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code(),
                   std::size_t size = 0);
 
 private:
   Socket& socket_;
   DynamicBuffer buffer_;
+  std::size_t size_;
 };
 
-template <typename Socket, typename DynamicBuffer, typename Handler>
-void socks_sgreet_op<Socket, DynamicBuffer, Handler>::operator()(
-    ASIOEXT_MOVE_ARG(Handler) handler, error_code ec, std::size_t size)
+template <typename Socket, typename DynamicBuffer>
+template <typename Self>
+void socks_sgreet_op<Socket, DynamicBuffer>::operator()(
+    Self& self, error_code ec, std::size_t size)
 {
   if (ec) {
-    handler(ec, auth_method::no_acceptable);
+    self.complete(ec, auth_method::no_acceptable);
     return;
   }
 
   ASIOEXT_CORO_REENTER (this) {
-    buffer_.consume(size);
-    ASIOEXT_CORO_YIELD asio::async_read(
-        socket_, buffer_.prepare(2),
-        asioext::make_composed_operation(
-            ASIOEXT_MOVE_CAST(Handler)(handler),
-            ASIOEXT_MOVE_CAST(socks_sgreet_op)(*this)));
-
-    if (ec) {
-      handler(ec, auth_method::no_acceptable);
+    if (0 == size_) {
+      asioext::detail::post_handler(socket_, asioext::bind_handler(
+          ASIOEXT_MOVE_CAST(Self)(self), asio::error::invalid_argument));
       return;
     }
 
+    ASIOEXT_CORO_YIELD asio::async_write(
+        socket_, buffer_.data(), ASIOEXT_MOVE_CAST(Self)(self));
+
+    buffer_.consume(size);
+    ASIOEXT_CORO_YIELD asio::async_read(
+        socket_, buffer_.prepare(2), ASIOEXT_MOVE_CAST(Self)(self));
+
     buffer_.commit(2);
 
     const uint8_t* data = asio::buffer_cast<const uint8_t*>(buffer_.data());
@@ -106,80 +100,75 @@ void socks_sgreet_op<Socket, DynamicBuffer, Handler>::operator()(
     buffer_.consume(2);
 
     if (version != 5) {
-      handler(error::invalid_version, auth_method::no_acceptable);
+      self.complete(error_code(error::invalid_version),
+                    auth_method::no_acceptable);
       return;
     }
 
     if (chosen_method == auth_method::no_acceptable) {
-      handler(error::no_acceptable_auth_method, auth_method::no_acceptable);
+      self.complete(error_code(error::no_acceptable_auth_method),
+                    auth_method::no_acceptable);
       return;
     }
 
-    handler(ec, chosen_method);
+    self.complete(ec, chosen_method);
   }
 }
 
-template <typename Socket, typename DynamicBuffer, typename Handler>
+template <typename Socket, typename DynamicBuffer>
 class socks_slogin_op : asio::coroutine
 {
 public:
-  socks_slogin_op(Handler& handler, Socket& socket,
+  socks_slogin_op(Socket& socket,
                   const std::string& username,
                   const std::string& password,
                   DynamicBuffer& buffer)
     : socket_(socket)
     , buffer_(ASIOEXT_MOVE_CAST(DynamicBuffer)(buffer))
+    , size_(get_slogin_packet_size(username, password))
   {
-    const std::size_t size =
-        get_slogin_packet_size(username, password);
-
-    if (0 == size) {
-      socket_.get_io_service().post(asioext::bind_handler(
-          ASIOEXT_MOVE_CAST(Handler)(handler), asio::error::invalid_argument));
-      return;
+    if (0 != size_) {
+      asio::mutable_buffer buf = buffer_.prepare(size_);
+      encode_slogin_packet(username, password,
+                           asio::buffer_cast<uint8_t*>(buf));
+      buffer_.commit(size_);
     }
-
-    asio::mutable_buffer buf = buffer_.prepare(size);
-    encode_slogin_packet(username, password,
-                         asio::buffer_cast<uint8_t*>(buf));
-    buffer_.commit(size);
-
-    asio::async_write(socket, buffer_.data(),
-        asioext::make_composed_operation(
-            ASIOEXT_MOVE_CAST(Handler)(handler),
-            ASIOEXT_MOVE_CAST(socks_slogin_op)(*this)));
   }
 
-  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code(),
                   std::size_t size = 0);
 
 private:
   Socket& socket_;
   DynamicBuffer buffer_;
+  std::size_t size_;
 };
 
-template <typename Socket, typename DynamicBuffer, typename Handler>
-void socks_slogin_op<Socket, DynamicBuffer, Handler>::operator()(
-    ASIOEXT_MOVE_ARG(Handler) handler, error_code ec, std::size_t size)
+template <typename Socket, typename DynamicBuffer>
+template <typename Self>
+void socks_slogin_op<Socket, DynamicBuffer>::operator()(
+    Self& self, error_code ec, std::size_t size)
 {
   if (ec) {
-    handler(ec);
+    self.complete(ec);
     return;
   }
 
   ASIOEXT_CORO_REENTER (this) {
-    buffer_.consume(size);
-    ASIOEXT_CORO_YIELD asio::async_read(
-        socket_, buffer_.prepare(2),
-        asioext::make_composed_operation(
-            ASIOEXT_MOVE_CAST(Handler)(handler),
-            ASIOEXT_MOVE_CAST(socks_slogin_op)(*this)));
-
-    if (ec) {
-      handler(ec);
+    if (0 == size_) {
+      asioext::detail::post_handler(socket_, asioext::bind_handler(
+          ASIOEXT_MOVE_CAST(Self)(self), asio::error::invalid_argument));
       return;
     }
 
+    ASIOEXT_CORO_YIELD asio::async_write(
+        socket_, buffer_.data(), ASIOEXT_MOVE_CAST(Self)(self));
+
+    buffer_.consume(size);
+    ASIOEXT_CORO_YIELD asio::async_read(
+        socket_, buffer_.prepare(2), ASIOEXT_MOVE_CAST(Self)(self));
+
     buffer_.commit(2);
 
     const uint8_t* data = asio::buffer_cast<const uint8_t*>(buffer_.data());
@@ -190,24 +179,24 @@ void socks_slogin_op<Socket, DynamicBuffer, Handler>::operator()(
     buffer_.consume(2);
 
     if (version != 1) {
-      handler(error::invalid_auth_version);
+      self.complete(error_code(error::invalid_auth_version));
       return;
     }
 
     if (status_code != 0) {
-      handler(error::login_failed);
+      self.complete(error_code(error::login_failed));
       return;
     }
 
-    handler(ec);
+    self.complete(ec);
   }
 }
 
-template <typename Socket, typename DynamicBuffer, typename Handler>
+template <typename Socket, typename DynamicBuffer>
 class socks_sexec_op : asio::coroutine
 {
 public:
-  socks_sexec_op(Handler& handler, Socket& socket,
+  socks_sexec_op(Socket& socket,
                  command cmd,
                  const asio::ip::tcp::endpoint& remote,
                  const std::string& remote_host,
@@ -215,60 +204,52 @@ public:
                  DynamicBuffer& buffer)
     : socket_(socket)
     , buffer_(ASIOEXT_MOVE_CAST(DynamicBuffer)(buffer))
+    , size_(get_sexec_packet_size(cmd, remote, remote_host, port))
   {
-    const std::size_t size =
-        get_sexec_packet_size(cmd, remote, remote_host, port);
-
-    if (0 == size) {
-      socket_.get_io_service().post(asioext::bind_handler(
-          ASIOEXT_MOVE_CAST(Handler)(handler), asio::error::invalid_argument));
-      return;
+    if (0 != size_) {
+      asio::mutable_buffer buf = buffer_.prepare(size_);
+      encode_sexec_packet(cmd, remote, remote_host, port,
+                          asio::buffer_cast<uint8_t*>(buf));
+      buffer_.commit(size_);
     }
-
-    asio::mutable_buffer buf = buffer_.prepare(size);
-    encode_sexec_packet(cmd, remote, remote_host, port,
-                        asio::buffer_cast<uint8_t*>(buf));
-    buffer_.commit(size);
-
-    asio::async_write(
-        socket, buffer_.data(),
-        asioext::make_composed_operation(
-            ASIOEXT_MOVE_CAST(Handler)(handler),
-            ASIOEXT_MOVE_CAST(socks_sexec_op)(*this)));
   }
 
-  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code(),
                   std::size_t size = 0);
 
 private:
   Socket& socket_;
   DynamicBuffer buffer_;
+  std::size_t size_;
   uint8_t address_type_;
   uint8_t first_address_byte_;
 };
 
-template <typename Socket, typename DynamicBuffer, typename Handler>
-void socks_sexec_op<Socket, DynamicBuffer, Handler>::operator()(
-    ASIOEXT_MOVE_ARG(Handler) handler, error_code ec, std::size_t size)
+template <typename Socket, typename DynamicBuffer>
+template <typename Self>
+void socks_sexec_op<Socket, DynamicBuffer>::operator()(
+    Self& self, error_code ec, std::size_t size)
 {
   if (ec) {
-    handler(ec);
+    self.complete(ec);
     return;
   }
 
   ASIOEXT_CORO_REENTER (this) {
-    buffer_.consume(size);
-    ASIOEXT_CORO_YIELD asio::async_read(
-        socket_, buffer_.prepare(5),
-        asioext::make_composed_operation(
-            ASIOEXT_MOVE_CAST(Handler)(handler),
-            ASIOEXT_MOVE_CAST(socks_sexec_op)(*this)));
-
-    if (ec) {
-      handler(ec);
+    if (0 == size_) {
+      asioext::detail::post_handler(socket_, asioext::bind_handler(
+          ASIOEXT_MOVE_CAST(Self)(self), asio::error::invalid_argument));
       return;
     }
 
+    ASIOEXT_CORO_YIELD asio::async_write(
+        socket_, buffer_.data(), ASIOEXT_MOVE_CAST(Self)(self));
+
+    buffer_.consume(size);
+    ASIOEXT_CORO_YIELD asio::async_read(
+        socket_, buffer_.prepare(5), ASIOEXT_MOVE_CAST(Self)(self));
+
     {
       buffer_.commit(5);
 
@@ -283,21 +264,12 @@ void socks_sexec_op<Socket, DynamicBuffer, Handler>::operator()(
       buffer_.consume(5);
 
       if (version != 5) {
-        handler(error::invalid_version);
+        self.complete(error_code(error::invalid_version));
         return;
       }
 
       if (status_code != 0) {
-        switch (status_code) {
-          case 2: ec = asio::error::no_permission; break;
-          case 3: ec = asio::error::network_unreachable; break;
-          case 4: ec = asio::error::host_unreachable; break;
-          case 5: ec = asio::error::connection_refused; break;
-          case 6: ec = asio::error::timed_out; break;
-          case 7: ec = error::command_not_supported; break;
-          case 8: ec = asio::error::address_family_not_supported; break;
-        }
-        handler(ec);
+        self.complete(make_sexec_error(status_code));
         return;
       }
     }
@@ -321,21 +293,123 @@ void socks_sexec_op<Socket, DynamicBuffer, Handler>::operator()(
     }
 
     ASIOEXT_CORO_YIELD asio::async_read(
-        socket_, buffer_.prepare(size + 2),
+        socket_, buffer_.prepare(size + 2), ASIOEXT_MOVE_CAST(Self)(self));
+
+    // TODO: should we return the actual target endpoint to the user?
+    buffer_.commit(size);
+    buffer_.consume(size);
+
+    self.complete(ec);
+  }
+}
+
+// Pipelined greeting, login and connect: all requests are sent with a single
+// write, after which the replies are read into the same storage.
+template <typename Socket, typename Handler>
+class socks_handshake_op : asio::coroutine
+{
+public:
+  socks_handshake_op(Handler& handler, Socket& socket,
+                     const std::string& username,
+                     const std::string& password,
+                     const asio::ip::tcp::endpoint& remote,
+                     const std::string& remote_host,
+                     uint16_t port,
+                     const asio::mutable_buffer& storage)
+    : socket_(socket)
+    , storage_(storage)
+    , method_(username.empty() ? auth_method::none
+                               : auth_method::username_password)
+    , size_(0)
+    , need_(0)
+  {
+    const std::size_t greet_size = get_sgreet_packet_size(&method_, 1);
+    const std::size_t login_size = method_ == auth_method::username_password
+        ? get_slogin_packet_size(username, password) : 0;
+    const std::size_t exec_size = get_sexec_packet_size(
+        command::connect, remote, remote_host, port);
+
+    if ((method_ == auth_method::username_password && 0 == login_size) ||
+        0 == exec_size) {
+      asioext::detail::post_handler(socket_, asioext::bind_handler(
+          ASIOEXT_MOVE_CAST(Handler)(handler), asio::error::invalid_argument));
+      return;
+    }
+
+    const std::size_t size = greet_size + login_size + exec_size;
+    if (asio::buffer_size(storage_) < size ||
+        asio::buffer_size(storage_) < get_handshake_max_reply_size(
+            method_ == auth_method::username_password)) {
+      asioext::detail::post_handler(socket_, asioext::bind_handler(
+          ASIOEXT_MOVE_CAST(Handler)(handler), asio::error::no_buffer_space));
+      return;
+    }
+
+    uint8_t* data = asio::buffer_cast<uint8_t*>(storage_);
+    encode_sgreet_packet(&method_, 1, data);
+    if (login_size != 0)
+      encode_slogin_packet(username, password, data + greet_size);
+    encode_sexec_packet(command::connect, remote, remote_host, port,
+                        data + greet_size + login_size);
+
+    asio::async_write(
+        socket, asio::buffer(storage_, size),
         asioext::make_composed_operation(
             ASIOEXT_MOVE_CAST(Handler)(handler),
-            ASIOEXT_MOVE_CAST(socks_sexec_op)(*this)));
+            ASIOEXT_MOVE_CAST(socks_handshake_op)(*this)));
+  }
+
+  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+                  std::size_t size = 0);
+
+private:
+  Socket& socket_;
+  asio::mutable_buffer storage_;
+  auth_method method_;
+  std::size_t size_;
+  std::size_t need_;
+};
 
+template <typename Socket, typename Handler>
+void socks_handshake_op<Socket, Handler>::operator()(
+    ASIOEXT_MOVE_ARG(Handler) handler, error_code ec, std::size_t size)
+{
+  ASIOEXT_CORO_REENTER (this) {
     if (ec) {
       handler(ec);
       return;
     }
 
-    // TODO: should we return the actual target endpoint to the user?
-    buffer_.commit(size);
-    buffer_.consume(size);
+    need_ = check_handshake_reply(nullptr, 0, method_, ec);
+    for (;;) {
+      // Never ask for more than the replies, anything after them belongs
+      // to the proxied connection.
+      ASIOEXT_CORO_YIELD socket_.async_read_some(
+          asio::buffer(storage_ + size_, need_ - size_),
+          asioext::make_composed_operation(
+              ASIOEXT_MOVE_CAST(Handler)(handler),
+              ASIOEXT_MOVE_CAST(socks_handshake_op)(*this)));
+
+      size_ += size;
+
+      {
+        // A server that rejects us usually closes the connection right
+        // away. Prefer the error from the reply over e.g. eof.
+        error_code reply_ec;
+        need_ = check_handshake_reply(
+            asio::buffer_cast<const uint8_t*>(storage_), size_, method_,
+            reply_ec);
+        if (reply_ec) {
+          handler(reply_ec);
+          return;
+        }
+      }
 
-    handler(ec);
+      if (ec || size_ == need_) {
+        handler(ec);
+        return;
+      }
+    }
   }
 }
 
@@ -4,6 +4,13 @@
 /// http://www.boost.org/LICENSE_1_0.txt)
 
 #include "asioext/socks/detail/protocol.hpp"
+#include "asioext/socks/error.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/error.hpp>
+#else
+# include <asio/error.hpp>
+#endif
 
 ASIOEXT_NS_BEGIN
 
@@ -130,6 +137,281 @@ void encode_sexec_packet(command cmd,
   }
 }
 
+error_code make_sexec_error(uint8_t status_code)
+{
+  switch (status_code) {
+    case 0: return error_code();
+    case 2: return asio::error::no_permission;
+    case 3: return asio::error::network_unreachable;
+    case 4: return asio::error::host_unreachable;
+    case 5: return asio::error::connection_refused;
+    case 6: return asio::error::timed_out;
+    case 7: return error::command_not_supported;
+    case 8: return asio::error::address_family_not_supported;
+    // 1 is a general failure, anything else is unknown.
+    default: return asio::error::connection_aborted;
+  }
+}
+
+std::size_t get_handshake_max_reply_size(bool login)
+{
+  // Greeting reply, login reply and the longest command reply
+  // (4 header bytes, hostname of 255 bytes + length, port).
+  return 2 + (login ? 2 : 0) + 4 + 1 + 255 + 2;
+}
+
+std::size_t check_handshake_reply(const uint8_t* data, std::size_t size,
+                                  auth_method method, error_code& ec)
+{
+  const bool login = method == auth_method::username_password;
+  const std::size_t exec_offset = login ? 4 : 2;
+
+  // Until the address type is known, the shortest reply (a hostname of
+  // length 0) is all we can expect.
+  const std::size_t min_size = exec_offset + 5;
+
+  if (size < 2)
+    return min_size;
+
+  if (data[0] != 5) {
+    ec = error::invalid_version;
+    return 0;
+  }
+  if (data[1] != static_cast<uint8_t>(method)) {
+    ec = error::no_acceptable_auth_method;
+    return 0;
+  }
+
+  if (login) {
+    if (size < 4)
+      return min_size;
+
+    if (data[2] != 1) {
+      ec = error::invalid_auth_version;
+      return 0;
+    }
+    if (data[3] != 0) {
+      ec = error::login_failed;
+      return 0;
+    }
+  }
+
+  if (size < exec_offset + 2)
+    return min_size;
+
+  if (data[exec_offset] != 5) {
+    ec = error::invalid_version;
+    return 0;
+  }
+
+  ec = make_sexec_error(data[exec_offset + 1]);
+  if (ec)
+    return 0;
+
+  if (size < min_size)
+    return min_size;
+
+  switch (data[exec_offset + 3]) {
+    // IPv4
+    case 1: return exec_offset + 4 + 4 + 2;
+    // Hostname
+    case 3: return exec_offset + 4 + 1 + data[exec_offset + 4] + 2;
+    // IPv6
+    case 4: return exec_offset + 4 + 16 + 2;
+  }
+
+  ec = asio::error::address_family_not_supported;
+  return 0;
+}
+
+std::size_t get_sgreet_request_size(const uint8_t* data, std::size_t size,
+                                    error_code& ec)
+{
+  if (size < 1)
+    return 2;
+
+  if (data[0] != 5) {
+    ec = error::invalid_version;
+    return 0;
+  }
+
+  if (size < 2)
+    return 2;
+
+  return 2 + data[1];
+}
+
+std::size_t get_slogin_request_size(const uint8_t* data, std::size_t size,
+                                    error_code& ec)
+{
+  if (size < 1)
+    return 3;
+
+  if (data[0] != 1) {
+    ec = error::invalid_auth_version;
+    return 0;
+  }
+
+  // Version, username length, password length.
+  if (size < 2)
+    return 3;
+
+  const std::size_t username_size = data[1];
+  if (size < 3 + username_size)
+    return 3 + username_size;
+
+  return 3 + username_size + data[2 + username_size];
+}
+
+std::size_t get_sexec_request_size(const uint8_t* data, std::size_t size,
+                                   error_code& ec)
+{
+  // The shortest request has a hostname of length 0.
+  const std::size_t min_size = 4 + 1 + 2;
+
+  if (size < 1)
+    return min_size;
+
+  if (data[0] != 5) {
+    ec = error::invalid_version;
+    return 0;
+  }
+
+  if (size < 5)
+    return min_size;
+
+  switch (data[3]) {
+    // IPv4
+    case 1: return 4 + 4 + 2;
+    // Hostname
+    case 3: return 4 + 1 + data[4] + 2;
+    // IPv6
+    case 4: return 4 + 16 + 2;
+  }
+
+  ec = asio::error::address_family_not_supported;
+  return 0;
+}
+
+bool has_auth_method(const uint8_t* data, auth_method method)
+{
+  const std::size_t num_auth_methods = data[1];
+  for (std::size_t i = 0; i != num_auth_methods; ++i) {
+    if (data[2 + i] == static_cast<uint8_t>(method))
+      return true;
+  }
+  return false;
+}
+
+void decode_slogin_packet(const uint8_t* data,
+                          std::string& username,
+                          std::string& password)
+{
+  const std::size_t username_size = data[1];
+  username.assign(reinterpret_cast<const char*>(data + 2), username_size);
+
+  const uint8_t* pw = data + 2 + username_size;
+  password.assign(reinterpret_cast<const char*>(pw + 1), pw[0]);
+}
+
+void decode_sexec_packet(const uint8_t* data,
+                         command& cmd,
+                         asio::ip::tcp::endpoint& remote,
+                         std::string& remote_host,
+                         uint16_t& port)
+{
+  cmd = static_cast<command>(data[1]);
+
+  const uint8_t* buf = data + 4;
+  switch (data[3]) {
+    case 1: {
+      asio::ip::address_v4::bytes_type addr;
+      std::memcpy(addr.data(), buf, addr.size());
+      buf += addr.size();
+      remote.address(asio::ip::address_v4(addr));
+      remote_host.clear();
+      break;
+    }
+    case 3: {
+      const std::size_t remote_host_size = *buf++;
+      remote_host.assign(reinterpret_cast<const char*>(buf),
+                         remote_host_size);
+      buf += remote_host_size;
+      remote = asio::ip::tcp::endpoint();
+      break;
+    }
+    case 4: {
+      asio::ip::address_v6::bytes_type addr;
+      std::memcpy(addr.data(), buf, addr.size());
+      buf += addr.size();
+      remote.address(asio::ip::address_v6(addr));
+      remote_host.clear();
+      break;
+    }
+  }
+
+  port = static_cast<uint16_t>((buf[0] << 8) | buf[1]);
+  if (remote_host.empty())
+    remote.port(port);
+}
+
+uint8_t make_sexec_status(const error_code& ec)
+{
+  if (!ec)
+    return 0;
+  if (ec == asio::error::no_permission ||
+      ec == asio::error::access_denied)
+    return 2;
+  if (ec == asio::error::network_unreachable ||
+      ec == asio::error::network_down)
+    return 3;
+  if (ec == asio::error::host_unreachable ||
+      ec == asio::error::host_not_found ||
+      ec == asio::error::host_not_found_try_again)
+    return 4;
+  if (ec == asio::error::connection_refused)
+    return 5;
+  if (ec == asio::error::timed_out)
+    return 6;
+  if (ec == error::command_not_supported)
+    return 7;
+  if (ec == asio::error::address_family_not_supported)
+    return 8;
+  return 1;
+}
+
+std::size_t get_sexec_reply_size(const asio::ip::tcp::endpoint& bound)
+{
+  return bound.protocol() == asio::ip::tcp::v4() ? 4 + 4 + 2 : 4 + 16 + 2;
+}
+
+void encode_sexec_reply(uint8_t status,
+                        const asio::ip::tcp::endpoint& bound,
+                        uint8_t* buf)
+{
+  const bool is_v4 = bound.protocol() == asio::ip::tcp::v4();
+
+  *buf++ = 5;
+  *buf++ = status;
+  *buf++ = 0;
+  *buf++ = is_v4 ? 1 : 4;
+  if (is_v4) {
+    const asio::ip::address_v4::bytes_type addr =
+        bound.address().to_v4().to_bytes();
+    std::memcpy(buf, addr.data(), addr.size());
+    buf += addr.size();
+  } else {
+    const asio::ip::address_v6::bytes_type addr =
+        bound.address().to_v6().to_bytes();
+    std::memcpy(buf, addr.data(), addr.size());
+    buf += addr.size();
+  }
+
+  const uint16_t port = bound.port();
+  *buf++ = static_cast<uint8_t>((port >> 8) & 0xff);
+  *buf++ = static_cast<uint8_t>((port >> 0) & 0xff);
+}
+
 }
 }
 
@@ -13,6 +13,7 @@
 #endif
 
 #include "asioext/socks/constants.hpp"
+#include "asioext/error_code.hpp"
 #include "asioext/linear_buffer.hpp"
 
 #if defined(ASIOEXT_USE_BOOST_ASIO)
@@ -60,6 +61,63 @@ ASIOEXT_DECL void encode_sexec_packet(
     uint16_t port,
     uint8_t* out);
 
+// Map the status field of a command reply to an error_code.
+ASIOEXT_DECL error_code make_sexec_error(uint8_t status_code);
+
+// Size of the replies to a pipelined handshake: greeting, login (optional)
+// and command reply with a bound address of at most 255 + 1 bytes.
+ASIOEXT_DECL std::size_t get_handshake_max_reply_size(bool login);
+
+// Check the (possibly incomplete) replies to a pipelined handshake.
+// Returns the number of reply bytes that are known to follow. This never
+// exceeds the size of a successful reply, so reading up to that many bytes
+// can't swallow data of the proxied connection.
+// The handshake is complete once |size| equals the returned value.
+ASIOEXT_DECL std::size_t check_handshake_reply(const uint8_t* data,
+                                               std::size_t size,
+                                               auth_method method,
+                                               error_code& ec);
+
+// Server side: Get the total size of a greeting, login or command request
+// from its first |size| bytes. While the request is incomplete, the returned
+// size is larger than |size| and tells how many bytes are known to follow.
+// Returns 0 (and sets |ec|) if the request is invalid.
+ASIOEXT_DECL std::size_t get_sgreet_request_size(const uint8_t* data,
+                                                 std::size_t size,
+                                                 error_code& ec);
+
+ASIOEXT_DECL std::size_t get_slogin_request_size(const uint8_t* data,
+                                                 std::size_t size,
+                                                 error_code& ec);
+
+ASIOEXT_DECL std::size_t get_sexec_request_size(const uint8_t* data,
+                                                std::size_t size,
+                                                error_code& ec);
+
+// Check whether the (complete) greeting contains |method|.
+ASIOEXT_DECL bool has_auth_method(const uint8_t* data, auth_method method);
+
+ASIOEXT_DECL void decode_slogin_packet(const uint8_t* data,
+                                       std::string& username,
+                                       std::string& password);
+
+ASIOEXT_DECL void decode_sexec_packet(const uint8_t* data,
+                                      command& cmd,
+                                      asio::ip::tcp::endpoint& remote,
+                                      std::string& remote_host,
+                                      uint16_t& port);
+
+// Map an error_code to the status field of a command reply.
+// This is the inverse of make_sexec_error().
+ASIOEXT_DECL uint8_t make_sexec_status(const error_code& ec);
+
+ASIOEXT_DECL std::size_t get_sexec_reply_size(
+    const asio::ip::tcp::endpoint& bound);
+
+ASIOEXT_DECL void encode_sexec_reply(uint8_t status,
+                                     const asio::ip::tcp::endpoint& bound,
+                                     uint8_t* out);
+
 }
 }
 
@@ -0,0 +1,232 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SOCKS_DETAIL_SERVER_HPP
+#define ASIOEXT_SOCKS_DETAIL_SERVER_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/socks/error.hpp"
+#include "asioext/composed_operation.hpp"
+
+#include "asioext/socks/detail/protocol.hpp"
+#include "asioext/detail/coroutine.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/write.hpp>
+#else
+# include <asio/write.hpp>
+#endif
+
+#include <algorithm>
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+namespace detail {
+
+// Pipelined requests are usually received in one go, so we try to read a
+// little more than the part of the request that is known to follow.
+const std::size_t min_request_read_size = 512;
+
+template <typename Socket, typename Authenticator, typename DynamicBuffer,
+          typename Handler>
+class socks_accept_request_op : asio::coroutine
+{
+public:
+  socks_accept_request_op(Handler& handler, Socket& socket,
+                          const Authenticator& auth,
+                          DynamicBuffer& buffer)
+    : socket_(socket)
+    , auth_(auth)
+    , buffer_(ASIOEXT_MOVE_CAST(DynamicBuffer)(buffer))
+    , size_(0)
+    , accepted_(false)
+  {
+    (*this)(ASIOEXT_MOVE_CAST(Handler)(handler), error_code(), 0);
+  }
+
+  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+                  std::size_t size = 0);
+
+private:
+  const uint8_t* data() const
+  {
+    return asio::buffer_cast<const uint8_t*>(buffer_.data());
+  }
+
+  void read(Handler& handler)
+  {
+    const std::size_t avail = buffer_.size();
+    socket_.async_read_some(
+        buffer_.prepare((std::max)(size_ - avail, min_request_read_size)),
+        asioext::make_composed_operation(
+            ASIOEXT_MOVE_CAST(Handler)(handler),
+            ASIOEXT_MOVE_CAST(socks_accept_request_op)(*this)));
+  }
+
+  // The reply is written from the output sequence, so that requests the
+  // client already sent aren't disturbed. Committing nothing afterwards
+  // discards it.
+  void write(Handler& handler, std::size_t size)
+  {
+    asio::async_write(
+        socket_, asio::buffer(out_, size),
+        asioext::make_composed_operation(
+            ASIOEXT_MOVE_CAST(Handler)(handler),
+            ASIOEXT_MOVE_CAST(socks_accept_request_op)(*this)));
+  }
+
+  Socket& socket_;
+  const Authenticator& auth_;
+  DynamicBuffer buffer_;
+  asio::mutable_buffer out_;
+  request request_;
+  std::string username_;
+  std::string password_;
+  std::size_t size_;
+  bool accepted_;
+};
+
+template <typename Socket, typename Authenticator, typename DynamicBuffer,
+          typename Handler>
+void socks_accept_request_op<Socket, Authenticator, DynamicBuffer, Handler>::
+    operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+               std::size_t size)
+{
+  if (ec) {
+    handler(ec, request());
+    return;
+  }
+
+  ASIOEXT_CORO_REENTER (this) {
+    for (;;) {
+      size_ = get_sgreet_request_size(data(), buffer_.size(), ec);
+      if (ec) {
+        handler(ec, request());
+        return;
+      }
+      if (buffer_.size() >= size_)
+        break;
+
+      ASIOEXT_CORO_YIELD read(handler);
+      buffer_.commit(size);
+    }
+
+    accepted_ = has_auth_method(data(), auth_.method());
+    buffer_.consume(size_);
+
+    out_ = buffer_.prepare(2);
+    asio::buffer_cast<uint8_t*>(out_)[0] = 5;
+    asio::buffer_cast<uint8_t*>(out_)[1] = static_cast<uint8_t>(
+        accepted_ ? auth_.method() : auth_method::no_acceptable);
+    ASIOEXT_CORO_YIELD write(handler, 2);
+    buffer_.commit(0);
+
+    if (!accepted_) {
+      handler(error::no_acceptable_auth_method, request());
+      return;
+    }
+
+    if (auth_.method() == auth_method::username_password) {
+      for (;;) {
+        size_ = get_slogin_request_size(data(), buffer_.size(), ec);
+        if (ec) {
+          handler(ec, request());
+          return;
+        }
+        if (buffer_.size() >= size_)
+          break;
+
+        ASIOEXT_CORO_YIELD read(handler);
+        buffer_.commit(size);
+      }
+
+      decode_slogin_packet(data(), username_, password_);
+      buffer_.consume(size_);
+
+      accepted_ = auth_.check(username_, password_);
+      username_.clear();
+      password_.clear();
+
+      out_ = buffer_.prepare(2);
+      asio::buffer_cast<uint8_t*>(out_)[0] = 1;
+      asio::buffer_cast<uint8_t*>(out_)[1] = accepted_ ? 0 : 1;
+      ASIOEXT_CORO_YIELD write(handler, 2);
+      buffer_.commit(0);
+
+      if (!accepted_) {
+        handler(error::login_failed, request());
+        return;
+      }
+    }
+
+    for (;;) {
+      size_ = get_sexec_request_size(data(), buffer_.size(), ec);
+      if (ec) {
+        handler(ec, request());
+        return;
+      }
+      if (buffer_.size() >= size_)
+        break;
+
+      ASIOEXT_CORO_YIELD read(handler);
+      buffer_.commit(size);
+    }
+
+    decode_sexec_packet(data(), request_.cmd, request_.endpoint,
+                        request_.hostname, request_.port);
+    buffer_.consume(size_);
+    handler(ec, request_);
+  }
+}
+
+template <typename Socket, typename DynamicBuffer, typename Handler>
+class socks_reply_op
+{
+public:
+  socks_reply_op(Handler& handler, Socket& socket,
+                 const error_code& result,
+                 const asio::ip::tcp::endpoint& bound,
+                 DynamicBuffer& buffer)
+    : buffer_(ASIOEXT_MOVE_CAST(DynamicBuffer)(buffer))
+  {
+    const std::size_t size = get_sexec_reply_size(bound);
+
+    // Written from the output sequence, so that data the client already
+    // sent stays in the buffer.
+    asio::mutable_buffer buf = buffer_.prepare(size);
+    encode_sexec_reply(make_sexec_status(result), bound,
+                       asio::buffer_cast<uint8_t*>(buf));
+
+    asio::async_write(
+        socket, asio::buffer(buf, size),
+        asioext::make_composed_operation(
+            ASIOEXT_MOVE_CAST(Handler)(handler),
+            ASIOEXT_MOVE_CAST(socks_reply_op)(*this)));
+  }
+
+  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+                  std::size_t /*size*/ = 0)
+  {
+    buffer_.commit(0);
+    handler(ec);
+  }
+
+private:
+  DynamicBuffer buffer_;
+};
+
+}
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,602 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SOCKS_DETAIL_UDP_HPP
+#define ASIOEXT_SOCKS_DETAIL_UDP_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/socks/error.hpp"
+#include "asioext/composed_operation.hpp"
+#include "asioext/bind_handler.hpp"
+
+#include "asioext/socks/detail/protocol.hpp"
+#include "asioext/detail/buffer_sequence_adapter.hpp"
+#include "asioext/detail/coroutine.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/error.hpp>
+# include <boost/asio/read.hpp>
+# include <boost/asio/write.hpp>
+#else
+# include <asio/error.hpp>
+# include <asio/read.hpp>
+# include <asio/write.hpp>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+namespace detail {
+
+struct udp_header_access
+{
+  // The part of the header that is received in front of the payload.
+  static asio::mutable_buffer receive_buffer(udp_header& h) ASIOEXT_NOEXCEPT
+  {
+    return asio::mutable_buffer(h.data_, h.expected_size_);
+  }
+
+  // The rest of the header storage, which is received behind the payload.
+  // If the header is larger than expected, the end of the payload ends up
+  // here instead of being cut off.
+  static asio::mutable_buffer overflow_buffer(udp_header& h) ASIOEXT_NOEXCEPT
+  {
+    return asio::mutable_buffer(h.data_ + h.expected_size_,
+                                udp_header::max_size - h.expected_size_);
+  }
+
+  static uint8_t* data(udp_header& h) ASIOEXT_NOEXCEPT
+  {
+    return h.data_;
+  }
+
+  static void set_received(udp_header& h, std::size_t size) ASIOEXT_NOEXCEPT
+  {
+    h.size_ = size;
+    h.expected_size_ = size;
+  }
+};
+
+// Get the size of a received UDP request header from its first
+// (at least 5) bytes. Returns 0 if the datagram has to be dropped.
+ASIOEXT_DECL std::size_t get_udp_header_size(const uint8_t* data,
+                                             std::size_t size);
+
+// A buffer sequence that consists of |prefix| followed by |buffers| and
+// an optional |suffix|. Used to send/receive the UDP request header along
+// with the payload.
+template <typename Buffer, typename Buffers>
+class prefixed_buffers
+{
+  typedef asioext::detail::buffer_sequence_range<Buffers> range;
+
+public:
+  typedef Buffer value_type;
+
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Buffer value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Buffer* pointer;
+    typedef Buffer reference;
+
+    const_iterator() ASIOEXT_NOEXCEPT
+      : prefix_(nullptr)
+      , it_()
+      , end_()
+      , suffix_(nullptr)
+    {
+      // ctor
+    }
+
+    const_iterator(const Buffer* prefix, typename range::iterator it,
+                   typename range::iterator end,
+                   const Buffer* suffix) ASIOEXT_NOEXCEPT
+      : prefix_(prefix)
+      , it_(it)
+      , end_(end)
+      , suffix_(suffix)
+    {
+      // ctor
+    }
+
+    Buffer operator*() const ASIOEXT_NOEXCEPT
+    {
+      if (prefix_)
+        return *prefix_;
+      return it_ != end_ ? Buffer(*it_) : *suffix_;
+    }
+
+    const_iterator& operator++() ASIOEXT_NOEXCEPT
+    {
+      if (prefix_)
+        prefix_ = nullptr;
+      else if (it_ != end_)
+        ++it_;
+      else
+        suffix_ = nullptr;
+      return *this;
+    }
+
+    const_iterator operator++(int) ASIOEXT_NOEXCEPT
+    {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(const const_iterator& a,
+                           const const_iterator& b) ASIOEXT_NOEXCEPT
+    {
+      return a.prefix_ == b.prefix_ && a.it_ == b.it_ &&
+             a.suffix_ == b.suffix_;
+    }
+
+    friend bool operator!=(const const_iterator& a,
+                           const const_iterator& b) ASIOEXT_NOEXCEPT
+    {
+      return !(a == b);
+    }
+
+  private:
+    const Buffer* prefix_;
+    typename range::iterator it_;
+    typename range::iterator end_;
+    const Buffer* suffix_;
+  };
+
+  prefixed_buffers(const Buffer& prefix, const Buffers& buffers,
+                   const Buffer& suffix = Buffer())
+    : prefix_(prefix)
+    , buffers_(buffers)
+    , suffix_(suffix)
+  {
+    // ctor
+  }
+
+  const_iterator begin() const ASIOEXT_NOEXCEPT
+  {
+    return const_iterator(&prefix_, range::begin(buffers_),
+                          range::end(buffers_),
+                          asio::buffer_size(suffix_) != 0 ? &suffix_
+                                                          : nullptr);
+  }
+
+  const_iterator end() const ASIOEXT_NOEXCEPT
+  {
+    return const_iterator(nullptr, range::end(buffers_),
+                          range::end(buffers_), nullptr);
+  }
+
+private:
+  Buffer prefix_;
+  Buffers buffers_;
+  Buffer suffix_;
+};
+
+// Byte-addressable view of a received datagram: the header storage
+// followed by the payload buffers and the overflow storage.
+template <typename Buffers>
+class udp_scatter_view
+{
+  typedef asioext::detail::buffer_sequence_range<Buffers> range;
+
+public:
+  udp_scatter_view(uint8_t* head, std::size_t head_size,
+                   const Buffers& buffers, uint8_t* tail,
+                   std::size_t tail_size) ASIOEXT_NOEXCEPT
+    : head_(head)
+    , head_size_(head_size)
+    , buffers_(buffers)
+    , tail_(tail)
+    , tail_size_(tail_size)
+  {
+    // ctor
+  }
+
+  std::size_t size() const ASIOEXT_NOEXCEPT
+  {
+    std::size_t size = head_size_ + tail_size_;
+    for (typename range::iterator it = range::begin(buffers_),
+         end = range::end(buffers_); it != end; ++it)
+      size += asio::buffer_size(asio::mutable_buffer(*it));
+    return size;
+  }
+
+  // Get the byte at |offset|. |before| is set to the number of bytes that
+  // precede it in the same segment, |after| to the number of bytes from
+  // there to the end of the segment.
+  uint8_t* locate(std::size_t offset, std::size_t& before,
+                  std::size_t& after) const ASIOEXT_NOEXCEPT
+  {
+    if (offset < head_size_) {
+      before = offset;
+      after = head_size_ - offset;
+      return head_ + offset;
+    }
+
+    offset -= head_size_;
+    for (typename range::iterator it = range::begin(buffers_),
+         end = range::end(buffers_); it != end; ++it) {
+      const asio::mutable_buffer b(*it);
+      const std::size_t size = asio::buffer_size(b);
+      if (offset < size) {
+        before = offset;
+        after = size - offset;
+        return asio::buffer_cast<uint8_t*>(b) + offset;
+      }
+      offset -= size;
+    }
+
+    if (offset < tail_size_) {
+      before = offset;
+      after = tail_size_ - offset;
+      return tail_ + offset;
+    }
+
+    before = after = 0;
+    return nullptr;
+  }
+
+  // Get the byte at |offset| and the number of contiguous bytes
+  // starting there.
+  uint8_t* at(std::size_t offset, std::size_t& avail) const ASIOEXT_NOEXCEPT
+  {
+    std::size_t before;
+    return locate(offset, before, avail);
+  }
+
+  // Get the end of the byte at |end| - 1 and the number of contiguous
+  // bytes ending there.
+  uint8_t* before(std::size_t end, std::size_t& avail) const ASIOEXT_NOEXCEPT
+  {
+    std::size_t after;
+    uint8_t* p = locate(end - 1, avail, after);
+    ++avail;
+    return p + 1;
+  }
+
+  void copy_out(std::size_t offset, uint8_t* out,
+                std::size_t count) const ASIOEXT_NOEXCEPT
+  {
+    while (count != 0) {
+      std::size_t avail;
+      const uint8_t* p = at(offset, avail);
+      const std::size_t n = (std::min)(count, avail);
+      std::memcpy(out, p, n);
+      out += n;
+      offset += n;
+      count -= n;
+    }
+  }
+
+  // Move |count| bytes from |src| to |dst|. Bytes that would end up
+  // behind the end are dropped. Returns the number of bytes moved.
+  std::size_t move(std::size_t dst, std::size_t src,
+                   std::size_t count) const ASIOEXT_NOEXCEPT
+  {
+    if (dst < src) {
+      const std::size_t moved = count;
+      while (count != 0) {
+        std::size_t src_avail, dst_avail;
+        const uint8_t* s = at(src, src_avail);
+        uint8_t* d = at(dst, dst_avail);
+        const std::size_t n = (std::min)(count, (std::min)(src_avail,
+                                                           dst_avail));
+        std::memmove(d, s, n);
+        src += n;
+        dst += n;
+        count -= n;
+      }
+      return moved;
+    }
+
+    const std::size_t total = size();
+    count = dst < total ? (std::min)(count, total - dst) : 0;
+
+    const std::size_t moved = count;
+    std::size_t src_end = src + count;
+    std::size_t dst_end = dst + count;
+    while (count != 0) {
+      std::size_t src_avail, dst_avail;
+      const uint8_t* s = before(src_end, src_avail);
+      uint8_t* d = before(dst_end, dst_avail);
+      const std::size_t n = (std::min)(count, (std::min)(src_avail,
+                                                         dst_avail));
+      std::memmove(d - n, s - n, n);
+      src_end -= n;
+      dst_end -= n;
+      count -= n;
+    }
+    return moved;
+  }
+
+private:
+  uint8_t* head_;
+  std::size_t head_size_;
+  const Buffers& buffers_;
+  uint8_t* tail_;
+  std::size_t tail_size_;
+};
+
+// Process a datagram of |size| bytes that was received into the header's
+// receive_buffer() followed by |buffers| and the header's overflow_buffer():
+// Decode the header and move the payload to the start of |buffers| if the
+// header size was mispredicted. Returns the payload size, or size_t(-1) if
+// the datagram is dropped (|ec| is set to error::invalid_datagram then).
+//
+// The overflow storage covers the largest possible misprediction, so the
+// payload is only cut off if it doesn't fit into |buffers| at all. |ec| is
+// set to asio::error::message_size in that case.
+template <typename Buffers>
+std::size_t finish_udp_receive(udp_header& header, const Buffers& buffers,
+                               std::size_t size,
+                               error_code& ec) ASIOEXT_NOEXCEPT
+{
+  const asio::mutable_buffer head =
+      udp_header_access::receive_buffer(header);
+  const asio::mutable_buffer tail =
+      udp_header_access::overflow_buffer(header);
+  const std::size_t expected = asio::buffer_size(head);
+  uint8_t* data = udp_header_access::data(header);
+
+  const std::size_t header_size =
+      get_udp_header_size(data, (std::min)(size, expected));
+  if (header_size == 0 || header_size > size) {
+    ec = error::invalid_datagram;
+    return static_cast<std::size_t>(-1);
+  }
+
+  const udp_scatter_view<Buffers> view(data, expected, buffers,
+                                       asio::buffer_cast<uint8_t*>(tail),
+                                       asio::buffer_size(tail));
+
+  // The rest of the header is at the start of |buffers|. It can't be copied
+  // behind the expected part right away, since that's where the overflow
+  // storage is.
+  uint8_t rest[udp_header::max_size];
+  if (header_size > expected)
+    view.copy_out(expected, rest, header_size - expected);
+
+  std::size_t payload_size = size - header_size;
+  if (header_size != expected)
+    payload_size = view.move(expected, header_size, payload_size);
+
+  if (header_size > expected)
+    std::memcpy(data + expected, rest, header_size - expected);
+
+  ec = error_code();
+  const std::size_t capacity = asio::buffer_size(buffers);
+  if (payload_size > capacity) {
+    ec = asio::error::message_size;
+    payload_size = capacity;
+  }
+
+  udp_header_access::set_received(header, header_size);
+  return payload_size;
+}
+
+template <typename Handler>
+class socks_udp_send_op
+{
+public:
+  explicit socks_udp_send_op(std::size_t header_size) ASIOEXT_NOEXCEPT
+    : header_size_(header_size)
+  {
+    // ctor
+  }
+
+  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+                  std::size_t size)
+  {
+    handler(ec, size > header_size_ ? size - header_size_ : 0);
+  }
+
+private:
+  std::size_t header_size_;
+};
+
+template <typename DatagramSocket, typename MutableBufferSequence,
+          typename Handler>
+class socks_udp_receive_op
+{
+public:
+  socks_udp_receive_op(Handler& handler, DatagramSocket& socket,
+                       const MutableBufferSequence& buffers,
+                       udp_header& header)
+    : socket_(socket)
+    , buffers_(buffers)
+    , header_(header)
+  {
+    receive(handler);
+  }
+
+  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+                  std::size_t size);
+
+private:
+  void receive(Handler& handler)
+  {
+    // Must be constructed before |*this| is moved from.
+    const prefixed_buffers<asio::mutable_buffer, MutableBufferSequence> bufs(
+        udp_header_access::receive_buffer(header_), buffers_,
+        udp_header_access::overflow_buffer(header_));
+    socket_.async_receive(
+        bufs,
+        asioext::make_composed_operation(
+            ASIOEXT_MOVE_CAST(Handler)(handler),
+            ASIOEXT_MOVE_CAST(socks_udp_receive_op)(*this)));
+  }
+
+  DatagramSocket& socket_;
+  MutableBufferSequence buffers_;
+  udp_header& header_;
+};
+
+template <typename DatagramSocket, typename MutableBufferSequence,
+          typename Handler>
+void socks_udp_receive_op<DatagramSocket, MutableBufferSequence, Handler>::
+    operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+               std::size_t size)
+{
+  if (ec) {
+    handler(ec, 0);
+    return;
+  }
+
+  const std::size_t payload_size =
+      finish_udp_receive(header_, buffers_, size, ec);
+  if (payload_size == static_cast<std::size_t>(-1)) {
+    receive(handler);
+    return;
+  }
+
+  handler(ec, payload_size);
+}
+
+template <typename Socket, typename DynamicBuffer, typename Handler>
+class socks_udp_associate_op : asio::coroutine
+{
+public:
+  socks_udp_associate_op(Handler& handler, Socket& socket,
+                         const asio::ip::udp::endpoint& local,
+                         DynamicBuffer& buffer)
+    : socket_(socket)
+    , buffer_(ASIOEXT_MOVE_CAST(DynamicBuffer)(buffer))
+    , size_(0)
+  {
+    const asio::ip::tcp::endpoint remote(local.address(), local.port());
+    const std::size_t size = get_sexec_packet_size(
+        command::bind_udp, remote, std::string(), 0);
+
+    asio::mutable_buffer buf = buffer_.prepare(size);
+    encode_sexec_packet(command::bind_udp, remote, std::string(), 0,
+                        asio::buffer_cast<uint8_t*>(buf));
+    buffer_.commit(size);
+
+    asio::async_write(
+        socket, buffer_.data(),
+        asioext::make_composed_operation(
+            ASIOEXT_MOVE_CAST(Handler)(handler),
+            ASIOEXT_MOVE_CAST(socks_udp_associate_op)(*this)));
+  }
+
+  void operator()(ASIOEXT_MOVE_ARG(Handler) handler, error_code ec,
+                  std::size_t size = 0);
+
+private:
+  Socket& socket_;
+  DynamicBuffer buffer_;
+  std::size_t size_;
+};
+
+template <typename Socket, typename DynamicBuffer, typename Handler>
+void socks_udp_associate_op<Socket, DynamicBuffer, Handler>::operator()(
+    ASIOEXT_MOVE_ARG(Handler) handler, error_code ec, std::size_t size)
+{
+  if (ec) {
+    handler(ec, asio::ip::udp::endpoint());
+    return;
+  }
+
+  ASIOEXT_CORO_REENTER (this) {
+    buffer_.consume(size);
+    ASIOEXT_CORO_YIELD asio::async_read(
+        socket_, buffer_.prepare(4),
+        asioext::make_composed_operation(
+            ASIOEXT_MOVE_CAST(Handler)(handler),
+            ASIOEXT_MOVE_CAST(socks_udp_associate_op)(*this)));
+
+    buffer_.commit(4);
+
+    {
+      const uint8_t* data =
+          asio::buffer_cast<const uint8_t*>(buffer_.data());
+
+      if (data[0] != 5) {
+        handler(error::invalid_version, asio::ip::udp::endpoint());
+        return;
+      }
+
+      if (data[1] != 0) {
+        handler(make_sexec_error(data[1]), asio::ip::udp::endpoint());
+        return;
+      }
+
+      switch (data[3]) {
+        // IPv4
+        case 1: size_ = 4 + 2; break;
+        // IPv6
+        case 4: size_ = 16 + 2; break;
+        // A hostname makes no sense for the relay.
+        default: {
+          handler(asio::error::address_family_not_supported,
+                  asio::ip::udp::endpoint());
+          return;
+        }
+      }
+    }
+
+    ASIOEXT_CORO_YIELD asio::async_read(
+        socket_, buffer_.prepare(size_),
+        asioext::make_composed_operation(
+            ASIOEXT_MOVE_CAST(Handler)(handler),
+            ASIOEXT_MOVE_CAST(socks_udp_associate_op)(*this)));
+
+    buffer_.commit(size_);
+
+    {
+      const uint8_t* data =
+          asio::buffer_cast<const uint8_t*>(buffer_.data()) + 4;
+
+      asio::ip::address address;
+      if (size_ == 4 + 2) {
+        asio::ip::address_v4::bytes_type bytes;
+        std::memcpy(bytes.data(), data, bytes.size());
+        address = asio::ip::address_v4(bytes);
+      } else {
+        asio::ip::address_v6::bytes_type bytes;
+        std::memcpy(bytes.data(), data, bytes.size());
+        address = asio::ip::address_v6(bytes);
+      }
+
+      const uint16_t port = static_cast<uint16_t>(
+          (data[size_ - 2] << 8) | data[size_ - 1]);
+
+      buffer_.consume(4 + size_);
+
+      // Servers commonly answer with 0.0.0.0, meaning "my address".
+      if (address.is_unspecified()) {
+        const asio::ip::tcp::endpoint server = socket_.remote_endpoint(ec);
+        if (ec) {
+          handler(ec, asio::ip::udp::endpoint());
+          return;
+        }
+        address = server.address();
+      }
+
+      handler(ec, asio::ip::udp::endpoint(address, port));
+    }
+  }
+}
+
+}
+}
+
+ASIOEXT_NS_END
+
+#endif
@@ -57,6 +57,13 @@ enum class error
   ///
   /// The server doesn't understand the @c command we sent.
   command_not_supported,
+
+  /// @brief A UDP relay sent a datagram we can't process.
+  ///
+  /// The datagram was fragmented or its header was invalid.
+  ///
+  /// @see receive_batch
+  invalid_datagram,
 };
 
 /// @brief Get the @c error_category for @c error
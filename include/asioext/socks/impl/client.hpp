@@ -25,9 +25,11 @@ async_greet(Socket& socket,
   > init_t;
 
   init_t init(handler);
-  detail::socks_sgreet_op<Socket, DynamicBuffer,
-      typename init_t::completion_handler_type> op(
-    init.completion_handler, socket, auth_methods, num_auth_methods, buffer);
+  asioext::allocate_composed_operation(
+      ASIOEXT_MOVE_CAST(typename init_t::completion_handler_type)(
+          init.completion_handler),
+      detail::socks_sgreet_op<Socket, DynamicBuffer>(
+          socket, auth_methods, num_auth_methods, buffer))();
 
   return init.result.get();
 }
@@ -43,9 +45,11 @@ async_login(Socket& socket,
   typedef async_completion<LoginHandler, void (error_code)> init_t;
 
   init_t init(handler);
-  detail::socks_slogin_op<Socket, DynamicBuffer,
-      typename init_t::completion_handler_type> op(
-    init.completion_handler, socket, username, password, buffer);
+  asioext::allocate_composed_operation(
+      ASIOEXT_MOVE_CAST(typename init_t::completion_handler_type)(
+          init.completion_handler),
+      detail::socks_slogin_op<Socket, DynamicBuffer>(
+          socket, username, password, buffer))();
 
   return init.result.get();
 }
@@ -60,10 +64,11 @@ async_execute(Socket& socket, command cmd,
   typedef async_completion<ExecuteHandler, void (error_code)> init_t;
 
   init_t init(handler);
-  detail::socks_sexec_op<Socket, DynamicBuffer,
-      typename init_t::completion_handler_type> op(
-    init.completion_handler, socket, cmd, remote, std::string(), 0,
-    buffer);
+  asioext::allocate_composed_operation(
+      ASIOEXT_MOVE_CAST(typename init_t::completion_handler_type)(
+          init.completion_handler),
+      detail::socks_sexec_op<Socket, DynamicBuffer>(
+          socket, cmd, remote, std::string(), 0, buffer))();
 
   return init.result.get();
 }
@@ -78,10 +83,51 @@ async_execute(Socket& socket, command cmd,
   typedef async_completion<ExecuteHandler, void (error_code)> init_t;
 
   init_t init(handler);
-  detail::socks_sexec_op<Socket, DynamicBuffer,
+  asioext::allocate_composed_operation(
+      ASIOEXT_MOVE_CAST(typename init_t::completion_handler_type)(
+          init.completion_handler),
+      detail::socks_sexec_op<Socket, DynamicBuffer>(
+          socket, cmd, asio::ip::tcp::endpoint(), remote, port, buffer))();
+
+  return init.result.get();
+}
+
+template <typename Socket, typename HandshakeHandler>
+ASIOEXT_INITFN_RESULT_TYPE(HandshakeHandler, void(error_code))
+async_handshake(Socket& socket,
+                const std::string& username,
+                const std::string& password,
+                const asio::ip::tcp::endpoint& remote,
+                const asio::mutable_buffer& storage,
+                ASIOEXT_MOVE_ARG(HandshakeHandler) handler)
+{
+  typedef async_completion<HandshakeHandler, void (error_code)> init_t;
+
+  init_t init(handler);
+  detail::socks_handshake_op<Socket,
+      typename init_t::completion_handler_type> op(
+    init.completion_handler, socket, username, password, remote,
+    std::string(), 0, storage);
+
+  return init.result.get();
+}
+
+template <typename Socket, typename HandshakeHandler>
+ASIOEXT_INITFN_RESULT_TYPE(HandshakeHandler, void(error_code))
+async_handshake(Socket& socket,
+                const std::string& username,
+                const std::string& password,
+                const std::string& remote, uint16_t port,
+                const asio::mutable_buffer& storage,
+                ASIOEXT_MOVE_ARG(HandshakeHandler) handler)
+{
+  typedef async_completion<HandshakeHandler, void (error_code)> init_t;
+
+  init_t init(handler);
+  detail::socks_handshake_op<Socket,
       typename init_t::completion_handler_type> op(
-    init.completion_handler, socket, cmd, asio::ip::tcp::endpoint(),
-    remote, port, buffer);
+    init.completion_handler, socket, username, password,
+    asio::ip::tcp::endpoint(), remote, port, storage);
 
   return init.result.get();
 }
@@ -26,6 +26,7 @@ public:
       case error::invalid_auth_version: return "invalid_auth_version";
       case error::login_failed: return "login_failed";
       case error::command_not_supported: return "command_not_supported";
+      case error::invalid_datagram: return "invalid_datagram";
     }
     return "unknown";
   }
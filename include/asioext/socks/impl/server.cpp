@@ -0,0 +1,499 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/socks/server.hpp"
+#include "asioext/connect.hpp"
+#include "asioext/linear_buffer.hpp"
+#include "asioext/resolver_cache.hpp"
+
+#include "asioext/detail/mutex.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/strand.hpp>
+# include <boost/asio/write.hpp>
+#else
+# include <asio/strand.hpp>
+# include <asio/write.hpp>
+#endif
+
+#if defined(__linux__)
+# include <cerrno>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#include <map>
+#include <string>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+namespace detail {
+
+namespace {
+
+// Number of bytes moved by a single splice() or read call.
+const std::size_t relay_chunk_size = 64 * 1024;
+
+// Number of chunks a direction may relay before it yields to other
+// connections.
+const int max_relay_rounds = 16;
+
+}
+
+// server_state has external linkage, so the session types it refers to
+// can't live in the unnamed namespace.
+
+class checker_auth
+{
+public:
+  explicit checker_auth(const server::login_checker& checker)
+    : checker_(checker)
+  {
+    // ctor
+  }
+
+  auth_method method() const ASIOEXT_NOEXCEPT
+  {
+    return checker_ ? auth_method::username_password : auth_method::none;
+  }
+
+  bool check(const std::string& username, const std::string& password) const
+  {
+    return checker_(username, password);
+  }
+
+private:
+  server::login_checker checker_;
+};
+
+class session;
+
+struct server_state : std::enable_shared_from_this<server_state>
+{
+  server_state(asio::io_service& io_service,
+               const asio::ip::tcp::endpoint& endpoint)
+    : io_service(io_service)
+    , acceptor(io_service, endpoint)
+    , resolver(io_service)
+  {
+    // ctor
+  }
+
+  void accept();
+  void close();
+
+  asio::io_service& io_service;
+  asio::ip::tcp::acceptor acceptor;
+  server::login_checker checker;
+
+  // Shared by all sessions, so that clients asking for the same host
+  // don't each cause a lookup.
+  resolver_cache resolver;
+
+  asioext::detail::mutex sessions_mutex;
+  std::map<session*, std::weak_ptr<session> > sessions;
+};
+
+// One direction of a relayed connection.
+struct relay_direction
+{
+  relay_direction() ASIOEXT_NOEXCEPT
+    : from(nullptr)
+    , to(nullptr)
+    , pending(0)
+  {
+    pipe[0] = pipe[1] = -1;
+  }
+
+  asio::ip::tcp::socket* from;
+  asio::ip::tcp::socket* to;
+
+  // splice() has to go through a pipe. |pending| is the number of bytes
+  // in the pipe.
+  int pipe[2];
+  std::size_t pending;
+
+  // Used instead if splice() isn't available.
+  std::vector<char> buffer;
+};
+
+class session : public std::enable_shared_from_this<session>
+{
+public:
+  explicit session(const std::shared_ptr<server_state>& server)
+    : server_(server)
+    , strand_(server->io_service)
+    , client_(server->io_service)
+    , target_(server->io_service)
+    , auth_(server->checker)
+  {
+    directions_[0].from = &client_;
+    directions_[0].to = &target_;
+    directions_[1].from = &target_;
+    directions_[1].to = &client_;
+  }
+
+  ~session()
+  {
+    {
+      asioext::detail::mutex::scoped_lock lock(server_->sessions_mutex);
+      server_->sessions.erase(this);
+    }
+
+#if defined(__linux__)
+    for (int d = 0; d != 2; ++d) {
+      if (directions_[d].pipe[0] != -1) {
+        ::close(directions_[d].pipe[0]);
+        ::close(directions_[d].pipe[1]);
+      }
+    }
+#endif
+  }
+
+  asio::ip::tcp::socket& client() ASIOEXT_NOEXCEPT
+  {
+    return client_;
+  }
+
+  void start();
+  void close();
+
+private:
+  void on_request(const error_code& ec, const request& req);
+  void on_connect(const error_code& ec);
+  void start_relay();
+
+  void relay(int d);
+#if defined(__linux__)
+  bool splice(int d);
+#endif
+  void copy(int d);
+  void fail();
+
+  std::shared_ptr<server_state> server_;
+  asio::io_service::strand strand_;
+  asio::ip::tcp::socket client_;
+  asio::ip::tcp::socket target_;
+  checker_auth auth_;
+  linear_buffer buffer_;
+  relay_direction directions_[2];
+};
+
+void session::start()
+{
+  {
+    asioext::detail::mutex::scoped_lock lock(server_->sessions_mutex);
+    server_->sessions[this] = shared_from_this();
+  }
+
+  const std::shared_ptr<session> self = shared_from_this();
+  async_accept_request(client_, auth_, dynamic_buffer(buffer_),
+                       strand_.wrap([self] (error_code ec, request req) {
+    self->on_request(ec, req);
+  }));
+}
+
+void session::close()
+{
+  const std::shared_ptr<session> self = shared_from_this();
+  strand_.dispatch([self] () {
+    error_code ec;
+    self->client_.close(ec);
+    self->target_.close(ec);
+  });
+}
+
+void session::on_request(const error_code& ec, const request& req)
+{
+  const std::shared_ptr<session> self = shared_from_this();
+
+  if (ec) {
+    // These are still answered, everything else ends the connection.
+    if (ec == asio::error::address_family_not_supported) {
+      async_send_reply(client_, ec, asio::ip::tcp::endpoint(),
+                       dynamic_buffer(buffer_),
+                       strand_.wrap([self] (error_code) {}));
+    }
+    return;
+  }
+
+  if (req.cmd != command::connect) {
+    async_send_reply(client_, error::command_not_supported,
+                     asio::ip::tcp::endpoint(), dynamic_buffer(buffer_),
+                     strand_.wrap([self] (error_code) {}));
+    return;
+  }
+
+  if (req.hostname.empty()) {
+    target_.async_connect(req.endpoint,
+                          strand_.wrap([self] (error_code ec) {
+      self->on_connect(ec);
+    }));
+    return;
+  }
+
+  const asio::ip::tcp::resolver::query q(
+      req.hostname, std::to_string(req.port),
+      asio::ip::tcp::resolver::query::numeric_service);
+  asioext::async_connect(target_, server_->resolver, q, strand_.wrap(
+      [self] (error_code ec, asio::ip::tcp::resolver::iterator) {
+    self->on_connect(ec);
+  }));
+}
+
+void session::on_connect(const error_code& ec)
+{
+  const std::shared_ptr<session> self = shared_from_this();
+
+  error_code ignored_ec;
+  asio::ip::tcp::endpoint bound;
+  if (!ec)
+    bound = target_.local_endpoint(ignored_ec);
+
+  const bool connected = !ec;
+  async_send_reply(client_, ec, bound, dynamic_buffer(buffer_),
+                   strand_.wrap([self, connected] (error_code ec) {
+    if (!ec && connected)
+      self->start_relay();
+  }));
+}
+
+void session::start_relay()
+{
+  const std::shared_ptr<session> self = shared_from_this();
+
+  error_code ec;
+  client_.set_option(asio::ip::tcp::no_delay(true), ec);
+  target_.set_option(asio::ip::tcp::no_delay(true), ec);
+
+#if defined(__linux__)
+  // splice() would block on blocking sockets.
+  client_.native_non_blocking(true, ec);
+  if (!ec)
+    target_.native_non_blocking(true, ec);
+  if (!ec) {
+    for (int d = 0; d != 2; ++d) {
+      if (::pipe2(directions_[d].pipe, O_NONBLOCK | O_CLOEXEC) != 0)
+        directions_[d].pipe[0] = directions_[d].pipe[1] = -1;
+    }
+  }
+#endif
+
+  relay(1);
+
+  // Forward what the client sent along with its request first.
+  if (buffer_.size() == 0) {
+    relay(0);
+    return;
+  }
+
+  asio::async_write(target_, asio::buffer(buffer_.data(), buffer_.size()),
+                    strand_.wrap([self] (error_code ec, std::size_t) {
+    self->buffer_.clear();
+    if (ec) {
+      self->fail();
+      return;
+    }
+    self->relay(0);
+  }));
+}
+
+void session::relay(int d)
+{
+#if defined(__linux__)
+  if (directions_[d].pipe[0] != -1 && splice(d))
+    return;
+#endif
+  copy(d);
+}
+
+#if defined(__linux__)
+bool session::splice(int d)
+{
+  relay_direction& r = directions_[d];
+  const std::shared_ptr<session> self = shared_from_this();
+
+  for (int round = 0; round != max_relay_rounds; ++round) {
+    if (r.pending == 0) {
+      const ssize_t n = ::splice(r.from->native_handle(), nullptr,
+                                 r.pipe[1], nullptr, relay_chunk_size,
+                                 SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          r.from->async_read_some(asio::null_buffers(), strand_.wrap(
+              [self, d] (error_code ec, std::size_t) {
+            if (ec) {
+              self->fail();
+              return;
+            }
+            self->relay(d);
+          }));
+          return true;
+        }
+
+        // Not supported for this kind of socket.
+        if (errno == EINVAL && round == 0) {
+          ::close(r.pipe[0]);
+          ::close(r.pipe[1]);
+          r.pipe[0] = r.pipe[1] = -1;
+          return false;
+        }
+
+        fail();
+        return true;
+      }
+
+      // Orderly shutdown, pass it on.
+      if (n == 0) {
+        error_code ec;
+        r.to->shutdown(asio::ip::tcp::socket::shutdown_send, ec);
+        return true;
+      }
+
+      r.pending = static_cast<std::size_t>(n);
+    }
+
+    const ssize_t n = ::splice(r.pipe[0], nullptr,
+                               r.to->native_handle(), nullptr, r.pending,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        r.to->async_write_some(asio::null_buffers(), strand_.wrap(
+            [self, d] (error_code ec, std::size_t) {
+          if (ec) {
+            self->fail();
+            return;
+          }
+          self->relay(d);
+        }));
+        return true;
+      }
+      fail();
+      return true;
+    }
+
+    r.pending -= static_cast<std::size_t>(n);
+  }
+
+  // Give other connections a chance.
+  strand_.post([self, d] () { self->relay(d); });
+  return true;
+}
+#endif
+
+void session::copy(int d)
+{
+  relay_direction& r = directions_[d];
+  const std::shared_ptr<session> self = shared_from_this();
+
+  if (r.buffer.empty())
+    r.buffer.resize(relay_chunk_size);
+
+  r.from->async_read_some(asio::buffer(r.buffer), strand_.wrap(
+      [self, d] (error_code ec, std::size_t size) {
+    relay_direction& r = self->directions_[d];
+    if (ec == asio::error::eof) {
+      r.to->shutdown(asio::ip::tcp::socket::shutdown_send, ec);
+      return;
+    }
+    if (ec) {
+      self->fail();
+      return;
+    }
+
+    asio::async_write(*r.to, asio::buffer(r.buffer, size), self->strand_.wrap(
+        [self, d] (error_code ec, std::size_t) {
+      if (ec) {
+        self->fail();
+        return;
+      }
+      self->copy(d);
+    }));
+  }));
+}
+
+void session::fail()
+{
+  // Aborts the other direction as well.
+  error_code ec;
+  client_.close(ec);
+  target_.close(ec);
+}
+
+void server_state::accept()
+{
+  const std::shared_ptr<server_state> self = shared_from_this();
+  const std::shared_ptr<session> s = std::make_shared<session>(self);
+  acceptor.async_accept(s->client(), [self, s] (error_code ec) {
+    if (!self->acceptor.is_open())
+      return;
+    if (!ec)
+      s->start();
+    self->accept();
+  });
+}
+
+void server_state::close()
+{
+  error_code ec;
+  acceptor.close(ec);
+
+  std::vector<std::shared_ptr<session> > active;
+  {
+    asioext::detail::mutex::scoped_lock lock(sessions_mutex);
+    for (std::map<session*, std::weak_ptr<session> >::iterator
+         it = sessions.begin(), end = sessions.end(); it != end; ++it) {
+      if (std::shared_ptr<session> s = it->second.lock())
+        active.push_back(s);
+    }
+  }
+
+  for (std::size_t i = 0, n = active.size(); i != n; ++i)
+    active[i]->close();
+}
+
+}
+
+server::server(asio::io_service& io_service,
+               const asio::ip::tcp::endpoint& endpoint)
+  : state_(std::make_shared<detail::server_state>(io_service, endpoint))
+{
+  // ctor
+}
+
+server::~server()
+{
+  stop();
+}
+
+void server::set_login_checker(const login_checker& checker)
+{
+  state_->checker = checker;
+}
+
+asio::ip::tcp::endpoint server::local_endpoint() const
+{
+  return state_->acceptor.local_endpoint();
+}
+
+void server::start()
+{
+  state_->accept();
+}
+
+void server::stop()
+{
+  state_->close();
+}
+
+}
+
+ASIOEXT_NS_END
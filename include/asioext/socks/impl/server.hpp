@@ -0,0 +1,57 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SOCKS_IMPL_SERVER_HPP
+#define ASIOEXT_SOCKS_IMPL_SERVER_HPP
+
+#include "asioext/socks/detail/server.hpp"
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+
+template <typename Socket, typename Authenticator, typename DynamicBuffer,
+          typename AcceptHandler>
+ASIOEXT_INITFN_RESULT_TYPE(AcceptHandler, void(error_code, request))
+async_accept_request(Socket& socket,
+                     const Authenticator& auth,
+                     ASIOEXT_MOVE_ARG(DynamicBuffer) buffer,
+                     ASIOEXT_MOVE_ARG(AcceptHandler) handler)
+{
+  typedef async_completion<
+    AcceptHandler, void (error_code, request)
+  > init_t;
+
+  init_t init(handler);
+  detail::socks_accept_request_op<Socket, Authenticator, DynamicBuffer,
+      typename init_t::completion_handler_type> op(
+    init.completion_handler, socket, auth, buffer);
+
+  return init.result.get();
+}
+
+template <typename Socket, typename DynamicBuffer, typename ReplyHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReplyHandler, void(error_code))
+async_send_reply(Socket& socket,
+                 const error_code& result,
+                 const asio::ip::tcp::endpoint& bound,
+                 ASIOEXT_MOVE_ARG(DynamicBuffer) buffer,
+                 ASIOEXT_MOVE_ARG(ReplyHandler) handler)
+{
+  typedef async_completion<ReplyHandler, void (error_code)> init_t;
+
+  init_t init(handler);
+  detail::socks_reply_op<Socket, DynamicBuffer,
+      typename init_t::completion_handler_type> op(
+    init.completion_handler, socket, result, bound, buffer);
+
+  return init.result.get();
+}
+
+}
+
+ASIOEXT_NS_END
+
+#endif
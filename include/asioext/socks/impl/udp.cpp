@@ -0,0 +1,362 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "asioext/socks/udp.hpp"
+
+#include "asioext/detail/throw_exception.hpp"
+
+#if defined(__linux__)
+# include <cerrno>
+# include <poll.h>
+# include <sys/socket.h>
+# include <sys/uio.h>
+#endif
+
+#include <cstring>
+#include <stdexcept>
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+
+namespace {
+
+// Header size of an IPv4 address, by far the most common case.
+const std::size_t default_header_size = 4 + 4 + 2;
+
+}
+
+const std::size_t udp_header::max_size;
+
+udp_header::udp_header() ASIOEXT_NOEXCEPT
+  : size_(0)
+  , expected_size_(default_header_size)
+{
+  // ctor
+}
+
+udp_header::udp_header(const asio::ip::udp::endpoint& destination)
+    ASIOEXT_NOEXCEPT
+  : size_(0)
+  , expected_size_(default_header_size)
+{
+  assign(destination);
+}
+
+udp_header::udp_header(const std::string& host, uint16_t port)
+  : size_(0)
+  , expected_size_(default_header_size)
+{
+  error_code ec;
+  assign(host, port, ec);
+  if (ec) {
+    std::length_error ex("udp_header: hostname too long");
+    asioext::detail::throw_exception(ex);
+  }
+}
+
+void udp_header::assign(const asio::ip::udp::endpoint& destination)
+    ASIOEXT_NOEXCEPT
+{
+  uint8_t* buf = data_;
+  *buf++ = 0;
+  *buf++ = 0;
+  *buf++ = 0;
+
+  const asio::ip::address address = destination.address();
+  if (address.is_v4()) {
+    *buf++ = 1;
+    const asio::ip::address_v4::bytes_type addr = address.to_v4().to_bytes();
+    std::memcpy(buf, addr.data(), addr.size());
+    buf += addr.size();
+  } else {
+    *buf++ = 4;
+    const asio::ip::address_v6::bytes_type addr = address.to_v6().to_bytes();
+    std::memcpy(buf, addr.data(), addr.size());
+    buf += addr.size();
+  }
+
+  const uint16_t port = destination.port();
+  *buf++ = static_cast<uint8_t>((port >> 8) & 0xff);
+  *buf++ = static_cast<uint8_t>((port >> 0) & 0xff);
+  size_ = buf - data_;
+}
+
+void udp_header::assign(const std::string& host, uint16_t port,
+                        error_code& ec) ASIOEXT_NOEXCEPT
+{
+  if (host.size() > 255) {
+    ec = asio::error::invalid_argument;
+    return;
+  }
+
+  uint8_t* buf = data_;
+  *buf++ = 0;
+  *buf++ = 0;
+  *buf++ = 0;
+  *buf++ = 3;
+  *buf++ = static_cast<uint8_t>(host.size());
+  std::memcpy(buf, host.data(), host.size());
+  buf += host.size();
+  *buf++ = static_cast<uint8_t>((port >> 8) & 0xff);
+  *buf++ = static_cast<uint8_t>((port >> 0) & 0xff);
+  size_ = buf - data_;
+  ec = error_code();
+}
+
+bool udp_header::is_hostname() const ASIOEXT_NOEXCEPT
+{
+  return size_ != 0 && data_[3] == 3;
+}
+
+asio::ip::udp::endpoint udp_header::endpoint() const ASIOEXT_NOEXCEPT
+{
+  if (size_ == 4 + 4 + 2 && data_[3] == 1) {
+    asio::ip::address_v4::bytes_type addr;
+    std::memcpy(addr.data(), data_ + 4, addr.size());
+    return asio::ip::udp::endpoint(asio::ip::address_v4(addr), port());
+  }
+  if (size_ == 4 + 16 + 2 && data_[3] == 4) {
+    asio::ip::address_v6::bytes_type addr;
+    std::memcpy(addr.data(), data_ + 4, addr.size());
+    return asio::ip::udp::endpoint(asio::ip::address_v6(addr), port());
+  }
+  return asio::ip::udp::endpoint();
+}
+
+std::string udp_header::hostname() const
+{
+  if (!is_hostname())
+    return std::string();
+  return std::string(reinterpret_cast<const char*>(data_ + 5), data_[4]);
+}
+
+uint16_t udp_header::port() const ASIOEXT_NOEXCEPT
+{
+  if (size_ == 0)
+    return 0;
+  return static_cast<uint16_t>((data_[size_ - 2] << 8) | data_[size_ - 1]);
+}
+
+namespace detail {
+
+std::size_t get_udp_header_size(const uint8_t* data, std::size_t size)
+{
+  // Fragmented datagrams are not supported and have to be dropped.
+  if (size < 5 || data[2] != 0)
+    return 0;
+
+  switch (data[3]) {
+    // IPv4
+    case 1: return 4 + 4 + 2;
+    // Hostname
+    case 3: return 4 + 1 + data[4] + 2;
+    // IPv6
+    case 4: return 4 + 16 + 2;
+  }
+  return 0;
+}
+
+#if defined(__linux__)
+namespace {
+
+// Number of datagrams passed to a single sendmmsg()/recvmmsg() call.
+const std::size_t max_batch_size = 64;
+
+void set_error(error_code& ec, int e) ASIOEXT_NOEXCEPT
+{
+  ec = error_code(e, asio::error::get_system_category());
+}
+
+// Asio may have put the descriptor into non-blocking mode on its own,
+// so a blocking socket has to wait for readiness itself.
+bool wait_for(asio::ip::udp::socket& socket, short events,
+              error_code& ec) ASIOEXT_NOEXCEPT
+{
+  if (socket.non_blocking()) {
+    ec = asio::error::would_block;
+    return false;
+  }
+
+  pollfd fd;
+  fd.fd = socket.native_handle();
+  fd.events = events;
+  fd.revents = 0;
+  if (::poll(&fd, 1, -1) < 0 && errno != EINTR) {
+    set_error(ec, errno);
+    return false;
+  }
+  return true;
+}
+
+}
+#endif
+
+}
+
+std::size_t send_batch(asio::ip::udp::socket& socket,
+                       udp_message* messages,
+                       std::size_t count,
+                       error_code& ec)
+{
+  std::size_t sent = 0;
+  ec = error_code();
+
+#if defined(__linux__)
+  while (sent != count) {
+    mmsghdr msgs[detail::max_batch_size];
+    iovec iovs[detail::max_batch_size][2];
+
+    const std::size_t n = (std::min)(count - sent, detail::max_batch_size);
+    for (std::size_t i = 0; i != n; ++i) {
+      udp_message& m = messages[sent + i];
+      iovs[i][0].iov_base = const_cast<void*>(
+          asio::buffer_cast<const void*>(m.header.buffer()));
+      iovs[i][0].iov_len = m.header.size();
+      iovs[i][1].iov_base = asio::buffer_cast<void*>(m.payload);
+      iovs[i][1].iov_len = asio::buffer_size(m.payload);
+
+      std::memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_iov = iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+
+    const int r = ::sendmmsg(socket.native_handle(), msgs,
+                             static_cast<unsigned int>(n), 0);
+    if (r < 0) {
+      const int e = errno;
+      if (e == EINTR)
+        continue;
+      if ((e == EAGAIN || e == EWOULDBLOCK) && sent == 0 &&
+          detail::wait_for(socket, POLLOUT, ec))
+        continue;
+      if (sent == 0 && !ec)
+        detail::set_error(ec, e);
+      break;
+    }
+
+    for (int i = 0; i != r; ++i) {
+      udp_message& m = messages[sent + i];
+      const std::size_t header_size = m.header.size();
+      m.size = msgs[i].msg_len > header_size
+          ? msgs[i].msg_len - header_size : 0;
+      m.error = error_code();
+    }
+
+    sent += static_cast<std::size_t>(r);
+    if (static_cast<std::size_t>(r) != n)
+      break;
+  }
+#else
+  for (; sent != count; ++sent) {
+    udp_message& m = messages[sent];
+    const std::size_t size = socket.send(
+        detail::prefixed_buffers<asio::const_buffer, asio::const_buffers_1>(
+            m.header.buffer(), asio::const_buffers_1(m.payload)),
+        0, ec);
+    if (ec)
+      break;
+    m.size = size > m.header.size() ? size - m.header.size() : 0;
+    m.error = error_code();
+  }
+#endif
+
+  if (sent != 0)
+    ec = error_code();
+  return sent;
+}
+
+std::size_t receive_batch(asio::ip::udp::socket& socket,
+                          udp_message* messages,
+                          std::size_t count,
+                          error_code& ec)
+{
+  std::size_t received = 0;
+  ec = error_code();
+
+#if defined(__linux__)
+  while (received != count) {
+    mmsghdr msgs[detail::max_batch_size];
+    iovec iovs[detail::max_batch_size][3];
+
+    const std::size_t n = (std::min)(count - received,
+                                     detail::max_batch_size);
+    for (std::size_t i = 0; i != n; ++i) {
+      udp_message& m = messages[received + i];
+      const asio::mutable_buffer head =
+          detail::udp_header_access::receive_buffer(m.header);
+      const asio::mutable_buffer tail =
+          detail::udp_header_access::overflow_buffer(m.header);
+      iovs[i][0].iov_base = asio::buffer_cast<void*>(head);
+      iovs[i][0].iov_len = asio::buffer_size(head);
+      iovs[i][1].iov_base = asio::buffer_cast<void*>(m.payload);
+      iovs[i][1].iov_len = asio::buffer_size(m.payload);
+      iovs[i][2].iov_base = asio::buffer_cast<void*>(tail);
+      iovs[i][2].iov_len = asio::buffer_size(tail);
+
+      std::memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_iov = iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 3;
+    }
+
+    // Only the first datagram is waited for.
+    const int flags = received == 0 ? MSG_WAITFORONE : MSG_DONTWAIT;
+    const int r = ::recvmmsg(socket.native_handle(), msgs,
+                             static_cast<unsigned int>(n), flags, nullptr);
+    if (r < 0) {
+      const int e = errno;
+      if (e == EINTR)
+        continue;
+      if ((e == EAGAIN || e == EWOULDBLOCK) && received == 0 &&
+          detail::wait_for(socket, POLLIN, ec))
+        continue;
+      if (received == 0 && !ec)
+        detail::set_error(ec, e);
+      break;
+    }
+
+    for (int i = 0; i != r; ++i) {
+      udp_message& m = messages[received + i];
+      const std::size_t size = detail::finish_udp_receive(
+          m.header, asio::mutable_buffers_1(m.payload), msgs[i].msg_len,
+          m.error);
+      m.size = size != static_cast<std::size_t>(-1) ? size : 0;
+    }
+
+    received += static_cast<std::size_t>(r);
+    if (static_cast<std::size_t>(r) != n)
+      break;
+  }
+#else
+  for (; received != count; ++received) {
+    // Don't block once we have something.
+    if (received != 0 && socket.available(ec) == 0)
+      break;
+
+    udp_message& m = messages[received];
+    const asio::mutable_buffers_1 payload(m.payload);
+    const std::size_t size = socket.receive(
+        detail::prefixed_buffers<asio::mutable_buffer,
+                                 asio::mutable_buffers_1>(
+            detail::udp_header_access::receive_buffer(m.header), payload,
+            detail::udp_header_access::overflow_buffer(m.header)),
+        0, ec);
+    if (ec)
+      break;
+
+    const std::size_t payload_size =
+        detail::finish_udp_receive(m.header, payload, size, m.error);
+    m.size = payload_size != static_cast<std::size_t>(-1) ? payload_size : 0;
+  }
+#endif
+
+  if (received != 0)
+    ec = error_code();
+  return received;
+}
+
+}
+
+ASIOEXT_NS_END
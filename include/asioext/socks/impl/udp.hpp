@@ -0,0 +1,84 @@
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SOCKS_IMPL_UDP_HPP
+#define ASIOEXT_SOCKS_IMPL_UDP_HPP
+
+#include "asioext/socks/detail/udp.hpp"
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+
+template <typename Socket, typename DynamicBuffer, typename AssociateHandler>
+ASIOEXT_INITFN_RESULT_TYPE(AssociateHandler,
+                           void(error_code, asio::ip::udp::endpoint))
+async_udp_associate(Socket& socket,
+                    const asio::ip::udp::endpoint& local,
+                    ASIOEXT_MOVE_ARG(DynamicBuffer) buffer,
+                    ASIOEXT_MOVE_ARG(AssociateHandler) handler)
+{
+  typedef async_completion<
+    AssociateHandler, void (error_code, asio::ip::udp::endpoint)
+  > init_t;
+
+  init_t init(handler);
+  detail::socks_udp_associate_op<Socket, DynamicBuffer,
+      typename init_t::completion_handler_type> op(
+    init.completion_handler, socket, local, buffer);
+
+  return init.result.get();
+}
+
+template <typename DatagramSocket, typename ConstBufferSequence,
+          typename WriteHandler>
+ASIOEXT_INITFN_RESULT_TYPE(WriteHandler, void(error_code, std::size_t))
+async_send_to(DatagramSocket& socket,
+              const ConstBufferSequence& buffers,
+              const udp_header& destination,
+              ASIOEXT_MOVE_ARG(WriteHandler) handler)
+{
+  typedef async_completion<
+    WriteHandler, void (error_code, std::size_t)
+  > init_t;
+
+  typedef typename init_t::completion_handler_type handler_type;
+
+  init_t init(handler);
+  socket.async_send(
+      detail::prefixed_buffers<asio::const_buffer, ConstBufferSequence>(
+          destination.buffer(), buffers),
+      asioext::make_composed_operation(
+          ASIOEXT_MOVE_CAST(handler_type)(init.completion_handler),
+          detail::socks_udp_send_op<handler_type>(destination.size())));
+
+  return init.result.get();
+}
+
+template <typename DatagramSocket, typename MutableBufferSequence,
+          typename ReadHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+async_receive_from(DatagramSocket& socket,
+                   const MutableBufferSequence& buffers,
+                   udp_header& source,
+                   ASIOEXT_MOVE_ARG(ReadHandler) handler)
+{
+  typedef async_completion<
+    ReadHandler, void (error_code, std::size_t)
+  > init_t;
+
+  init_t init(handler);
+  detail::socks_udp_receive_op<DatagramSocket, MutableBufferSequence,
+      typename init_t::completion_handler_type> op(
+    init.completion_handler, socket, buffers, source);
+
+  return init.result.get();
+}
+
+}
+
+ASIOEXT_NS_END
+
+#endif
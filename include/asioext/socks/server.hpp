@@ -0,0 +1,255 @@
+/// @file
+/// SOCKS server functionality.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SOCKS_SERVER_HPP
+#define ASIOEXT_SOCKS_SERVER_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/socks/constants.hpp"
+#include "asioext/async_result.hpp"
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/move_support.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/ip/tcp.hpp>
+#else
+# include <asio/io_service.hpp>
+# include <asio/ip/tcp.hpp>
+#endif
+
+#include <functional>
+#include <memory>
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+
+namespace detail {
+struct server_state;
+}
+
+/// @ingroup net_socks
+/// @{
+
+/// @brief A command request received by a SOCKS 5 server.
+struct request
+{
+  /// The command the client asks the server to execute.
+  command cmd;
+
+  /// The remote endpoint. Only valid if @c hostname is empty.
+  asio::ip::tcp::endpoint endpoint;
+
+  /// The remote host, if the client sent a hostname instead of an address.
+  std::string hostname;
+
+  /// The remote port.
+  uint16_t port;
+};
+
+/// @brief Authenticator that accepts anonymous clients.
+///
+/// Authenticators are used by async_accept_request() to pick the
+/// authentication method and check the client's credentials.
+/// Their requirements are:
+/// @code
+/// // The method clients have to support.
+/// auth_method method() const;
+///
+/// // Check a username/password pair. Only called for
+/// // auth_method::username_password.
+/// bool check(const std::string& username,
+///            const std::string& password) const;
+/// @endcode
+class no_auth
+{
+public:
+  auth_method method() const ASIOEXT_NOEXCEPT
+  {
+    return auth_method::none;
+  }
+
+  bool check(const std::string& /*username*/,
+             const std::string& /*password*/) const ASIOEXT_NOEXCEPT
+  {
+    return true;
+  }
+};
+
+/// @brief Authenticator that requires a username and password.
+///
+/// The credentials are checked by a user-supplied predicate with the
+/// signature <tt>bool(const std::string& username,
+/// const std::string& password)</tt>.
+template <typename Predicate>
+class password_auth
+{
+public:
+  explicit password_auth(const Predicate& predicate)
+    : predicate_(predicate)
+  {
+    // ctor
+  }
+
+  auth_method method() const ASIOEXT_NOEXCEPT
+  {
+    return auth_method::username_password;
+  }
+
+  bool check(const std::string& username,
+             const std::string& password) const
+  {
+    return predicate_(username, password);
+  }
+
+private:
+  Predicate predicate_;
+};
+
+/// @brief Asynchronously accept a SOCKS 5 client's request.
+///
+/// This function performs the server side of the SOCKS 5 greeting, the
+/// login (if required by @c auth) and reads the client's command request.
+/// The caller is expected to execute the request and then answer it with
+/// async_send_reply().
+///
+/// Clients may pipeline their requests. Bytes the client sent after the
+/// command request are left in @c buffer, they belong to the proxied
+/// connection.
+///
+/// @param socket The connected socket to the SOCKS 5 client.
+/// @param auth The authenticator to use (e.g. no_auth). Must remain valid
+/// until the handler is called.
+/// @param buffer A DynamicBuffer that is used to buffer sent/received messages.
+/// @param handler The handler to be called when the accept operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation.
+///   const error_code& error,
+///
+///   // The client's request.
+///   const request& req
+/// );
+/// @endcode
+/// Requests with unknown address types fail with
+/// @c asio::error::address_family_not_supported. They (as well as
+/// unsupported commands) should still be answered with async_send_reply().
+template <typename Socket, typename Authenticator, typename DynamicBuffer,
+          typename AcceptHandler>
+ASIOEXT_INITFN_RESULT_TYPE(AcceptHandler, void(error_code, request))
+async_accept_request(Socket& socket,
+                     const Authenticator& auth,
+                     ASIOEXT_MOVE_ARG(DynamicBuffer) buffer,
+                     ASIOEXT_MOVE_ARG(AcceptHandler) handler);
+
+/// @brief Asynchronously answer a SOCKS 5 command request.
+///
+/// @param socket The connected socket to the SOCKS 5 client.
+/// @param result The result of the command. This is mapped to the
+/// corresponding SOCKS 5 reply code, the client's async_execute()
+/// reports it as its error.
+/// @param bound The address the server bound to execute the command.
+/// @param buffer A DynamicBuffer that is used to buffer sent/received messages.
+/// Its contents are left untouched.
+/// @param handler The handler to be called when the reply operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation.
+///   const error_code& error
+/// );
+/// @endcode
+template <typename Socket, typename DynamicBuffer, typename ReplyHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReplyHandler, void(error_code))
+async_send_reply(Socket& socket,
+                 const error_code& result,
+                 const asio::ip::tcp::endpoint& bound,
+                 ASIOEXT_MOVE_ARG(DynamicBuffer) buffer,
+                 ASIOEXT_MOVE_ARG(ReplyHandler) handler);
+
+/// @brief A SOCKS 5 proxy server.
+///
+/// This class accepts SOCKS 5 clients and executes their @c connect
+/// requests. Data is relayed between the client and the remote end until
+/// both directions have been shut down.
+///
+/// On Linux data is moved between the sockets with @c splice(), so
+/// it never gets copied to user space. Elsewhere a buffer per
+/// direction is used.
+///
+/// The server uses the io_service it was constructed with. It is meant for
+/// local proxying and testing and makes no attempt at limiting resource
+/// usage.
+///
+/// @par Thread Safety
+/// @e Distinct @e objects: Safe.@n
+/// @e Shared @e objects: Unsafe.
+class server
+{
+public:
+  /// The login predicate's type.
+  typedef std::function<
+    bool (const std::string& username, const std::string& password)
+  > login_checker;
+
+  /// @brief Create a server listening on the given endpoint.
+  ///
+  /// Clients are not accepted until start() is called.
+  ///
+  /// @throws asio::system_error Thrown on failure.
+  ASIOEXT_DECL server(asio::io_service& io_service,
+                      const asio::ip::tcp::endpoint& endpoint);
+
+  /// @brief Stop the server.
+  ///
+  /// Closes the listening socket and all connections.
+  ASIOEXT_DECL ~server();
+
+  /// @brief Require clients to log in.
+  ///
+  /// By default clients are accepted anonymously. Once a login checker is
+  /// set, clients have to authenticate with a username and password that
+  /// is accepted by @c checker.
+  /// Only affects clients accepted afterwards.
+  ASIOEXT_DECL void set_login_checker(const login_checker& checker);
+
+  /// @brief Get the endpoint the server is listening on.
+  ASIOEXT_DECL asio::ip::tcp::endpoint local_endpoint() const;
+
+  /// @brief Start accepting clients.
+  ASIOEXT_DECL void start();
+
+  /// @brief Stop accepting clients and close all connections.
+  ASIOEXT_DECL void stop();
+
+private:
+  std::shared_ptr<detail::server_state> state_;
+};
+
+/// @}
+
+}
+
+ASIOEXT_NS_END
+
+#include "asioext/socks/impl/server.hpp"
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/socks/impl/server.cpp"
+#endif
+
+#endif
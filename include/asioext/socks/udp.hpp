@@ -0,0 +1,318 @@
+/// @file
+/// SOCKS 5 UDP relay support.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_SOCKS_UDP_HPP
+#define ASIOEXT_SOCKS_UDP_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/socks/constants.hpp"
+#include "asioext/async_result.hpp"
+#include "asioext/error_code.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/ip/tcp.hpp>
+# include <boost/asio/ip/udp.hpp>
+#else
+# include <asio/ip/tcp.hpp>
+# include <asio/ip/udp.hpp>
+#endif
+
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+namespace socks {
+
+namespace detail {
+struct udp_header_access;
+}
+
+/// @ingroup net_socks
+/// @{
+
+/// @brief The header of a datagram relayed by a SOCKS 5 server.
+///
+/// Every datagram exchanged with a SOCKS 5 UDP relay is prefixed with a
+/// header containing the destination (when sending) or the source
+/// (when receiving) of the datagram. This class holds such a header.
+///
+/// The header is kept separate from the payload, so that it can be sent and
+/// received with scatter/gather I/O instead of copying the payload.
+/// A udp_header object must remain valid until the operation using it
+/// has completed.
+///
+/// @see async_send_to
+/// @see async_receive_from
+class udp_header
+{
+  friend struct detail::udp_header_access;
+
+public:
+  /// Maximum size of an encoded header (hostname of 255 bytes).
+  static const std::size_t max_size = 4 + 1 + 255 + 2;
+
+  /// @brief Construct an empty header.
+  ///
+  /// Empty headers are used to receive datagrams.
+  ASIOEXT_DECL udp_header() ASIOEXT_NOEXCEPT;
+
+  /// @brief Construct a header for the given destination endpoint.
+  ASIOEXT_DECL explicit udp_header(
+      const asio::ip::udp::endpoint& destination) ASIOEXT_NOEXCEPT;
+
+  /// @brief Construct a header for the given destination host.
+  ///
+  /// The hostname is resolved by the SOCKS server.
+  ///
+  /// @throws std::length_error Thrown if @c host is longer than 255 bytes.
+  ASIOEXT_DECL udp_header(const std::string& host, uint16_t port);
+
+  /// @brief Set the destination endpoint.
+  ASIOEXT_DECL void assign(
+      const asio::ip::udp::endpoint& destination) ASIOEXT_NOEXCEPT;
+
+  /// @brief Set the destination host.
+  ///
+  /// @param host The hostname, which is resolved by the SOCKS server.
+  /// @param port The destination port.
+  /// @param ec Set to @c asio::error::invalid_argument if @c host is longer
+  /// than 255 bytes.
+  ASIOEXT_DECL void assign(const std::string& host, uint16_t port,
+                           error_code& ec) ASIOEXT_NOEXCEPT;
+
+  /// @brief Get the size of the encoded header.
+  std::size_t size() const ASIOEXT_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// @brief Get a buffer that represents the encoded header.
+  asio::const_buffer buffer() const ASIOEXT_NOEXCEPT
+  {
+    return asio::const_buffer(data_, size_);
+  }
+
+  /// @brief Check whether the address is a hostname.
+  ASIOEXT_DECL bool is_hostname() const ASIOEXT_NOEXCEPT;
+
+  /// @brief Get the address as endpoint.
+  ///
+  /// @returns The endpoint, or a default-constructed endpoint if the
+  /// header is empty or contains a hostname.
+  ASIOEXT_DECL asio::ip::udp::endpoint endpoint() const ASIOEXT_NOEXCEPT;
+
+  /// @brief Get the hostname.
+  ///
+  /// @returns The hostname, or an empty string if the header doesn't
+  /// contain one.
+  ASIOEXT_DECL std::string hostname() const;
+
+  /// @brief Get the port.
+  ASIOEXT_DECL uint16_t port() const ASIOEXT_NOEXCEPT;
+
+private:
+  uint8_t data_[max_size];
+  std::size_t size_;
+
+  // Number of bytes to receive into |data_| in front of the payload. This
+  // is the size of the last received header, so that steady traffic from
+  // one address family lands directly in the payload buffers. The rest of
+  // |data_| is received behind the payload.
+  std::size_t expected_size_;
+};
+
+/// @brief A datagram for send_batch() and receive_batch().
+struct udp_message
+{
+  /// Destination (send) or source (receive) of the datagram.
+  udp_header header;
+
+  /// The payload (send) or storage for it (receive).
+  asio::mutable_buffer payload;
+
+  /// Number of payload bytes transferred.
+  std::size_t size;
+
+  /// Result for this datagram. See receive_batch() for the errors that
+  /// only affect single datagrams.
+  error_code error;
+};
+
+/// @brief Asynchronously ask a SOCKS 5 server to relay UDP datagrams.
+///
+/// This function sends a @c command::bind_udp (UDP ASSOCIATE) request and
+/// reports the endpoint of the server's UDP relay. Datagrams sent to this
+/// relay (using async_send_to() or send_batch()) are forwarded to their
+/// destination, replies are sent back to the client.
+///
+/// The association ends when @c socket is closed, so it needs to remain
+/// open while the relay is used.
+///
+/// @param socket The connected socket. The remote endpoint
+/// needs to be a successfully greeted SOCKS 5 proxy.
+/// @param local The endpoint the client will send datagrams from. May be
+/// unspecified (e.g. <tt>0.0.0.0:0</tt>) if unknown, though servers may
+/// reject this.
+/// @param buffer A DynamicBuffer that is used to buffer sent/received messages.
+/// @param handler The handler to be called when the operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation.
+///   const error_code& error,
+///
+///   // The relay endpoint. If the server reported an unspecified
+///   // address, the address of the SOCKS server is used.
+///   asio::ip::udp::endpoint relay
+/// );
+/// @endcode
+template <typename Socket, typename DynamicBuffer, typename AssociateHandler>
+ASIOEXT_INITFN_RESULT_TYPE(AssociateHandler,
+                           void(error_code, asio::ip::udp::endpoint))
+async_udp_associate(Socket& socket,
+                    const asio::ip::udp::endpoint& local,
+                    ASIOEXT_MOVE_ARG(DynamicBuffer) buffer,
+                    ASIOEXT_MOVE_ARG(AssociateHandler) handler);
+
+/// @brief Asynchronously send a datagram through a SOCKS 5 UDP relay.
+///
+/// The header and the payload are sent with a single gather write; the
+/// payload is not copied.
+///
+/// @param socket The datagram socket, connected to the relay endpoint
+/// reported by async_udp_associate().
+/// @param buffers The payload.
+/// @param destination The header containing the destination. Must remain
+/// valid until the handler is called.
+/// @param handler The handler to be called when the send operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation.
+///   const error_code& error,
+///
+///   // Number of payload bytes sent.
+///   std::size_t bytes_transferred
+/// );
+/// @endcode
+template <typename DatagramSocket, typename ConstBufferSequence,
+          typename WriteHandler>
+ASIOEXT_INITFN_RESULT_TYPE(WriteHandler, void(error_code, std::size_t))
+async_send_to(DatagramSocket& socket,
+              const ConstBufferSequence& buffers,
+              const udp_header& destination,
+              ASIOEXT_MOVE_ARG(WriteHandler) handler);
+
+/// @brief Asynchronously receive a datagram through a SOCKS 5 UDP relay.
+///
+/// The header and the payload are received with a single scatter read. As
+/// long as consecutive datagrams have headers of the same size (i.e. come
+/// from the same address family), the payload is received directly into
+/// @c buffers. Otherwise it is moved into place afterwards. The unused part
+/// of @c source is received behind @c buffers, so a payload that fits into
+/// @c buffers is never cut off, whatever the size of the header.
+///
+/// Fragmented datagrams (which are optional in SOCKS 5) and invalid
+/// datagrams are dropped.
+///
+/// If the payload doesn't fit into @c buffers, it is truncated and the
+/// operation fails with @c asio::error::message_size.
+///
+/// @param socket The datagram socket, connected to the relay endpoint
+/// reported by async_udp_associate().
+/// @param buffers Storage for the payload.
+/// @param source Receives the header containing the source. Must remain
+/// valid until the handler is called.
+/// @param handler The handler to be called when the receive operation
+/// completes. The function signature of the handler must be:
+/// @code
+/// void handler(
+///   // Result of operation.
+///   const error_code& error,
+///
+///   // Number of payload bytes received.
+///   std::size_t bytes_transferred
+/// );
+/// @endcode
+template <typename DatagramSocket, typename MutableBufferSequence,
+          typename ReadHandler>
+ASIOEXT_INITFN_RESULT_TYPE(ReadHandler, void(error_code, std::size_t))
+async_receive_from(DatagramSocket& socket,
+                   const MutableBufferSequence& buffers,
+                   udp_header& source,
+                   ASIOEXT_MOVE_ARG(ReadHandler) handler);
+
+/// @brief Send multiple datagrams through a SOCKS 5 UDP relay.
+///
+/// On Linux all datagrams are passed to the kernel with as few
+/// @c sendmmsg() calls as possible. Elsewhere they are sent one by one.
+///
+/// @param socket The datagram socket, connected to the relay endpoint
+/// reported by async_udp_associate().
+/// @param messages The datagrams. The @c size member of each sent message is
+/// set to the number of payload bytes sent.
+/// @param count Number of datagrams.
+/// @param ec Set to indicate what error occurred, if any. Errors after the
+/// first datagram are not reported, they will resurface on the next call.
+///
+/// @returns The number of datagrams sent.
+ASIOEXT_DECL std::size_t send_batch(asio::ip::udp::socket& socket,
+                                    udp_message* messages,
+                                    std::size_t count,
+                                    error_code& ec);
+
+/// @brief Receive multiple datagrams through a SOCKS 5 UDP relay.
+///
+/// Blocks (unless the socket is non-blocking) until at least one datagram
+/// is available and then receives as many of the available datagrams as fit
+/// into @c messages. On Linux this uses @c recvmmsg(), elsewhere datagrams
+/// are received one by one.
+///
+/// Each message's @c error member reports problems with that particular
+/// datagram:
+///
+/// @li @c error::invalid_datagram: The datagram was fragmented or its header
+/// was invalid. Its @c size is set to 0.
+/// @li @c asio::error::message_size: The payload didn't fit into the
+/// message's @c payload and was truncated.
+///
+/// @param socket The datagram socket, connected to the relay endpoint
+/// reported by async_udp_associate().
+/// @param messages Storage for the datagrams. The @c header member receives
+/// the source, @c payload the data, @c size is set to the number of
+/// payload bytes received and @c error to the result for the datagram.
+/// @param count Number of datagrams.
+/// @param ec Set to indicate what error occurred, if any.
+///
+/// @returns The number of datagrams received.
+ASIOEXT_DECL std::size_t receive_batch(asio::ip::udp::socket& socket,
+                                       udp_message* messages,
+                                       std::size_t count,
+                                       error_code& ec);
+
+/// @}
+
+}
+
+ASIOEXT_NS_END
+
+#include "asioext/socks/impl/udp.hpp"
+
+#if defined(ASIOEXT_HEADER_ONLY)
+# include "asioext/socks/impl/udp.cpp"
+#endif
+
+#endif
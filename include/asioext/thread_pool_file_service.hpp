@@ -16,6 +16,7 @@
 #endif
 
 #include "asioext/file_handle.hpp"
+#include "asioext/directory_handle.hpp"
 #include "asioext/open_args.hpp"
 #include "asioext/file_perms.hpp"
 #include "asioext/file_attrs.hpp"
@@ -34,6 +35,8 @@
 # include <boost/filesystem/path.hpp>
 #endif
 
+#include <atomic>
+
 ASIOEXT_NS_BEGIN
 
 /// @ingroup files_handle
@@ -68,7 +71,8 @@ public:
   {
   public:
     implementation_type()
-      : next_(0)
+      : pending_opens_(0)
+      , next_(0)
       , prev_(0)
     {
       // ctor
@@ -81,12 +85,28 @@ public:
     file_handle handle_;
     cancellation_token_source cancel_token_;
 
+    // Number of async_open() calls that will assign |handle_|.
+    std::size_t pending_opens_;
+
     // Pointers to adjacent handle implementations in linked list.
     implementation_type* next_;
     implementation_type* prev_;
   };
 #endif
 
+  /// Statistics of the non-blocking read fast path.
+  ///
+  /// @see nowait_reads()
+  struct nowait_read_stats
+  {
+    /// Reads that were completed without involving the thread pool.
+    uint64_t hits;
+
+    /// Reads that had to be handed to the thread pool, because the data
+    /// wasn't cached or the non-blocking read failed.
+    uint64_t misses;
+  };
+
   /// Construct a new file service for the specified io_service.
   ///
   /// @param io_service The io_service that will own this service object.
@@ -215,6 +235,11 @@ public:
                           const file_times& new_times,
                           error_code& ec) ASIOEXT_NOEXCEPT;
 
+  /// Get multiple metadata values at once.
+  ASIOEXT_DECL file_status status(implementation_type& impl,
+                                  file_status_mask mask,
+                                  error_code& ec) ASIOEXT_NOEXCEPT;
+
   /// Cancel all operations associated with the handle.
   ASIOEXT_DECL void cancel(implementation_type& impl,
                            error_code& ec) ASIOEXT_NOEXCEPT;
@@ -277,6 +302,106 @@ public:
                       const ConstBufferSequence& buffers,
                       ASIOEXT_MOVE_ARG(Handler) handler);
 
+  /// Start an asynchronous read that fills all buffers (unless EOF is
+  /// reached). All partial reads are performed on a single pool thread.
+  /// The buffer for the data being received must be valid for the lifetime of
+  /// the asynchronous operation.
+  template <typename MutableBufferSequence, typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, std::size_t))
+  async_read_at(implementation_type& impl, uint64_t offset,
+                const MutableBufferSequence& buffers,
+                ASIOEXT_MOVE_ARG(Handler) handler);
+
+  /// Start an asynchronous write of all data at a specified offset.
+  /// All partial writes are performed on a single pool thread.
+  /// The data being written must be valid for the lifetime of the
+  /// asynchronous operation.
+  template <typename ConstBufferSequence, typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, std::size_t))
+  async_write_at(implementation_type& impl, uint64_t offset,
+                 const ConstBufferSequence& buffers,
+                 ASIOEXT_MOVE_ARG(Handler) handler);
+
+  /// Start an asynchronous open of the given file. The file is opened on a
+  /// pool thread. The new handle is assigned to the implementation on the
+  /// handler's executor, right before the handler is invoked.
+  ///
+  /// cancel(), async_close() and destroying the implementation abort the
+  /// operation. If the file was already opened, it is closed again.
+  template <typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code))
+  async_open(implementation_type& impl, const char* filename,
+             const open_args& args, ASIOEXT_MOVE_ARG(Handler) handler);
+
+  /// Start an asynchronous close. The implementation is reset immediately
+  /// and all of its outstanding operations are cancelled. The handle itself
+  /// is closed on a pool thread. Unlike other operations, the close cannot be
+  /// cancelled.
+  template <typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code))
+  async_close(implementation_type& impl, ASIOEXT_MOVE_ARG(Handler) handler);
+
+  /// Start an asynchronous query of the file size.
+  template <typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, uint64_t))
+  async_size(implementation_type& impl, ASIOEXT_MOVE_ARG(Handler) handler);
+
+  /// Start an asynchronous change of the file size.
+  template <typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code))
+  async_size(implementation_type& impl, uint64_t new_size,
+             ASIOEXT_MOVE_ARG(Handler) handler);
+
+  /// Start an asynchronous query of the file times.
+  template <typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, file_times))
+  async_times(implementation_type& impl, ASIOEXT_MOVE_ARG(Handler) handler);
+
+  /// Start an asynchronous query of multiple metadata values at once.
+  template <typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, file_status))
+  async_status(implementation_type& impl, file_status_mask mask,
+               ASIOEXT_MOVE_ARG(Handler) handler);
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE) || defined(ASIOEXT_IS_DOCUMENTATION)
+  /// Start an asynchronous read of the next batch of directory entries.
+  /// The directory is read on a pool thread, see
+  /// directory_handle::read_entries() for details. The handle and the buffer
+  /// must be valid for the lifetime of the asynchronous operation.
+  ///
+  /// The handler is called with the entries that were read. An empty batch
+  /// means that the end of the directory was reached.
+  ///
+  /// @note Only available if @c ASIOEXT_HAS_DIRECTORY_HANDLE is defined.
+  template <typename Handler>
+  ASIOEXT_INITFN_RESULT_TYPE(Handler, void(error_code, directory_entries))
+  async_read_entries(directory_handle& dir,
+                     const asio::mutable_buffer& buffer,
+                     ASIOEXT_MOVE_ARG(Handler) handler);
+#endif
+
+  /// Enable or disable the non-blocking read fast path.
+  ///
+  /// If enabled, async_read_some_at() first attempts to read the data
+  /// on the calling thread, using @c preadv2() with @c RWF_NOWAIT.
+  /// This succeeds if the data is in the page cache. The handler is then
+  /// posted to the io_service directly, without a round trip to the pool.
+  /// Only if the data would need to be fetched from disk, the operation is
+  /// handed to the thread pool.
+  ///
+  /// The fast path is enabled by default. It is only available on Linux
+  /// and disables itself if the kernel or file system doesn't support
+  /// @c RWF_NOWAIT.
+  ASIOEXT_DECL void nowait_reads(bool enabled) ASIOEXT_NOEXCEPT;
+
+  /// Check whether the non-blocking read fast path is enabled.
+  ///
+  /// @return @c false if the fast path was disabled or isn't supported.
+  ASIOEXT_DECL bool nowait_reads() const ASIOEXT_NOEXCEPT;
+
+  /// Get the hit/miss counters of the non-blocking read fast path.
+  ASIOEXT_DECL nowait_read_stats nowait_stats() const ASIOEXT_NOEXCEPT;
+
   /// @private
   // This is needed for tests.
   asio::io_service& get_pool_io_service()
@@ -291,10 +416,25 @@ private:
     void operator()();
   };
 
+  // Assigns the handle opened by async_open() to the implementation.
+  class open_completion;
+
   // Helper function to close a handle when the associated object is being
   // destroyed.
   ASIOEXT_DECL void close_for_destruction(implementation_type& impl);
 
+  // Attempt a non-blocking read of cached data. Returns false if the
+  // operation needs to be performed on the thread pool.
+  template <typename MutableBufferSequence>
+  bool try_read_some_at_nowait(implementation_type& impl, uint64_t offset,
+                               const MutableBufferSequence& buffers,
+                               std::size_t& bytes_transferred,
+                               error_code& ec) ASIOEXT_NOEXCEPT;
+
+  // Count the outcome of a non-blocking read attempt and turn the
+  // fast path off if it isn't supported.
+  ASIOEXT_DECL void nowait_read_result(const error_code& ec) ASIOEXT_NOEXCEPT;
+
   // The io_service that runs on the thread pool.
   asio::io_service pool_;
 
@@ -309,6 +449,13 @@ private:
 
   // The head of a linked list of all implementations.
   implementation_type* impl_list_;
+
+  // Whether async_read_some_at() may try a non-blocking read first.
+  std::atomic<bool> nowait_reads_;
+
+  // Counters for nowait_stats().
+  std::atomic<uint64_t> nowait_hits_;
+  std::atomic<uint64_t> nowait_misses_;
 };
 
 ASIOEXT_NS_END
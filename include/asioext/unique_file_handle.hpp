@@ -368,6 +368,18 @@ public:
     handle_.times(new_times, ec);
   }
 
+  /// @copydoc file_handle::status(file_status_mask)
+  file_status status(file_status_mask mask = file_status_mask::all)
+  {
+    return handle_.status(mask);
+  }
+
+  /// @copydoc file_handle::status(file_status_mask,error_code&)
+  file_status status(file_status_mask mask, error_code& ec) ASIOEXT_NOEXCEPT
+  {
+    return handle_.status(mask, ec);
+  }
+
   /// @}
 
   /// @name SyncReadStream functions
@@ -0,0 +1,121 @@
+/// @file
+/// Declares the asioext::write_at and asioext::async_write_at functions.
+///
+/// @copyright Copyright (c) 2018 Tim Niederhausen (tim@rnc-ag.de)
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE_1_0.txt or copy at
+/// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ASIOEXT_WRITEAT_HPP
+#define ASIOEXT_WRITEAT_HPP
+
+#include "asioext/detail/config.hpp"
+
+#if ASIOEXT_HAS_PRAGMA_ONCE
+# pragma once
+#endif
+
+#include "asioext/basic_file.hpp"
+#include "asioext/error_code.hpp"
+#include "asioext/async_result.hpp"
+
+#include "asioext/detail/cstdint.hpp"
+#include "asioext/detail/move_support.hpp"
+
+#include <cstddef> // for size_t
+
+ASIOEXT_NS_BEGIN
+
+/// @ingroup files
+/// @defgroup write_at asioext::write_at()
+/// Write all of the supplied data at a specific offset.
+///
+/// Unlike @c asio::write_at, these functions only require a
+/// @c write_some_at member function (e.g. @ref file_handle,
+/// @ref unique_file_handle or @ref basic_file).
+///
+///@{
+
+/// Write all of the supplied data to a file at the specified offset.
+///
+/// This function writes to @c device until all of @c buffers were
+/// written or an error occurred. It is implemented in terms of zero or more
+/// calls to @c device.write_some_at().
+///
+/// @param device The device to write to, e.g. a @ref file_handle.
+///
+/// @param offset The offset at which the data will be written.
+///
+/// @param buffers One or more buffers containing the data to be written.
+///
+/// @returns The number of bytes written.
+///
+/// @throws asio::system_error Thrown on failure.
+template <typename RandomAccessWriteDevice, typename ConstBufferSequence>
+std::size_t write_at(RandomAccessWriteDevice& device, uint64_t offset,
+                     const ConstBufferSequence& buffers);
+
+/// Write all of the supplied data to a file at the specified offset.
+///
+/// This function writes to @c device until all of @c buffers were
+/// written or an error occurred. It is implemented in terms of zero or more
+/// calls to @c device.write_some_at().
+///
+/// @param device The device to write to, e.g. a @ref file_handle.
+///
+/// @param offset The offset at which the data will be written.
+///
+/// @param buffers One or more buffers containing the data to be written.
+///
+/// @param ec Set to indicate what error occurred. If no error occurred,
+/// the object is reset. If @c device.write_some_at() wrote nothing without
+/// failing, @c ec is set to @c errc::no_space_on_device.
+///
+/// @returns The number of bytes written.
+template <typename RandomAccessWriteDevice, typename ConstBufferSequence>
+std::size_t write_at(RandomAccessWriteDevice& device, uint64_t offset,
+                     const ConstBufferSequence& buffers, error_code& ec);
+
+/// Start an asynchronous write of all of the supplied data at the specified
+/// offset.
+///
+/// This function writes to @c file until all of @c buffers were written
+/// or an error occurred. The function call always returns immediately.
+///
+/// In contrast to @c asio::async_write_at, the whole operation is executed
+/// by the @c FileService, so a @ref thread_pool_file_service performs all
+/// partial writes on a single pool thread and only invokes @c handler once.
+///
+/// @param file The file to write to.
+///
+/// @param offset The offset at which the data will be written.
+///
+/// @param buffers One or more data buffers to be written to the file.
+/// Although the buffers object may be copied as necessary, ownership of the
+/// underlying memory blocks is retained by the caller, which must guarantee
+/// that they remain valid until the handler is called.
+///
+/// @param handler The handler to be called when the write operation
+/// completes.
+/// Copies will be made of the handler as required. The function signature of
+/// the handler must be:
+/// @code void handler(
+///   const error_code& error, // Result of operation.
+///   std::size_t bytes_transferred // Number of bytes written.
+/// ); @endcode
+/// Invocation of the handler will be performed in a manner equivalent to
+/// using asio::io_service::post().
+template <typename FileService, typename ConstBufferSequence,
+          typename WriteHandler>
+ASIOEXT_INITFN_RESULT_TYPE(WriteHandler, void(error_code, std::size_t))
+async_write_at(basic_file<FileService>& file, uint64_t offset,
+               const ConstBufferSequence& buffers,
+               ASIOEXT_MOVE_ARG(WriteHandler) handler);
+
+///@}
+
+ASIOEXT_NS_END
+
+#include "asioext/impl/write_at.hpp"
+
+#endif
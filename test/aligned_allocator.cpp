@@ -0,0 +1,130 @@
+#include "test_file_writer.hpp"
+
+#include "asioext/aligned_allocator.hpp"
+#include "asioext/page_allocator.hpp"
+#include "asioext/linear_buffer.hpp"
+#include "asioext/read_file.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_aligned_allocator)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const char* test_filename = "asioext_alignedallocator_test";
+static const char test_data[] = "hello world!";
+static const std::size_t test_data_size = sizeof(test_data) - 1;
+
+static bool is_aligned(const void* p, std::size_t alignment)
+{
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+template <class Buffer>
+static std::string to_string(const Buffer& b)
+{
+  return std::string(reinterpret_cast<const char*>(b.data()), b.size());
+}
+
+BOOST_AUTO_TEST_CASE(aligned)
+{
+  aligned_allocator<uint8_t, 4096> a;
+  uint8_t* p = a.allocate(10);
+  BOOST_CHECK(is_aligned(p, 4096));
+  a.deallocate(p, 10);
+
+  // Rebinding keeps the alignment.
+  aligned_allocator<uint32_t, 4096> b(a);
+  BOOST_CHECK(a == b);
+  uint32_t* q = b.allocate(3);
+  BOOST_CHECK(is_aligned(q, 4096));
+  b.deallocate(q, 3);
+
+  basic_linear_buffer<aligned_allocator<uint8_t, 512>> buf;
+  buf.append("HELLO", 5);
+  BOOST_CHECK(is_aligned(buf.data(), 512));
+  buf.append(" WORLD", 6);
+  BOOST_CHECK(is_aligned(buf.data(), 512));
+  BOOST_CHECK_EQUAL("HELLO WORLD", to_string(buf));
+}
+
+BOOST_AUTO_TEST_CASE(page)
+{
+  const std::size_t page_size = page_allocator<uint8_t>::page_size();
+  BOOST_REQUIRE_NE(0, page_size);
+
+  page_allocator<uint8_t> a;
+  uint8_t* p = a.allocate(page_size + 1);
+  BOOST_CHECK(is_aligned(p, page_size));
+  // The whole mapping is usable.
+  std::memset(p, 0xff, page_size + 1);
+  a.deallocate(p, page_size + 1);
+
+  std::vector<char, page_allocator<char>> v(100, 'x');
+  BOOST_CHECK(is_aligned(v.data(), page_size));
+  v.resize(3 * page_size);
+  BOOST_CHECK(is_aligned(v.data(), page_size));
+}
+
+BOOST_AUTO_TEST_CASE(hugepage)
+{
+  const std::size_t page_size = page_allocator<uint8_t>::page_size();
+  const std::size_t huge_page_size =
+      hugepage_allocator<uint8_t>::huge_page_size();
+
+  hugepage_allocator<uint8_t> a;
+
+  // Small allocations behave like page_allocator.
+  uint8_t* p = a.allocate(100);
+  BOOST_CHECK(is_aligned(p, page_size));
+  std::memset(p, 0xff, 100);
+  a.deallocate(p, 100);
+
+  // Large ones fall back to regular pages if there are no huge pages.
+  if (huge_page_size != 0) {
+    const std::size_t size = huge_page_size + 1;
+    p = a.allocate(size);
+    BOOST_CHECK(is_aligned(p, page_size));
+#if !defined(ASIOEXT_WINDOWS)
+    // ... which are huge page aligned, so they can become huge pages later.
+    BOOST_CHECK(is_aligned(p, huge_page_size));
+#endif
+    p[0] = 1;
+    p[size - 1] = 2;
+    a.deallocate(p, size);
+  }
+
+  basic_linear_buffer<hugepage_allocator<uint8_t>> buf;
+  buf.append("HELLO", 5);
+  BOOST_CHECK_EQUAL("HELLO", to_string(buf));
+}
+
+BOOST_AUTO_TEST_CASE(read_file_into)
+{
+  static test_file_writer file(test_filename, test_data, test_data_size);
+
+  basic_linear_buffer<aligned_allocator<uint8_t, 4096>> a;
+  read_file(test_filename, a);
+  BOOST_CHECK(is_aligned(a.data(), 4096));
+  BOOST_CHECK_EQUAL(test_data, to_string(a));
+
+  basic_linear_buffer<page_allocator<uint8_t>> b;
+  read_file(test_filename, b);
+  BOOST_CHECK_EQUAL(test_data, to_string(b));
+
+  std::vector<char, hugepage_allocator<char>> c;
+  read_file(test_filename, c);
+  BOOST_CHECK_EQUAL(test_data, std::string(c.begin(), c.end()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
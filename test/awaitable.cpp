@@ -0,0 +1,212 @@
+#include "test_file_rm_guard.hpp"
+
+#include "asioext/awaitable.hpp"
+
+#if defined(ASIOEXT_HAS_CO_AWAIT)
+
+#include "asioext/file.hpp"
+#include "asioext/open_flags.hpp"
+#include "asioext/socks/awaitable.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/read.hpp>
+# include <boost/asio/write.hpp>
+#else
+# include <asio/io_service.hpp>
+# include <asio/read.hpp>
+# include <asio/write.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_awaitable)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const char* test_filename = "asioext_awaitable_test";
+
+static task<int> add(int a, int b)
+{
+  co_return a + b;
+}
+
+static task<int> sum(int n)
+{
+  int s = 0;
+  for (int i = 0; i != n; ++i)
+    s = co_await add(s, i);
+  co_return s;
+}
+
+static task<void> fail()
+{
+  co_await add(1, 2);
+  throw std::runtime_error("fail");
+}
+
+BOOST_AUTO_TEST_CASE(awaitable_task)
+{
+  asio::io_service io_service;
+
+  int result = 0;
+  co_spawn(io_service, sum(1000), [&] (std::exception_ptr e, int value) {
+    BOOST_CHECK(!e);
+    result = value;
+  });
+
+  // Tasks are started by the io_service.
+  BOOST_CHECK_EQUAL(0, result);
+  io_service.run();
+  BOOST_CHECK_EQUAL(499500, result);
+
+  bool called = false;
+  co_spawn(io_service, fail(), [&] (std::exception_ptr e) {
+    called = true;
+    BOOST_CHECK_THROW(std::rethrow_exception(e), std::runtime_error);
+  });
+
+  io_service.restart();
+  io_service.run();
+  BOOST_CHECK(called);
+}
+
+static task<std::string> copy_file(file& f)
+{
+  const std::string data = "hello world!";
+  std::size_t n = co_await await_write_some_at(f, 10, asio::buffer(data));
+  BOOST_CHECK_EQUAL(data.size(), n);
+
+  char buffer[5];
+  n = co_await await_read_some_at(f, 16, asio::buffer(buffer));
+  BOOST_CHECK_EQUAL(5, n);
+  BOOST_CHECK_EQUAL("world", std::string(buffer, 5));
+
+  // Reading at the end yields eof.
+  error_code ec;
+  n = co_await await_read_some_at(f, 22, asio::buffer(buffer), ec);
+  BOOST_CHECK_EQUAL(0, n);
+  BOOST_CHECK_MESSAGE(ec == asio::error::eof, "ec: " << ec);
+
+  std::string contents;
+  n = co_await await_read_file(f, contents);
+  BOOST_CHECK_EQUAL(22, n);
+  co_return contents;
+}
+
+static task<void> read_file(file& f, std::string& contents)
+{
+  co_await await_read_file(f, contents);
+}
+
+BOOST_AUTO_TEST_CASE(awaitable_file)
+{
+  test_file_rm_guard rguard(test_filename);
+
+  asio::io_service io_service;
+  file f(io_service);
+  f.open(test_filename, open_flags::access_read_write |
+                        open_flags::create_always);
+
+  std::string contents;
+  co_spawn(io_service, copy_file(f),
+           [&] (std::exception_ptr e, std::string value) {
+    BOOST_CHECK(!e);
+    contents = value;
+  });
+  io_service.run();
+  BOOST_CHECK(std::string(10, '\0') + "hello world!" == contents);
+
+  // Errors are thrown if no error_code is given.
+  f.close();
+  std::string ignored;
+  bool called = false;
+  co_spawn(io_service, read_file(f, ignored), [&] (std::exception_ptr e) {
+    called = true;
+    BOOST_CHECK(e);
+  });
+  io_service.restart();
+  io_service.run();
+  BOOST_CHECK(called);
+}
+
+static task<void> connect_and_handshake(asio::ip::tcp::socket& socket,
+                                        asio::ip::tcp::resolver& resolver,
+                                        unsigned short port)
+{
+  asio::ip::tcp::resolver::query q(
+      "127.0.0.1", std::to_string(port),
+      asio::ip::tcp::resolver::query::numeric_service);
+  asio::ip::tcp::resolver::iterator it =
+      co_await await_connect(socket, resolver, q);
+  BOOST_CHECK_EQUAL(port, it->endpoint().port());
+
+  char storage[socks::max_handshake_size];
+  co_await socks::await_handshake(socket, "", "", "example.com", 80,
+                                  asio::buffer(storage));
+
+  // The server refuses the second handshake.
+  error_code ec;
+  co_await socks::await_handshake(socket, "", "", "example.com", 80,
+                                  asio::buffer(storage), ec);
+  BOOST_CHECK(ec);
+}
+
+BOOST_AUTO_TEST_CASE(awaitable_connect)
+{
+  asio::io_service io_service;
+
+  const std::string greeting_reply("\x05\x00", 2);
+  const std::string connect_reply("\x05\x00\x00\x01\x0a\x00\x00\x01"
+                                  "\x12\x34", 10);
+  const std::string refused_reply("\x05\x05\x00\x01\x0a\x00\x00\x01"
+                                  "\x12\x34", 10);
+
+  // A scripted SOCKS 5 server that accepts the first handshake and
+  // refuses the second one.
+  asio::ip::tcp::acceptor acceptor(io_service, asio::ip::tcp::endpoint(
+      asio::ip::address_v4::loopback(), 0));
+  asio::ip::tcp::socket peer(io_service);
+  char request[3 + 18];
+  const std::string reply1 = greeting_reply + connect_reply;
+  const std::string reply2 = greeting_reply + refused_reply;
+  acceptor.async_accept(peer, [&] (error_code ec) {
+    BOOST_REQUIRE(!ec);
+    asio::async_read(peer, asio::buffer(request),
+                     [&] (error_code ec, std::size_t) {
+      BOOST_REQUIRE(!ec);
+      asio::write(peer, asio::buffer(reply1));
+      asio::async_read(peer, asio::buffer(request),
+                       [&] (error_code ec, std::size_t) {
+        BOOST_REQUIRE(!ec);
+        asio::write(peer, asio::buffer(reply2));
+      });
+    });
+  });
+
+  asio::ip::tcp::socket socket(io_service);
+  asio::ip::tcp::resolver resolver(io_service);
+  bool called = false;
+  co_spawn(io_service,
+           connect_and_handshake(socket, resolver,
+                                 acceptor.local_endpoint().port()),
+           [&] (std::exception_ptr e) {
+    called = true;
+    BOOST_CHECK(!e);
+  });
+  io_service.run();
+  BOOST_CHECK(called);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
+
+#endif
@@ -359,6 +359,226 @@ BOOST_AUTO_TEST_CASE(async_read_write_cancel)
   io_service.reset();
 }
 
+BOOST_AUTO_TEST_CASE(nowait_reads)
+{
+  typedef thread_pool_file_service FileService;
+
+  test_file_rm_guard rguard1(test_filename);
+
+  asio::io_service io_service;
+  FileService& svc = asio::use_service<FileService>(io_service);
+  asioext::basic_file<FileService> file(io_service);
+
+  asioext::error_code ec;
+  file.open(test_filename,
+            open_flags::access_read_write | open_flags::create_always, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_REQUIRE_EQUAL(test_data_size,
+                      file.write_some_at(0, asio::buffer(test_data,
+                                                         test_data_size)));
+
+  const bool enabled = svc.nowait_reads();
+  for (int i = 0; i != 2; ++i) {
+    char buffer[128];
+    std::size_t result = 0;
+    file.async_read_some_at(0, asio::buffer(buffer),
+        [&](const error_code& ec, std::size_t bytes_transferred) {
+      BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+      result = bytes_transferred;
+    });
+
+    // The handler must not be invoked from within the initiating function.
+    BOOST_REQUIRE_EQUAL(0, result);
+    io_service.run();
+    io_service.reset();
+
+    BOOST_REQUIRE_EQUAL(test_data_size, result);
+    BOOST_REQUIRE_EQUAL(0, std::memcmp(test_data, buffer, test_data_size));
+
+    // Second run without the fast path.
+    svc.nowait_reads(false);
+    BOOST_REQUIRE(!svc.nowait_reads());
+  }
+
+  const FileService::nowait_read_stats stats = svc.nowait_stats();
+  if (enabled)
+    BOOST_CHECK_EQUAL(1, stats.hits + stats.misses);
+  else
+    BOOST_CHECK_EQUAL(0, stats.hits + stats.misses);
+
+  // Reads that fail are retried on the thread pool, so they're misses.
+  if (enabled) {
+    svc.nowait_reads(true);
+
+    asioext::basic_file<FileService> write_only(io_service);
+    write_only.open(test_filename,
+                    open_flags::access_write | open_flags::open_existing, ec);
+    BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+    char buffer[16];
+    error_code read_ec;
+    write_only.async_read_some_at(0, asio::buffer(buffer),
+        [&](const error_code& ec, std::size_t) {
+      read_ec = ec;
+    });
+    io_service.run();
+    BOOST_CHECK(read_ec);
+
+    const FileService::nowait_read_stats failed_stats = svc.nowait_stats();
+    BOOST_CHECK_EQUAL(stats.hits, failed_stats.hits);
+    BOOST_CHECK_EQUAL(stats.misses + 1, failed_stats.misses);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(async_open_close)
+{
+  typedef thread_pool_file_service FileService;
+
+  test_file_rm_guard rguard1(test_filename);
+
+  asio::io_service io_service;
+  asioext::basic_file<FileService> file(io_service);
+
+  error_code result = asio::error::would_block;
+  const auto store_result = [&result](const error_code& ec) {
+    result = ec;
+  };
+
+  file.async_open("nosuchfile",
+                  open_flags::access_read | open_flags::open_existing,
+                  store_result);
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK(result);
+  BOOST_CHECK(result != asio::error::would_block);
+  BOOST_CHECK(!file.is_open());
+
+  file.async_open(test_filename,
+                  open_flags::access_read_write | open_flags::create_always,
+                  store_result);
+
+  // The handle is assigned right before the handler is invoked.
+  BOOST_CHECK(!file.is_open());
+  io_service.run();
+  io_service.reset();
+  BOOST_REQUIRE_MESSAGE(!result, "ec: " << result);
+  BOOST_REQUIRE(file.is_open());
+
+  file.async_open(test_filename,
+                  open_flags::access_read | open_flags::open_existing,
+                  store_result);
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_EQUAL(result, asio::error::already_open);
+  BOOST_CHECK(file.is_open());
+
+  file.async_size(test_data_size, store_result);
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_MESSAGE(!result, "ec: " << result);
+
+  uint64_t size = 0;
+  file.async_size([&](const error_code& ec, uint64_t s) {
+    result = ec;
+    size = s;
+  });
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_MESSAGE(!result, "ec: " << result);
+  BOOST_CHECK_EQUAL(test_data_size, size);
+
+  file_times times;
+  file.async_times([&](const error_code& ec, const file_times& t) {
+    result = ec;
+    times = t;
+  });
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_MESSAGE(!result, "ec: " << result);
+  BOOST_CHECK(times.mtime.time_since_epoch().count() != 0);
+
+  file_status status;
+  file.async_status(file_status_mask::size,
+                    [&](const error_code& ec, const file_status& s) {
+    result = ec;
+    status = s;
+  });
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_MESSAGE(!result, "ec: " << result);
+  BOOST_CHECK(status.mask == file_status_mask::size);
+  BOOST_CHECK_EQUAL(test_data_size, status.size);
+
+  // The file is reset immediately.
+  file.async_close(store_result);
+  BOOST_CHECK(!file.is_open());
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_MESSAGE(!result, "ec: " << result);
+
+  // Cancelled opens never assign the handle, no matter whether the pool
+  // has opened the file already.
+  file.async_open(test_filename,
+                  open_flags::access_read | open_flags::open_existing,
+                  store_result);
+  file.cancel();
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_EQUAL(result, asio::error::operation_aborted);
+  BOOST_CHECK(!file.is_open());
+
+  error_code ec;
+  file.cancel(ec);
+  BOOST_CHECK_EQUAL(ec, asio::error::bad_descriptor);
+
+  // Same for files that are destroyed.
+  {
+    asioext::basic_file<FileService> file2(io_service);
+    file2.async_open(test_filename,
+                     open_flags::access_read | open_flags::open_existing,
+                     store_result);
+  }
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_EQUAL(result, asio::error::operation_aborted);
+
+#if defined(ASIOEXT_HAS_MOVE)
+  // And for files that are moved. Neither the moved-from file (destroyed
+  // here) nor the new one gets the handle.
+  asioext::basic_file<FileService> file3(io_service);
+  {
+    asioext::basic_file<FileService> file2(io_service);
+    file2.async_open(test_filename,
+                     open_flags::access_read | open_flags::open_existing,
+                     store_result);
+    asioext::basic_file<FileService> moved(std::move(file2));
+    file3 = std::move(moved);
+  }
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_EQUAL(result, asio::error::operation_aborted);
+  BOOST_CHECK(!file3.is_open());
+
+  file3.async_open(test_filename,
+                   open_flags::access_read | open_flags::open_existing,
+                   store_result);
+  asioext::basic_file<FileService> file4(std::move(file3));
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_EQUAL(result, asio::error::operation_aborted);
+  BOOST_CHECK(!file4.is_open());
+
+  // The new file is still usable afterwards.
+  file4.async_open(test_filename,
+                   open_flags::access_read | open_flags::open_existing,
+                   store_result);
+  io_service.run();
+  io_service.reset();
+  BOOST_CHECK_MESSAGE(!result, "ec: " << result);
+  BOOST_CHECK(file4.is_open());
+#endif
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ASIOEXT_NS_END
@@ -0,0 +1,180 @@
+#include "asioext/buffer_pool.hpp"
+#include "asioext/linear_buffer.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_buffer_pool)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+BOOST_AUTO_TEST_CASE(size_classes)
+{
+  buffer_pool pool(100, 5000);
+  BOOST_CHECK_EQUAL(128, pool.min_buffer_size());
+  BOOST_CHECK_EQUAL(8192, pool.max_buffer_size());
+
+  BOOST_CHECK_EQUAL(128, pool.buffer_size(0));
+  BOOST_CHECK_EQUAL(128, pool.buffer_size(128));
+  BOOST_CHECK_EQUAL(256, pool.buffer_size(129));
+  BOOST_CHECK_EQUAL(8192, pool.buffer_size(8192));
+
+  // Too large to be pooled.
+  BOOST_CHECK_EQUAL(8193, pool.buffer_size(8193));
+}
+
+BOOST_AUTO_TEST_CASE(lease)
+{
+  buffer_pool pool;
+
+  uint8_t* first;
+  {
+    pooled_buffer buf = pool.acquire(1000);
+    BOOST_REQUIRE(!buf.empty());
+    BOOST_CHECK_EQUAL(&pool, buf.pool());
+    BOOST_CHECK_EQUAL(1000, buf.size());
+    BOOST_CHECK_EQUAL(1024, buf.capacity());
+    first = buf.data();
+
+    asio::mutable_buffer mb = buf;
+    BOOST_CHECK_EQUAL(1000, asio::buffer_size(mb));
+    BOOST_CHECK_EQUAL(1000, asio::buffer_copy(asio::buffer(buf),
+                                              asio::buffer(std::string(1000, 'x'))));
+
+    BOOST_CHECK_EQUAL(1024, pool.stats().bytes_in_use);
+  }
+
+  buffer_pool_stats s = pool.stats();
+  BOOST_CHECK_EQUAL(0, s.bytes_in_use);
+  BOOST_CHECK_EQUAL(1024, s.bytes_cached);
+
+  // The same buffer is handed out again.
+  pooled_buffer a = pool.acquire(600);
+  BOOST_CHECK_EQUAL(first, a.data());
+
+  pooled_buffer b(std::move(a));
+  BOOST_CHECK(a.empty());
+  BOOST_CHECK_EQUAL(first, b.data());
+
+  a = pool.acquire(10);
+  a = std::move(b);
+  BOOST_CHECK(b.empty());
+  BOOST_CHECK_EQUAL(first, a.data());
+
+  a.reset();
+  BOOST_CHECK(a.empty());
+
+  s = pool.stats();
+  BOOST_CHECK_EQUAL(3, s.allocations);
+  BOOST_CHECK_EQUAL(1, s.thread_cache_hits);
+  BOOST_CHECK_EQUAL(2, s.misses);
+  BOOST_CHECK_EQUAL(0, s.bytes_in_use);
+  BOOST_CHECK_CLOSE(1.0 / 3.0, s.hit_rate(), 0.001);
+
+  pool.release();
+  BOOST_CHECK_EQUAL(0, pool.stats().bytes_cached);
+}
+
+BOOST_AUTO_TEST_CASE(oversized)
+{
+  buffer_pool pool(512, 4096);
+  void* p = pool.allocate(10000);
+  BOOST_CHECK_EQUAL(10000, pool.stats().bytes_in_use);
+  pool.deallocate(p, 10000);
+
+  buffer_pool_stats s = pool.stats();
+  BOOST_CHECK_EQUAL(0, s.bytes_in_use);
+  BOOST_CHECK_EQUAL(0, s.bytes_cached);
+  BOOST_CHECK_EQUAL(1, s.misses);
+}
+
+BOOST_AUTO_TEST_CASE(overflow)
+{
+  buffer_pool pool(512, 4096, 4);
+
+  std::vector<void*> buffers;
+  for (int i = 0; i != 10; ++i)
+    buffers.push_back(pool.allocate(512));
+
+  for (std::size_t i = 0; i != buffers.size(); ++i)
+    pool.deallocate(buffers[i], 512);
+
+  // Everything is cached, the excess in the overflow list.
+  BOOST_CHECK_EQUAL(10 * 512, pool.stats().bytes_cached);
+
+  // Another thread refills its cache from the overflow list.
+  std::thread t([&pool] () {
+    void* p = pool.allocate(512);
+    pool.deallocate(p, 512);
+  });
+  t.join();
+
+  buffer_pool_stats s = pool.stats();
+  BOOST_CHECK_EQUAL(1, s.shared_hits);
+  BOOST_CHECK_EQUAL(10, s.misses);
+  // The exited thread's cache went back to the overflow list.
+  BOOST_CHECK_EQUAL(10 * 512, s.bytes_cached);
+  BOOST_CHECK_EQUAL(0, s.bytes_in_use);
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+  buffer_pool pool(512, 4096, 8);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i != 4; ++i) {
+    threads.emplace_back([&pool, i] () {
+      std::vector<pooled_buffer> leases;
+      for (int j = 0; j != 1000; ++j) {
+        leases.push_back(pool.acquire(512 + (j % 7) * 500));
+        std::memset(leases.back().data(), i, leases.back().size());
+        if (leases.size() == 16)
+          leases.clear();
+      }
+    });
+  }
+
+  for (std::size_t i = 0; i != threads.size(); ++i)
+    threads[i].join();
+
+  buffer_pool_stats s = pool.stats();
+  BOOST_CHECK_EQUAL(4000, s.allocations);
+  BOOST_CHECK_EQUAL(s.allocations,
+                    s.thread_cache_hits + s.shared_hits + s.misses);
+  BOOST_CHECK_EQUAL(0, s.bytes_in_use);
+  BOOST_CHECK_GT(s.hit_rate(), 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(allocator)
+{
+  typedef buffer_pool_allocator<uint8_t> allocator_type;
+
+  buffer_pool pool;
+  {
+    basic_linear_buffer<allocator_type> buf{allocator_type(pool)};
+    buf.append("HELLO", 5);
+    buf.append(" WORLD", 6);
+    BOOST_CHECK_EQUAL("HELLO WORLD",
+                      std::string(reinterpret_cast<const char*>(buf.data()),
+                                  buf.size()));
+    BOOST_CHECK_NE(0, pool.stats().bytes_in_use);
+  }
+
+  BOOST_CHECK_EQUAL(0, pool.stats().bytes_in_use);
+
+  buffer_pool other;
+  BOOST_CHECK(allocator_type(pool) == allocator_type(pool));
+  BOOST_CHECK(allocator_type(pool) != allocator_type(other));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,256 @@
+#include "asioext/circular_buffer.hpp"
+#include "asioext/mirrored_circular_buffer.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_circular_buffer)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+template <typename ConstBufferSequence>
+static std::string to_string(const ConstBufferSequence& buffers)
+{
+  std::string s(asio::buffer_size(buffers), '\0');
+  asio::buffer_copy(asio::buffer(&s[0], s.size()), buffers);
+  return s;
+}
+
+template <typename ConstBufferSequence>
+static std::size_t count_buffers(const ConstBufferSequence& buffers)
+{
+  return std::distance(buffers.begin(), buffers.end());
+}
+
+BOOST_AUTO_TEST_CASE(basic_construction)
+{
+  circular_buffer x1;
+  BOOST_CHECK_EQUAL(0, x1.size());
+  BOOST_CHECK_EQUAL(0, x1.capacity());
+  BOOST_CHECK_EQUAL(0, asio::buffer_size(x1.data()));
+
+  circular_buffer x2(100, 64);
+  BOOST_CHECK_EQUAL(0, x2.size());
+  BOOST_CHECK_EQUAL(128, x2.capacity());
+  BOOST_CHECK_EQUAL(64, x2.max_size());
+}
+
+BOOST_AUTO_TEST_CASE(wrap_around)
+{
+  circular_buffer a(8);
+  a.append("ABCDEF", 6);
+  a.consume(4);
+  BOOST_CHECK_EQUAL(2, a.size());
+
+  // The output sequence wraps around the end of the storage.
+  circular_buffer::mutable_buffers_type out = a.prepare(5);
+  BOOST_CHECK_EQUAL(2, count_buffers(out));
+  BOOST_CHECK_EQUAL(5, asio::buffer_size(out));
+  asio::buffer_copy(out, asio::buffer("GHIJK", 5));
+  a.commit(5);
+
+  BOOST_CHECK_EQUAL(8, a.capacity());
+  BOOST_CHECK_EQUAL(7, a.size());
+  BOOST_CHECK_EQUAL(2, count_buffers(a.data()));
+  BOOST_CHECK_EQUAL("EFGHIJK", to_string(a.data()));
+  BOOST_CHECK_EQUAL('E', a[0]);
+  BOOST_CHECK_EQUAL('K', a[6]);
+
+  // Growing linearizes the data.
+  a.append("LMN", 3);
+  BOOST_CHECK_EQUAL(16, a.capacity());
+  BOOST_CHECK_EQUAL(1, count_buffers(a.data()));
+  BOOST_CHECK_EQUAL("EFGHIJKLMN", to_string(a.data()));
+
+  // Consuming everything starts over at the front.
+  a.consume(100);
+  BOOST_CHECK(a.empty());
+  BOOST_CHECK_EQUAL(1, count_buffers(a.prepare(16)));
+}
+
+BOOST_AUTO_TEST_CASE(commit_limits)
+{
+  circular_buffer a;
+  asio::buffer_copy(a.prepare(4), asio::buffer("ABCD", 4));
+  a.commit(10);
+  BOOST_CHECK_EQUAL("ABCD", to_string(a.data()));
+
+  // Nothing was prepared.
+  a.commit(10);
+  BOOST_CHECK_EQUAL(4, a.size());
+}
+
+BOOST_AUTO_TEST_CASE(copy_move)
+{
+  circular_buffer a(8);
+  a.append("ABCDEF", 6);
+  a.consume(4);
+  a.append("GHIJ", 4);
+
+  circular_buffer b(a);
+  BOOST_CHECK_EQUAL(1, count_buffers(b.data()));
+  BOOST_CHECK_EQUAL("EFGHIJ", to_string(b.data()));
+
+  circular_buffer c;
+  c = a;
+  BOOST_CHECK_EQUAL("EFGHIJ", to_string(c.data()));
+
+#if defined(ASIOEXT_HAS_MOVE)
+  circular_buffer d(std::move(a));
+  BOOST_CHECK_EQUAL(0, a.capacity());
+  BOOST_CHECK_EQUAL("EFGHIJ", to_string(d.data()));
+
+  c = std::move(d);
+  BOOST_CHECK_EQUAL(0, d.size());
+  BOOST_CHECK_EQUAL("EFGHIJ", to_string(c.data()));
+#endif
+}
+
+#if defined(ASIOEXT_HAS_MOVE)
+// Doesn't propagate on move assignment. Allocators with different tags
+// can't free each other's memory.
+template <typename T>
+struct tagged_allocator
+{
+  typedef T value_type;
+
+  explicit tagged_allocator(int tag)
+    : tag(tag)
+  {
+    // ctor
+  }
+
+  template <typename U>
+  tagged_allocator(const tagged_allocator<U>& other)
+    : tag(other.tag)
+  {
+    // ctor
+  }
+
+  T* allocate(std::size_t n)
+  {
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  std::size_t max_size() const
+  {
+    return 1000 * tag;
+  }
+
+  int tag;
+};
+
+template <typename T, typename U>
+bool operator==(const tagged_allocator<T>& a, const tagged_allocator<U>& b)
+{
+  return a.tag == b.tag;
+}
+
+template <typename T, typename U>
+bool operator!=(const tagged_allocator<T>& a, const tagged_allocator<U>& b)
+{
+  return a.tag != b.tag;
+}
+
+BOOST_AUTO_TEST_CASE(move_assign_allocator)
+{
+  typedef basic_circular_buffer<tagged_allocator<uint8_t> > tagged_buffer;
+
+  // Moving may have to copy, so it's only noexcept if the allocator
+  // propagates.
+  BOOST_STATIC_ASSERT(std::is_nothrow_move_assignable<circular_buffer>::value);
+  BOOST_STATIC_ASSERT(!std::is_nothrow_move_assignable<tagged_buffer>::value);
+
+  tagged_buffer a((tagged_allocator<uint8_t>(1)));
+  a.append("ABCDEF", 6);
+  tagged_buffer b((tagged_allocator<uint8_t>(2)));
+
+  b = std::move(a);
+  BOOST_CHECK_EQUAL(2, b.get_allocator().tag);
+  BOOST_CHECK_EQUAL("ABCDEF", to_string(b.data()));
+  BOOST_CHECK_EQUAL(a.max_size(), b.max_size());
+  BOOST_CHECK_EQUAL(0, a.size());
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(dynamic_buffer)
+{
+  circular_buffer a;
+  dynamic_circular_buffer<circular_buffer> x1 = asioext::dynamic_buffer(a, 4);
+  BOOST_CHECK_EQUAL(4, x1.max_size());
+
+  asio::buffer_copy(x1.prepare(3), asio::buffer("ABC", 3));
+  x1.commit(3);
+  BOOST_CHECK_EQUAL(3, x1.size());
+  BOOST_CHECK_THROW(x1.prepare(2), std::length_error);
+
+  error_code ec;
+  x1.prepare(2, ec);
+  BOOST_CHECK_EQUAL(asio::error::no_memory, ec);
+
+  x1.consume(2);
+  x1.prepare(3, ec);
+  BOOST_CHECK(!ec);
+
+  // The data outlives the adapter.
+  BOOST_CHECK_EQUAL("C", to_string(a.data()));
+}
+
+#if defined(ASIOEXT_HAS_MIRRORED_MEMORY)
+BOOST_AUTO_TEST_CASE(mirrored)
+{
+  mirrored_circular_buffer a;
+  BOOST_CHECK_EQUAL(0, a.capacity());
+
+  asio::buffer_copy(a.prepare(10), asio::buffer("0123456789", 10));
+  a.commit(10);
+  const std::size_t cap = a.capacity();
+  BOOST_REQUIRE_LE(10, cap);
+  BOOST_CHECK_EQUAL(0, cap & (cap - 1));
+
+  // Move the data to the end of the ring, so it has to wrap around.
+  a.consume(10);
+  std::vector<char> fill(cap - 4, 'x');
+  asio::buffer_copy(a.prepare(fill.size()), asio::buffer(fill));
+  a.commit(fill.size());
+  a.consume(fill.size());
+
+  asio::buffer_copy(a.prepare(10), asio::buffer("ABCDEFGHIJ", 10));
+  a.commit(10);
+  BOOST_CHECK_EQUAL(cap, a.capacity());
+  BOOST_CHECK_EQUAL("ABCDEFGHIJ", to_string(a.data()));
+
+  // Growing keeps the contents.
+  std::vector<char> big(cap, 'y');
+  asio::buffer_copy(a.prepare(big.size()), asio::buffer(big));
+  a.commit(big.size());
+  BOOST_CHECK_LT(cap, a.capacity());
+  BOOST_CHECK_EQUAL("ABCDEFGHIJyy",
+                    to_string(a.data()).substr(0, 12));
+
+  dynamic_circular_buffer<mirrored_circular_buffer> x1 =
+      asioext::dynamic_buffer(a, cap);
+  BOOST_CHECK_THROW(x1.prepare(1), std::length_error);
+
+#if defined(ASIOEXT_HAS_MOVE)
+  mirrored_circular_buffer b(std::move(a));
+  BOOST_CHECK_EQUAL(0, a.capacity());
+  BOOST_CHECK_EQUAL(10 + cap, b.size());
+#endif
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -1,5 +1,7 @@
 #include "asioext/composed_operation.hpp"
 
+#include "asioext/detail/handler_work.hpp"
+
 #if (ASIOEXT_ASIO_VERSION >= 101100)
 # if defined(ASIOEXT_USE_BOOST_ASIO)
 #  include <boost/asio/io_context.hpp>
@@ -55,7 +57,7 @@ void* asio_handler_allocate(std::size_t size,
   return std::malloc(size);
 }
 
-void asio_handler_deallocate(void* pointer, std::size_t size,
+void asio_handler_deallocate(void* pointer, std::size_t /*size*/,
     simple_handler* this_handler)
 {
   ++this_handler->deallocate_count;
@@ -170,6 +172,157 @@ BOOST_AUTO_TEST_CASE(make_composed_op)
   test_make_composed_op_aux(make_composed_operation(
     simple_handler(), test_make_composed_op_operation()));
 }
+
+struct chain_handler
+{
+  void operator()(int steps)
+  {
+    *result = steps;
+  }
+
+  int* result;
+  int* allocate_count;
+};
+
+void* asio_handler_allocate(std::size_t size,
+    chain_handler* this_handler)
+{
+  ++*this_handler->allocate_count;
+  return std::malloc(size);
+}
+
+void asio_handler_deallocate(void* pointer, std::size_t /*size*/,
+    chain_handler* /*this_handler*/)
+{
+  std::free(pointer);
+}
+
+struct chain_operation
+{
+  template <typename Self>
+  void operator()(Self& self)
+  {
+    if (++steps != 5) {
+      detail::post_handler(ctx, std::move(self));
+      return;
+    }
+    self.complete(steps);
+  }
+
+  asio::io_context& ctx;
+  int steps;
+};
+
+BOOST_AUTO_TEST_CASE(allocate_composed_op)
+{
+  int result = 0;
+  int allocate_count = 0;
+
+  asio::io_context ctx;
+  allocate_composed_operation(chain_handler{&result, &allocate_count},
+                              chain_operation{ctx, 0})();
+  BOOST_CHECK_EQUAL(0, result);
+  ctx.run();
+
+  // All steps used the memory of the operation's state.
+  BOOST_CHECK_EQUAL(5, result);
+  BOOST_CHECK_EQUAL(0, allocate_count);
+
+  // Pending steps are destroyed along with the state.
+  {
+    asio::io_context ctx2;
+    allocate_composed_operation(chain_handler{&result, &allocate_count},
+                                chain_operation{ctx2, 0})();
+  }
+  BOOST_CHECK_EQUAL(5, result);
+}
+
+#if (ASIOEXT_ASIO_VERSION >= 101200)
+template <typename T>
+struct tracking_allocator
+{
+  typedef T value_type;
+
+  explicit tracking_allocator(std::size_t* outstanding)
+    : outstanding(outstanding)
+  {
+    // ctor
+  }
+
+  template <typename U>
+  tracking_allocator(const tracking_allocator<U>& other)
+    : outstanding(other.outstanding)
+  {
+    // ctor
+  }
+
+  T* allocate(std::size_t n)
+  {
+    ++*outstanding;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    --*outstanding;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  std::size_t* outstanding;
+};
+
+template <typename T, typename U>
+bool operator==(const tracking_allocator<T>& a,
+                const tracking_allocator<U>& b)
+{
+  return a.outstanding == b.outstanding;
+}
+
+template <typename T, typename U>
+bool operator!=(const tracking_allocator<T>& a,
+                const tracking_allocator<U>& b)
+{
+  return a.outstanding != b.outstanding;
+}
+
+struct tracking_handler
+{
+  typedef tracking_allocator<void> allocator_type;
+
+  allocator_type get_allocator() const ASIOEXT_NOEXCEPT
+  {
+    return allocator_type(outstanding);
+  }
+
+  void operator()(int steps)
+  {
+    *result = steps;
+    *outstanding_in_upcall = *outstanding;
+  }
+
+  std::size_t* outstanding;
+  std::size_t* outstanding_in_upcall;
+  int* result;
+};
+
+BOOST_AUTO_TEST_CASE(allocate_composed_op_upcall)
+{
+  std::size_t outstanding = 0;
+  std::size_t outstanding_in_upcall = 1;
+  int result = 0;
+
+  // The state is freed before the handler is invoked.
+  asio::io_context ctx;
+  tracking_handler h = {&outstanding, &outstanding_in_upcall, &result};
+  allocate_composed_operation(h, chain_operation{ctx, 0})();
+  BOOST_CHECK_EQUAL(1, outstanding);
+  ctx.run();
+
+  BOOST_CHECK_EQUAL(5, result);
+  BOOST_CHECK_EQUAL(0, outstanding_in_upcall);
+  BOOST_CHECK_EQUAL(0, outstanding);
+}
+#endif
 #endif
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,404 @@
+#include "asioext/connect.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# if ASIOEXT_ASIO_VERSION >= 101200
+#  include <boost/asio/bind_executor.hpp>
+#  include <boost/asio/strand.hpp>
+# endif
+#else
+# include <asio/io_service.hpp>
+# if ASIOEXT_ASIO_VERSION >= 101200
+#  include <asio/bind_executor.hpp>
+#  include <asio/strand.hpp>
+# endif
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_connect)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+typedef std::vector<asio::ip::tcp::endpoint> endpoint_list;
+
+static asio::ip::tcp::endpoint loopback(unsigned short port = 0)
+{
+  return asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), port);
+}
+
+// Returns an endpoint nobody listens on.
+static asio::ip::tcp::endpoint refusing_endpoint(asio::io_service& io_service)
+{
+  asio::ip::tcp::acceptor acceptor(io_service, loopback());
+  return acceptor.local_endpoint();
+}
+
+BOOST_AUTO_TEST_CASE(connect_resolve)
+{
+  asio::io_service io_service;
+  asio::ip::tcp::acceptor acceptor(io_service, loopback());
+  asio::ip::tcp::socket peer(io_service);
+  acceptor.async_accept(peer, [] (error_code ec) {
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+  });
+
+  asio::ip::tcp::resolver resolver(io_service);
+  asio::ip::tcp::resolver::query q(
+      "127.0.0.1", std::to_string(acceptor.local_endpoint().port()),
+      asio::ip::tcp::resolver::query::numeric_service);
+
+  asio::ip::tcp::socket socket(io_service);
+  bool called = false;
+  asioext::async_connect(socket, resolver, q,
+      [&] (error_code ec, asio::ip::tcp::resolver::iterator it) {
+    called = true;
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+    BOOST_REQUIRE(it != asio::ip::tcp::resolver::iterator());
+    BOOST_CHECK_EQUAL(it->endpoint(), acceptor.local_endpoint());
+  });
+
+  io_service.run();
+  BOOST_CHECK(called);
+  BOOST_CHECK(socket.is_open());
+  BOOST_CHECK_EQUAL(socket.remote_endpoint(), acceptor.local_endpoint());
+}
+
+BOOST_AUTO_TEST_CASE(connect_empty)
+{
+  asio::io_service io_service;
+  asio::ip::tcp::socket socket(io_service);
+
+  endpoint_list endpoints;
+  bool called = false;
+  asioext::async_connect(socket, endpoints.begin(), endpoints.end(),
+                         std::chrono::milliseconds(10),
+      [&] (error_code ec, endpoint_list::iterator it) {
+    called = true;
+    BOOST_CHECK_MESSAGE(ec == asio::error::not_found, "ec: " << ec);
+    BOOST_CHECK(it == endpoints.end());
+  });
+
+  BOOST_CHECK(!called);
+  io_service.run();
+  BOOST_CHECK(called);
+}
+
+BOOST_AUTO_TEST_CASE(connect_all_fail)
+{
+  asio::io_service io_service;
+  asio::ip::tcp::socket socket(io_service);
+
+  endpoint_list endpoints;
+  endpoints.push_back(refusing_endpoint(io_service));
+  endpoints.push_back(refusing_endpoint(io_service));
+
+  bool called = false;
+  asioext::async_connect(socket, endpoints.begin(), endpoints.end(),
+                         std::chrono::seconds(10),
+      [&] (error_code ec, endpoint_list::iterator it) {
+    called = true;
+    BOOST_CHECK_MESSAGE(ec == asio::error::connection_refused,
+                        "ec: " << ec);
+    BOOST_CHECK(it == endpoints.end());
+  });
+
+  io_service.run();
+  BOOST_CHECK(called);
+}
+
+BOOST_AUTO_TEST_CASE(connect_failed_attempt)
+{
+  asio::io_service io_service;
+  asio::ip::tcp::acceptor acceptor(io_service, loopback());
+  asio::ip::tcp::socket peer(io_service);
+  acceptor.async_accept(peer, [] (error_code ec) {
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+  });
+
+  endpoint_list endpoints;
+  endpoints.push_back(refusing_endpoint(io_service));
+  endpoints.push_back(acceptor.local_endpoint());
+
+  // A failed attempt immediately starts the next one, so the long delay
+  // must not matter.
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+
+  asio::ip::tcp::socket socket(io_service);
+  bool called = false;
+  asioext::async_connect(socket, endpoints.begin(), endpoints.end(),
+                         std::chrono::seconds(30),
+      [&] (error_code ec, endpoint_list::iterator it) {
+    called = true;
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+    BOOST_CHECK(it == endpoints.begin() + 1);
+  });
+
+  io_service.run();
+  BOOST_CHECK(called);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start <
+              std::chrono::seconds(10));
+  BOOST_CHECK_EQUAL(socket.remote_endpoint(), acceptor.local_endpoint());
+}
+
+BOOST_AUTO_TEST_CASE(connect_race)
+{
+  asio::io_service io_service;
+
+  // Connections to an acceptor whose backlog is full don't complete.
+  asio::ip::tcp::acceptor stalled(io_service, loopback());
+  stalled.listen(0);
+  asio::ip::tcp::socket filler(io_service);
+  filler.connect(stalled.local_endpoint());
+
+  asio::ip::tcp::acceptor acceptor(io_service, loopback());
+  asio::ip::tcp::socket peer(io_service);
+  acceptor.async_accept(peer, [&] (error_code ec) {
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+  });
+
+  endpoint_list endpoints;
+  endpoints.push_back(stalled.local_endpoint());
+  endpoints.push_back(acceptor.local_endpoint());
+
+  asio::ip::tcp::socket socket(io_service);
+  bool called = false;
+  asioext::async_connect(socket, endpoints.begin(), endpoints.end(),
+                         std::chrono::milliseconds(50),
+      [&] (error_code ec, endpoint_list::iterator it) {
+    called = true;
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+    BOOST_CHECK(it == endpoints.begin() + 1);
+  });
+
+  // Returns once the stalled attempt was cancelled.
+  io_service.run();
+  BOOST_CHECK(called);
+  BOOST_CHECK_EQUAL(socket.remote_endpoint(), acceptor.local_endpoint());
+}
+
+BOOST_AUTO_TEST_CASE(connect_close_during_attempt)
+{
+  asio::io_service io_service;
+  asio::ip::tcp::acceptor acceptor(io_service, loopback());
+
+  endpoint_list endpoints;
+  endpoints.push_back(refusing_endpoint(io_service));
+  endpoints.push_back(acceptor.local_endpoint());
+
+  asio::ip::tcp::socket socket(io_service);
+  bool called = false;
+  asioext::async_connect(socket, endpoints.begin(), endpoints.end(),
+                         std::chrono::seconds(30),
+      [&] (error_code ec, endpoint_list::iterator it) {
+    called = true;
+    BOOST_CHECK_MESSAGE(ec == asio::error::operation_aborted, "ec: " << ec);
+    BOOST_CHECK(it == endpoints.end());
+  });
+
+  // The first attempt is already running, so its failure must not start
+  // the second one. The long delay must not matter either.
+  io_service.post([&] () {
+    socket.close();
+  });
+
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+
+  io_service.run();
+  BOOST_CHECK(called);
+  BOOST_CHECK(!socket.is_open());
+  BOOST_CHECK(std::chrono::steady_clock::now() - start <
+              std::chrono::seconds(10));
+}
+
+BOOST_AUTO_TEST_CASE(connect_threads)
+{
+  asio::io_service io_service;
+  asio::ip::tcp::acceptor acceptor(io_service, loopback());
+
+  endpoint_list endpoints;
+  endpoints.push_back(refusing_endpoint(io_service));
+  endpoints.push_back(refusing_endpoint(io_service));
+  endpoints.push_back(acceptor.local_endpoint());
+
+  const std::size_t count = 32;
+
+  // Only one accept is outstanding at a time, so the acceptor is never
+  // used by two threads at once.
+  std::deque<asio::ip::tcp::socket> peers;
+  for (std::size_t i = 0; i != count; ++i)
+    peers.emplace_back(io_service);
+
+  std::size_t accepted = 0;
+  std::function<void (error_code)> on_accept = [&] (error_code ec) {
+    if (ec || ++accepted == count)
+      return;
+    acceptor.async_accept(peers[accepted], on_accept);
+  };
+  acceptor.async_accept(peers[0], on_accept);
+
+  // The short delay makes timers, failed and successful attempts of the
+  // same operation complete on different threads at the same time.
+  std::deque<asio::ip::tcp::socket> sockets;
+  std::vector<error_code> results(count, asio::error::would_block);
+  std::vector<endpoint_list::iterator> winners(count, endpoints.end());
+  std::atomic<std::size_t> calls(0);
+  for (std::size_t i = 0; i != count; ++i) {
+    sockets.emplace_back(io_service);
+    asioext::async_connect(sockets[i], endpoints.begin(), endpoints.end(),
+                           std::chrono::milliseconds(1),
+        [&, i] (error_code ec, endpoint_list::iterator it) {
+      ++calls;
+      results[i] = ec;
+      winners[i] = it;
+    });
+  }
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i != 4; ++i)
+    threads.emplace_back([&io_service] () { io_service.run(); });
+  for (std::size_t i = 0; i != threads.size(); ++i)
+    threads[i].join();
+
+  BOOST_CHECK_EQUAL(count, calls.load());
+  BOOST_CHECK_EQUAL(count, accepted);
+  for (std::size_t i = 0; i != count; ++i) {
+    BOOST_CHECK_MESSAGE(!results[i], "ec: " << results[i]);
+    BOOST_CHECK(winners[i] == endpoints.begin() + 2);
+    BOOST_CHECK(sockets[i].is_open());
+  }
+}
+
+#if ASIOEXT_ASIO_VERSION >= 101200
+template <typename T>
+struct counting_allocator
+{
+  typedef T value_type;
+
+  explicit counting_allocator(std::size_t* count)
+    : count(count)
+  {
+    // ctor
+  }
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other)
+    : count(other.count)
+  {
+    // ctor
+  }
+
+  T* allocate(std::size_t n)
+  {
+    ++*count;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  std::size_t* count;
+};
+
+template <typename T, typename U>
+bool operator==(const counting_allocator<T>& a,
+                const counting_allocator<U>& b)
+{
+  return a.count == b.count;
+}
+
+template <typename T, typename U>
+bool operator!=(const counting_allocator<T>& a,
+                const counting_allocator<U>& b)
+{
+  return a.count != b.count;
+}
+
+typedef asio::strand<asio::io_service::executor_type> strand_type;
+
+struct strand_handler
+{
+  typedef counting_allocator<void> allocator_type;
+
+  allocator_type get_allocator() const ASIOEXT_NOEXCEPT
+  {
+    return allocator_type(allocations);
+  }
+
+  void operator()(error_code ec, endpoint_list::iterator it)
+  {
+    *called = true;
+    BOOST_CHECK(strand->running_in_this_thread());
+    BOOST_CHECK_EQUAL(ec, expected_ec);
+    BOOST_CHECK(it == expected_it);
+  }
+
+  strand_type* strand;
+  std::size_t* allocations;
+  bool* called;
+  error_code expected_ec;
+  endpoint_list::iterator expected_it;
+};
+
+BOOST_AUTO_TEST_CASE(connect_executor)
+{
+  asio::io_service io_service;
+  strand_type strand(io_service.get_executor());
+  asio::ip::tcp::acceptor acceptor(io_service, loopback());
+  asio::ip::tcp::socket peer(io_service);
+  acceptor.async_accept(peer, [] (error_code ec) {
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+  });
+
+  endpoint_list endpoints;
+  endpoints.push_back(refusing_endpoint(io_service));
+  endpoints.push_back(acceptor.local_endpoint());
+
+  // The handler runs on its strand, the operation's state is allocated
+  // with its allocator.
+  asio::ip::tcp::socket socket(io_service);
+  std::size_t allocations = 0;
+  bool called = false;
+  strand_handler h = {&strand, &allocations, &called, error_code(),
+                      endpoints.begin() + 1};
+  asioext::async_connect(socket, endpoints.begin(), endpoints.end(),
+                         std::chrono::seconds(10),
+                         asio::bind_executor(strand, h));
+
+  io_service.run();
+  BOOST_CHECK(called);
+  BOOST_CHECK_NE(allocations, 0);
+
+  // Immediate completions are posted to the strand as well.
+  endpoint_list empty;
+  called = false;
+  h.expected_ec = asio::error::not_found;
+  h.expected_it = empty.end();
+  asioext::async_connect(socket, empty.begin(), empty.end(),
+                         std::chrono::seconds(10),
+                         asio::bind_executor(strand, h));
+  BOOST_CHECK(!called);
+
+  io_service.restart();
+  io_service.run();
+  BOOST_CHECK(called);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,277 @@
+#include "asioext/connection_pool.hpp"
+#include "asioext/socks/server.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+#else
+# include <asio/io_service.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <list>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_connection_pool)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+// Accepts connections and keeps them open.
+struct test_server
+{
+  explicit test_server(asio::io_service& io_service)
+    : acceptor(io_service, asio::ip::tcp::endpoint(
+          asio::ip::address_v4::loopback(), 0))
+  {
+    accept();
+  }
+
+  void accept()
+  {
+    peers.emplace_back(acceptor.get_io_service());
+    acceptor.async_accept(peers.back(), [this] (error_code ec) {
+      if (!ec)
+        accept();
+    });
+  }
+
+  // The last socket is still waiting to be accepted.
+  std::size_t accepted() const
+  {
+    return peers.size() - 1;
+  }
+
+  connection_key key() const
+  {
+    return connection_key("127.0.0.1", acceptor.local_endpoint().port());
+  }
+
+  asio::ip::tcp::acceptor acceptor;
+  std::list<asio::ip::tcp::socket> peers;
+};
+
+static void acquire(connection_pool& pool, const connection_key& key,
+                    pooled_connection& conn, error_code& ec)
+{
+  asio::io_service& io_service = conn.socket().get_io_service();
+  bool called = false;
+  pool.async_acquire(key, conn, [&] (error_code ec2) {
+    ec = ec2;
+    called = true;
+  });
+  io_service.reset();
+  while (!called && io_service.run_one())
+    ;
+  BOOST_REQUIRE(called);
+}
+
+BOOST_AUTO_TEST_CASE(connection_pool_reuse)
+{
+  asio::io_service io_service;
+  test_server server(io_service);
+  connection_pool pool(io_service);
+
+  error_code ec;
+  {
+    pooled_connection conn(io_service);
+    acquire(pool, server.key(), conn, ec);
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+    BOOST_CHECK(!conn.empty());
+    BOOST_CHECK(!conn.reused());
+    BOOST_CHECK(conn.key() == server.key());
+    BOOST_CHECK(conn.socket().is_open());
+    BOOST_CHECK_EQUAL(pool.connection_count(server.key()), 1);
+    BOOST_CHECK_EQUAL(pool.idle_count(server.key()), 0);
+  }
+  BOOST_CHECK_EQUAL(pool.idle_count(server.key()), 1);
+
+  pooled_connection conn(io_service);
+  acquire(pool, server.key(), conn, ec);
+  BOOST_REQUIRE_EQUAL(ec, error_code());
+  BOOST_CHECK(conn.reused());
+  BOOST_CHECK_EQUAL(pool.connection_count(server.key()), 1);
+  BOOST_CHECK_EQUAL(server.accepted(), 1);
+
+  conn.discard();
+  BOOST_CHECK(conn.empty());
+  BOOST_CHECK(!conn.socket().is_open());
+  BOOST_CHECK_EQUAL(pool.connection_count(server.key()), 0);
+}
+
+BOOST_AUTO_TEST_CASE(connection_pool_validate)
+{
+  asio::io_service io_service;
+  test_server server(io_service);
+  connection_pool pool(io_service);
+
+  error_code ec;
+  pooled_connection conn(io_service);
+  acquire(pool, server.key(), conn, ec);
+  BOOST_REQUIRE_EQUAL(ec, error_code());
+  conn.release();
+  BOOST_CHECK_EQUAL(pool.idle_count(server.key()), 1);
+
+  // The peer closes the idle connection.
+  server.peers.front().close();
+  acquire(pool, server.key(), conn, ec);
+  BOOST_REQUIRE_EQUAL(ec, error_code());
+  BOOST_CHECK(!conn.reused());
+  BOOST_CHECK_EQUAL(server.accepted(), 2);
+  BOOST_CHECK_EQUAL(pool.connection_count(server.key()), 1);
+}
+
+BOOST_AUTO_TEST_CASE(connection_pool_idle_timeout)
+{
+  asio::io_service io_service;
+  test_server server(io_service);
+  connection_pool pool(io_service, 6, chrono::seconds(0));
+
+  error_code ec;
+  pooled_connection conn(io_service);
+  acquire(pool, server.key(), conn, ec);
+  BOOST_REQUIRE_EQUAL(ec, error_code());
+  conn.release();
+
+  acquire(pool, server.key(), conn, ec);
+  BOOST_REQUIRE_EQUAL(ec, error_code());
+  BOOST_CHECK(!conn.reused());
+  BOOST_CHECK_EQUAL(pool.connection_count(server.key()), 1);
+}
+
+BOOST_AUTO_TEST_CASE(connection_pool_limit)
+{
+  asio::io_service io_service;
+  test_server server(io_service);
+  connection_pool pool(io_service, 1);
+
+  error_code ec;
+  pooled_connection first(io_service);
+  acquire(pool, server.key(), first, ec);
+  BOOST_REQUIRE_EQUAL(ec, error_code());
+
+  pooled_connection second(io_service);
+  bool called = false;
+  pool.async_acquire(server.key(), second, [&] (error_code ec) {
+    BOOST_CHECK_EQUAL(ec, error_code());
+    called = true;
+  });
+
+  io_service.reset();
+  io_service.poll();
+  BOOST_CHECK(!called);
+  BOOST_CHECK_EQUAL(pool.connection_count(server.key()), 1);
+
+  first.release();
+  io_service.poll();
+  BOOST_CHECK(called);
+  BOOST_CHECK(second.reused());
+  BOOST_CHECK_EQUAL(server.accepted(), 1);
+
+  // Discarding the connection gives the slot to the next request.
+  pooled_connection third(io_service);
+  called = false;
+  pool.async_acquire(server.key(), third, [&] (error_code ec) {
+    BOOST_CHECK_EQUAL(ec, error_code());
+    called = true;
+  });
+  second.discard();
+  while (!called && io_service.run_one())
+    ;
+  BOOST_CHECK(called);
+  BOOST_CHECK(!third.reused());
+}
+
+BOOST_AUTO_TEST_CASE(connection_pool_error)
+{
+  asio::io_service io_service;
+  connection_key key;
+  {
+    test_server server(io_service);
+    key = server.key();
+  }
+
+  connection_pool pool(io_service);
+  error_code ec;
+  pooled_connection conn(io_service);
+  acquire(pool, key, conn, ec);
+  BOOST_CHECK_MESSAGE(ec == asio::error::connection_refused, "ec: " << ec);
+  BOOST_CHECK(conn.empty());
+  BOOST_CHECK_EQUAL(pool.connection_count(key), 0);
+}
+
+BOOST_AUTO_TEST_CASE(connection_pool_close)
+{
+  asio::io_service io_service;
+  test_server server(io_service);
+
+  pooled_connection first(io_service);
+  pooled_connection second(io_service);
+  bool called = false;
+  {
+    connection_pool pool(io_service, 1);
+
+    error_code ec;
+    acquire(pool, server.key(), first, ec);
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+
+    pool.async_acquire(server.key(), second, [&] (error_code ec) {
+      BOOST_CHECK_MESSAGE(ec == asio::error::operation_aborted,
+                          "ec: " << ec);
+      called = true;
+    });
+  }
+
+  io_service.reset();
+  io_service.poll();
+  BOOST_CHECK(called);
+  BOOST_CHECK(second.empty());
+
+  // Returning a connection to a closed pool closes it.
+  first.release();
+  BOOST_CHECK(!first.socket().is_open());
+}
+
+BOOST_AUTO_TEST_CASE(connection_pool_proxy)
+{
+  asio::io_service io_service;
+  test_server server(io_service);
+
+  socks::server proxy(io_service, asio::ip::tcp::endpoint(
+      asio::ip::address_v4::loopback(), 0));
+  proxy.start();
+
+  connection_pool pool(io_service);
+  const connection_key key("127.0.0.1", server.key().port,
+                           proxy.local_endpoint());
+  BOOST_CHECK(key.uses_proxy());
+  BOOST_CHECK(!(key == server.key()));
+
+  pool.warm(key, 2);
+  BOOST_CHECK_EQUAL(pool.connection_count(key), 2);
+  io_service.reset();
+  while (pool.idle_count(key) != 2 && io_service.run_one())
+    ;
+  BOOST_CHECK_EQUAL(pool.idle_count(key), 2);
+
+  error_code ec;
+  pooled_connection conn(io_service);
+  acquire(pool, key, conn, ec);
+  BOOST_REQUIRE_EQUAL(ec, error_code());
+  BOOST_CHECK(conn.reused());
+  BOOST_CHECK_EQUAL(pool.connection_count(key), 2);
+  BOOST_CHECK_EQUAL(pool.idle_count(key), 1);
+
+  // Direct connections are kept apart.
+  BOOST_CHECK_EQUAL(pool.connection_count(server.key()), 0);
+
+  conn.discard();
+  pool.clear();
+  BOOST_CHECK_EQUAL(pool.connection_count(key), 0);
+  proxy.stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
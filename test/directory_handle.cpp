@@ -0,0 +1,245 @@
+#include "asioext/directory_handle.hpp"
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+
+#include "asioext/open.hpp"
+#include "asioext/thread_pool_file_service.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+#else
+# include <asio/io_service.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <sys/stat.h>
+
+#include <map>
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_directory_handle)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const char* test_dirname = "asioext_directory_handle_test";
+
+struct test_directory
+{
+  test_directory()
+  {
+    boost::filesystem::remove_all(test_dirname);
+    boost::filesystem::create_directory(test_dirname);
+    boost::filesystem::create_directory(std::string(test_dirname) + "/sub");
+    open(std::string(test_dirname) + "/a");
+    open(std::string(test_dirname) + "/b");
+  }
+
+  ~test_directory()
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(test_dirname, ec);
+  }
+
+  static void open(const std::string& filename)
+  {
+    asioext::open(filename.c_str(), open_flags::access_write |
+                                    open_flags::create_always);
+  }
+};
+
+typedef std::map<std::string, file_type> entry_map;
+
+static uint64_t inode_of(const std::string& filename)
+{
+  struct stat st;
+  BOOST_REQUIRE_EQUAL(0, ::stat(filename.c_str(), &st));
+  return st.st_ino;
+}
+
+static void add_entries(const directory_entries& entries, entry_map& names)
+{
+  for (directory_entries::const_iterator it = entries.begin();
+       it != entries.end(); ++it) {
+    BOOST_CHECK_MESSAGE(names.count(it->name()) == 0, it->name());
+    names[it->name()] = it->type();
+
+    if (it->name() == std::string("a") || it->name() == std::string("sub")) {
+      BOOST_CHECK_EQUAL(inode_of(std::string(test_dirname) + "/" + it->name()),
+                        it->inode());
+    }
+  }
+}
+
+static void check_entries(const entry_map& names)
+{
+  BOOST_REQUIRE_EQUAL(5, names.size());
+  BOOST_CHECK(names.count(".") == 1);
+  BOOST_CHECK(names.count("..") == 1);
+
+  // Some file systems don't report entry types.
+  const entry_map::const_iterator a = names.find("a");
+  const entry_map::const_iterator sub = names.find("sub");
+  BOOST_REQUIRE(a != names.end());
+  BOOST_REQUIRE(sub != names.end());
+  BOOST_REQUIRE(names.count("b") == 1);
+  BOOST_CHECK(a->second == file_type::regular ||
+              a->second == file_type::unknown);
+  BOOST_CHECK(sub->second == file_type::directory ||
+              sub->second == file_type::unknown);
+}
+
+BOOST_AUTO_TEST_CASE(directory_handle_read_entries)
+{
+  test_directory dir_guard;
+
+  directory_handle dir;
+  BOOST_CHECK(!dir.is_open());
+  dir.open(test_dirname, open_flags::access_read | open_flags::open_existing);
+  BOOST_REQUIRE(dir.is_open());
+
+  // Large enough for all entries at once.
+  char buffer[4096];
+  entry_map names;
+  directory_entries entries = dir.read_entries(asio::buffer(buffer));
+  BOOST_CHECK(!entries.empty());
+  add_entries(entries, names);
+  check_entries(names);
+
+  entries = dir.read_entries(asio::buffer(buffer));
+  BOOST_CHECK(entries.empty());
+  BOOST_CHECK(entries.begin() == entries.end());
+
+  // A buffer that holds only a few entries requires multiple batches.
+  // The offset makes sure unaligned buffers work, too.
+  dir.rewind();
+  names.clear();
+  int batches = 0;
+  for (;; ++batches) {
+    entries = dir.read_entries(asio::buffer(buffer + 1, 64));
+    if (entries.empty())
+      break;
+    add_entries(entries, names);
+  }
+  BOOST_CHECK_GT(batches, 1);
+  check_entries(names);
+
+  // The buffer is too small for any entry.
+  error_code ec;
+  dir.rewind();
+  entries = dir.read_entries(asio::buffer(buffer, 8), ec);
+  BOOST_CHECK(ec);
+  BOOST_CHECK(entries.empty());
+
+  dir.close();
+  BOOST_CHECK(!dir.is_open());
+}
+
+BOOST_AUTO_TEST_CASE(directory_handle_open)
+{
+  test_directory dir_guard;
+
+  error_code ec;
+  directory_handle dir;
+  dir.open("asioext_directory_handle_nonexistent",
+           open_flags::access_read | open_flags::open_existing, ec);
+  BOOST_CHECK(ec);
+  BOOST_CHECK(!dir.is_open());
+
+  // Regular files can't be opened as directories.
+  dir.open((std::string(test_dirname) + "/a").c_str(),
+           open_flags::access_read | open_flags::open_existing, ec);
+  BOOST_CHECK(ec);
+  BOOST_CHECK(!dir.is_open());
+
+  dir.open(test_dirname, open_flags::access_read | open_flags::open_existing,
+           ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  // Paths relative to |dir|.
+  unique_file_handle file = open(dir, "a", open_flags::access_read |
+                                           open_flags::open_existing, ec);
+  BOOST_CHECK_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK(file.is_open());
+
+  file = open(dir, "c", open_flags::access_write | open_flags::create_new);
+  BOOST_CHECK(file.is_open());
+  BOOST_CHECK(boost::filesystem::exists(std::string(test_dirname) + "/c"));
+
+  open(dir, "c", open_flags::access_write | open_flags::create_new, ec);
+  BOOST_CHECK(ec);
+
+  directory_handle sub;
+  sub.open(dir, "sub", open_flags::access_read | open_flags::open_existing);
+  BOOST_CHECK(sub.is_open());
+
+  char buffer[4096];
+  int count = 0;
+  const directory_entries entries = sub.read_entries(asio::buffer(buffer));
+  for (directory_entries::const_iterator it = entries.begin();
+       it != entries.end(); ++it)
+    ++count;
+  BOOST_CHECK_EQUAL(2, count);
+
+  // A handle can be replaced by one of its subdirectories.
+  dir.open(dir, "sub", open_flags::access_read | open_flags::open_existing);
+  BOOST_CHECK(dir.is_open());
+
+  directory_handle moved(std::move(dir));
+  BOOST_CHECK(!dir.is_open());
+  BOOST_CHECK(moved.is_open());
+}
+
+BOOST_AUTO_TEST_CASE(directory_handle_async_read_entries)
+{
+  test_directory dir_guard;
+
+  asio::io_service io_service;
+  thread_pool_file_service& service =
+      asio::use_service<thread_pool_file_service>(io_service);
+
+  directory_handle dir;
+  dir.open(test_dirname, open_flags::access_read | open_flags::open_existing);
+
+  char buffer[64];
+  entry_map names;
+  bool done = false;
+
+  struct reader
+  {
+    void operator()(error_code ec, directory_entries entries)
+    {
+      BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+      if (entries.empty()) {
+        *done = true;
+        return;
+      }
+
+      add_entries(entries, *names);
+      service->async_read_entries(*dir, asio::buffer(*buffer), *this);
+    }
+
+    thread_pool_file_service* service;
+    directory_handle* dir;
+    char (*buffer)[64];
+    entry_map* names;
+    bool* done;
+  };
+
+  reader r = { &service, &dir, &buffer, &names, &done };
+  service.async_read_entries(dir, asio::buffer(buffer), r);
+  io_service.run();
+
+  BOOST_CHECK(done);
+  check_entries(names);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
+
+#endif
@@ -13,7 +13,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <thread>
+#include <vector>
 
 ASIOEXT_NS_BEGIN
 
@@ -102,6 +104,71 @@ BOOST_AUTO_TEST_CASE(read_write)
   BOOST_REQUIRE_EQUAL(0, std::memcmp(test_data, buffer, test_data_size));
 }
 
+#if !defined(ASIOEXT_WINDOWS)
+BOOST_AUTO_TEST_CASE(read_write_many_buffers)
+{
+  test_file_rm_guard rguard1(test_filename);
+
+  // More buffers than a single readv()/writev() call accepts.
+  const std::size_t num_buffers = 3000;
+
+  std::vector<char> data(num_buffers * 2);
+  for (std::size_t i = 0; i != data.size(); ++i)
+    data[i] = static_cast<char>(i % 251);
+
+  std::vector<asio::const_buffer> in;
+  for (std::size_t i = 0; i != num_buffers; ++i) {
+    in.push_back(asio::buffer(&data[i * 2], 2));
+    in.push_back(asio::const_buffer()); // empty buffers are skipped
+  }
+
+  asioext::error_code ec;
+  asioext::unique_file_handle fh;
+  fh = asioext::open(test_filename,
+                     asioext::open_flags::access_read_write |
+                     asioext::open_flags::create_always, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  // Stream operations only transfer the first chunk, as a second call
+  // might block. Positional ones continue.
+  const std::size_t written = fh.write_some(in, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_REQUIRE(written != 0 && written < data.size());
+  BOOST_REQUIRE_EQUAL(data.size() - written,
+                      asio::write(fh, asio::buffer(&data[written],
+                                                   data.size() - written)));
+  BOOST_REQUIRE_EQUAL(data.size(), fh.write_some_at(data.size(), in, ec));
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  std::vector<char> out_data(data.size() * 2);
+  std::vector<asio::mutable_buffer> out;
+  for (std::size_t i = 0; i != num_buffers * 2; ++i)
+    out.push_back(asio::buffer(&out_data[i * 2], 2));
+
+  BOOST_REQUIRE_EQUAL(out_data.size(), fh.read_some_at(0, out, ec));
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK(std::equal(data.begin(), data.end(), out_data.begin()));
+  BOOST_CHECK(std::equal(data.begin(), data.end(),
+                         out_data.begin() + data.size()));
+
+  std::fill(out_data.begin(), out_data.end(), 0);
+  fh.seek(asioext::seek_origin::from_begin, data.size());
+  const std::size_t read = fh.read_some(out, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_REQUIRE(read != 0 && read < data.size());
+  BOOST_CHECK(std::equal(data.begin(), data.begin() + read,
+                         out_data.begin()));
+
+  // Data beyond EOF: the partial result is returned with eof.
+  BOOST_REQUIRE_EQUAL(data.size() - read, asio::read(fh, out, ec));
+  BOOST_REQUIRE_EQUAL(asio::error::eof, ec);
+  BOOST_CHECK(std::equal(data.begin() + read, data.end(), out_data.begin()));
+
+  BOOST_REQUIRE_EQUAL(0, fh.read_some(out, ec));
+  BOOST_REQUIRE_EQUAL(asio::error::eof, ec);
+}
+#endif
+
 BOOST_AUTO_TEST_CASE(position)
 {
   test_file_rm_guard rguard1(test_filename);
@@ -287,6 +354,46 @@ BOOST_AUTO_TEST_CASE(set_times_manual)
 #endif
 }
 
+BOOST_AUTO_TEST_CASE(get_status)
+{
+  test_file_rm_guard rguard1(test_filename);
+
+  asioext::error_code ec;
+  asioext::unique_file_handle fh = asioext::open(test_filename,
+    asioext::open_flags::access_write |
+    asioext::open_flags::create_always, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  BOOST_REQUIRE_EQUAL(test_data_size,
+                      asio::write(fh, asio::buffer(test_data,
+                                                   test_data_size)));
+
+  file_status st = fh.status(file_status_mask::all, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK(st.mask == file_status_mask::all);
+  BOOST_CHECK(st.type == file_type::regular);
+  BOOST_CHECK_EQUAL(test_data_size, st.size);
+  BOOST_CHECK(st.perms == fh.permissions());
+  BOOST_CHECK(st.attrs == fh.attributes());
+
+  const file_times times = fh.times();
+  BOOST_CHECK(st.atime == times.atime);
+  BOOST_CHECK(st.mtime == times.mtime);
+
+  // Only the requested members are set.
+  st = fh.status(file_status_mask::size);
+  BOOST_CHECK(st.mask == file_status_mask::size);
+  BOOST_CHECK_EQUAL(test_data_size, st.size);
+  BOOST_CHECK(st.type == file_type::unknown);
+  BOOST_CHECK(st.perms == file_perms::none);
+  BOOST_CHECK_EQUAL(0, st.mtime.time_since_epoch().count());
+
+  fh.close();
+  st = fh.status(file_status_mask::all, ec);
+  BOOST_CHECK(ec);
+  BOOST_CHECK(st.mask == file_status_mask::none);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ASIOEXT_NS_END
@@ -0,0 +1,116 @@
+#include "test_file_rm_guard.hpp"
+
+#include "asioext/file_io_observer.hpp"
+#include "asioext/unique_file_handle.hpp"
+#include "asioext/open.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/error.hpp>
+#else
+# include <asio/error.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+#if defined(ASIOEXT_ENABLE_FILE_IO_OBSERVER)
+
+BOOST_AUTO_TEST_SUITE(asioext_file_io_observer)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const char* test_filename = "asioext_fileioobserver_test";
+static const char test_data[] = "hello world!";
+static const std::size_t test_data_size = sizeof(test_data) - 1;
+
+class recording_observer : public file_io_observer
+{
+public:
+  recording_observer()
+    : previous_(set_file_io_observer(this))
+  {
+    // ctor
+  }
+
+  ~recording_observer()
+  {
+    set_file_io_observer(previous_);
+  }
+
+  void on_file_io(const file_io_event& ev) ASIOEXT_NOEXCEPT
+  {
+    events.push_back(ev);
+  }
+
+  std::vector<file_io_event> events;
+
+private:
+  file_io_observer* previous_;
+};
+
+BOOST_AUTO_TEST_CASE(install)
+{
+  BOOST_CHECK(get_file_io_observer() == 0);
+  {
+    recording_observer obs;
+    BOOST_CHECK(get_file_io_observer() == &obs);
+  }
+  BOOST_CHECK(get_file_io_observer() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(events)
+{
+  test_file_rm_guard rguard(test_filename);
+
+  recording_observer obs;
+
+  error_code ec;
+  unique_file_handle fh = open(test_filename,
+                               open_flags::access_read_write |
+                               open_flags::create_always, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  BOOST_REQUIRE_EQUAL(1, obs.events.size());
+  BOOST_CHECK(obs.events[0].operation == file_io_operation::open);
+  BOOST_CHECK(obs.events[0].handle == fh.get().native_handle());
+  BOOST_CHECK_EQUAL(test_filename, obs.events[0].path);
+  BOOST_CHECK(!obs.events[0].ec);
+
+  BOOST_REQUIRE_EQUAL(test_data_size,
+                      fh.write_some_at(5, asio::buffer(test_data,
+                                                       test_data_size)));
+  BOOST_REQUIRE_EQUAL(2, obs.events.size());
+  BOOST_CHECK(obs.events[1].operation == file_io_operation::write_at);
+  BOOST_CHECK_EQUAL(5, obs.events[1].offset);
+  BOOST_CHECK_EQUAL(test_data_size, obs.events[1].size);
+  BOOST_CHECK_EQUAL(test_data_size, obs.events[1].transferred);
+  BOOST_CHECK(obs.events[1].duration.count() >= 0);
+
+  char buffer[64];
+  BOOST_REQUIRE_EQUAL(test_data_size,
+                      fh.read_some_at(5, asio::buffer(buffer)));
+  BOOST_REQUIRE_EQUAL(3, obs.events.size());
+  BOOST_CHECK(obs.events[2].operation == file_io_operation::read_at);
+  BOOST_CHECK_EQUAL(sizeof(buffer), obs.events[2].size);
+  BOOST_CHECK_EQUAL(test_data_size, obs.events[2].transferred);
+
+  fh.read_some_at(5 + test_data_size, asio::buffer(buffer), ec);
+  BOOST_REQUIRE_EQUAL(4, obs.events.size());
+  BOOST_CHECK_EQUAL(0, obs.events[3].transferred);
+  BOOST_CHECK(obs.events[3].ec == asio::error::eof);
+
+  fh.close(ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_REQUIRE_EQUAL(5, obs.events.size());
+  BOOST_CHECK(obs.events[4].operation == file_io_operation::close);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
+
+ASIOEXT_NS_END
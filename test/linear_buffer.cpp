@@ -1,5 +1,8 @@
 #include "asioext/linear_buffer.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #include <boost/test/unit_test.hpp>
 
 ASIOEXT_NS_BEGIN
@@ -52,6 +55,169 @@ BOOST_AUTO_TEST_CASE(move)
 }
 #endif
 
+BOOST_AUTO_TEST_CASE(insert_erase)
+{
+  linear_buffer a;
+  a.append("HLO", 3);
+  a.insert(1, "EL", 2);
+  BOOST_REQUIRE_EQUAL(5, a.size());
+  BOOST_REQUIRE_EQUAL(std::string(reinterpret_cast<const char*>(a.data()), 5),
+                      "HELLO");
+
+  // Force the insertion to reallocate.
+  a.insert(5, " WORLD", 6);
+  a.insert(a.begin(), ">", 1);
+  BOOST_REQUIRE_EQUAL(12, a.size());
+  BOOST_REQUIRE_EQUAL(std::string(reinterpret_cast<const char*>(a.data()), 12),
+                      ">HELLO WORLD");
+
+  a.erase(a.begin());
+  a.erase(5, 11);
+  BOOST_REQUIRE_EQUAL(5, a.size());
+  BOOST_REQUIRE_EQUAL(std::string(reinterpret_cast<const char*>(a.data()), 5),
+                      "HELLO");
+}
+
+BOOST_AUTO_TEST_CASE(growth_policy)
+{
+  linear_buffer a;
+  BOOST_CHECK(linear_buffer_growth::factor_2 == a.growth_policy());
+  a.resize(100);
+  a.resize(101);
+  BOOST_CHECK_EQUAL(200, a.capacity());
+
+  linear_buffer b;
+  b.growth_policy(linear_buffer_growth::exact);
+  b.resize(100);
+  b.resize(101);
+  BOOST_CHECK_EQUAL(101, b.capacity());
+
+  linear_buffer c;
+  c.growth_policy(linear_buffer_growth::factor_1_5);
+  c.resize(100);
+  c.resize(101);
+  BOOST_CHECK_EQUAL(150, c.capacity());
+
+  linear_buffer d;
+  d.growth_policy(linear_buffer_growth::page_rounded);
+  d.resize(100);
+  BOOST_CHECK_EQUAL(4096, d.capacity());
+  d.resize(4097);
+  BOOST_CHECK_EQUAL(8192, d.capacity());
+
+  // The maximum size is never exceeded.
+  linear_buffer e(0, 5000);
+  e.growth_policy(linear_buffer_growth::page_rounded);
+  e.resize(4097);
+  BOOST_CHECK_EQUAL(5000, e.capacity());
+
+  // The policy is copied along with the data.
+  linear_buffer f(b);
+  BOOST_CHECK(linear_buffer_growth::exact == f.growth_policy());
+}
+
+BOOST_AUTO_TEST_CASE(shrink_to_fit)
+{
+  linear_buffer a;
+  a.append("HELLO", 5);
+  a.reserve(100);
+  BOOST_REQUIRE_LE(100, a.capacity());
+
+  a.shrink_to_fit();
+  BOOST_CHECK_EQUAL(5, a.capacity());
+  BOOST_REQUIRE_EQUAL(std::string(reinterpret_cast<const char*>(a.data()), 5),
+                      "HELLO");
+
+  a.clear();
+  a.shrink_to_fit();
+  BOOST_CHECK_EQUAL(0, a.capacity());
+}
+
+BOOST_AUTO_TEST_CASE(resize_uninitialized)
+{
+  linear_buffer a;
+  a.append("HELLO", 5);
+  a.resize_uninitialized(64);
+  BOOST_CHECK_EQUAL(64, a.size());
+  BOOST_REQUIRE_EQUAL(std::string(reinterpret_cast<const char*>(a.data()), 5),
+                      "HELLO");
+}
+
+BOOST_AUTO_TEST_CASE(find)
+{
+  linear_buffer a;
+  a.append("HELLO WORLD", 11);
+
+  BOOST_CHECK_EQUAL(2, a.find('L'));
+  BOOST_CHECK_EQUAL(3, a.find('L', 3));
+  BOOST_CHECK_EQUAL(9, a.find('L', 4));
+  BOOST_CHECK_EQUAL(linear_buffer::npos, a.find('X'));
+  BOOST_CHECK_EQUAL(linear_buffer::npos, a.find('H', 11));
+
+  BOOST_CHECK_EQUAL(6, a.find("WORLD", 5));
+  BOOST_CHECK_EQUAL(linear_buffer::npos, a.find("WORLDS", 6));
+  BOOST_CHECK_EQUAL(linear_buffer::npos, a.find("HELLO", 5, 1));
+  BOOST_CHECK_EQUAL(4, a.find("", 0, 4));
+  BOOST_CHECK_EQUAL(11, a.find("", 0, 11));
+  BOOST_CHECK_EQUAL(linear_buffer::npos, a.find("", 0, 12));
+
+  BOOST_CHECK_EQUAL(4, a.find_any(" O", 2));
+  BOOST_CHECK_EQUAL(5, a.find_any(" O", 2, 5));
+  BOOST_CHECK_EQUAL(linear_buffer::npos, a.find_any("xyz", 3));
+
+  linear_buffer empty;
+  BOOST_CHECK_EQUAL(linear_buffer::npos, empty.find('A'));
+  BOOST_CHECK_EQUAL(0, empty.find("", 0));
+}
+
+// Compare against the standard algorithms for all combinations of sizes and
+// match positions, so that the vector loops and their tails are covered.
+BOOST_AUTO_TEST_CASE(find_exhaustive)
+{
+  static const char needle[] = "\r\n\r\n";
+  static const char set[] = "\r\n\t\"<>&;:,.!?#";
+
+  for (std::size_t size = 0; size != 100; ++size) {
+    for (std::size_t match = 0; match <= size; ++match) {
+      linear_buffer a(size);
+      std::memset(a.data(), 'a', size);
+      if (match != size) {
+        a[match] = '\n';
+        std::memcpy(a.data() + match, needle,
+                    (std::min)(size - match, sizeof(needle) - 1));
+      }
+      // Bytes with the high bit set must not confuse the comparisons.
+      if (size > 1)
+        a[size - 1] = 0xff;
+
+      const char* first = reinterpret_cast<const char*>(a.data());
+      const char* last = first + size;
+      for (std::size_t pos = 0; pos <= size && pos < 3; ++pos) {
+        const char* r = std::find(first + pos, last, '\r');
+        BOOST_CHECK_EQUAL(r != last ? std::size_t(r - first)
+                                    : linear_buffer::npos,
+                          a.find('\r', pos));
+
+        r = std::search(first + pos, last, needle, needle + 4);
+        BOOST_CHECK_EQUAL(r != last ? std::size_t(r - first)
+                                    : linear_buffer::npos,
+                          a.find(needle, 4, pos));
+
+        r = std::find_first_of(first + pos, last, set + 1,
+                               set + sizeof(set) - 1);
+        BOOST_CHECK_EQUAL(r != last ? std::size_t(r - first)
+                                    : linear_buffer::npos,
+                          a.find_any(set + 1, sizeof(set) - 2, pos));
+
+        r = std::find_first_of(first + pos, last, set, set + 3);
+        BOOST_CHECK_EQUAL(r != last ? std::size_t(r - first)
+                                    : linear_buffer::npos,
+                          a.find_any(set, 3, pos));
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(asioext_dynamic_linear_buffer)
@@ -148,6 +314,22 @@ BOOST_AUTO_TEST_CASE(max_size)
   BOOST_CHECK_EQUAL(asio::error::no_memory, ec);
 }
 
+BOOST_AUTO_TEST_CASE(find)
+{
+  linear_buffer a;
+  dynbuf_type x1(a);
+  dynbuf_type::mutable_buffers_type b1 = x1.prepare(8);
+  std::memcpy(asio::buffer_cast<char*>(b1), "AB\r\nCD\r\n", 8);
+  x1.commit(6);
+
+  // Only the input sequence is searched.
+  BOOST_CHECK_EQUAL(2, x1.find('\r'));
+  BOOST_CHECK_EQUAL(linear_buffer::npos, x1.find('\r', 3));
+  BOOST_CHECK_EQUAL(2, x1.find("\r\n", 2));
+  BOOST_CHECK_EQUAL(linear_buffer::npos, x1.find("\r\n", 2, 3));
+  BOOST_CHECK_EQUAL(4, x1.find_any("DC", 2));
+}
+
 #if defined(ASIOEXT_HAS_MOVE)
 BOOST_AUTO_TEST_CASE(move)
 {
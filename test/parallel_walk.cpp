@@ -0,0 +1,246 @@
+#include "asioext/parallel_walk.hpp"
+
+#if defined(ASIOEXT_HAS_DIRECTORY_HANDLE)
+
+#include "asioext/open.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_parallel_walk)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const char* test_dirname = "asioext_parallel_walk_test";
+
+struct visited_entry
+{
+  file_type type;
+  std::size_t depth;
+  uint64_t size;
+};
+
+typedef std::map<std::string, visited_entry> entry_map;
+
+// Creates the following tree:
+// a (3 bytes)
+// d0/a, d0/b, d0/d1/a, d0/d1/b, ... (|depth| levels)
+// skip/a, skip/sub/a
+struct test_tree
+{
+  explicit test_tree(std::size_t depth = 4)
+  {
+    boost::filesystem::remove_all(test_dirname);
+    boost::filesystem::create_directory(test_dirname);
+
+    unique_file_handle f = open(path("a").c_str(),
+                                open_flags::access_write |
+                                open_flags::create_always);
+    f.write_some(asio::buffer("abc", 3));
+
+    std::string dir;
+    for (std::size_t i = 0; i != depth; ++i) {
+      if (!dir.empty())
+        dir += '/';
+      dir += "d" + std::to_string(i);
+      boost::filesystem::create_directory(path(dir));
+      create(dir + "/a");
+      create(dir + "/b");
+    }
+
+    boost::filesystem::create_directory(path("skip"));
+    boost::filesystem::create_directory(path("skip/sub"));
+    create("skip/a");
+    create("skip/sub/a");
+  }
+
+  ~test_tree()
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(test_dirname, ec);
+  }
+
+  static std::string path(const std::string& name)
+  {
+    return std::string(test_dirname) + "/" + name;
+  }
+
+  static void create(const std::string& name)
+  {
+    open(path(name).c_str(), open_flags::access_write |
+                             open_flags::create_always);
+  }
+};
+
+struct collector
+{
+  collector()
+    : prune("skip")
+  {
+    // ctor
+  }
+
+  walk_action operator()(const walk_entry& e)
+  {
+    visited_entry v = {e.type(), e.depth(), e.status().size};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    BOOST_CHECK_MESSAGE(entries.count(e.path()) == 0, e.path());
+    entries[e.path()] = v;
+    return e.path() == prune ? walk_action::prune : walk_action::proceed;
+  }
+
+  std::string prune;
+  std::mutex mutex;
+  entry_map entries;
+};
+
+BOOST_AUTO_TEST_CASE(parallel_walk_all)
+{
+  test_tree tree_guard;
+
+  collector c;
+  c.prune.clear();
+
+  walk_options options;
+  options.threads = 4;
+  parallel_walk(test_dirname, std::ref(c), options);
+
+  BOOST_CHECK_EQUAL(1 + 4 * 3 + 4, c.entries.size());
+  BOOST_CHECK(c.entries.count("d0/d1/d2/d3/b") == 1);
+  BOOST_CHECK(c.entries.count("skip/sub/a") == 1);
+
+  BOOST_CHECK(c.entries["a"].type == file_type::regular);
+  BOOST_CHECK(c.entries["d0/d1"].type == file_type::directory);
+  BOOST_CHECK_EQUAL(1, c.entries["a"].depth);
+  BOOST_CHECK_EQUAL(4, c.entries["d0/d1/d2/a"].depth);
+
+  // No status was requested.
+  BOOST_CHECK_EQUAL(0, c.entries["a"].size);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_walk_prune)
+{
+  test_tree tree_guard;
+
+  collector c;
+  walk_options options;
+  options.threads = 2;
+  parallel_walk(test_dirname, std::ref(c), options);
+
+  BOOST_CHECK_EQUAL(1 + 4 * 3 + 1, c.entries.size());
+  BOOST_CHECK(c.entries.count("skip") == 1);
+  BOOST_CHECK(c.entries.count("skip/a") == 0);
+  BOOST_CHECK(c.entries.count("skip/sub") == 0);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_walk_stop)
+{
+  test_tree tree_guard;
+
+  std::atomic<int> count(0);
+  walk_options options;
+  options.threads = 1;
+  parallel_walk(test_dirname, [&count] (const walk_entry&) {
+    ++count;
+    return walk_action::stop;
+  }, options);
+  BOOST_CHECK_EQUAL(1, count.load());
+
+  BOOST_CHECK_THROW(parallel_walk(test_dirname, [] (const walk_entry&)
+                                  -> walk_action {
+    throw std::runtime_error("visitor");
+  }, options), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_walk_status)
+{
+  test_tree tree_guard;
+
+  collector c;
+  walk_options options;
+  options.threads = 2;
+  options.status_mask = file_status_mask::size | file_status_mask::times;
+  parallel_walk(test_dirname, std::ref(c), options);
+
+  BOOST_REQUIRE(c.entries.count("a") == 1);
+  BOOST_CHECK_EQUAL(3, c.entries["a"].size);
+  BOOST_CHECK_EQUAL(0, c.entries["d0/a"].size);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_walk_open_directories)
+{
+  // Deeper than the number of handles we may keep open.
+  test_tree tree_guard(32);
+
+  // Entries can be opened relative to their directory.
+  std::atomic<int> opened(0);
+  const walk_visitor visitor = [&opened] (const walk_entry& e) {
+    if (e.type() == file_type::regular) {
+      unique_file_handle f = open(e.directory(), e.name(),
+                                  open_flags::access_read |
+                                  open_flags::open_existing);
+      if (f.is_open())
+        ++opened;
+    }
+    return walk_action::proceed;
+  };
+
+  walk_options options;
+  options.threads = 3;
+  options.max_open_directories = 0;
+  parallel_walk(test_dirname, visitor, options);
+  BOOST_CHECK_EQUAL(1 + 32 * 2 + 2, opened.load());
+
+  opened = 0;
+  options.max_open_directories = 4;
+  parallel_walk(test_dirname, visitor, options);
+  BOOST_CHECK_EQUAL(1 + 32 * 2 + 2, opened.load());
+}
+
+BOOST_AUTO_TEST_CASE(parallel_walk_errors)
+{
+  test_tree tree_guard;
+
+  const walk_visitor visitor = [] (const walk_entry&) {
+    return walk_action::proceed;
+  };
+
+  error_code ec;
+  parallel_walk("asioext_parallel_walk_nonexistent", visitor, walk_options(),
+                ec);
+  BOOST_CHECK(ec);
+
+  // The buffer is too small for any entry.
+  walk_options options;
+  options.buffer_size = 8;
+  parallel_walk(test_dirname, visitor, options, ec);
+  BOOST_CHECK(ec);
+  BOOST_CHECK_THROW(parallel_walk(test_dirname, visitor, options),
+                    std::runtime_error);
+
+  std::atomic<int> errors(0);
+  options.on_error = [&errors] (const std::string& path, const error_code&) {
+    BOOST_CHECK_EQUAL("", path);
+    ++errors;
+    return walk_action::proceed;
+  };
+  parallel_walk(test_dirname, visitor, options, ec);
+  BOOST_CHECK_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK_EQUAL(1, errors.load());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
+
+#endif
@@ -0,0 +1,136 @@
+#include "test_file_writer.hpp"
+
+#include "asioext/read_until.hpp"
+#include "asioext/file.hpp"
+#include "asioext/open_flags.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_read_until)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const char* test_filename = "asioext_readuntil_test";
+
+static const std::string& test_data()
+{
+  // The long line forces several reads and buffer reallocations.
+  static const std::string data = "GET / HTTP/1.1\r\nHost: a\r\n\r\n" +
+                                  std::string(100000, 'x') + "\n" + "tail";
+  return data;
+}
+
+static void write_test_file()
+{
+  static test_file_writer file(test_filename, test_data().data(),
+                               test_data().size());
+}
+
+static std::string front(const linear_buffer& b, std::size_t n)
+{
+  return std::string(reinterpret_cast<const char*>(b.data()), n);
+}
+
+BOOST_AUTO_TEST_CASE(sync)
+{
+  write_test_file();
+
+  asio::io_service io_service;
+  file f(io_service, test_filename,
+         open_flags::access_read | open_flags::open_existing);
+
+  linear_buffer b;
+  std::size_t n = read_until(f, dynamic_buffer(b), "\r\n\r\n");
+  BOOST_REQUIRE_EQUAL(27, n);
+  BOOST_CHECK_EQUAL(test_data().substr(0, n), front(b, n));
+
+  // A delimiter that's already in the buffer doesn't cause a read.
+  const std::size_t size = b.size();
+  BOOST_CHECK_EQUAL(16, read_until(f, dynamic_buffer(b), '\n'));
+  BOOST_CHECK_EQUAL(size, b.size());
+
+  b.erase(b.begin(), b.begin() + n);
+  n = read_until(f, dynamic_buffer(b), '\n');
+  BOOST_REQUIRE_EQUAL(100001, n);
+  BOOST_CHECK_EQUAL(test_data().substr(27, n), front(b, n));
+
+  b.erase(b.begin(), b.begin() + n);
+  error_code ec;
+  BOOST_CHECK_EQUAL(0, read_until(f, dynamic_buffer(b), '\n', ec));
+  BOOST_CHECK_EQUAL(asio::error::eof, ec);
+  BOOST_CHECK_EQUAL("tail", front(b, b.size()));
+}
+
+BOOST_AUTO_TEST_CASE(sync_max_size)
+{
+  write_test_file();
+
+  asio::io_service io_service;
+  file f(io_service, test_filename,
+         open_flags::access_read | open_flags::open_existing);
+
+  typedef dynamic_linear_buffer<std::allocator<uint8_t> > dynbuf_type;
+
+  linear_buffer b;
+  error_code ec;
+  BOOST_CHECK_EQUAL(0, read_until(f, dynbuf_type(b, 20), "\r\n\r\n", ec));
+  BOOST_CHECK_EQUAL(asio::error::not_found, ec);
+  BOOST_CHECK_EQUAL(20, b.size());
+
+  BOOST_CHECK_THROW(read_until(f, dynbuf_type(b, 20), "\r\n\r\n"),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(async)
+{
+  write_test_file();
+
+  asio::io_service io_service;
+  file f(io_service, test_filename,
+         open_flags::access_read | open_flags::open_existing);
+
+  linear_buffer b;
+  error_code ec1, ec2;
+  std::size_t n1 = 0, n2 = 0;
+  async_read_until(f, dynamic_buffer(b), "\r\n\r\n",
+                   [&] (error_code ec, std::size_t n) {
+    ec1 = ec;
+    n1 = n;
+    b.erase(b.begin(), b.begin() + n);
+    async_read_until(f, dynamic_buffer(b), '\n',
+                     [&] (error_code ec, std::size_t n) {
+      ec2 = ec;
+      n2 = n;
+    });
+  });
+
+  io_service.run();
+  BOOST_CHECK(!ec1);
+  BOOST_CHECK_EQUAL(27, n1);
+  BOOST_CHECK(!ec2);
+  BOOST_REQUIRE_EQUAL(100001, n2);
+  BOOST_CHECK_EQUAL(test_data().substr(27, n2), front(b, n2));
+
+  b.erase(b.begin(), b.begin() + n2);
+  async_read_until(f, dynamic_buffer(b), '\n',
+                   [&] (error_code ec, std::size_t n) {
+    ec1 = ec;
+    n1 = n;
+  });
+
+  io_service.reset();
+  io_service.run();
+  BOOST_CHECK_EQUAL(asio::error::eof, ec1);
+  BOOST_CHECK_EQUAL(0, n1);
+  BOOST_CHECK_EQUAL("tail", front(b, b.size()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,176 @@
+#include "test_file_rm_guard.hpp"
+
+#include "asioext/read_at.hpp"
+#include "asioext/write_at.hpp"
+#include "asioext/unique_file_handle.hpp"
+#include "asioext/open.hpp"
+#include "asioext/file.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/error.hpp>
+#else
+# include <asio/error.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_read_write_at)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const char* test_filename = "asioext_readwriteat_test";
+
+static std::vector<char> make_data(std::size_t size)
+{
+  std::vector<char> data(size);
+  for (std::size_t i = 0; i != size; ++i)
+    data[i] = static_cast<char>(i % 251);
+  return data;
+}
+
+static std::vector<asio::mutable_buffer> split(std::vector<char>& data,
+                                               std::size_t chunk_size)
+{
+  std::vector<asio::mutable_buffer> buffers;
+  for (std::size_t i = 0; i < data.size(); i += chunk_size) {
+    buffers.push_back(asio::buffer(&data[i], (std::min)(chunk_size,
+                                                        data.size() - i)));
+  }
+  return buffers;
+}
+
+BOOST_AUTO_TEST_CASE(sync)
+{
+  test_file_rm_guard rguard1(test_filename);
+
+  std::vector<char> data = make_data(100000);
+
+  asioext::error_code ec;
+  asioext::unique_file_handle fh = asioext::open(
+      test_filename,
+      asioext::open_flags::access_read_write |
+      asioext::open_flags::create_always, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  BOOST_REQUIRE_EQUAL(0, asioext::write_at(fh, 0, asio::buffer(data, 0)));
+  BOOST_REQUIRE_EQUAL(data.size(),
+                      asioext::write_at(fh, 10, split(data, 7), ec));
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_REQUIRE_EQUAL(data.size() + 10, fh.size());
+
+  std::vector<char> out(data.size());
+  BOOST_REQUIRE_EQUAL(out.size(), asioext::read_at(fh, 10, split(out, 13)));
+  BOOST_CHECK(data == out);
+
+  // Reading past the end yields a partial result and eof.
+  std::fill(out.begin(), out.end(), 0);
+  BOOST_REQUIRE_EQUAL(data.size() - 10,
+                      asioext::read_at(fh, 20, asio::buffer(out), ec));
+  BOOST_REQUIRE_EQUAL(asio::error::eof, ec);
+  BOOST_CHECK(std::equal(data.begin() + 10, data.end(), out.begin()));
+
+  BOOST_CHECK_THROW(asioext::read_at(fh, 20, asio::buffer(out)),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(async)
+{
+  test_file_rm_guard rguard1(test_filename);
+
+  std::vector<char> data = make_data(100000);
+  std::vector<char> out(data.size());
+
+  asio::io_service io_service;
+  asioext::file file(io_service);
+
+  asioext::error_code ec;
+  file.open(test_filename, asioext::open_flags::access_read_write |
+                           asioext::open_flags::create_always, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  int calls = 0;
+  asioext::async_write_at(file, 0, split(data, 7),
+      [&](const error_code& ec, std::size_t bytes_transferred) {
+    ++calls;
+    BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+    BOOST_REQUIRE_EQUAL(data.size(), bytes_transferred);
+
+    asioext::async_read_at(file, 0, split(out, 13),
+        [&](const error_code& ec, std::size_t bytes_transferred) {
+      ++calls;
+      BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+      BOOST_REQUIRE_EQUAL(out.size(), bytes_transferred);
+    });
+  });
+
+  io_service.run();
+  io_service.reset();
+  BOOST_REQUIRE_EQUAL(2, calls);
+  BOOST_CHECK(data == out);
+
+  file.async_read_at(50000, asio::buffer(out),
+      [&](const error_code& ec, std::size_t bytes_transferred) {
+    ++calls;
+    BOOST_REQUIRE_EQUAL(asio::error::eof, ec);
+    BOOST_REQUIRE_EQUAL(50000, bytes_transferred);
+  });
+
+  io_service.run();
+  BOOST_REQUIRE_EQUAL(3, calls);
+}
+
+// Transfers |available| bytes, then nothing, without reporting an error.
+struct stalling_device
+{
+  template <typename MutableBufferSequence>
+  std::size_t read_some_at(uint64_t, const MutableBufferSequence& buffers,
+                           error_code& ec)
+  {
+    ec = error_code();
+    return transfer(asio::buffer_size(buffers));
+  }
+
+  template <typename ConstBufferSequence>
+  std::size_t write_some_at(uint64_t, const ConstBufferSequence& buffers,
+                            error_code& ec)
+  {
+    ec = error_code();
+    return transfer(asio::buffer_size(buffers));
+  }
+
+  std::size_t transfer(std::size_t size)
+  {
+    const std::size_t n = (std::min)(size, available);
+    available -= n;
+    return n;
+  }
+
+  std::size_t available;
+};
+
+BOOST_AUTO_TEST_CASE(zero_transfer)
+{
+  std::vector<char> data(100);
+
+  error_code ec;
+  stalling_device device = {40};
+  BOOST_CHECK_EQUAL(40, asioext::read_at(device, 0, asio::buffer(data), ec));
+  BOOST_CHECK_EQUAL(asio::error::eof, ec);
+
+  device.available = 60;
+  BOOST_CHECK_EQUAL(60, asioext::write_at(device, 0, asio::buffer(data), ec));
+  BOOST_CHECK_MESSAGE(ec == errc::no_space_on_device, "ec: " << ec);
+  BOOST_CHECK_THROW(asioext::write_at(device, 0, asio::buffer(data)),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,166 @@
+#include "asioext/resolver_cache.hpp"
+#include "asioext/connect.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+#else
+# include <asio/io_service.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_resolver_cache)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+typedef asio::ip::tcp::resolver::query query;
+typedef asio::ip::tcp::resolver::iterator iterator;
+
+static const query::flags numeric =
+    query::numeric_host | query::numeric_service;
+
+BOOST_AUTO_TEST_CASE(resolver_cache_resolve)
+{
+  asio::io_service io_service;
+  resolver_cache cache(io_service);
+
+  const asio::ip::tcp::endpoint expected(
+      asio::ip::address_v4::loopback(), 1234);
+
+  int called = 0;
+  const auto handler = [&] (error_code ec, iterator it) {
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+    BOOST_REQUIRE(it != iterator());
+    BOOST_CHECK_EQUAL(it->endpoint(), expected);
+    ++called;
+  };
+
+  // Concurrent lookups share a single result.
+  cache.async_resolve(query("127.0.0.1", "1234", numeric), handler);
+  cache.async_resolve(query("127.0.0.1", "1234", numeric), handler);
+  BOOST_CHECK_EQUAL(called, 0);
+  io_service.run();
+  BOOST_CHECK_EQUAL(called, 2);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+
+  // Cached results aren't passed to the handler inline either.
+  cache.async_resolve(query("127.0.0.1", "1234", numeric), handler);
+  BOOST_CHECK_EQUAL(called, 2);
+  io_service.reset();
+  io_service.run();
+  BOOST_CHECK_EQUAL(called, 3);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+
+  // Different queries have their own entries.
+  cache.async_resolve(query("127.0.0.1", "1235", numeric),
+                      [&] (error_code ec, iterator it) {
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+    BOOST_CHECK_EQUAL(it->endpoint().port(), 1235);
+    ++called;
+  });
+  io_service.reset();
+  io_service.run();
+  BOOST_CHECK_EQUAL(called, 4);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(resolver_cache_negative)
+{
+  asio::io_service io_service;
+  resolver_cache cache(io_service);
+
+  // Only numeric addresses are allowed, so this fails without asking a
+  // name server.
+  int called = 0;
+  const auto handler = [&] (error_code ec, iterator it) {
+    BOOST_CHECK_MESSAGE(ec == asio::error::host_not_found, "ec: " << ec);
+    BOOST_CHECK(it == iterator());
+    ++called;
+  };
+
+  cache.async_resolve(query("not-an-address", "80", numeric), handler);
+  io_service.run();
+  BOOST_CHECK_EQUAL(called, 1);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+
+  cache.async_resolve(query("not-an-address", "80", numeric), handler);
+  io_service.reset();
+  io_service.run();
+  BOOST_CHECK_EQUAL(called, 2);
+}
+
+BOOST_AUTO_TEST_CASE(resolver_cache_ttl)
+{
+  asio::io_service io_service;
+  resolver_cache cache(io_service, chrono::seconds(0), chrono::seconds(0));
+
+  bool called = false;
+  cache.async_resolve(query("127.0.0.1", "80", numeric),
+                      [&] (error_code ec, iterator) {
+    BOOST_CHECK_EQUAL(ec, error_code());
+    called = true;
+  });
+  cache.async_resolve(query("not-an-address", "80", numeric),
+                      [&] (error_code, iterator) {});
+  io_service.run();
+  BOOST_CHECK(called);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(resolver_cache_max_entries)
+{
+  asio::io_service io_service;
+  resolver_cache cache(io_service, chrono::seconds(60), chrono::seconds(5),
+                       2);
+
+  const char* services[] = {"1", "2", "3"};
+  for (std::size_t i = 0; i != 3; ++i) {
+    cache.async_resolve(query("127.0.0.1", services[i], numeric),
+                        [] (error_code ec, iterator) {
+      BOOST_CHECK_EQUAL(ec, error_code());
+    });
+    io_service.reset();
+    io_service.run();
+  }
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(resolver_cache_connect)
+{
+  asio::io_service io_service;
+  resolver_cache cache(io_service);
+
+  asio::ip::tcp::acceptor acceptor(io_service, asio::ip::tcp::endpoint(
+      asio::ip::address_v4::loopback(), 0));
+  asio::ip::tcp::socket peer(io_service);
+  acceptor.async_accept(peer, [] (error_code ec) {
+    BOOST_CHECK_EQUAL(ec, error_code());
+  });
+
+  asio::ip::tcp::socket socket(io_service);
+  bool called = false;
+  asioext::async_connect(
+      socket, cache,
+      query("127.0.0.1", std::to_string(acceptor.local_endpoint().port()),
+            numeric),
+      [&] (error_code ec, iterator it) {
+    BOOST_REQUIRE_EQUAL(ec, error_code());
+    BOOST_CHECK_EQUAL(it->endpoint(), acceptor.local_endpoint());
+    called = true;
+  });
+
+  io_service.run();
+  BOOST_CHECK(called);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  BOOST_CHECK_EQUAL(socket.remote_endpoint(), acceptor.local_endpoint());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,168 @@
+#include "test_file_rm_guard.hpp"
+
+#include "asioext/segmented_buffer.hpp"
+#include "asioext/file_handle.hpp"
+#include "asioext/open.hpp"
+#include "asioext/read_at.hpp"
+#include "asioext/unique_file_handle.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/error.hpp>
+#else
+# include <asio/error.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <string>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_segmented_buffer)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const char* test_filename = "asioext_segmentedbuffer_test";
+
+template <typename ConstBufferSequence>
+static std::string to_string(const ConstBufferSequence& buffers)
+{
+  std::string s(asio::buffer_size(buffers), '\0');
+  if (!s.empty())
+    asio::buffer_copy(asio::buffer(&s[0], s.size()), buffers);
+  return s;
+}
+
+template <typename ConstBufferSequence>
+static std::size_t count_buffers(const ConstBufferSequence& buffers)
+{
+  return std::distance(buffers.begin(), buffers.end());
+}
+
+BOOST_AUTO_TEST_CASE(block_pool_reuse)
+{
+  block_pool pool(64, 2);
+  BOOST_CHECK_EQUAL(64, pool.block_size());
+  BOOST_CHECK_EQUAL(0, pool.cached_blocks());
+
+  uint8_t* a = pool.allocate();
+  uint8_t* b = pool.allocate();
+  uint8_t* c = pool.allocate();
+  pool.deallocate(a);
+  pool.deallocate(b);
+  BOOST_CHECK_EQUAL(2, pool.cached_blocks());
+
+  // Only two blocks are cached.
+  pool.deallocate(c);
+  BOOST_CHECK_EQUAL(2, pool.cached_blocks());
+
+  BOOST_CHECK_EQUAL(b, pool.allocate());
+  BOOST_CHECK_EQUAL(1, pool.cached_blocks());
+  pool.deallocate(b);
+
+  pool.release();
+  BOOST_CHECK_EQUAL(0, pool.cached_blocks());
+}
+
+BOOST_AUTO_TEST_CASE(grow_consume)
+{
+  block_pool pool(8);
+  segmented_buffer a(pool);
+  BOOST_CHECK_EQUAL(0, a.size());
+  BOOST_CHECK_EQUAL(0, a.capacity());
+  BOOST_CHECK_EQUAL(0, count_buffers(a.data()));
+
+  a.append("HELLO", 5);
+  BOOST_CHECK_EQUAL(1, a.block_count());
+
+  // The output sequence spans the rest of the first block and a new one.
+  segmented_buffer::mutable_buffers_type out = a.prepare(7);
+  BOOST_CHECK_EQUAL(2, count_buffers(out));
+  BOOST_CHECK_EQUAL(7, asio::buffer_size(out));
+  asio::buffer_copy(out, asio::buffer(" WORLD!", 7));
+  a.commit(7);
+
+  BOOST_CHECK_EQUAL(12, a.size());
+  BOOST_CHECK_EQUAL(2, a.block_count());
+  BOOST_CHECK_EQUAL(2, count_buffers(a.data()));
+  BOOST_CHECK_EQUAL("HELLO WORLD!", to_string(a.data()));
+
+  // Consuming the first block returns it to the pool.
+  a.consume(3);
+  BOOST_CHECK_EQUAL(2, a.block_count());
+  a.consume(6);
+  BOOST_CHECK_EQUAL(1, a.block_count());
+  BOOST_CHECK_EQUAL(1, pool.cached_blocks());
+  BOOST_CHECK_EQUAL("LD!", to_string(a.data()));
+
+  a.consume(100);
+  BOOST_CHECK(a.empty());
+  BOOST_CHECK_EQUAL(0, a.block_count());
+  BOOST_CHECK_EQUAL(2, pool.cached_blocks());
+}
+
+BOOST_AUTO_TEST_CASE(dynamic_buffer)
+{
+  block_pool pool(8);
+  segmented_buffer a(pool);
+  dynamic_segmented_buffer x1 = asioext::dynamic_buffer(a, 10);
+  BOOST_CHECK_EQUAL(10, x1.max_size());
+
+  asio::buffer_copy(x1.prepare(9), asio::buffer("ABCDEFGHI", 9));
+  x1.commit(20);
+  BOOST_CHECK_EQUAL(9, x1.size());
+  BOOST_CHECK_EQUAL(2, a.block_count());
+  BOOST_CHECK_THROW(x1.prepare(2), std::length_error);
+
+  error_code ec;
+  x1.prepare(2, ec);
+  BOOST_CHECK_EQUAL(asio::error::no_memory, ec);
+
+  x1.consume(5);
+  x1.prepare(6, ec);
+  BOOST_CHECK(!ec);
+  BOOST_CHECK_EQUAL("FGHI", to_string(a.data()));
+
+#if defined(ASIOEXT_HAS_MOVE)
+  segmented_buffer b(std::move(a));
+  BOOST_CHECK_EQUAL(0, a.block_count());
+  BOOST_CHECK_EQUAL("FGHI", to_string(b.data()));
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(gather_write)
+{
+  test_file_rm_guard rguard1(test_filename);
+
+  block_pool pool(16);
+  segmented_buffer a(pool);
+
+  std::string expected;
+  for (int i = 0; i != 100; ++i) {
+    const std::string line = "line " + std::to_string(i) + "\n";
+    a.append(line.data(), line.size());
+    expected += line;
+  }
+
+  error_code ec;
+  unique_file_handle fh = open(test_filename,
+                               open_flags::access_read_write |
+                               open_flags::create_always, ec);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  while (!a.empty())
+    a.consume(fh.write_some(a.data()));
+
+  BOOST_CHECK_EQUAL(0, a.block_count());
+
+  std::string actual(expected.size(), '\0');
+  BOOST_REQUIRE_EQUAL(actual.size(),
+                      read_at(fh, 0, asio::buffer(&actual[0], actual.size())));
+  BOOST_CHECK(expected == actual);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,235 @@
+#include "asioext/small_linear_buffer.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_small_linear_buffer)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+template <typename Buffer>
+static std::string to_string(const Buffer& b)
+{
+  return std::string(reinterpret_cast<const char*>(b.data()), b.size());
+}
+
+BOOST_AUTO_TEST_CASE(inline_storage)
+{
+  small_linear_buffer<8> a;
+  BOOST_CHECK_EQUAL(0, a.size());
+  BOOST_CHECK_EQUAL(8, a.capacity());
+  BOOST_CHECK(a.is_inline());
+
+  a.append("HELLO", 5);
+  a.append("ABC", 3);
+  BOOST_CHECK_EQUAL(8, a.capacity());
+  BOOST_CHECK(a.is_inline());
+  BOOST_CHECK_EQUAL("HELLOABC", to_string(a));
+
+  small_linear_buffer<8> b(6, 64);
+  BOOST_CHECK_EQUAL(6, b.size());
+  BOOST_CHECK_EQUAL(64, b.max_size());
+  BOOST_CHECK(b.is_inline());
+}
+
+BOOST_AUTO_TEST_CASE(spill)
+{
+  small_linear_buffer<8> a;
+  a.append("HELLO", 5);
+  a.insert(a.begin(), ">", 1);
+  BOOST_CHECK(a.is_inline());
+
+  a.append(" WORLD", 6);
+  BOOST_CHECK(!a.is_inline());
+  BOOST_CHECK_LE(12, a.capacity());
+  BOOST_CHECK_EQUAL(">HELLO WORLD", to_string(a));
+
+  // Shrinking doesn't move the data back into the inline storage.
+  a.erase(5, 12);
+  BOOST_CHECK(!a.is_inline());
+  BOOST_CHECK_EQUAL(">HELL", to_string(a));
+}
+
+BOOST_AUTO_TEST_CASE(shrink_to_fit)
+{
+  small_linear_buffer<8> a;
+  a.append("HELLO WORLD", 11);
+  BOOST_REQUIRE(!a.is_inline());
+
+  a.erase(5, 11);
+  a.shrink_to_fit();
+  BOOST_CHECK(a.is_inline());
+  BOOST_CHECK_EQUAL(8, a.capacity());
+  BOOST_CHECK_EQUAL("HELLO", to_string(a));
+}
+
+BOOST_AUTO_TEST_CASE(copy)
+{
+  small_linear_buffer<8> a;
+  a.append("HELLO", 5);
+
+  small_linear_buffer<8> b(a);
+  BOOST_CHECK(b.is_inline());
+  BOOST_CHECK_EQUAL("HELLO", to_string(b));
+
+  linear_buffer c;
+  c.append("HELLO WORLD", 11);
+  small_linear_buffer<8> d(c);
+  BOOST_CHECK(!d.is_inline());
+  BOOST_CHECK_EQUAL("HELLO WORLD", to_string(d));
+
+  d = b;
+  BOOST_CHECK_EQUAL("HELLO", to_string(d));
+}
+
+#if defined(ASIOEXT_HAS_MOVE)
+BOOST_AUTO_TEST_CASE(move)
+{
+  small_linear_buffer<8> a;
+  a.append("HELLO", 5);
+
+  // Inline contents have to be copied.
+  small_linear_buffer<8> b(std::move(a));
+  BOOST_CHECK_EQUAL(0, a.size());
+  BOOST_CHECK(a.is_inline());
+  BOOST_CHECK(b.is_inline());
+  BOOST_CHECK_EQUAL("HELLO", to_string(b));
+
+  // Allocated memory is transferred.
+  b.append(" WORLD", 6);
+  const uint8_t* data = b.data();
+  small_linear_buffer<8> c(std::move(b));
+  BOOST_CHECK_EQUAL(0, b.size());
+  BOOST_CHECK_EQUAL(8, b.capacity());
+  BOOST_CHECK(b.is_inline());
+  BOOST_CHECK_EQUAL(data, c.data());
+  BOOST_CHECK_EQUAL("HELLO WORLD", to_string(c));
+
+  // Move-assigning releases the target's memory.
+  c = std::move(a);
+  BOOST_CHECK(c.is_inline());
+  BOOST_CHECK_EQUAL(0, c.size());
+  BOOST_CHECK_EQUAL(8, c.capacity());
+
+  a.append("ABC", 3);
+  small_linear_buffer<8> d;
+  d.append("TEST WITH MEMORY", 16);
+  d = std::move(a);
+  BOOST_CHECK_EQUAL("ABC", to_string(d));
+  BOOST_CHECK_EQUAL(0, a.size());
+
+  // Plain linear buffers don't have to deal with inline storage.
+  static_assert(std::is_nothrow_move_constructible<linear_buffer>::value,
+                "linear_buffer's move constructor must not throw");
+  static_assert(std::is_nothrow_move_assignable<linear_buffer>::value,
+                "linear_buffer's move assignment must not throw");
+}
+#endif
+
+template <typename T>
+struct tagged_allocator
+{
+  typedef T value_type;
+
+  tagged_allocator(int tag, std::size_t* allocations)
+    : tag(tag)
+    , allocations(allocations)
+  {
+    // ctor
+  }
+
+  template <typename U>
+  tagged_allocator(const tagged_allocator<U>& other)
+    : tag(other.tag)
+    , allocations(other.allocations)
+  {
+    // ctor
+  }
+
+  T* allocate(std::size_t n)
+  {
+    ++*allocations;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  int tag;
+  std::size_t* allocations;
+};
+
+template <typename T, typename U>
+bool operator==(const tagged_allocator<T>& a, const tagged_allocator<U>& b)
+{
+  return a.tag == b.tag;
+}
+
+template <typename T, typename U>
+bool operator!=(const tagged_allocator<T>& a, const tagged_allocator<U>& b)
+{
+  return a.tag != b.tag;
+}
+
+BOOST_AUTO_TEST_CASE(allocator)
+{
+  typedef tagged_allocator<uint8_t> allocator_type;
+
+  std::size_t allocations = 0;
+  basic_small_linear_buffer<8, allocator_type> a(
+      allocator_type(1, &allocations));
+  a.append("HELLO", 5);
+
+  // Copies use the other buffer's allocator.
+  basic_small_linear_buffer<8, allocator_type> b(a);
+  BOOST_CHECK_EQUAL(1, b.get_allocator().tag);
+  BOOST_CHECK_EQUAL(0, allocations);
+
+  a.append(" WORLD", 6);
+  BOOST_CHECK_EQUAL(1, allocations);
+  a.erase(5, 11);
+
+#if defined(ASIOEXT_HAS_MOVE)
+  // Inline contents are copied and allocated memory is transferred,
+  // so neither allocates.
+  basic_small_linear_buffer<8, allocator_type> d(std::move(b));
+  BOOST_CHECK(d.is_inline());
+  d = std::move(a);
+  BOOST_CHECK(!d.is_inline());
+  BOOST_CHECK(a.is_inline());
+  BOOST_CHECK_EQUAL("HELLO", std::string(
+      reinterpret_cast<const char*>(d.data()), d.size()));
+  BOOST_CHECK_EQUAL(1, allocations);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(dynamic_buffer)
+{
+  small_linear_buffer<4> a;
+  auto x1 = asioext::dynamic_buffer(a);
+
+  asio::buffer_copy(x1.prepare(2), asio::buffer("AB", 2));
+  x1.commit(2);
+  BOOST_CHECK(a.is_inline());
+
+  asio::buffer_copy(x1.prepare(4), asio::buffer("CDEF", 4));
+  x1.commit(4);
+  BOOST_CHECK(!a.is_inline());
+  BOOST_CHECK_EQUAL("ABCDEF", to_string(a));
+
+  x1.consume(3);
+  BOOST_CHECK_EQUAL("DEF", to_string(a));
+  BOOST_CHECK_EQUAL(3, asio::buffer_size(asioext::buffer(a)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,182 @@
+#include "asioext/socks/client.hpp"
+#include "asioext/socks/error.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/read.hpp>
+# include <boost/asio/write.hpp>
+#else
+# include <asio/io_service.hpp>
+# include <asio/read.hpp>
+# include <asio/write.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_socks_client)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+// A scripted SOCKS 5 server: waits for |request_size| bytes and answers them
+// with |reply| in a single write.
+struct scripted_server
+{
+  scripted_server(asio::io_service& io_service,
+                  std::size_t request_size, const std::string& reply)
+    : acceptor(io_service, asio::ip::tcp::endpoint(
+          asio::ip::address_v4::loopback(), 0))
+    , socket(io_service)
+    , request(request_size)
+    , reply(reply)
+  {
+    acceptor.async_accept(socket, [this] (error_code ec) {
+      BOOST_REQUIRE(!ec);
+      asio::async_read(socket, asio::buffer(request),
+                       [this] (error_code ec, std::size_t) {
+        BOOST_REQUIRE(!ec);
+        asio::async_write(socket, asio::buffer(this->reply),
+                          [this] (error_code ec, std::size_t) {
+          BOOST_REQUIRE(!ec);
+          socket.shutdown(asio::ip::tcp::socket::shutdown_send, ec);
+        });
+      });
+    });
+  }
+
+  std::string received() const
+  {
+    return std::string(request.begin(), request.end());
+  }
+
+  asio::ip::tcp::acceptor acceptor;
+  asio::ip::tcp::socket socket;
+  std::vector<char> request;
+  std::string reply;
+};
+
+static const asio::ip::tcp::endpoint target(
+    asio::ip::address_v4(0x7f000001), 80);
+
+static const std::string connect_request("\x05\x01\x00\x01\x7f\x00\x00\x01"
+                                         "\x00\x50", 10);
+static const std::string connect_reply("\x05\x00\x00\x01\x0a\x00\x00\x01"
+                                       "\x12\x34", 10);
+
+BOOST_AUTO_TEST_CASE(handshake_anonymous)
+{
+  asio::io_service io_service;
+
+  const std::string greeting("\x05\x01\x00", 3);
+  scripted_server server(io_service, 13,
+                         std::string("\x05\x00", 2) + connect_reply +
+                         "payload");
+
+  asio::ip::tcp::socket socket(io_service);
+  socket.connect(server.acceptor.local_endpoint());
+
+  char storage[socks::max_handshake_size];
+  error_code ec = asio::error::would_block;
+  socks::async_handshake(socket, "", "", target, asio::buffer(storage),
+                         [&] (error_code e) { ec = e; });
+  io_service.run();
+
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK(greeting + connect_request == server.received());
+
+  // Data of the proxied connection has to be left in the socket.
+  char payload[7];
+  asio::read(socket, asio::buffer(payload));
+  BOOST_CHECK_EQUAL("payload", std::string(payload, 7));
+}
+
+BOOST_AUTO_TEST_CASE(handshake_login)
+{
+  asio::io_service io_service;
+
+  const std::string greeting("\x05\x01\x02", 3);
+  const std::string login("\x01\x04user\x02pw", 9);
+  // Connect to a hostname, reply with a hostname.
+  const std::string request("\x05\x01\x00\x03\x0b" "example.com\x01\xbb", 18);
+  const std::string reply("\x05\x00\x00\x03\x04host\x12\x34", 11);
+
+  scripted_server server(io_service, 3 + 9 + 18,
+                         std::string("\x05\x02\x01\x00", 4) + reply);
+
+  asio::ip::tcp::socket socket(io_service);
+  socket.connect(server.acceptor.local_endpoint());
+
+  char storage[socks::max_handshake_size];
+  error_code ec = asio::error::would_block;
+  socks::async_handshake(socket, "user", "pw", "example.com", 443,
+                         asio::buffer(storage),
+                         [&] (error_code e) { ec = e; });
+  io_service.run();
+
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK(greeting + login + request == server.received());
+}
+
+BOOST_AUTO_TEST_CASE(handshake_errors)
+{
+  const struct {
+    const char* reply;
+    std::size_t reply_size;
+    error_code ec;
+  } cases[] = {
+    { "\x04\x02", 2, socks::error::invalid_version },
+    { "\x05\xff", 2, socks::error::no_acceptable_auth_method },
+    { "\x05\x02\x02\x00", 4, socks::error::invalid_auth_version },
+    { "\x05\x02\x01\x01", 4, socks::error::login_failed },
+    { "\x05\x02\x01\x00\x05\x05\x00\x01", 8, asio::error::connection_refused },
+    { "\x05\x02\x01\x00\x05\x00\x00\x01\x00", 9, asio::error::eof },
+  };
+
+  for (std::size_t i = 0; i != sizeof(cases) / sizeof(cases[0]); ++i) {
+    asio::io_service io_service;
+    scripted_server server(io_service, 3 + 9 + 10,
+                           std::string(cases[i].reply, cases[i].reply_size));
+
+    asio::ip::tcp::socket socket(io_service);
+    socket.connect(server.acceptor.local_endpoint());
+
+    char storage[socks::max_handshake_size];
+    error_code ec;
+    socks::async_handshake(socket, "user", "pw", target,
+                           asio::buffer(storage),
+                           [&] (error_code e) { ec = e; });
+    io_service.run();
+
+    BOOST_CHECK_MESSAGE(cases[i].ec == ec,
+                        "case " << i << ": " << ec << " != " << cases[i].ec);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(handshake_storage)
+{
+  asio::io_service io_service;
+  asio::ip::tcp::socket socket(io_service);
+
+  char storage[64];
+  error_code ec;
+  socks::async_handshake(socket, "user", "pw", target, asio::buffer(storage),
+                         [&] (error_code e) { ec = e; });
+  io_service.run();
+  BOOST_CHECK_EQUAL(asio::error::no_buffer_space, ec);
+
+  io_service.reset();
+  socks::async_handshake(socket, std::string(256, 'u'), "pw", target,
+                         asio::buffer(storage),
+                         [&] (error_code e) { ec = e; });
+  io_service.run();
+  BOOST_CHECK_EQUAL(asio::error::invalid_argument, ec);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,223 @@
+#include "asioext/socks/server.hpp"
+#include "asioext/socks/client.hpp"
+#include "asioext/socks/error.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/read.hpp>
+# include <boost/asio/write.hpp>
+#else
+# include <asio/io_service.hpp>
+# include <asio/read.hpp>
+# include <asio/write.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_socks_server)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+// Accepts a single connection and echoes everything back.
+struct echo_server
+{
+  explicit echo_server(asio::io_service& io_service)
+    : acceptor(io_service, asio::ip::tcp::endpoint(
+          asio::ip::address_v4::loopback(), 0))
+    , socket(io_service)
+    , buffer(4096)
+  {
+    acceptor.async_accept(socket, [this] (error_code ec) {
+      acceptor.close(ec);
+      read();
+    });
+  }
+
+  void read()
+  {
+    socket.async_read_some(asio::buffer(buffer),
+                           [this] (error_code ec, std::size_t size) {
+      if (ec) {
+        socket.shutdown(asio::ip::tcp::socket::shutdown_send, ec);
+        return;
+      }
+      asio::async_write(socket, asio::buffer(buffer, size),
+                        [this] (error_code ec, std::size_t) {
+        if (!ec)
+          read();
+      });
+    });
+  }
+
+  asio::ip::tcp::acceptor acceptor;
+  asio::ip::tcp::socket socket;
+  std::vector<char> buffer;
+};
+
+static std::string make_payload(std::size_t size)
+{
+  std::string payload(size, '\0');
+  for (std::size_t i = 0; i != size; ++i)
+    payload[i] = static_cast<char>(i * 7 + i / 251);
+  return payload;
+}
+
+// Performs a handshake and echoes |payload| through the proxy.
+static error_code echo_through(const std::string& username,
+                               const std::string& password,
+                               const std::string& host,
+                               const std::string& payload,
+                               std::string& received)
+{
+  asio::io_service io_service;
+  socks::server server(io_service, asio::ip::tcp::endpoint(
+      asio::ip::address_v4::loopback(), 0));
+  server.set_login_checker([] (const std::string& username,
+                               const std::string& password) {
+    return username == "user" && password == "secret";
+  });
+  if (username.empty())
+    server.set_login_checker(socks::server::login_checker());
+  server.start();
+
+  echo_server echo(io_service);
+
+  asio::ip::tcp::socket socket(io_service);
+  socket.connect(server.local_endpoint());
+
+  char storage[socks::max_handshake_size];
+  error_code result = asio::error::would_block;
+  received.assign(payload.size(), '\0');
+
+  auto on_handshake = [&] (error_code ec) {
+    result = ec;
+    if (ec) {
+      server.stop();
+      echo.acceptor.close(ec);
+      return;
+    }
+
+    asio::async_write(socket, asio::buffer(payload),
+                      [&] (error_code ec, std::size_t) {
+      BOOST_CHECK_MESSAGE(!ec, "ec: " << ec);
+    });
+    asio::async_read(socket, asio::buffer(&received[0], received.size()),
+                     [&] (error_code ec, std::size_t) {
+      BOOST_CHECK_MESSAGE(!ec, "ec: " << ec);
+      socket.close(ec);
+      server.stop();
+    });
+  };
+
+  if (host.empty()) {
+    socks::async_handshake(socket, username, password,
+                           echo.acceptor.local_endpoint(),
+                           asio::buffer(storage), on_handshake);
+  } else {
+    socks::async_handshake(socket, username, password,
+                           host, echo.acceptor.local_endpoint().port(),
+                           asio::buffer(storage), on_handshake);
+  }
+
+  io_service.run();
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE(connect)
+{
+  const std::string payload = make_payload(1024 * 1024 + 17);
+  std::string received;
+  const error_code ec = echo_through("", "", "", payload, received);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK(payload == received);
+}
+
+BOOST_AUTO_TEST_CASE(connect_hostname)
+{
+  const std::string payload = make_payload(1000);
+  std::string received;
+  const error_code ec = echo_through("", "", "127.0.0.1", payload, received);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK(payload == received);
+}
+
+BOOST_AUTO_TEST_CASE(login)
+{
+  const std::string payload = make_payload(1000);
+  std::string received;
+  error_code ec = echo_through("user", "secret", "", payload, received);
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK(payload == received);
+
+  ec = echo_through("user", "wrong", "", payload, received);
+  BOOST_CHECK_MESSAGE(ec == socks::error::login_failed, "ec: " << ec);
+}
+
+BOOST_AUTO_TEST_CASE(connection_refused)
+{
+  asio::io_service io_service;
+  socks::server server(io_service, asio::ip::tcp::endpoint(
+      asio::ip::address_v4::loopback(), 0));
+  server.start();
+
+  asio::ip::tcp::endpoint closed;
+  {
+    asio::ip::tcp::acceptor acceptor(io_service, asio::ip::tcp::endpoint(
+        asio::ip::address_v4::loopback(), 0));
+    closed = acceptor.local_endpoint();
+  }
+
+  asio::ip::tcp::socket socket(io_service);
+  socket.connect(server.local_endpoint());
+
+  char storage[socks::max_handshake_size];
+  error_code result = asio::error::would_block;
+  socks::async_handshake(socket, "", "", closed, asio::buffer(storage),
+                         [&] (error_code ec) {
+    result = ec;
+    server.stop();
+  });
+  io_service.run();
+
+  BOOST_CHECK_MESSAGE(result == asio::error::connection_refused,
+                      "ec: " << result);
+}
+
+BOOST_AUTO_TEST_CASE(unsupported_command)
+{
+  asio::io_service io_service;
+  socks::server server(io_service, asio::ip::tcp::endpoint(
+      asio::ip::address_v4::loopback(), 0));
+  server.start();
+
+  asio::ip::tcp::socket socket(io_service);
+  socket.connect(server.local_endpoint());
+
+  linear_buffer buffer;
+  const socks::auth_method method = socks::auth_method::none;
+  error_code result = asio::error::would_block;
+  socks::async_greet(socket, &method, 1, dynamic_buffer(buffer),
+                     [&] (error_code ec, socks::auth_method) {
+    BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+    socks::async_execute(socket, socks::command::bind,
+                         server.local_endpoint(), dynamic_buffer(buffer),
+                         [&] (error_code ec) {
+      result = ec;
+      server.stop();
+    });
+  });
+  io_service.run();
+
+  BOOST_CHECK_MESSAGE(result == socks::error::command_not_supported,
+                      "ec: " << result);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END
@@ -0,0 +1,328 @@
+#include "asioext/socks/udp.hpp"
+#include "asioext/socks/error.hpp"
+#include "asioext/linear_buffer.hpp"
+
+#if defined(ASIOEXT_USE_BOOST_ASIO)
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/read.hpp>
+# include <boost/asio/write.hpp>
+#else
+# include <asio/io_service.hpp>
+# include <asio/read.hpp>
+# include <asio/write.hpp>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+ASIOEXT_NS_BEGIN
+
+BOOST_AUTO_TEST_SUITE(asioext_socks_udp)
+
+// BOOST_AUTO_TEST_SUITE() gives us a unique NS, so we don't need to
+// prefix our variables.
+
+static const asio::ip::udp::endpoint peer_v4(
+    asio::ip::address_v4(0x0a000001), 53);
+static const asio::ip::udp::endpoint peer_v6(
+    asio::ip::address::from_string("2001:db8::1"), 443);
+
+// A client socket connected to a fake relay.
+struct relay_fixture
+{
+  relay_fixture()
+    : relay(io_service, asio::ip::udp::endpoint(
+          asio::ip::address_v4::loopback(), 0))
+    , socket(io_service, asio::ip::udp::endpoint(
+          asio::ip::address_v4::loopback(), 0))
+  {
+    socket.connect(relay.local_endpoint());
+    relay.connect(socket.local_endpoint());
+  }
+
+  std::string relay_receive()
+  {
+    char buf[1024];
+    const std::size_t size = relay.receive(asio::buffer(buf));
+    return std::string(buf, size);
+  }
+
+  void relay_send(const socks::udp_header& header, const std::string& payload)
+  {
+    std::string datagram(asio::buffer_cast<const char*>(header.buffer()),
+                         header.size());
+    datagram += payload;
+    relay.send(asio::buffer(datagram));
+  }
+
+  asio::io_service io_service;
+  asio::ip::udp::socket relay;
+  asio::ip::udp::socket socket;
+};
+
+static std::string header_string(const socks::udp_header& h)
+{
+  return std::string(asio::buffer_cast<const char*>(h.buffer()), h.size());
+}
+
+BOOST_AUTO_TEST_CASE(header)
+{
+  socks::udp_header h1(peer_v4);
+  BOOST_CHECK_EQUAL(std::string("\x00\x00\x00\x01\x0a\x00\x00\x01\x00\x35",
+                                10), header_string(h1));
+  BOOST_CHECK(peer_v4 == h1.endpoint());
+  BOOST_CHECK_EQUAL(53, h1.port());
+  BOOST_CHECK(!h1.is_hostname());
+
+  socks::udp_header h2(peer_v6);
+  BOOST_CHECK_EQUAL(22, h2.size());
+  BOOST_CHECK(peer_v6 == h2.endpoint());
+
+  socks::udp_header h3("example.com", 80);
+  BOOST_CHECK_EQUAL(std::string("\x00\x00\x00\x03\x0b", 5) + "example.com" +
+                    std::string("\x00\x50", 2), header_string(h3));
+  BOOST_CHECK(h3.is_hostname());
+  BOOST_CHECK_EQUAL("example.com", h3.hostname());
+  BOOST_CHECK_EQUAL(80, h3.port());
+  BOOST_CHECK(asio::ip::udp::endpoint() == h3.endpoint());
+
+  BOOST_CHECK_THROW(socks::udp_header(std::string(256, 'a'), 80), std::length_error);
+
+  socks::udp_header h4;
+  BOOST_CHECK_EQUAL(0, h4.size());
+}
+
+BOOST_AUTO_TEST_CASE(associate)
+{
+  asio::io_service io_service;
+  asio::ip::tcp::acceptor acceptor(io_service, asio::ip::tcp::endpoint(
+      asio::ip::address_v4::loopback(), 0));
+  asio::ip::tcp::socket server(io_service);
+
+  char request[10];
+  // Bound address 0.0.0.0 means "the server's address".
+  const std::string reply("\x05\x00\x00\x01\x00\x00\x00\x00\x12\x34", 10);
+  acceptor.async_accept(server, [&] (error_code ec) {
+    BOOST_REQUIRE(!ec);
+    asio::async_read(server, asio::buffer(request),
+                     [&] (error_code ec, std::size_t) {
+      BOOST_REQUIRE(!ec);
+      asio::async_write(server, asio::buffer(reply),
+                        [] (error_code ec, std::size_t) {
+        BOOST_REQUIRE(!ec);
+      });
+    });
+  });
+
+  asio::ip::tcp::socket socket(io_service);
+  socket.connect(acceptor.local_endpoint());
+
+  linear_buffer buffer;
+  error_code ec = asio::error::would_block;
+  asio::ip::udp::endpoint relay;
+  socks::async_udp_associate(socket, peer_v4, dynamic_buffer(buffer),
+                             [&] (error_code e, asio::ip::udp::endpoint r) {
+    ec = e;
+    relay = r;
+  });
+  io_service.run();
+
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK_EQUAL(std::string("\x05\x03\x00\x01\x0a\x00\x00\x01\x00\x35",
+                                10), std::string(request, 10));
+  BOOST_CHECK(asio::ip::udp::endpoint(asio::ip::address_v4::loopback(),
+                                      0x1234) == relay);
+}
+
+BOOST_AUTO_TEST_CASE(send)
+{
+  relay_fixture f;
+
+  const socks::udp_header destination(peer_v4);
+  const std::string p1 = "hello ", p2 = "world";
+  std::vector<asio::const_buffer> payload;
+  payload.push_back(asio::buffer(p1));
+  payload.push_back(asio::buffer(p2));
+
+  error_code ec = asio::error::would_block;
+  std::size_t size = 0;
+  socks::async_send_to(f.socket, payload, destination,
+                       [&] (error_code e, std::size_t n) {
+    ec = e;
+    size = n;
+  });
+  f.io_service.run();
+
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  BOOST_CHECK_EQUAL(11, size);
+  BOOST_CHECK_EQUAL(header_string(destination) + "hello world",
+                    f.relay_receive());
+}
+
+BOOST_AUTO_TEST_CASE(receive)
+{
+  relay_fixture f;
+
+  // Different header sizes exercise both directions of the payload fix-up.
+  // The fragmented datagram has to be dropped.
+  std::string fragmented = header_string(socks::udp_header(peer_v4)) + "frag";
+  fragmented[2] = 1;
+  f.relay.send(asio::buffer(fragmented));
+
+  f.relay_send(socks::udp_header(peer_v6), "first datagram");
+  f.relay_send(socks::udp_header(peer_v4), "second datagram");
+  f.relay_send(socks::udp_header("example.com", 80), "third");
+  f.relay_send(socks::udp_header(peer_v4), "fourth datagram");
+
+  const asio::ip::udp::endpoint sources[] = {
+    peer_v6, peer_v4, asio::ip::udp::endpoint(), peer_v4
+  };
+  const char* payloads[] = {
+    "first datagram", "second datagram", "third", "fourth datagram"
+  };
+
+  socks::udp_header source;
+  for (std::size_t i = 0; i != 4; ++i) {
+    // Split the payload buffer to cross segment boundaries.
+    char a[3], b[64];
+    std::vector<asio::mutable_buffer> buffers;
+    buffers.push_back(asio::buffer(a));
+    buffers.push_back(asio::buffer(b));
+
+    error_code ec = asio::error::would_block;
+    std::size_t size = 0;
+    socks::async_receive_from(f.socket, buffers, source,
+                              [&] (error_code e, std::size_t n) {
+      ec = e;
+      size = n;
+    });
+    f.io_service.reset();
+    f.io_service.run();
+
+    BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+    BOOST_REQUIRE_EQUAL(std::strlen(payloads[i]), size);
+    BOOST_CHECK_EQUAL(payloads[i],
+                      std::string(a, 3) + std::string(b, size - 3));
+    BOOST_CHECK(sources[i] == source.endpoint());
+    BOOST_CHECK_EQUAL(i == 2 ? "example.com" : "", source.hostname());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(receive_truncated)
+{
+  relay_fixture f;
+
+  // The first datagram sets the expected header size to that of IPv4.
+  // The second one's larger header pushes the end of its payload (which
+  // fills the buffer) behind the buffer, from where it has to be recovered.
+  // Only the last one's payload really doesn't fit.
+  const std::string payload(16, 'x');
+  f.relay_send(socks::udp_header(peer_v4), payload);
+  f.relay_send(socks::udp_header("example.com", 80), payload);
+  f.relay_send(socks::udp_header(peer_v4), payload);
+  f.relay_send(socks::udp_header(peer_v6), payload + "yz");
+
+  const error_code expected[] = {
+    error_code(), error_code(), error_code(), asio::error::message_size
+  };
+
+  socks::udp_header source;
+  for (std::size_t i = 0; i != 4; ++i) {
+    char buffer[16];
+    error_code ec = asio::error::would_block;
+    std::size_t size = 0;
+    socks::async_receive_from(f.socket, asio::buffer(buffer), source,
+                              [&] (error_code e, std::size_t n) {
+      ec = e;
+      size = n;
+    });
+    f.io_service.reset();
+    f.io_service.run();
+
+    BOOST_REQUIRE_MESSAGE(ec == expected[i], "ec: " << ec);
+    BOOST_CHECK_EQUAL(payload.size(), size);
+    BOOST_CHECK_EQUAL(payload, std::string(buffer, size));
+  }
+  BOOST_CHECK(peer_v6 == source.endpoint());
+
+  // Batches report the result of each datagram.
+  std::string fragmented = header_string(socks::udp_header(peer_v4)) + "frag";
+  fragmented[2] = 1;
+  f.relay_send(socks::udp_header(peer_v4), payload);
+  f.relay_send(socks::udp_header(peer_v6), payload);
+  f.relay.send(asio::buffer(fragmented));
+  f.relay_send(socks::udp_header("example.com", 80), payload + "yz");
+
+  char storage[4][16];
+  socks::udp_message received[4];
+  for (std::size_t i = 0; i != 4; ++i)
+    received[i].payload = asio::buffer(storage[i]);
+
+  error_code ec;
+  std::size_t count = 0;
+  while (count != 4) {
+    count += socks::receive_batch(f.socket, received + count, 4 - count, ec);
+    BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  }
+
+  const error_code batch_expected[] = {
+    error_code(), error_code(), socks::error::invalid_datagram,
+    asio::error::message_size
+  };
+  const std::size_t sizes[] = { 16, 16, 0, 16 };
+  for (std::size_t i = 0; i != 4; ++i) {
+    BOOST_CHECK_MESSAGE(received[i].error == batch_expected[i],
+                        "error: " << received[i].error);
+    BOOST_REQUIRE_EQUAL(sizes[i], received[i].size);
+    BOOST_CHECK_EQUAL(payload.substr(0, sizes[i]),
+                      std::string(storage[i], sizes[i]));
+  }
+  BOOST_CHECK_EQUAL("example.com", received[3].header.hostname());
+}
+
+BOOST_AUTO_TEST_CASE(batch)
+{
+  relay_fixture f;
+
+  std::string payloads[3] = { "one", "two", "three" };
+  socks::udp_message messages[3];
+  messages[0].header.assign(peer_v4);
+  messages[1].header.assign(peer_v6);
+  messages[2].header.assign(peer_v4);
+  for (std::size_t i = 0; i != 3; ++i)
+    messages[i].payload = asio::buffer(&payloads[i][0], payloads[i].size());
+
+  error_code ec;
+  BOOST_REQUIRE_EQUAL(3, socks::send_batch(f.socket, messages, 3, ec));
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+
+  for (std::size_t i = 0; i != 3; ++i) {
+    BOOST_CHECK_EQUAL(payloads[i].size(), messages[i].size);
+    const std::string datagram = f.relay_receive();
+    BOOST_CHECK_EQUAL(header_string(messages[i].header) + payloads[i],
+                      datagram);
+    f.relay.send(asio::buffer(datagram));
+  }
+
+  char storage[3][16];
+  socks::udp_message received[4];
+  for (std::size_t i = 0; i != 4; ++i)
+    received[i].payload = asio::buffer(storage[i % 3]);
+
+  // All three are queued, so a single call returns them.
+  BOOST_REQUIRE_EQUAL(3, socks::receive_batch(f.socket, received, 4, ec));
+  BOOST_REQUIRE_MESSAGE(!ec, "ec: " << ec);
+  for (std::size_t i = 0; i != 3; ++i) {
+    BOOST_REQUIRE_EQUAL(payloads[i].size(), received[i].size);
+    BOOST_CHECK_EQUAL(payloads[i], std::string(storage[i], received[i].size));
+    BOOST_CHECK(messages[i].header.endpoint() ==
+                received[i].header.endpoint());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+ASIOEXT_NS_END